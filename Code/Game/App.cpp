@@ -170,11 +170,17 @@ void App::RunFrame()
 	BeginFrame();	
 	
 	Update();
+
+	//When pipelining, the raycasts for the next frame run on the job pool while this frame renders
+	m_game->KickPipelinedRaycasts();
 	Render();	
 
 	PostRender();
 
 	EndFrame();
+
+	//Commit before we pump messages again since input handlers are free to modify the scene
+	m_game->CommitPipelinedRaycasts();
 }
 
 
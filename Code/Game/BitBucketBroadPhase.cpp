@@ -1,5 +1,19 @@
 #include "Game/BitBucketBroadPhase.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include <cfloat>
+#include <cmath>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static int ClampCellIndex(int cellIndex, int numCells)
+{
+	if (cellIndex < 0)
+		return 0;
+
+	if (cellIndex >= numCells)
+		return numCells - 1;
+
+	return cellIndex;
+}
 
 //------------------------------------------------------------------------------------------------------------------------------
 BitFieldBroadPhase::BitFieldBroadPhase()
@@ -56,11 +70,17 @@ IntVec2 BitFieldBroadPhase::GetRegionForConvexPoly(const ConvexPoly2D& polygon)
 IntVec2 BitFieldBroadPhase::GetRegionIDForMinMaxs(const Vec2& shapeMins, const Vec2& shapeMaxs) const
 {
 	//Check what regions encompass the shape and return those as bit fields in the IntVec2
-	int minXCell = (shapeMins.x) / m_xDelta;
-	int minYCell = (shapeMins.y) / m_yDelta;
+	int minXCell = (shapeMins.x - m_worldMins.x) / m_xDelta;
+	int minYCell = (shapeMins.y - m_worldMins.y) / m_yDelta;
+
+	int maxXCell = (shapeMaxs.x - m_worldMins.x) / m_xDelta;
+	int maxYCell = (shapeMaxs.y - m_worldMins.y) / m_yDelta;
 
-	int maxXCell = (shapeMaxs.x) / m_xDelta;
-	int maxYCell = (shapeMaxs.y) / m_yDelta;
+	//Shapes inflated by a sweep can reach past the world bounds, keep the cells inside the bit fields we have
+	minXCell = ClampCellIndex(minXCell, m_numBitFieldsToUse);
+	minYCell = ClampCellIndex(minYCell, m_numBitFieldsToUse);
+	maxXCell = ClampCellIndex(maxXCell, m_numBitFieldsToUse);
+	maxYCell = ClampCellIndex(maxYCell, m_numBitFieldsToUse);
 
 	//We now need to get all the bit flags for the regions between minX and maxX and add OR them to define the region of the shape
 	//Same for Y which will be the y component in the IntVec2
@@ -130,6 +150,50 @@ IntVec2 BitFieldBroadPhase::GetRegionForRay(const Ray2D& ray) const
 	return regionID;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+IntVec2 BitFieldBroadPhase::GetRegionForSweptCapsule(const Vec2& segmentStart, const Vec2& segmentEnd, float radius, const Vec2& displacement) const
+{
+	//Same regions as a static shape, just with the bounds inflated by the radius and stretched along the displacement
+	Vec2 minBounds;
+	minBounds.x = GetLowerValue(segmentStart.x, segmentEnd.x) - radius;
+	minBounds.y = GetLowerValue(segmentStart.y, segmentEnd.y) - radius;
+
+	Vec2 maxBounds;
+	maxBounds.x = GetHigherValue(segmentStart.x, segmentEnd.x) + radius;
+	maxBounds.y = GetHigherValue(segmentStart.y, segmentEnd.y) + radius;
+
+	minBounds.x += GetLowerValue(displacement.x, 0.f);
+	minBounds.y += GetLowerValue(displacement.y, 0.f);
+	maxBounds.x += GetHigherValue(displacement.x, 0.f);
+	maxBounds.y += GetHigherValue(displacement.y, 0.f);
+
+	IntVec2 regionID = GetRegionIDForMinMaxs(minBounds, maxBounds);
+	return regionID;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+IntVec2 BitFieldBroadPhase::GetCellForPoint(const Vec2& point) const
+{
+	IntVec2 cell;
+	cell.x = ClampCellIndex((int)((point.x - m_worldMins.x) / m_xDelta), m_numBitFieldsToUse);
+	cell.y = ClampCellIndex((int)((point.y - m_worldMins.y) / m_yDelta), m_numBitFieldsToUse);
+	return cell;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BitFieldBroadPhase::GetCellRangeForMinMaxs(const Vec2& shapeMins, const Vec2& shapeMaxs, IntVec2& minCellOut, IntVec2& maxCellOut) const
+{
+	minCellOut = GetCellForPoint(shapeMins);
+	maxCellOut = GetCellForPoint(shapeMaxs);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BitFieldBroadPhase::GetCellBounds(const IntVec2& cell, Vec2& cellMinsOut, Vec2& cellMaxsOut) const
+{
+	cellMinsOut = m_worldMins + Vec2(cell.x * m_xDelta, cell.y * m_yDelta);
+	cellMaxsOut = cellMinsOut + Vec2(m_xDelta, m_yDelta);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void BitFieldBroadPhase::SetWorldDimensions(const Vec2& mins, const Vec2& maxs)
 {
@@ -176,3 +240,292 @@ void BitFieldBroadPhase::MakeRegionsForWorld()
 		yMaxs += yStepVec;
 	}
 }
+
+//------------------------------------------------------------------------------------------------------------------------------
+BitFieldCellBuckets::BitFieldCellBuckets()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+BitFieldCellBuckets::~BitFieldCellBuckets()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BitFieldCellBuckets::Build(const std::vector<IntVec2>& bitFields, int numCellsPerAxis, int slackPerCell)
+{
+	Clear();
+
+	m_numCellsPerAxis = numCellsPerAxis;
+	int numCells = numCellsPerAxis * numCellsPerAxis;
+	int numEntries = (int)bitFields.size();
+
+	m_cellStarts.assign(numCells + 1, 0);
+	m_cellCounts.assign(numCells, 0);
+	m_firstCells.assign(numEntries, IntVec2(numCellsPerAxis, numCellsPerAxis));
+
+	//Counting pass then fill pass so every cell's entries end up contiguous
+	std::vector<int> cellFill;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		if (pass == 1)
+		{
+			for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+			{
+				m_cellCounts[cellIndex] = m_cellStarts[cellIndex + 1];
+				m_cellStarts[cellIndex + 1] += m_cellStarts[cellIndex] + slackPerCell;
+			}
+
+			m_cellEntries.assign(m_cellStarts[numCells], -1);
+			cellFill.assign(m_cellStarts.begin(), m_cellStarts.end() - 1);
+		}
+
+		for (int entryIndex = 0; entryIndex < numEntries; entryIndex++)
+		{
+			const IntVec2& entryBitFields = bitFields[entryIndex];
+
+			for (int cellY = 0; cellY < numCellsPerAxis; cellY++)
+			{
+				if ((entryBitFields.y & BIT_FLAG(cellY)) == 0)
+					continue;
+
+				for (int cellX = 0; cellX < numCellsPerAxis; cellX++)
+				{
+					if ((entryBitFields.x & BIT_FLAG(cellX)) == 0)
+						continue;
+
+					int cellIndex = cellY * numCellsPerAxis + cellX;
+					if (pass == 0)
+					{
+						m_cellStarts[cellIndex + 1]++;
+
+						IntVec2& firstCell = m_firstCells[entryIndex];
+						firstCell.x = (cellX < firstCell.x) ? cellX : firstCell.x;
+						firstCell.y = (cellY < firstCell.y) ? cellY : firstCell.y;
+					}
+					else
+					{
+						m_cellEntries[cellFill[cellIndex]++] = entryIndex;
+					}
+				}
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BitFieldCellBuckets::Clear()
+{
+	m_numCellsPerAxis = 0;
+	m_cellStarts.clear();
+	m_cellCounts.clear();
+	m_cellEntries.clear();
+	m_firstCells.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool BitFieldCellBuckets::MoveEntry(int entryIndex, const IntVec2& oldBitFields, const IntVec2& newBitFields)
+{
+	if (oldBitFields.x == newBitFields.x && oldBitFields.y == newBitFields.y)
+		return true;
+
+	//Room is checked for every entered cell first so a failed move leaves the buckets as they were
+	for (int pass = 0; pass < 3; pass++)
+	{
+		for (int cellY = 0; cellY < m_numCellsPerAxis; cellY++)
+		{
+			bool wasInRow = (oldBitFields.y & BIT_FLAG(cellY)) != 0;
+			bool isInRow = (newBitFields.y & BIT_FLAG(cellY)) != 0;
+			if (!wasInRow && !isInRow)
+				continue;
+
+			for (int cellX = 0; cellX < m_numCellsPerAxis; cellX++)
+			{
+				bool wasInCell = wasInRow && (oldBitFields.x & BIT_FLAG(cellX)) != 0;
+				bool isInCell = isInRow && (newBitFields.x & BIT_FLAG(cellX)) != 0;
+				if (wasInCell == isInCell)
+					continue;
+
+				int cellIndex = cellY * m_numCellsPerAxis + cellX;
+				int cellStart = m_cellStarts[cellIndex];
+				int cellEnd = cellStart + m_cellCounts[cellIndex];
+
+				if (pass == 0)
+				{
+					if (isInCell && cellEnd == m_cellStarts[cellIndex + 1])
+						return false;
+				}
+				else if (pass == 1 && wasInCell)
+				{
+					//Close the gap so the cell stays contiguous and ordered
+					int bucketIndex = cellStart;
+					while (m_cellEntries[bucketIndex] != entryIndex)
+					{
+						bucketIndex++;
+					}
+
+					for (; bucketIndex < cellEnd - 1; bucketIndex++)
+					{
+						m_cellEntries[bucketIndex] = m_cellEntries[bucketIndex + 1];
+					}
+
+					m_cellEntries[cellEnd - 1] = -1;
+					m_cellCounts[cellIndex]--;
+				}
+				else if (pass == 2 && isInCell)
+				{
+					int bucketIndex = cellEnd;
+					while (bucketIndex > cellStart && m_cellEntries[bucketIndex - 1] > entryIndex)
+					{
+						m_cellEntries[bucketIndex] = m_cellEntries[bucketIndex - 1];
+						bucketIndex--;
+					}
+
+					m_cellEntries[bucketIndex] = entryIndex;
+					m_cellCounts[cellIndex]++;
+				}
+			}
+		}
+	}
+
+	//Lowest set bit on each axis, the same cell the build would have found first
+	IntVec2& firstCell = m_firstCells[entryIndex];
+	firstCell = IntVec2(m_numCellsPerAxis, m_numCellsPerAxis);
+	for (int cellIndex = m_numCellsPerAxis - 1; cellIndex >= 0; cellIndex--)
+	{
+		firstCell.x = ((newBitFields.x & BIT_FLAG(cellIndex)) != 0) ? cellIndex : firstCell.x;
+		firstCell.y = ((newBitFields.y & BIT_FLAG(cellIndex)) != 0) ? cellIndex : firstCell.y;
+	}
+
+	if (firstCell.x == m_numCellsPerAxis || firstCell.y == m_numCellsPerAxis)
+	{
+		firstCell = IntVec2(m_numCellsPerAxis, m_numCellsPerAxis);
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool BitFieldCellBuckets::IsFirstCellInRange(int entryIndex, const IntVec2& cell, const IntVec2& rangeMinCell) const
+{
+	const IntVec2& firstCell = m_firstCells[entryIndex];
+	int firstX = (firstCell.x > rangeMinCell.x) ? firstCell.x : rangeMinCell.x;
+	int firstY = (firstCell.y > rangeMinCell.y) ? firstCell.y : rangeMinCell.y;
+
+	return cell.x == firstX && cell.y == firstY;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+BitFieldRayWalker::BitFieldRayWalker()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+BitFieldRayWalker::~BitFieldRayWalker()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool BitFieldRayWalker::Begin(const BitFieldBroadPhase& broadPhase, const Ray2D& ray, float maxTime)
+{
+	m_numCellsPerAxis = broadPhase.GetNumBitFields();
+
+	Vec2 gridMins;
+	Vec2 cellSize;
+	broadPhase.GetCellBounds(IntVec2(0, 0), gridMins, cellSize);
+	cellSize = cellSize - gridMins;
+	Vec2 gridMaxs = gridMins + (float)m_numCellsPerAxis * cellSize;
+
+	//Part of the ray over the grid
+	float startTime = 0.f;
+	float endTime = maxTime;
+	float rayStart[2] = { ray.m_start.x, ray.m_start.y };
+	float rayDirection[2] = { ray.m_direction.x, ray.m_direction.y };
+	float mins[2] = { gridMins.x, gridMins.y };
+	float maxs[2] = { gridMaxs.x, gridMaxs.y };
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (rayDirection[axis] == 0.f)
+		{
+			if (rayStart[axis] < mins[axis] || rayStart[axis] > maxs[axis])
+				return false;
+
+			continue;
+		}
+
+		float minTime = (mins[axis] - rayStart[axis]) / rayDirection[axis];
+		float maxTimeOnAxis = (maxs[axis] - rayStart[axis]) / rayDirection[axis];
+		startTime = GetHigherValue(startTime, GetLowerValue(minTime, maxTimeOnAxis));
+		endTime = GetLowerValue(endTime, GetHigherValue(minTime, maxTimeOnAxis));
+	}
+
+	if (startTime > endTime)
+		return false;
+
+	m_endTime = endTime;
+
+	//The time to the next cell boundary on each axis decides which way to step
+	m_cell = broadPhase.GetCellForPoint(ray.GetPointAtTime(startTime));
+	m_step.x = (ray.m_direction.x > 0.f) ? 1 : ((ray.m_direction.x < 0.f) ? -1 : 0);
+	m_step.y = (ray.m_direction.y > 0.f) ? 1 : ((ray.m_direction.y < 0.f) ? -1 : 0);
+
+	m_nextTimeX = FLT_MAX;
+	m_deltaTimeX = FLT_MAX;
+	if (m_step.x != 0)
+	{
+		float boundaryX = gridMins.x + (float)(m_cell.x + ((m_step.x > 0) ? 1 : 0)) * cellSize.x;
+		m_nextTimeX = (boundaryX - ray.m_start.x) / ray.m_direction.x;
+		m_deltaTimeX = cellSize.x / fabsf(ray.m_direction.x);
+	}
+
+	m_nextTimeY = FLT_MAX;
+	m_deltaTimeY = FLT_MAX;
+	if (m_step.y != 0)
+	{
+		float boundaryY = gridMins.y + (float)(m_cell.y + ((m_step.y > 0) ? 1 : 0)) * cellSize.y;
+		m_nextTimeY = (boundaryY - ray.m_start.y) / ray.m_direction.y;
+		m_deltaTimeY = cellSize.y / fabsf(ray.m_direction.y);
+	}
+
+	m_cellEnterTime = startTime;
+	m_isFirstCell = true;
+	UpdateCellExit();
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool BitFieldRayWalker::Advance()
+{
+	if (m_isLastCell)
+		return false;
+
+	if (m_nextTimeX < m_nextTimeY)
+	{
+		m_cell.x += m_step.x;
+		m_nextTimeX += m_deltaTimeX;
+	}
+	else
+	{
+		m_cell.y += m_step.y;
+		m_nextTimeY += m_deltaTimeY;
+	}
+
+	m_cellEnterTime = m_cellExitTime;
+	m_isFirstCell = false;
+	UpdateCellExit();
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BitFieldRayWalker::UpdateCellExit()
+{
+	bool stepsAlongX = m_nextTimeX < m_nextTimeY;
+	m_cellExitTime = GetLowerValue(stepsAlongX ? m_nextTimeX : m_nextTimeY, m_endTime);
+
+	IntVec2 nextCell = stepsAlongX ? IntVec2(m_cell.x + m_step.x, m_cell.y) : IntVec2(m_cell.x, m_cell.y + m_step.y);
+	m_isLastCell = m_cellExitTime >= m_endTime || nextCell.x < 0 || nextCell.y < 0 || nextCell.x >= m_numCellsPerAxis || nextCell.y >= m_numCellsPerAxis;
+}
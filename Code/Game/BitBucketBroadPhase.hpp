@@ -29,6 +29,13 @@ public:
 	IntVec2		GetRegionForConvexPoly(const ConvexPoly2D& polygon) const;
 	IntVec2		GetRegionIDForMinMaxs(const Vec2& shapeMins, const Vec2& shapeMaxs) const;
 	IntVec2		GetRegionForRay(const Ray2D& ray) const;
+	IntVec2		GetRegionForSweptCapsule(const Vec2& segmentStart, const Vec2& segmentEnd, float radius, const Vec2& displacement) const;
+
+	//Cell coordinates (bit indices on each axis) of the region containing the point, clamped to the world
+	IntVec2		GetCellForPoint(const Vec2& point) const;
+	int			GetNumBitFields() const { return m_numBitFieldsToUse; }
+	void		GetCellRangeForMinMaxs(const Vec2& shapeMins, const Vec2& shapeMaxs, IntVec2& minCellOut, IntVec2& maxCellOut) const;
+	void		GetCellBounds(const IntVec2& cell, Vec2& cellMinsOut, Vec2& cellMaxsOut) const;
 	
 	void		SetWorldDimensions(const Vec2& mins, const Vec2& maxs);
 
@@ -47,3 +54,86 @@ private:
 };
 
 //------------------------------------------------------------------------------------------------------------------------------
+
+//Spare room left in every cell by buckets built for moving entries, a cell that fills up needs a rebuild
+constexpr int CELL_BUCKET_REFIT_SLACK = 8;
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Entries bucketed per broadphase cell from their bit fields, every cell's entries are contiguous and in ascending order
+//The first cell of each entry is kept so a query spanning several cells can report every entry once
+//Built with slack, an entry whose bit fields changed can be moved between cells without touching the rest
+//------------------------------------------------------------------------------------------------------------------------------
+class BitFieldCellBuckets
+{
+public:
+	BitFieldCellBuckets();
+	~BitFieldCellBuckets();
+
+	void			Build(const std::vector<IntVec2>& bitFields, int numCellsPerAxis, int slackPerCell = 0);
+	void			Clear();
+
+	//Takes the entry out of the cells it left and into the ones it entered, keeping every cell in ascending order
+	//Returns false without changing anything when an entered cell has no room left
+	bool			MoveEntry(int entryIndex, const IntVec2& oldBitFields, const IntVec2& newBitFields);
+
+	int				GetNumCellsPerAxis() const { return m_numCellsPerAxis; }
+	int				GetCellIndex(const IntVec2& cell) const { return cell.y * m_numCellsPerAxis + cell.x; }
+
+	//Entries of a cell are GetEntry(GetCellStart(c)) to GetEntry(GetCellEnd(c) - 1)
+	int				GetCellStart(int cellIndex) const { return m_cellStarts[cellIndex]; }
+	int				GetCellEnd(int cellIndex) const { return m_cellStarts[cellIndex] + m_cellCounts[cellIndex]; }
+	int				GetEntry(int bucketIndex) const { return m_cellEntries[bucketIndex]; }
+
+	//True for the first cell of the query range the entry is in, use it to skip the duplicates in the other cells
+	bool			IsFirstCellInRange(int entryIndex, const IntVec2& cell, const IntVec2& rangeMinCell) const;
+	const IntVec2&	GetFirstCell(int entryIndex) const { return m_firstCells[entryIndex]; }
+
+private:
+	int						m_numCellsPerAxis = 0;
+	std::vector<int>		m_cellStarts;			//Cell i has room for m_cellStarts[i + 1] - m_cellStarts[i] entries
+	std::vector<int>		m_cellCounts;
+	std::vector<int>		m_cellEntries;
+	std::vector<IntVec2>	m_firstCells;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Walks the broadphase cells a ray crosses in the order it crosses them. Each cell covers the ray times
+//[GetCellEnterTime(), GetCellExitTime()) and neighbouring cells share the boundary time exactly
+//------------------------------------------------------------------------------------------------------------------------------
+class BitFieldRayWalker
+{
+public:
+	BitFieldRayWalker();
+	~BitFieldRayWalker();
+
+	//Starts on the first cell, false when the ray misses the grid before maxTime
+	bool			Begin(const BitFieldBroadPhase& broadPhase, const Ray2D& ray, float maxTime);
+
+	//Moves on to the next cell, false once the last cell has been visited
+	bool			Advance();
+
+	const IntVec2&	GetCell() const { return m_cell; }
+	float			GetCellEnterTime() const { return m_cellEnterTime; }
+	float			GetCellExitTime() const { return m_cellExitTime; }
+	bool			IsFirstCell() const { return m_isFirstCell; }
+	bool			IsLastCell() const { return m_isLastCell; }
+
+private:
+	void			UpdateCellExit();
+
+private:
+	int				m_numCellsPerAxis = 0;
+	float			m_endTime = 0.f;
+
+	IntVec2			m_cell = IntVec2::ZERO;
+	IntVec2			m_step = IntVec2::ZERO;
+	float			m_nextTimeX = 0.f;
+	float			m_nextTimeY = 0.f;
+	float			m_deltaTimeX = 0.f;
+	float			m_deltaTimeY = 0.f;
+
+	float			m_cellEnterTime = 0.f;
+	float			m_cellExitTime = 0.f;
+	bool			m_isFirstCell = true;
+	bool			m_isLastCell = true;
+};
@@ -0,0 +1,549 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/ConvexDistance.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/JobPool.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Point of the Minkowski difference B - A along with the polygon vertices it came from
+struct SimplexVertex2D
+{
+	Vec2	m_pointA;
+	Vec2	m_pointB;
+	Vec2	m_point;			//m_pointB - m_pointA
+	float	m_weight = 0.f;		//Barycentric weight of the closest point
+	int		m_indexA = 0;
+	int		m_indexB = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct Simplex2D
+{
+	SimplexVertex2D		m_vertices[3];
+	int					m_numVertices = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static float DotProduct(const Vec2& a, const Vec2& b)
+{
+	return a.x * b.x + a.y * b.y;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static float CrossProduct(const Vec2& a, const Vec2& b)
+{
+	return a.x * b.y - a.y * b.x;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static int GetSupportIndex(const std::vector<Vec2>& points, const Vec2& direction)
+{
+	int bestIndex = 0;
+	float bestProjection = DotProduct(points[0], direction);
+	for (int pointIndex = 1; pointIndex < (int)points.size(); pointIndex++)
+	{
+		float projection = DotProduct(points[pointIndex], direction);
+		if (projection > bestProjection)
+		{
+			bestProjection = projection;
+			bestIndex = pointIndex;
+		}
+	}
+
+	return bestIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void SetSimplexVertex(SimplexVertex2D& vertex, const std::vector<Vec2>& pointsA, const std::vector<Vec2>& pointsB, int indexA, int indexB)
+{
+	vertex.m_indexA = indexA;
+	vertex.m_indexB = indexB;
+	vertex.m_pointA = pointsA[indexA];
+	vertex.m_pointB = pointsB[indexB];
+	vertex.m_point = vertex.m_pointB - vertex.m_pointA;
+	vertex.m_weight = 1.f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void ReadCache(Simplex2D& simplex, const GjkCache2D* cache, const std::vector<Vec2>& pointsA, const std::vector<Vec2>& pointsB)
+{
+	simplex.m_numVertices = 0;
+
+	if (cache != nullptr && cache->m_numPoints > 0 && cache->m_numPoints <= 3)
+	{
+		bool isCacheValid = true;
+		for (int vertexIndex = 0; vertexIndex < cache->m_numPoints; vertexIndex++)
+		{
+			int indexA = cache->m_indicesA[vertexIndex];
+			int indexB = cache->m_indicesB[vertexIndex];
+			if (indexA < 0 || indexA >= (int)pointsA.size() || indexB < 0 || indexB >= (int)pointsB.size())
+			{
+				isCacheValid = false;
+				break;
+			}
+
+			SetSimplexVertex(simplex.m_vertices[vertexIndex], pointsA, pointsB, indexA, indexB);
+		}
+
+		//The shapes may have moved enough since the cache was written to collapse the old simplex
+		if (isCacheValid && cache->m_numPoints == 2)
+		{
+			Vec2 edge = simplex.m_vertices[1].m_point - simplex.m_vertices[0].m_point;
+			isCacheValid = DotProduct(edge, edge) > FLT_EPSILON;
+		}
+		else if (isCacheValid && cache->m_numPoints == 3)
+		{
+			Vec2 edgeA = simplex.m_vertices[1].m_point - simplex.m_vertices[0].m_point;
+			Vec2 edgeB = simplex.m_vertices[2].m_point - simplex.m_vertices[0].m_point;
+			isCacheValid = fabsf(CrossProduct(edgeA, edgeB)) > FLT_EPSILON;
+		}
+
+		if (isCacheValid)
+		{
+			simplex.m_numVertices = cache->m_numPoints;
+			return;
+		}
+	}
+
+	SetSimplexVertex(simplex.m_vertices[0], pointsA, pointsB, 0, 0);
+	simplex.m_numVertices = 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void WriteCache(const Simplex2D& simplex, GjkCache2D* cache)
+{
+	if (cache == nullptr)
+		return;
+
+	cache->m_numPoints = simplex.m_numVertices;
+	for (int vertexIndex = 0; vertexIndex < simplex.m_numVertices; vertexIndex++)
+	{
+		cache->m_indicesA[vertexIndex] = simplex.m_vertices[vertexIndex].m_indexA;
+		cache->m_indicesB[vertexIndex] = simplex.m_vertices[vertexIndex].m_indexB;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Reduces a segment to the part closest to the origin, either one of its ends or the whole segment
+static void SolveSegment(Simplex2D& simplex)
+{
+	SimplexVertex2D& vertex1 = simplex.m_vertices[0];
+	SimplexVertex2D& vertex2 = simplex.m_vertices[1];
+
+	Vec2 edge12 = vertex2.m_point - vertex1.m_point;
+
+	float weight2 = -DotProduct(vertex1.m_point, edge12);
+	if (weight2 <= 0.f)
+	{
+		vertex1.m_weight = 1.f;
+		simplex.m_numVertices = 1;
+		return;
+	}
+
+	float weight1 = DotProduct(vertex2.m_point, edge12);
+	if (weight1 <= 0.f)
+	{
+		vertex2.m_weight = 1.f;
+		simplex.m_vertices[0] = vertex2;
+		simplex.m_numVertices = 1;
+		return;
+	}
+
+	float inverseSum = 1.f / (weight1 + weight2);
+	vertex1.m_weight = weight1 * inverseSum;
+	vertex2.m_weight = weight2 * inverseSum;
+	simplex.m_numVertices = 2;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Reduces a triangle to the vertex, edge or whole triangle region the origin is in
+static void SolveTriangle(Simplex2D& simplex)
+{
+	SimplexVertex2D& vertex1 = simplex.m_vertices[0];
+	SimplexVertex2D& vertex2 = simplex.m_vertices[1];
+	SimplexVertex2D& vertex3 = simplex.m_vertices[2];
+
+	const Vec2& point1 = vertex1.m_point;
+	const Vec2& point2 = vertex2.m_point;
+	const Vec2& point3 = vertex3.m_point;
+
+	//Edge regions
+	Vec2 edge12 = point2 - point1;
+	float weight12_1 = DotProduct(point2, edge12);
+	float weight12_2 = -DotProduct(point1, edge12);
+
+	Vec2 edge13 = point3 - point1;
+	float weight13_1 = DotProduct(point3, edge13);
+	float weight13_2 = -DotProduct(point1, edge13);
+
+	Vec2 edge23 = point3 - point2;
+	float weight23_1 = DotProduct(point3, edge23);
+	float weight23_2 = -DotProduct(point2, edge23);
+
+	//Triangle region
+	float area123 = CrossProduct(edge12, edge13);
+	float weight123_1 = area123 * CrossProduct(point2, point3);
+	float weight123_2 = area123 * CrossProduct(point3, point1);
+	float weight123_3 = area123 * CrossProduct(point1, point2);
+
+	if (weight12_2 <= 0.f && weight13_2 <= 0.f)
+	{
+		vertex1.m_weight = 1.f;
+		simplex.m_numVertices = 1;
+		return;
+	}
+
+	if (weight12_1 > 0.f && weight12_2 > 0.f && weight123_3 <= 0.f)
+	{
+		float inverseSum = 1.f / (weight12_1 + weight12_2);
+		vertex1.m_weight = weight12_1 * inverseSum;
+		vertex2.m_weight = weight12_2 * inverseSum;
+		simplex.m_numVertices = 2;
+		return;
+	}
+
+	if (weight13_1 > 0.f && weight13_2 > 0.f && weight123_2 <= 0.f)
+	{
+		float inverseSum = 1.f / (weight13_1 + weight13_2);
+		vertex1.m_weight = weight13_1 * inverseSum;
+		vertex3.m_weight = weight13_2 * inverseSum;
+		simplex.m_vertices[1] = vertex3;
+		simplex.m_numVertices = 2;
+		return;
+	}
+
+	if (weight12_1 <= 0.f && weight23_2 <= 0.f)
+	{
+		vertex2.m_weight = 1.f;
+		simplex.m_vertices[0] = vertex2;
+		simplex.m_numVertices = 1;
+		return;
+	}
+
+	if (weight13_1 <= 0.f && weight23_1 <= 0.f)
+	{
+		vertex3.m_weight = 1.f;
+		simplex.m_vertices[0] = vertex3;
+		simplex.m_numVertices = 1;
+		return;
+	}
+
+	if (weight23_1 > 0.f && weight23_2 > 0.f && weight123_1 <= 0.f)
+	{
+		float inverseSum = 1.f / (weight23_1 + weight23_2);
+		vertex2.m_weight = weight23_1 * inverseSum;
+		vertex3.m_weight = weight23_2 * inverseSum;
+		simplex.m_vertices[0] = vertex3;
+		simplex.m_numVertices = 2;
+		return;
+	}
+
+	//Origin is inside the triangle
+	float inverseSum = 1.f / (weight123_1 + weight123_2 + weight123_3);
+	vertex1.m_weight = weight123_1 * inverseSum;
+	vertex2.m_weight = weight123_2 * inverseSum;
+	vertex3.m_weight = weight123_3 * inverseSum;
+	simplex.m_numVertices = 3;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static Vec2 GetSearchDirection(const Simplex2D& simplex)
+{
+	if (simplex.m_numVertices == 1)
+		return -1.f * simplex.m_vertices[0].m_point;
+
+	//Perpendicular to the segment on the side of the origin
+	Vec2 edge12 = simplex.m_vertices[1].m_point - simplex.m_vertices[0].m_point;
+	if (CrossProduct(edge12, -1.f * simplex.m_vertices[0].m_point) > 0.f)
+		return Vec2(-edge12.y, edge12.x);
+
+	return Vec2(edge12.y, -edge12.x);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void GetWitnessPoints(const Simplex2D& simplex, Vec2& pointAOut, Vec2& pointBOut)
+{
+	pointAOut = Vec2::ZERO;
+	pointBOut = Vec2::ZERO;
+	for (int vertexIndex = 0; vertexIndex < simplex.m_numVertices; vertexIndex++)
+	{
+		const SimplexVertex2D& vertex = simplex.m_vertices[vertexIndex];
+		pointAOut += vertex.m_weight * vertex.m_pointA;
+		pointBOut += vertex.m_weight * vertex.m_pointB;
+	}
+
+	if (simplex.m_numVertices == 3)
+	{
+		pointBOut = pointAOut;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Expands the triangle GJK ended on towards the edge of B - A closest to the origin, that edge gives the penetration
+static void RunEPA(const Simplex2D& simplex, const std::vector<Vec2>& pointsA, const std::vector<Vec2>& pointsB, ConvexDistance2D& resultOut)
+{
+	std::vector<SimplexVertex2D> polytope(simplex.m_vertices, simplex.m_vertices + 3);
+
+	//Counter clockwise so every edge normal below faces out
+	if (CrossProduct(polytope[1].m_point - polytope[0].m_point, polytope[2].m_point - polytope[0].m_point) < 0.f)
+	{
+		std::swap(polytope[1], polytope[2]);
+	}
+
+	int closestEdge = 0;
+	float closestDistance = 0.f;
+	Vec2 closestNormal = Vec2::ZERO;
+
+	for (int iteration = 0; ; iteration++)
+	{
+		closestDistance = FLT_MAX;
+		int numVertices = (int)polytope.size();
+		for (int edgeIndex = 0; edgeIndex < numVertices; edgeIndex++)
+		{
+			Vec2 edge = polytope[(edgeIndex + 1) % numVertices].m_point - polytope[edgeIndex].m_point;
+			Vec2 normal = Vec2(edge.y, -edge.x);
+			float edgeLength = normal.GetLength();
+			if (edgeLength <= FLT_EPSILON)
+				continue;
+
+			normal = normal / edgeLength;
+			float distance = DotProduct(normal, polytope[edgeIndex].m_point);
+			if (distance < closestDistance)
+			{
+				closestDistance = distance;
+				closestNormal = normal;
+				closestEdge = edgeIndex;
+			}
+		}
+
+		//Out of iterations, settle for the closest edge found so far
+		if (iteration == EPA_MAX_ITERATIONS)
+			break;
+
+		SimplexVertex2D support;
+		SetSimplexVertex(support, pointsA, pointsB, GetSupportIndex(pointsA, -1.f * closestNormal), GetSupportIndex(pointsB, closestNormal));
+
+		//The boundary can not be pushed out any further along this normal so the edge is on the hull of B - A
+		if (DotProduct(support.m_point, closestNormal) - closestDistance < EPA_TOLERANCE)
+			break;
+
+		polytope.insert(polytope.begin() + closestEdge + 1, support);
+
+		//GJK's starting vertex can be inside B - A, drop any vertex the new one leaves in a dent so the polytope stays convex
+		bool removedVertex = true;
+		while (removedVertex && polytope.size() > 3)
+		{
+			removedVertex = false;
+			int numPolytopeVertices = (int)polytope.size();
+			for (int vertexIndex = 0; vertexIndex < numPolytopeVertices; vertexIndex++)
+			{
+				const Vec2& previousPoint = polytope[(vertexIndex + numPolytopeVertices - 1) % numPolytopeVertices].m_point;
+				const Vec2& nextPoint = polytope[(vertexIndex + 1) % numPolytopeVertices].m_point;
+				if (CrossProduct(polytope[vertexIndex].m_point - previousPoint, nextPoint - polytope[vertexIndex].m_point) <= 0.f)
+				{
+					polytope.erase(polytope.begin() + vertexIndex);
+					removedVertex = true;
+					break;
+				}
+			}
+		}
+	}
+
+	//Witness points from where the origin projects onto the closest edge
+	int numVertices = (int)polytope.size();
+	const SimplexVertex2D& edgeStart = polytope[closestEdge];
+	const SimplexVertex2D& edgeEnd = polytope[(closestEdge + 1) % numVertices];
+
+	Vec2 edge = edgeEnd.m_point - edgeStart.m_point;
+	float edgeLengthSquared = DotProduct(edge, edge);
+	float fraction = 0.f;
+	if (edgeLengthSquared > 0.f)
+	{
+		fraction = Clamp(DotProduct(closestDistance * closestNormal - edgeStart.m_point, edge) / edgeLengthSquared, 0.f, 1.f);
+	}
+
+	resultOut.m_isOverlapping = true;
+	resultOut.m_signedDistance = -closestDistance;
+	resultOut.m_normal = -1.f * closestNormal;
+	resultOut.m_closestPointA = edgeStart.m_pointA + fraction * (edgeEnd.m_pointA - edgeStart.m_pointA);
+	resultOut.m_closestPointB = edgeStart.m_pointB + fraction * (edgeEnd.m_pointB - edgeStart.m_pointB);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ConvexDistanceSolver::ConvexDistanceSolver()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ConvexDistanceSolver::~ConvexDistanceSolver()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void ConvexDistanceSolver::ComputeDistance(const std::vector<Vec2>& pointsA, const std::vector<Vec2>& pointsB, ConvexDistance2D& resultOut, GjkCache2D* cacheInOut)
+{
+	resultOut = ConvexDistance2D();
+	if (pointsA.empty() || pointsB.empty())
+		return;
+
+	Simplex2D simplex;
+	ReadCache(simplex, cacheInOut, pointsA, pointsB);
+
+	int savedIndicesA[3];
+	int savedIndicesB[3];
+
+	int iteration = 0;
+	while (iteration < GJK_MAX_ITERATIONS)
+	{
+		int numSaved = simplex.m_numVertices;
+		for (int vertexIndex = 0; vertexIndex < numSaved; vertexIndex++)
+		{
+			savedIndicesA[vertexIndex] = simplex.m_vertices[vertexIndex].m_indexA;
+			savedIndicesB[vertexIndex] = simplex.m_vertices[vertexIndex].m_indexB;
+		}
+
+		if (simplex.m_numVertices == 2)
+		{
+			SolveSegment(simplex);
+		}
+		else if (simplex.m_numVertices == 3)
+		{
+			SolveTriangle(simplex);
+		}
+
+		//Origin is enclosed, the shapes overlap
+		if (simplex.m_numVertices == 3)
+			break;
+
+		Vec2 searchDirection = GetSearchDirection(simplex);
+		if (DotProduct(searchDirection, searchDirection) < FLT_EPSILON * FLT_EPSILON)
+			break;
+
+		SimplexVertex2D& newVertex = simplex.m_vertices[simplex.m_numVertices];
+		SetSimplexVertex(newVertex, pointsA, pointsB, GetSupportIndex(pointsA, -1.f * searchDirection), GetSupportIndex(pointsB, searchDirection));
+		iteration++;
+
+		//A support point we already have means no more progress can be made
+		bool isDuplicate = false;
+		for (int vertexIndex = 0; vertexIndex < numSaved; vertexIndex++)
+		{
+			if (newVertex.m_indexA == savedIndicesA[vertexIndex] && newVertex.m_indexB == savedIndicesB[vertexIndex])
+			{
+				isDuplicate = true;
+				break;
+			}
+		}
+
+		if (isDuplicate)
+			break;
+
+		simplex.m_numVertices++;
+	}
+
+	WriteCache(simplex, cacheInOut);
+	resultOut.m_numIterations = iteration;
+
+	if (simplex.m_numVertices == 3)
+	{
+		//A flat triangle means the origin sits on the boundary, the shapes are just touching
+		const Vec2& point1 = simplex.m_vertices[0].m_point;
+		if (fabsf(CrossProduct(simplex.m_vertices[1].m_point - point1, simplex.m_vertices[2].m_point - point1)) > FLT_EPSILON)
+		{
+			RunEPA(simplex, pointsA, pointsB, resultOut);
+			return;
+		}
+	}
+
+	GetWitnessPoints(simplex, resultOut.m_closestPointA, resultOut.m_closestPointB);
+
+	Vec2 separation = resultOut.m_closestPointB - resultOut.m_closestPointA;
+	resultOut.m_signedDistance = separation.GetLength();
+	if (resultOut.m_signedDistance > 0.f)
+	{
+		resultOut.m_normal = separation / resultOut.m_signedDistance;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ConvexDistanceSolver::ComputeDistances(const std::vector<Geometry>& geometry, const std::vector<OverlapPair>& pairs, std::vector<ConvexDistance2D>& resultsOut, JobPool* jobPool, bool useWarmStart)
+{
+	int numPairs = (int)pairs.size();
+	resultsOut.resize(numPairs);
+
+	//Pick up the caches of pairs we solved last time
+	std::vector<uint64_t> pairKeys(numPairs);
+	std::vector<GjkCache2D> pairCaches(numPairs);
+	m_numWarmStartedPairs = 0;
+	for (int pairIndex = 0; pairIndex < numPairs; pairIndex++)
+	{
+		pairKeys[pairIndex] = MakePairKey(pairs[pairIndex]);
+		if (!useWarmStart)
+			continue;
+
+		std::vector<uint64_t>::const_iterator cacheIter = std::lower_bound(m_cacheKeys.begin(), m_cacheKeys.end(), pairKeys[pairIndex]);
+		if (cacheIter != m_cacheKeys.end() && *cacheIter == pairKeys[pairIndex])
+		{
+			pairCaches[pairIndex] = m_caches[cacheIter - m_cacheKeys.begin()];
+			m_numWarmStartedPairs++;
+		}
+	}
+
+	auto solveRange = [&geometry, &pairs, &resultsOut, &pairCaches](int startIndex, int endIndex)
+	{
+		for (int pairIndex = startIndex; pairIndex < endIndex; pairIndex++)
+		{
+			const std::vector<Vec2>& pointsA = geometry[pairs[pairIndex].m_geometryIndexA].GetConvexPoly2D().GetConvexPoly2DPoints();
+			const std::vector<Vec2>& pointsB = geometry[pairs[pairIndex].m_geometryIndexB].GetConvexPoly2D().GetConvexPoly2DPoints();
+			ComputeDistance(pointsA, pointsB, resultsOut[pairIndex], &pairCaches[pairIndex]);
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(numPairs, PAIR_QUERY_GRAIN_SIZE, solveRange);
+	}
+	else
+	{
+		solveRange(0, numPairs);
+	}
+
+	//Keep the caches sorted by key for the next batch
+	std::vector<int> sortedOrder(numPairs);
+	for (int pairIndex = 0; pairIndex < numPairs; pairIndex++)
+	{
+		sortedOrder[pairIndex] = pairIndex;
+	}
+
+	std::sort(sortedOrder.begin(), sortedOrder.end(), [&pairKeys](int lhs, int rhs)
+	{
+		return pairKeys[lhs] < pairKeys[rhs];
+	});
+
+	m_cacheKeys.resize(numPairs);
+	m_caches.resize(numPairs);
+	for (int sortedIndex = 0; sortedIndex < numPairs; sortedIndex++)
+	{
+		m_cacheKeys[sortedIndex] = pairKeys[sortedOrder[sortedIndex]];
+		m_caches[sortedIndex] = pairCaches[sortedOrder[sortedIndex]];
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ConvexDistanceSolver::ClearCaches()
+{
+	m_cacheKeys.clear();
+	m_caches.clear();
+	m_numWarmStartedPairs = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint64_t ConvexDistanceSolver::MakePairKey(const OverlapPair& pair)
+{
+	return ((uint64_t)(uint32_t)pair.m_geometryIndexA << 32) | (uint64_t)(uint32_t)pair.m_geometryIndexB;
+}
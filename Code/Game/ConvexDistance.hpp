@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Game/OverlapPairs.hpp"
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+class JobPool;
+
+constexpr int GJK_MAX_ITERATIONS = 32;
+constexpr int EPA_MAX_ITERATIONS = 64;		//Each iteration adds a vertex of B - A, which has at most as many as A and B together
+constexpr float EPA_TOLERANCE = 0.0001f;
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Vertex indices of the simplex GJK finished on, feeding them back in starts the next query where the last one ended
+//------------------------------------------------------------------------------------------------------------------------------
+struct GjkCache2D
+{
+	int		m_numPoints = 0;
+	int		m_indicesA[3] = { 0, 0, 0 };
+	int		m_indicesB[3] = { 0, 0, 0 };
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct ConvexDistance2D
+{
+	float	m_signedDistance = 0.f;			//Negative penetration depth when the shapes overlap
+	Vec2	m_closestPointA = Vec2::ZERO;	//Deepest points when overlapping
+	Vec2	m_closestPointB = Vec2::ZERO;
+	Vec2	m_normal = Vec2::ZERO;			//Points from A to B, moving B by -m_signedDistance along it separates them
+	int		m_numIterations = 0;
+	bool	m_isOverlapping = false;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//GJK distance between convex polygons with EPA for the penetration depth when they overlap
+//Both work on the polygon points through support functions so they do not care how many sides the polygons have
+//The batched form keeps a GJK cache per pair and warm starts each pair from the simplex it ended on last time
+//------------------------------------------------------------------------------------------------------------------------------
+class ConvexDistanceSolver
+{
+public:
+	ConvexDistanceSolver();
+	~ConvexDistanceSolver();
+
+	//Pass a cache to warm start from it, it is updated with the final simplex either way
+	static void				ComputeDistance(const std::vector<Vec2>& pointsA, const std::vector<Vec2>& pointsB, ConvexDistance2D& resultOut, GjkCache2D* cacheInOut = nullptr);
+
+	//resultsOut lines up with pairs. Pairs seen in the previous call reuse their cache unless useWarmStart is off
+	void					ComputeDistances(const std::vector<Geometry>& geometry, const std::vector<OverlapPair>& pairs, std::vector<ConvexDistance2D>& resultsOut, JobPool* jobPool = nullptr, bool useWarmStart = true);
+
+	void					ClearCaches();
+	int						GetNumWarmStartedPairs() const { return m_numWarmStartedPairs; }
+
+private:
+	static uint64_t			MakePairKey(const OverlapPair& pair);
+
+private:
+	//Sorted by key so the next batch can find its caches with a binary search
+	std::vector<uint64_t>	m_cacheKeys;
+	std::vector<GjkCache2D>	m_caches;
+
+	int						m_numWarmStartedPairs = 0;
+};
@@ -0,0 +1,167 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/DistanceFieldGrid.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include "Game/JobPool.hpp"
+#include "Game/SceneQuery.hpp"
+#include <cfloat>
+#include <cmath>
+
+//------------------------------------------------------------------------------------------------------------------------------
+DistanceFieldGrid::DistanceFieldGrid()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+DistanceFieldGrid::~DistanceFieldGrid()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void DistanceFieldGrid::Bake(const SceneQuery& sceneQuery, const AABB2& bounds, float cellSize, JobPool* jobPool)
+{
+	Clear();
+
+	m_bounds = bounds;
+
+	Vec2 dimensions = bounds.m_maxBounds - bounds.m_minBounds;
+	m_numSamples.x = (int)ceilf(dimensions.x / cellSize) + 1;
+	m_numSamples.y = (int)ceilf(dimensions.y / cellSize) + 1;
+	m_cellSize = Vec2(dimensions.x / (float)(m_numSamples.x - 1), dimensions.y / (float)(m_numSamples.y - 1));
+
+	AABB2 sceneBounds;
+	if (sceneQuery.GetSceneBounds(sceneBounds))
+	{
+		m_boundsContainAllGeometry = sceneBounds.m_minBounds.x >= bounds.m_minBounds.x && sceneBounds.m_minBounds.y >= bounds.m_minBounds.y
+			&& sceneBounds.m_maxBounds.x <= bounds.m_maxBounds.x && sceneBounds.m_maxBounds.y <= bounds.m_maxBounds.y;
+	}
+
+	m_distances.resize(m_numSamples.x * m_numSamples.y);
+
+	//Every sample is independent so rows can be baked in any order
+	auto bakeRows = [this, &sceneQuery](int startRow, int endRow)
+	{
+		NearestGeometry2D nearest;
+		NearestGeometryScratch nearestScratch;
+		for (int rowIndex = startRow; rowIndex < endRow; rowIndex++)
+		{
+			for (int columnIndex = 0; columnIndex < m_numSamples.x; columnIndex++)
+			{
+				Vec2 samplePoint = m_bounds.m_minBounds + Vec2(columnIndex * m_cellSize.x, rowIndex * m_cellSize.y);
+
+				float distance = FLT_MAX;
+				if (sceneQuery.FindNearestGeometry(samplePoint, nearest, nearestScratch))
+				{
+					distance = nearest.m_signedDistance;
+				}
+
+				m_distances[rowIndex * m_numSamples.x + columnIndex] = distance;
+			}
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(m_numSamples.y, 1, bakeRows);
+	}
+	else
+	{
+		bakeRows(0, m_numSamples.y);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void DistanceFieldGrid::Clear()
+{
+	m_distances.clear();
+	m_numSamples = IntVec2::ZERO;
+	m_boundsContainAllGeometry = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float DistanceFieldGrid::GetDistanceLowerBound(const Vec2& point) const
+{
+	int columnIndex = (int)floorf((point.x - m_bounds.m_minBounds.x) / m_cellSize.x + 0.5f);
+	int rowIndex = (int)floorf((point.y - m_bounds.m_minBounds.y) / m_cellSize.y + 0.5f);
+
+	columnIndex = (columnIndex < 0) ? 0 : ((columnIndex >= m_numSamples.x) ? m_numSamples.x - 1 : columnIndex);
+	rowIndex = (rowIndex < 0) ? 0 : ((rowIndex >= m_numSamples.y) ? m_numSamples.y - 1 : rowIndex);
+
+	//Distance changes by at most how far we move, so the nearest sample minus the offset to it is safe
+	Vec2 samplePoint = m_bounds.m_minBounds + Vec2(columnIndex * m_cellSize.x, rowIndex * m_cellSize.y);
+	return m_distances[rowIndex * m_numSamples.x + columnIndex] - (point - samplePoint).GetLength();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool DistanceFieldGrid::AdvanceRay(Ray2D& rayInOut, float& skippedTimeOut, const BitFieldBroadPhase& broadPhase) const
+{
+	skippedTimeOut = 0.f;
+
+	//Rays starting outside the field are left for the exact test as they are
+	float exitTime = 0.f;
+	if (!IsBaked() || !GetTimeInsideBounds(rayInOut, exitTime))
+		return true;
+
+	float time = 0.f;
+	for (int stepIndex = 0; stepIndex < DISTANCE_FIELD_MAX_TRACE_STEPS; stepIndex++)
+	{
+		float freeDistance = GetDistanceLowerBound(rayInOut.GetPointAtTime(time));
+		if (freeDistance < DISTANCE_FIELD_MIN_STEP)
+			break;
+
+		time += freeDistance - DISTANCE_FIELD_STEP_MARGIN;
+		if (time >= exitTime)
+		{
+			if (m_boundsContainAllGeometry)
+				return false;
+
+			time = exitTime;
+			break;
+		}
+	}
+
+	if (time == 0.f)
+		return true;
+
+	Vec2 exitPoint = rayInOut.GetPointAtTime(exitTime);
+	rayInOut.m_start = rayInOut.GetPointAtTime(time);
+	skippedTimeOut = time;
+
+	//Everything the ray can still hit sits between the new start and where it leaves the field
+	if (m_boundsContainAllGeometry)
+	{
+		Vec2 remainingMins = Vec2(GetLowerValue(rayInOut.m_start.x, exitPoint.x), GetLowerValue(rayInOut.m_start.y, exitPoint.y));
+		Vec2 remainingMaxs = Vec2(GetHigherValue(rayInOut.m_start.x, exitPoint.x), GetHigherValue(rayInOut.m_start.y, exitPoint.y));
+
+		IntVec2 remainingBitFields = broadPhase.GetRegionIDForMinMaxs(remainingMins, remainingMaxs);
+		rayInOut.m_bitFieldsXY.x &= remainingBitFields.x;
+		rayInOut.m_bitFieldsXY.y &= remainingBitFields.y;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool DistanceFieldGrid::GetTimeInsideBounds(const Ray2D& ray, float& exitTimeOut) const
+{
+	const Vec2& start = ray.m_start;
+	if (start.x < m_bounds.m_minBounds.x || start.x > m_bounds.m_maxBounds.x || start.y < m_bounds.m_minBounds.y || start.y > m_bounds.m_maxBounds.y)
+		return false;
+
+	exitTimeOut = FLT_MAX;
+	if (ray.m_direction.x != 0.f)
+	{
+		float boundaryX = (ray.m_direction.x > 0.f) ? m_bounds.m_maxBounds.x : m_bounds.m_minBounds.x;
+		exitTimeOut = GetLowerValue(exitTimeOut, (boundaryX - start.x) / ray.m_direction.x);
+	}
+
+	if (ray.m_direction.y != 0.f)
+	{
+		float boundaryY = (ray.m_direction.y > 0.f) ? m_bounds.m_maxBounds.y : m_bounds.m_minBounds.y;
+		exitTimeOut = GetLowerValue(exitTimeOut, (boundaryY - start.y) / ray.m_direction.y);
+	}
+
+	return true;
+}
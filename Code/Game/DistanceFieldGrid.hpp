@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Ray2D.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class BitFieldBroadPhase;
+class JobPool;
+class SceneQuery;
+
+constexpr float DISTANCE_FIELD_CELL_SIZE = 1.f;		//World units between baked samples
+constexpr float DISTANCE_FIELD_MIN_STEP = 0.25f;		//Tracing stops once the free distance drops below this
+constexpr float DISTANCE_FIELD_STEP_MARGIN = 0.01f;		//Kept between a traced ray and the geometry so it never starts on a surface
+constexpr int DISTANCE_FIELD_MAX_TRACE_STEPS = 64;		//Rays grazing along a surface hand over to the exact test after this many steps
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Signed distance to the nearest geometry baked at the corners of a regular grid over the world bounds
+//Raycasts sphere trace it to skip the empty space in front of them and only run the exact hull tests from
+//the point where they get close to something
+//------------------------------------------------------------------------------------------------------------------------------
+class DistanceFieldGrid
+{
+public:
+	DistanceFieldGrid();
+	~DistanceFieldGrid();
+
+	//Samples every grid corner with the nearest geometry query, rows are spread across the job pool when one is passed in
+	void					Bake(const SceneQuery& sceneQuery, const AABB2& bounds, float cellSize, JobPool* jobPool = nullptr);
+	void					Clear();
+
+	bool					IsBaked() const { return !m_distances.empty(); }
+	const IntVec2&			GetNumSamples() const { return m_numSamples; }
+
+	//Never more than the true distance from the point to the geometry, inside the bounds only
+	float					GetDistanceLowerBound(const Vec2& point) const;
+
+	//Moves the ray start up to the point where it may first touch geometry and returns the time skipped in skippedTimeOut
+	//The bit fields are tightened to the rest of the ray. Returns false when the ray leaves the field without
+	//getting close to anything, the ray can not hit anything in that case
+	bool					AdvanceRay(Ray2D& rayInOut, float& skippedTimeOut, const BitFieldBroadPhase& broadPhase) const;
+
+private:
+	bool					GetTimeInsideBounds(const Ray2D& ray, float& exitTimeOut) const;
+
+private:
+	AABB2					m_bounds;
+	Vec2					m_cellSize = Vec2::ZERO;
+	IntVec2					m_numSamples = IntVec2::ZERO;
+
+	//Row major, m_numSamples.x per row
+	std::vector<float>		m_distances;
+
+	//Geometry outside the bounds can still be hit by a ray leaving the field
+	bool					m_boundsContainAllGeometry = true;
+};
@@ -32,9 +32,11 @@
 #include "Engine/Core/BufferReadUtils.hpp"
 #include "Engine/Core/BufferWriteUtils.hpp"
 #include <ThirdParty/TinyXML2/tinyxml2.h>
+#include <algorithm>
 
 //Game systems
 #include "Game/GameCursor.hpp"
+#include "Game/JobPool.hpp"
 #include "SceneCooker.hpp"
 
 
@@ -77,6 +79,10 @@ Game::~Game()
 
 	delete m_gameCursor;
 	m_gameCursor = nullptr;
+
+	//Waits on any raycasts still in flight before the workers are joined
+	delete m_jobPool;
+	m_jobPool = nullptr;
 }
 
 //------------------------------------------------------------------------------------------------
@@ -279,6 +285,22 @@ void Game::StartUp()
 	m_broadPhaseChecker.SetWorldDimensions(minWorldBounds, maxWorldBounds);
 	m_broadPhaseChecker.MakeRegionsForWorld();
 
+	//Cooked geometry is loaded before the regions exist, so it only gets its bit fields now
+	if (m_loadedFromCookedData)
+	{
+		for (int geometryIndex = 0; geometryIndex < m_geometry.size(); geometryIndex++)
+		{
+			IntVec2 bitField = m_broadPhaseChecker.GetRegionForConvexPoly(m_geometry[geometryIndex].GetConvexPoly2D());
+			m_geometry[geometryIndex].SetBitFieldsForBitBucketBroadPhase(bitField);
+		}
+
+		m_isHullStoreDirty = true;
+	}
+
+	m_raySorter.SetWorldDimensions(minWorldBounds, maxWorldBounds);
+
+	m_jobPool = new JobPool();
+
 	UnitTestRunAllCategories(10);
 
 	//Generate Random Convex Polygons to render on screen
@@ -290,6 +312,12 @@ void Game::StartUp()
 	
 	CreateRaycasts(INIT_NUM_RAYCASTS);
 
+	//A cooked scene keeps the visible set saved with it, one saved without it or from other polygons bakes it now
+	if (m_loadedFromCookedData)
+	{
+		UpdatePotentiallyVisibleSet();
+	}
+
 	//Setup the render ray
 	CreateRenderRay();
 }
@@ -344,624 +372,3356 @@ UNITTEST("RaycastTests", "MathUtils", 1)
 	return true;
 }
 
-UNITTEST("BinaryFileRead", "FileUtils", 1)
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("HullStoreKernels", "MathUtils", 1)
 {
-	std::string fileReadPath = BINARY_FILES_PATH + std::string("test.bin");
-	std::vector<uchar> testReadBuffer;
-	bool result = LoadBinaryFileToExistingBuffer(fileReadPath, testReadBuffer);
+	//The specialized kernels should agree with the engine Raycast on the first hit of a simple hull
+	std::vector<Vec2> points = { Vec2(60.f, 40.f), Vec2(40.f, 60.f), Vec2(20.f, 40.f), Vec2(40.f, 20.f) };
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(points);
 
-	if (!result)
+	HullStore hullStore;
+	hullStore.BuildFromGeometry(geometry);
+
+	Vec2 direction = Vec2(1.f, 1.f);
+	direction.Normalize();
+	Ray2D ray(Vec2(0.f, 0.f), direction);
+
+	RayHit2D storeHit;
+	int geometryIndex = hullStore.RaycastClosest(storeHit, ray, false);
+	if (geometryIndex != 0)
 	{
 		return false;
 	}
 
-	DebuggerPrintf("\n Binary File Read Unit Test \n");
-
-	for (int i = 0; i < testReadBuffer.size(); i++)
+	const ConvexHull2D& hull = geometry[0].GetConvexHull2D();
+	std::vector<RayHit2D> engineHits(hull.GetNumPlanes());
+	uint numHits = Raycast(engineHits.data(), ray, hull, 0.f);
+	if (numHits == 0)
 	{
-		DebuggerPrintf("%c", testReadBuffer[i]);
+		return false;
 	}
 
-	return true;
+	float timeDifference = storeHit.m_timeAtHit - engineHits[0].m_timeAtHit;
+	return timeDifference < 0.001f && timeDifference > -0.001f;
 }
 
-UNITTEST("BufferParser", "ReadBufferTest", 1)
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("LargeHullKernel", "MathUtils", 1)
 {
-	// Just trying stuff out here initially to see if buffer writing/parsing seems to be working
-	Vec3 pos(3.f, 4.f, 5.f);
-	IntVec2 coords(3, 4);
+	//A 64 sided hull goes through the binary search path and should agree with the engine Raycast
+	std::vector<Vec2> points;
+	for (int pointIndex = 0; pointIndex < 64; pointIndex++)
+	{
+		float angle = 2.f * 3.14159265f * (float)pointIndex / 64.f;
+		points.push_back(Vec2(100.f + 20.f * cosf(angle), 50.f + 20.f * sinf(angle)));
+	}
 
-	BufferReadUtils bufVec3((unsigned char*)&pos, sizeof(pos));
-	float x = bufVec3.ParseFloat();
-	float y = bufVec3.ParseFloat();
-	float z = bufVec3.ParseFloat();
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(points);
 
-	BufferReadUtils bufLittle((unsigned char*)&coords, sizeof(coords));
-	int x1 = bufLittle.ParseInt32();
-	int y1 = bufLittle.ParseInt32();
+	HullStore hullStore;
+	hullStore.BuildFromGeometry(geometry);
+	if (hullStore.GetLargeHulls().size() != 1)
+	{
+		return false;
+	}
 
-	BufferReadUtils bufBig((unsigned char*)&coords, sizeof(coords), eBufferEndianness::BUFFER_BIG_ENDIAN);
-	int x2 = bufBig.ParseInt32();
-	int y2 = bufBig.ParseInt32();
+	Vec2 direction = Vec2(1.f, 0.3f);
+	direction.Normalize();
+	Ray2D ray(Vec2(40.f, 35.f), direction);
 
-	BufferReadUtils bufNative((unsigned char*)&coords, sizeof(coords), eBufferEndianness::BUFFER_NATIVE);
-	int x3 = bufNative.ParseInt32();
-	int y3 = bufNative.ParseInt32();
+	RayHit2D storeHit;
+	int geometryIndex = hullStore.RaycastClosest(storeHit, ray, false);
 
-	Buffer b;
-	b.push_back(0xff);
-	b.push_back(0x00);
-	b.push_back(0xa3);
+	const ConvexHull2D& hull = geometry[0].GetConvexHull2D();
+	std::vector<RayHit2D> engineHits(hull.GetNumPlanes());
+	uint numHits = Raycast(engineHits.data(), ray, hull, 0.f);
+	if (numHits == 0 || geometryIndex != 0)
+	{
+		return false;
+	}
 
-	BufferWriteUtils bw(b, eBufferEndianness::BUFFER_BIG_ENDIAN);
-	bw.AppendByte(0x12);
-	bw.AppendByte(0x34);
-	bw.AppendByte(0x56);
-	bw.AppendByte(0x78);
-	bw.AppendInt32(42);
-	bw.AppendFloat(3.14159265f);
+	float timeDifference = storeHit.m_timeAtHit - engineHits[0].m_timeAtHit;
+	if (timeDifference >= 0.001f || timeDifference <= -0.001f)
+		return false;
 
-	BufferWriteUtils bw2(b, eBufferEndianness::BUFFER_LITTLE_ENDIAN);
-	bw2.AppendInt32(15);
+	//Straight down and straight up rays look for support points at the +PI and -PI ends of the sorted normal angles
+	Vec2 verticalDirections[2] = { Vec2(0.f, -1.f), Vec2(0.f, 1.f) };
+	Vec2 verticalStarts[2] = { Vec2(107.f, 90.f), Vec2(93.f, 10.f) };
+	for (int rayIndex = 0; rayIndex < 2; rayIndex++)
+	{
+		Ray2D verticalRay(verticalStarts[rayIndex], verticalDirections[rayIndex]);
+		if (hullStore.RaycastClosest(storeHit, verticalRay, false) != 0 || Raycast(engineHits.data(), verticalRay, hull, 0.f) == 0)
+			return false;
 
-	double dp1 = 3.1415926535897932384626433832795;
-	BufferReadUtils dpBuf((unsigned char*)&dp1, sizeof(dp1));
-	double dp2 = dpBuf.ParseDouble();
-	GUARANTEE_RECOVERABLE(dp1 == dp2, "Value read and value from write is not the same");
+		timeDifference = storeHit.m_timeAtHit - engineHits[0].m_timeAtHit;
+		if (timeDifference >= 0.001f || timeDifference <= -0.001f)
+			return false;
+	}
 
-	Buffer dpBuf2;
-	BufferWriteUtils dpWrite2(dpBuf2);
-	dpWrite2.AppendDouble(dp1);
+	//A (-1, -0) normal comes out of atan2f as -PI, it has to be stored as +PI at the end of the sorted angles
+	std::vector<Plane2D> seamPlanes;
+	for (int planeIndex = 0; planeIndex < 64; planeIndex++)
+	{
+		float angle = 2.f * 3.14159265f * (float)planeIndex / 64.f;
+		Vec2 normal = (planeIndex == 32) ? Vec2(-1.f, -0.f) : Vec2(cosf(angle), sinf(angle));
+		seamPlanes.push_back(Plane2D(normal, 20.f));
+	}
 
-	BufferReadUtils dpParse2(dpBuf2);
-	double dp3 = dpParse2.ParseDouble();
-	GUARANTEE_RECOVERABLE(dp1 == dp3, "Value read and value from write is not the same");
-	return true;
+	LargeHull seamHull;
+	seamHull.MakeFromPlanes(seamPlanes);
+	for (int angleIndex = 0; angleIndex < (int)seamHull.m_normalAngles.size(); angleIndex++)
+	{
+		if (seamHull.m_normalAngles[angleIndex] <= -3.14159265f)
+			return false;
+	}
+
+	return seamHull.m_normalAngles.back() == atan2f(0.f, -1.f)
+		&& seamHull.GetSupportVertexIndex(Vec2(-1.f, -0.f)) == seamHull.GetSupportVertexIndex(Vec2(-1.f, 0.f));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::UpdateImGUI()
+UNITTEST("ShapeCasts", "MathUtils", 1)
 {
-	//Use this function to create and use an ImGUI widget
-	ImGui::Begin("Geometry Visualizer");
+	//Disc and capsule swept at a 20x20 square, once against a face and once against a corner
+	std::vector<Vec2> points = { Vec2(20.f, 20.f), Vec2(40.f, 20.f), Vec2(40.f, 40.f), Vec2(20.f, 40.f) };
 
-	ImGui::ColorEdit3("Scene Background Color", (float*)&ui_cameraClearColor); // Edit 3 floats representing a color
-	ImGui::ColorEdit3("Polygon Color", (float*)ui_polygonColor);
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(points);
 
-	ImGui::Text("Polygons :");
-	ImGui::SameLine();
-	if (ImGui::Button("Reduce by half"))
+	ShapeCaster shapeCaster;
+	shapeCaster.BuildFromGeometry(geometry);
+
+	ShapeCastHit2D hit;
+	ShapeCast2D discCast = ShapeCast2D::MakeDiscCast(Vec2(0.f, 30.f), 2.f, Vec2::RIGHT, 100.f);
+	if (shapeCaster.CastShape(hit, discCast, false) != 0 || fabsf(hit.m_timeAtHit - 18.f) > 0.001f || hit.m_impactNormal != Vec2::LEFT)
 	{
-		ui_numGeometry /= 2;
-		CreateConvexGeometry(ui_numGeometry);
+		return false;
 	}
 
-	ImGui::SameLine();
-	if (ImGui::Button("Double"))
+	ShapeCast2D cornerCast = ShapeCast2D::MakeDiscCast(Vec2(0.f, 43.f), 5.f, Vec2::RIGHT, 100.f);
+	if (shapeCaster.CastShape(hit, cornerCast, false) != 0 || fabsf(hit.m_timeAtHit - 16.f) > 0.001f)
 	{
-		ui_numGeometry *= 2;
-		CreateConvexGeometry(ui_numGeometry);
+		return false;
 	}
 
-	ImGui::SliderInt("Number of Polygons", &ui_numGeometry, ui_minGeometry, ui_maxGeometry);
-	
-	ImGui::Text("Rays :");
-	ImGui::SameLine();
-	if (ImGui::Button("Half"))
+	//Both ends are wider than the square so only the flat side of the capsule can touch its bottom corners
+	ShapeCast2D capsuleCast = ShapeCast2D::MakeCapsuleCast(Vec2(10.f, 0.f), Vec2(50.f, 0.f), 1.f, Vec2::UP, 100.f);
+	if (shapeCaster.CastShape(hit, capsuleCast, false) != 0 || fabsf(hit.m_timeAtHit - 19.f) > 0.001f)
 	{
-		ui_numRays /= 2;
-		CreateRaycasts(ui_numRays);
+		return false;
 	}
 
-	ImGui::SameLine();
-	if (ImGui::Button("2X"))
+	ShapeCast2D missCast = ShapeCast2D::MakeDiscCast(Vec2(0.f, 30.f), 2.f, Vec2::LEFT, 100.f);
+	return shapeCaster.CastShape(hit, missCast, false) == -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Broadphase over the whole world, as the game makes it
+static void MakeTestBroadPhase(BitFieldBroadPhase& broadPhase)
+{
+	broadPhase.SetWorldDimensions(Vec2::ZERO, Vec2(WORLD_WIDTH, WORLD_HEIGHT));
+	broadPhase.MakeRegionsForWorld();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Broadphase over the whole world with the bit fields of every test polygon set from it
+static void MakeTestBroadPhase(std::vector<Geometry>& geometry, BitFieldBroadPhase& broadPhase)
+{
+	MakeTestBroadPhase(broadPhase);
+	for (int geometryIndex = 0; geometryIndex < (int)geometry.size(); geometryIndex++)
 	{
-		ui_numRays *= 2;
-		CreateRaycasts(ui_numRays);
+		geometry[geometryIndex].SetBitFieldsForBitBucketBroadPhase(broadPhase.GetRegionForConvexPoly(geometry[geometryIndex].GetConvexPoly2D()));
 	}
+}
 
-	ImGui::SliderInt("Number of Rays", &ui_numRays, ui_minRays, ui_maxRays);
-	ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("PointContainment", "MathUtils", 1)
+{
+	//Two overlapping squares, the overlap should pick the later one
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(20.f, 20.f), Vec2(40.f, 20.f), Vec2(40.f, 40.f), Vec2(20.f, 40.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(30.f, 30.f), Vec2(50.f, 30.f), Vec2(50.f, 50.f), Vec2(30.f, 50.f) });
 
-	ImGui::Checkbox("Enable Bit Bucket Broad-phase Check", &m_toggleBroadPhaseMode);
-	ImGui::Text("Total Raycast Time last frame in ms: %f", m_cachedRaycastTime * 1000.f);
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
 
-	ImGui::Checkbox("Enable Cursor Debugging: ", &ui_debugCursorPosition);
-	m_gameCursor->SetDebugMode(ui_debugCursorPosition);
+	PointContainmentQuery pointQuery;
+	pointQuery.BuildFromGeometry(geometry, broadPhase);
 
-	ImGui::End();
+	std::vector<Vec2> points = { Vec2(25.f, 25.f), Vec2(35.f, 35.f), Vec2(45.f, 45.f), Vec2(10.f, 10.f), Vec2(45.f, 25.f) };
+	std::vector<int> geometryIndices;
+	pointQuery.QueryPoints(points, geometryIndices);
+
+	return geometryIndices[0] == 0 && geometryIndices[1] == 1 && geometryIndices[2] == 1 && geometryIndices[3] == -1 && geometryIndices[4] == -1;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::UpdateVisualRay()
+UNITTEST("RegionQueries", "MathUtils", 1)
 {
-	if (m_canMoveStart)
+	//A thin diamond whose bounds overlap the query box but whose edges do not
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(40.f, 20.f), Vec2(60.f, 40.f), Vec2(40.f, 60.f), Vec2(20.f, 40.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(100.f, 20.f), Vec2(120.f, 20.f), Vec2(120.f, 40.f), Vec2(100.f, 40.f) });
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	SceneQuery sceneQuery;
+	sceneQuery.BuildFromGeometry(geometry, broadPhase);
+
+	int results[2];
+	if (sceneQuery.QueryAABB(AABB2(Vec2(18.f, 18.f), Vec2(26.f, 26.f)), results, 2) != 0)
 	{
-		m_rayStart = m_gameCursor->GetCursorPositon();
-		m_renderedRay.m_start = m_gameCursor->GetCursorPositon();
+		return false;
 	}
 
-	if (m_canMoveEnd)
+	if (sceneQuery.QueryAABB(AABB2(Vec2(0.f, 0.f), Vec2(150.f, 100.f)), results, 2) != 2 || sceneQuery.CountAABB(AABB2(Vec2(50.f, 30.f), Vec2(110.f, 35.f))) != 2)
 	{
-		m_rayEnd = m_gameCursor->GetCursorPositon();
+		return false;
 	}
 
-	Vec2 rayDir = m_rayEnd - m_rayStart;
-	rayDir.Normalize();
+	//Disc just outside the corner of the square, then just touching it
+	if (sceneQuery.CountDisc(Vec2(125.f, 45.f), 7.f) != 0 || sceneQuery.QueryDisc(Vec2(125.f, 45.f), 7.1f, results, 2) != 1 || results[0] != 1)
+	{
+		return false;
+	}
 
-	m_renderedRay.m_direction = rayDir;
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::ShutDown()
+UNITTEST("NearestGeometry", "MathUtils", 1)
 {
-	m_cooker->InitiateWriteSequence();
+	//Two squares a cell or two apart, queried from outside both, from inside one and from beyond a distance cap
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(40.f, 40.f), Vec2(60.f, 40.f), Vec2(60.f, 60.f), Vec2(40.f, 60.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(100.f, 40.f), Vec2(110.f, 40.f), Vec2(110.f, 50.f), Vec2(100.f, 50.f) });
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	SceneQuery sceneQuery;
+	sceneQuery.BuildFromGeometry(geometry, broadPhase);
+
+	//One scratch for every query, as a caller looping over points would use it
+	Vec2 queryPoints[3] = { Vec2(30.f, 50.f), Vec2(50.f, 45.f), Vec2(93.f, 45.f) };
+	float expectedDistances[3] = { 10.f, -5.f, 7.f };
+	Vec2 expectedClosestPoints[3] = { Vec2(40.f, 50.f), Vec2(50.f, 40.f), Vec2(100.f, 45.f) };
+	int expectedGeometryIndices[3] = { 0, 0, 1 };
+
+	NearestGeometryScratch scratch;
+	NearestGeometry2D nearest;
+	for (int queryIndex = 0; queryIndex < 3; queryIndex++)
+	{
+		if (!sceneQuery.FindNearestGeometry(queryPoints[queryIndex], nearest, scratch) || nearest.m_geometryIndex != expectedGeometryIndices[queryIndex])
+			return false;
+
+		Vec2 closestPointError = nearest.m_closestPoint - expectedClosestPoints[queryIndex];
+		if (fabsf(nearest.m_signedDistance - expectedDistances[queryIndex]) > 0.001f || closestPointError.GetLength() > 0.001f)
+			return false;
+	}
+
+	return !sceneQuery.FindNearestGeometry(Vec2(30.f, 50.f), nearest, scratch, 5.f);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::HandleKeyPressed(unsigned char keyCode)
+UNITTEST("DistanceFieldRaycasts", "MathUtils", 1)
 {
-	if (g_devConsole->IsOpen())
+	//A square and a triangle, one ray above both through empty space and one crossing the world into the square
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(200.f, 40.f), Vec2(220.f, 40.f), Vec2(220.f, 60.f), Vec2(200.f, 60.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(80.f, 80.f), Vec2(100.f, 80.f), Vec2(90.f, 95.f) });
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	SceneQuery sceneQuery;
+	sceneQuery.BuildFromGeometry(geometry, broadPhase);
+	HullStore hullStore;
+	hullStore.BuildFromGeometry(geometry);
+
+	DistanceFieldGrid distanceField;
+	distanceField.Bake(sceneQuery, AABB2(Vec2::ZERO, Vec2(WORLD_WIDTH, WORLD_HEIGHT)), DISTANCE_FIELD_CELL_SIZE);
+
+	//Nothing above the triangle, the trace leaves the field and the exact test agrees there is nothing to hit
+	Ray2D emptyRay(Vec2(5.f, 130.f), Vec2(1.f, 0.f));
+	emptyRay.m_bitFieldsXY = broadPhase.GetRegionForRay(emptyRay);
+	RayHit2D exactHit;
+	float skippedTime = 0.f;
+	Ray2D tracedRay = emptyRay;
+	if (distanceField.AdvanceRay(tracedRay, skippedTime, broadPhase) || hullStore.RaycastClosest(exactHit, emptyRay, true) != -1)
+		return false;
+
+	//The traced ray skips most of the way to the square and then has to find the same hit as the exact test
+	Vec2 direction = Vec2(190.f, 35.f);
+	direction.Normalize();
+	Ray2D hittingRay(Vec2(10.f, 15.f), direction);
+	hittingRay.m_bitFieldsXY = broadPhase.GetRegionForRay(hittingRay);
+	if (hullStore.RaycastClosest(exactHit, hittingRay, true) != 0)
+		return false;
+
+	tracedRay = hittingRay;
+	RayHit2D tracedHit;
+	if (!distanceField.AdvanceRay(tracedRay, skippedTime, broadPhase) || skippedTime <= 0.f || hullStore.RaycastClosest(tracedHit, tracedRay, true) != 0)
+		return false;
+
+	return fabsf(tracedHit.m_timeAtHit + skippedTime - exactHit.m_timeAtHit) < 0.001f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("OverlapPairs", "MathUtils", 1)
+{
+	//Two overlapping squares, a square far away and a diamond whose bounds overlap the second square but whose edges do not
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(20.f, 20.f), Vec2(40.f, 20.f), Vec2(40.f, 40.f), Vec2(20.f, 40.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(30.f, 30.f), Vec2(50.f, 30.f), Vec2(50.f, 50.f), Vec2(30.f, 50.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(100.f, 100.f), Vec2(110.f, 100.f), Vec2(110.f, 110.f), Vec2(100.f, 110.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(56.f, 46.f), Vec2(66.f, 56.f), Vec2(56.f, 66.f), Vec2(46.f, 56.f) });
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	OverlapPairFinder overlapFinder;
+	std::vector<OverlapPair> pairs;
+	overlapFinder.FindOverlappingPairs(geometry, broadPhase, pairs);
+
+	return pairs.size() == 1 && pairs[0].m_geometryIndexA == 0 && pairs[0].m_geometryIndexB == 1 && overlapFinder.GetNumCandidatePairs() == 2;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("ConvexDistance", "MathUtils", 1)
+{
+	std::vector<Vec2> square = { Vec2(0.f, 0.f), Vec2(10.f, 0.f), Vec2(10.f, 10.f), Vec2(0.f, 10.f) };
+	std::vector<Vec2> farTriangle = { Vec2(20.f, 5.f), Vec2(30.f, 0.f), Vec2(30.f, 10.f) };
+	std::vector<Vec2> overlappingBox = { Vec2(7.f, 2.f), Vec2(17.f, 2.f), Vec2(17.f, 8.f), Vec2(7.f, 8.f) };
+
+	ConvexDistance2D result;
+	ConvexDistanceSolver::ComputeDistance(square, farTriangle, result);
+	if (result.m_isOverlapping || fabsf(result.m_signedDistance - 10.f) > 0.001f || fabsf(result.m_closestPointB.x - 20.f) > 0.001f)
 	{
-		g_devConsole->HandleKeyDown(keyCode);
-		return;
+		return false;
 	}
 
-	switch( keyCode )
+	//Overlaps by 3 along x, pushing the box 3 units along the normal separates them
+	GjkCache2D cache;
+	ConvexDistanceSolver::ComputeDistance(square, overlappingBox, result, &cache);
+	if (!result.m_isOverlapping || fabsf(result.m_signedDistance + 3.f) > 0.001f || fabsf(result.m_normal.x - 1.f) > 0.001f)
 	{
-		case W_KEY:
-		case S_KEY:
-		{
-			m_canMoveStart = true;
-			m_mouseStart = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
-			m_renderedRay.m_start = m_mouseStart;
-			break;
-		}
-		case A_KEY:
-		case D_KEY:
-		break;
-		case E_KEY:
-		{
-			m_canMoveEnd = true;
-			m_mouseEnd = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
-			m_rayEnd = m_mouseEnd;
-			break;
-		}
-		case LCTRL_KEY:
-		{
-			m_toggleUI = !m_toggleUI;
-		}
-		break;
-		case DEL_KEY:
-		case G_KEY:
-		case TAB_KEY:
-		case K_KEY:
-		break;
-		case L_KEY:
-		break;
-		case NUM_1:
-		{
-			ui_numRays /= 2;
-			CreateRaycasts(ui_numRays);
-		}
-		break;
-		case NUM_2:
-		{
-			ui_numRays *= 2;
-			
-			if (ui_numRays == 0)
-				ui_numRays = 1;
+		return false;
+	}
 
-			CreateRaycasts(ui_numRays);
-		}
-		break;
-		case NUM_3:
-		{
-			ui_numGeometry /= 2;
-			
-			if (ui_numGeometry == 0)
-				ui_numGeometry = 1;
+	//Warm started from the cache the same query should not need any new support points
+	ConvexDistanceSolver::ComputeDistance(square, overlappingBox, result, &cache);
+	return result.m_isOverlapping && result.m_numIterations == 0 && fabsf(result.m_signedDistance + 3.f) < 0.001f;
+}
 
-			CreateConvexGeometry(ui_numGeometry);
-		}
-		break;
-		case NUM_4:
-		{
-			ui_numGeometry *= 2;
-			CreateConvexGeometry(ui_numGeometry);
-		}
-		break;
-		case NUM_5:
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("VisibilityPolygon", "MathUtils", 1)
+{
+	//A square straight to the right of the viewer shadows the right wall between y = 40 and y = 60
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(60.f, 45.f), Vec2(70.f, 45.f), Vec2(70.f, 55.f), Vec2(60.f, 55.f) });
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	VisibilityPolygonQuery visibilityQuery;
+	visibilityQuery.BuildFromGeometry(geometry, broadPhase, AABB2(Vec2(0.f, 0.f), Vec2(100.f, 100.f)));
+
+	std::vector<Vec2> polygon;
+	visibilityQuery.ComputeVisibilityPolygon(Vec2(50.f, 50.f), polygon);
+
+	//4 world corners, the 2 corners of the near face, the 2 ends of the shadow on the wall and the point behind the viewer
+	//where the sweep starts
+	int numShadowPoints = 0;
+	for (int pointIndex = 0; pointIndex < (int)polygon.size(); pointIndex++)
+	{
+		if (polygon[pointIndex].x == 100.f && (fabsf(polygon[pointIndex].y - 25.f) < 0.001f || fabsf(polygon[pointIndex].y - 75.f) < 0.001f))
 		{
-			m_toggleBroadPhaseMode = !m_toggleBroadPhaseMode;
+			numShadowPoints++;
 		}
-		break;
-		case NUM_6:
-		{
-			ReRandomize();
+	}
+
+	return polygon.size() == 9 && numShadowPoints == 2;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("LineOfSightMatrix", "MathUtils", 1)
+{
+	//Points 0 and 1 are on either side of the square, 2 sees both from above it and 3 is inside it
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(40.f, 40.f), Vec2(60.f, 40.f), Vec2(60.f, 60.f), Vec2(40.f, 60.f) });
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	VisibilityPolygonQuery visibilityQuery;
+	visibilityQuery.BuildFromGeometry(geometry, broadPhase, AABB2(Vec2(0.f, 0.f), Vec2(100.f, 100.f)));
+	PointContainmentQuery pointQuery;
+	pointQuery.BuildFromGeometry(geometry, broadPhase);
+
+	std::vector<Vec2> points = { Vec2(20.f, 50.f), Vec2(80.f, 50.f), Vec2(50.f, 90.f), Vec2(50.f, 50.f) };
+
+	LineOfSightMatrix lineOfSight;
+	lineOfSight.Compute(points, visibilityQuery, pointQuery);
+
+	return !lineOfSight.IsVisible(0, 1) && !lineOfSight.IsVisible(1, 0) && lineOfSight.IsVisible(0, 2) && lineOfSight.IsVisible(2, 1)
+		&& !lineOfSight.IsVisible(3, 2) && lineOfSight.CountVisiblePairs() == 2;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("ReflectionTracer", "MathUtils", 1)
+{
+	//Straight into the left face of the box, back out the way it came and off the left edge of the world
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(60.f, 40.f), Vec2(70.f, 40.f), Vec2(70.f, 60.f), Vec2(60.f, 60.f) });
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	HullStore hullStore;
+	hullStore.BuildFromGeometry(geometry);
+
+	Ray2D ray(Vec2(20.f, 50.f), Vec2(1.f, 0.f));
+	ray.m_bitFieldsXY = broadPhase.GetRegionForRay(ray);
+	std::vector<Ray2D> rays = { ray };
+
+	ReflectionTracer tracer;
+	std::vector<BounceSegment> segments;
+	tracer.TracePaths(rays, 4, hullStore, broadPhase, AABB2(Vec2::ZERO, Vec2(WORLD_WIDTH, WORLD_HEIGHT)), segments);
+
+	return segments.size() == 2 && fabsf(segments[0].m_end.x - 60.f) < 0.001f && segments[0].m_impactNormal.x < -0.999f
+		&& segments[1].m_bounceIndex == 1 && fabsf(segments[1].m_end.x) < 0.001f && segments[1].m_impactNormal == Vec2::ZERO;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("RaycastAll", "MathUtils", 1)
+{
+	//The far square comes first in the geometry list, the ray starts inside the near one
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(200.f, 40.f), Vec2(220.f, 40.f), Vec2(220.f, 60.f), Vec2(200.f, 60.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(10.f, 40.f), Vec2(30.f, 40.f), Vec2(30.f, 60.f), Vec2(10.f, 60.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(100.f, 100.f), Vec2(110.f, 100.f), Vec2(110.f, 110.f), Vec2(100.f, 110.f) });
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	SceneQuery sceneQuery;
+	sceneQuery.BuildFromGeometry(geometry, broadPhase);
+
+	Ray2D ray(Vec2(20.f, 50.f), Vec2(1.f, 0.f));
+	RayInterval2D intervals[4];
+	int numIntervals = sceneQuery.RaycastAll(ray, intervals, 4);
+	if (numIntervals != 2 || intervals[0].m_geometryIndex != 1 || intervals[0].m_timeEnter != 0.f || fabsf(intervals[0].m_timeExit - 10.f) > 0.001f
+		|| intervals[1].m_geometryIndex != 0 || fabsf(intervals[1].m_timeEnter - 180.f) > 0.001f || fabsf(intervals[1].m_timeExit - 200.f) > 0.001f)
+	{
+		return false;
+	}
+
+	//A full buffer keeps the nearest
+	return sceneQuery.RaycastAll(ray, intervals, 1) == 1 && intervals[0].m_geometryIndex == 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("PrimitiveStore", "MathUtils", 1)
+{
+	//One of each type along y = 50, walking the ray start forward reaches each in turn
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(100.f, 40.f), Vec2(120.f, 40.f), Vec2(120.f, 60.f), Vec2(100.f, 60.f) });
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	PrimitiveStore primitiveStore;
+	primitiveStore.AddHull(geometry[0], 7);
+	primitiveStore.AddOBB(Vec2(80.f, 50.f), Vec2(5.f, 20.f), 90.f, 3);
+	primitiveStore.AddCapsule(Vec2(40.f, 40.f), Vec2(40.f, 60.f), 2.f, 2);
+	primitiveStore.AddDisc(Vec2(20.f, 50.f), 3.f, 1);
+	primitiveStore.BuildBuckets(broadPhase);
+
+	const float rayStarts[4] = { 0.f, 30.f, 50.f, 80.f };
+	const float expectedTimes[4] = { 17.f, 8.f, 10.f, 20.f };
+	const ePrimitiveType expectedTypes[4] = { PRIMITIVE_DISC, PRIMITIVE_CAPSULE, PRIMITIVE_OBB, PRIMITIVE_HULL };
+	const int expectedOwners[4] = { 1, 2, 3, 7 };
+
+	for (int testIndex = 0; testIndex < 4; testIndex++)
+	{
+		//The last ray starts inside the box, which is skipped
+		PrimitiveHit2D hit;
+		Ray2D ray(Vec2(rayStarts[testIndex], 50.f), Vec2(1.f, 0.f));
+		if (!primitiveStore.RaycastClosest(hit, ray) || hit.m_type != expectedTypes[testIndex] || hit.m_ownerIndex != expectedOwners[testIndex]
+			|| fabsf(hit.m_timeAtHit - expectedTimes[testIndex]) > 0.001f || fabsf(hit.m_impactNormal.x + 1.f) > 0.001f)
+		{
+			return false;
+		}
+	}
+
+	PrimitiveHit2D hit;
+	return !primitiveStore.RaycastClosest(hit, Ray2D(Vec2(0.f, 50.f), Vec2(-1.f, 0.f)));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("GeometryInstances", "MathUtils", 1)
+{
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(broadPhase);
+
+	//Unit square scaled up to 10 wide, turned a quarter so the face hit comes from the local y planes
+	InstancedGeometryStore instances;
+	int prototypeIndex = instances.AddPrototype(std::vector<Vec2>{ Vec2(-1.f, -1.f), Vec2(1.f, -1.f), Vec2(1.f, 1.f), Vec2(-1.f, 1.f) });
+
+	InstanceTransform2D transform;
+	transform.m_position = Vec2(50.f, 50.f);
+	transform.m_rotationDegrees = 90.f;
+	transform.m_scale = 5.f;
+	int instanceIndex = instances.AddInstance(prototypeIndex, transform, broadPhase);
+
+	Ray2D ray(Vec2(30.f, 50.f), Vec2(1.f, 0.f));
+	ray.m_bitFieldsXY = broadPhase.GetRegionForRay(ray);
+
+	RayHit2D hit;
+	if (instances.RaycastClosest(hit, ray) != instanceIndex || fabsf(hit.m_timeAtHit - 15.f) > 0.001f || fabsf(hit.m_impactNormal.x + 1.f) > 0.001f)
+	{
+		return false;
+	}
+
+	//Moving it only refits the bounds, the ray has to find it in its new cells
+	transform.m_position = Vec2(100.f, 50.f);
+	instances.SetInstanceTransform(instanceIndex, transform, broadPhase);
+	return instances.RaycastClosest(hit, ray) == instanceIndex && fabsf(hit.m_timeAtHit - 65.f) < 0.001f
+		&& instances.GetInstance(instanceIndex).m_worldMins.x > 94.999f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("PrototypeDeduplication", "MathUtils", 1)
+{
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(broadPhase);
+
+	//The second triangle is the first moved over, the third is a different shape
+	InstancedGeometryStore instances;
+	instances.AddInstanceOfPolygon(std::vector<Vec2>{ Vec2(10.f, 10.f), Vec2(16.f, 10.f), Vec2(10.f, 19.f) }, broadPhase);
+	int movedIndex = instances.AddInstanceOfPolygon(std::vector<Vec2>{ Vec2(110.3f, 60.7f), Vec2(116.3f, 60.7f), Vec2(110.3f, 69.7f) }, broadPhase);
+	instances.AddInstanceOfPolygon(std::vector<Vec2>{ Vec2(50.f, 10.f), Vec2(56.f, 10.f), Vec2(50.f, 20.f) }, broadPhase);
+
+	if (instances.GetNumPrototypes() != 2 || instances.GetInstance(movedIndex).m_prototypeIndex != instances.GetInstance(0).m_prototypeIndex)
+	{
+		return false;
+	}
+
+	//A scene polygon of the same shape is given the shared prototype and its centroid as the offset, moving it moves the offset
+	Geometry sceneGeometry(std::vector<Vec2>{ Vec2(30.f, 30.f), Vec2(36.f, 30.f), Vec2(30.f, 39.f) });
+	Vec2 prototypeOffset;
+	std::vector<Vec2> scratchLocalPoints;
+	int prototypeIndex = instances.FindOrAddPrototypeOfPolygon(sceneGeometry.GetConvexPoly2D().GetConvexPoly2DPoints(), prototypeOffset, scratchLocalPoints);
+	sceneGeometry.SetPrototype(prototypeIndex, prototypeOffset);
+	sceneGeometry.Translate(Vec2(1.f, -2.f));
+
+	Vec2 offsetError = sceneGeometry.GetPrototypeOffset() - Vec2(33.f, 31.f);
+	if (prototypeIndex != instances.GetInstance(0).m_prototypeIndex || instances.GetNumPrototypes() != 2 || fabsf(offsetError.x) > 0.001f || fabsf(offsetError.y) > 0.001f)
+	{
+		return false;
+	}
+
+	//Tagged scene polygons of one shape share a single plane set in the hull store, the moved one is still hit where it is now
+	std::vector<Geometry> sceneGeometries{ sceneGeometry, Geometry(std::vector<Vec2>{ Vec2(70.f, 70.f), Vec2(76.f, 70.f), Vec2(70.f, 79.f) }) };
+	sceneGeometries[1].SetPrototype(instances.FindOrAddPrototypeOfPolygon(sceneGeometries[1].GetConvexPoly2D().GetConvexPoly2DPoints(), prototypeOffset, scratchLocalPoints), prototypeOffset);
+
+	HullStore hullStore;
+	hullStore.BuildFromGeometry(sceneGeometries);
+	RayHit2D storeHit;
+	if (hullStore.GetNumPlaneSets() != 1 || hullStore.GetPlaneDataBytes() >= hullStore.GetUnsharedPlaneDataBytes()
+		|| hullStore.RaycastClosest(storeHit, Ray2D(Vec2(20.f, 30.f), Vec2(1.f, 0.f)), false) != 0 || fabsf(storeHit.m_timeAtHit - 11.f) > 0.001f)
+	{
+		return false;
+	}
+
+	//The shared prototype placed at the moved centroid covers the moved triangle
+	Ray2D ray(Vec2(100.f, 62.f), Vec2(1.f, 0.f));
+	ray.m_bitFieldsXY = broadPhase.GetRegionForRay(ray);
+
+	RayHit2D hit;
+	return instances.RaycastClosest(hit, ray) == movedIndex && fabsf(hit.m_timeAtHit - 10.3f) < 0.001f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("DriftingGeometryRefit", "MathUtils", 1)
+{
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(10.f, 40.f), Vec2(20.f, 40.f), Vec2(20.f, 50.f), Vec2(10.f, 50.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(100.f, 100.f), Vec2(110.f, 100.f), Vec2(110.f, 110.f), Vec2(100.f, 110.f) });
+	geometry[0].SetPrototype(0, Vec2(10.f, 40.f));
+	geometry[1].SetPrototype(0, Vec2(100.f, 100.f));
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	//Both squares are placed from the same local planes in the hull store
+	HullStore hullStore;
+	hullStore.BuildFromGeometry(geometry);
+	if (hullStore.GetNumPlaneSets() != 1)
+	{
+		return false;
+	}
+
+	SceneQuery sceneQuery;
+	sceneQuery.BuildFromGeometry(geometry, broadPhase);
+	PointContainmentQuery pointQuery;
+	pointQuery.BuildFromGeometry(geometry, broadPhase);
+	PrimitiveStore primitiveStore;
+	for (int geometryIndex = 0; geometryIndex < geometry.size(); geometryIndex++)
+	{
+		primitiveStore.AddHull(geometry[geometryIndex], geometryIndex);
+	}
+	primitiveStore.BuildBuckets(broadPhase);
+
+	//Carry the first square well across the cells without rebuilding any of them
+	geometry[0].Translate(Vec2(120.f, 10.f));
+	geometry[0].SetBitFieldsForBitBucketBroadPhase(broadPhase.GetRegionForConvexPoly(geometry[0].GetConvexPoly2D()));
+
+	std::vector<int> movedIndices{ 0 };
+	if (sceneQuery.RefitMovedGeometry(geometry, movedIndices) != 1 || pointQuery.RefitMovedGeometry(geometry, movedIndices) != 1
+		|| primitiveStore.RefitMovedHulls(geometry, movedIndices) != 1)
+	{
+		return false;
+	}
+
+	hullStore.RefitMovedGeometry(geometry, movedIndices);
+	RayHit2D storeHit;
+	if (hullStore.RaycastClosest(storeHit, Ray2D(Vec2(0.f, 45.f), Vec2(1.f, 0.f)), false) != -1
+		|| hullStore.RaycastClosest(storeHit, Ray2D(Vec2(100.f, 55.f), Vec2(1.f, 0.f)), false) != 0 || fabsf(storeHit.m_timeAtHit - 30.f) > 0.001f
+		|| hullStore.RaycastClosest(storeHit, Ray2D(Vec2(90.f, 105.f), Vec2(1.f, 0.f)), false) != 1 || fabsf(storeHit.m_timeAtHit - 10.f) > 0.001f)
+	{
+		return false;
+	}
+
+	PrimitiveHit2D primitiveHit;
+	if (primitiveStore.RaycastClosest(primitiveHit, Ray2D(Vec2(0.f, 45.f), Vec2(1.f, 0.f)))
+		|| !primitiveStore.RaycastClosest(primitiveHit, Ray2D(Vec2(100.f, 55.f), Vec2(1.f, 0.f))) || primitiveHit.m_ownerIndex != 0
+		|| fabsf(primitiveHit.m_timeAtHit - 30.f) > 0.001f)
+	{
+		return false;
+	}
+
+	if (pointQuery.GetGeometryContainingPoint(Vec2(15.f, 45.f)) != -1 || pointQuery.GetGeometryContainingPoint(Vec2(135.f, 55.f)) != 0)
+	{
+		return false;
+	}
+
+	int overlapIndices[2];
+	return sceneQuery.QueryDisc(Vec2(15.f, 45.f), 2.f, overlapIndices, 2) == 0
+		&& sceneQuery.QueryDisc(Vec2(135.f, 55.f), 2.f, overlapIndices, 2) == 1 && overlapIndices[0] == 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("TimeOfImpact", "MathUtils", 1)
+{
+	//The square covers far more than the wall's width in one step, a test at the end of the step would miss the wall
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(10.f, 40.f), Vec2(20.f, 40.f), Vec2(20.f, 50.f), Vec2(10.f, 50.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(60.f, 30.f), Vec2(61.f, 30.f), Vec2(61.f, 60.f), Vec2(60.f, 60.f) });
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(200.f, 200.f), Vec2(210.f, 200.f), Vec2(210.f, 210.f), Vec2(200.f, 210.f) });
+	std::vector<Vec2> velocities{ Vec2(200.f, 0.f), Vec2::ZERO, Vec2::ZERO };
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	TimeOfImpactSolver solver;
+	std::vector<OverlapPair> pairs;
+	solver.FindSweptPairs(geometry, velocities, 1.f, broadPhase, pairs);
+	if (pairs.size() != 1 || pairs[0].m_geometryIndexA != 0 || pairs[0].m_geometryIndexB != 1)
+	{
+		return false;
+	}
+
+	std::vector<TimeOfImpact2D> impacts;
+	solver.ComputeTimesOfImpact(geometry, velocities, 1.f, pairs, impacts);
+	float expectedTime = (40.f - TOI_TARGET_SEPARATION) / 200.f;
+	if (impacts[0].m_state != TOI_HIT || fabsf(impacts[0].m_time - expectedTime) > 0.0001f || fabsf(impacts[0].m_normal.x - 1.f) > 0.001f)
+	{
+		return false;
+	}
+
+	//Only the square and the wall are held back, the far square keeps the whole frame
+	std::vector<float> moveTimes;
+	solver.ComputeMoveTimes(geometry, velocities, 1.f, pairs, impacts, moveTimes);
+	if (fabsf(moveTimes[0] - expectedTime) > 0.0001f || moveTimes[2] != 1.f)
+	{
+		return false;
+	}
+
+	//Moving apart never meets, starting inside is reported as such
+	const std::vector<Vec2>& squarePoints = geometry[0].GetConvexPoly2D().GetConvexPoly2DPoints();
+	const std::vector<Vec2>& wallPoints = geometry[1].GetConvexPoly2D().GetConvexPoly2DPoints();
+
+	TimeOfImpact2D impact;
+	TimeOfImpactSolver::ComputeTimeOfImpact(squarePoints, Vec2(-200.f, 0.f), wallPoints, Vec2::ZERO, 1.f, impact);
+	if (impact.m_state != TOI_SEPARATED)
+	{
+		return false;
+	}
+
+	TimeOfImpactSolver::ComputeTimeOfImpact(squarePoints, Vec2(200.f, 0.f), squarePoints, Vec2::ZERO, 1.f, impact);
+	return impact.m_state == TOI_OVERLAPPING_AT_START;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("ParticleCollider", "MathUtils", 1)
+{
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(100.f, 40.f), Vec2(120.f, 40.f), Vec2(120.f, 60.f), Vec2(100.f, 60.f) });
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	//One particle dropped onto the box and one started inside it, both should end up resting on top
+	DiscParticleCollider particles;
+	particles.BuildStaticHulls(geometry, broadPhase, AABB2(Vec2::ZERO, Vec2(WORLD_WIDTH, WORLD_HEIGHT)));
+	particles.AddParticle(Vec2(110.f, 65.f), Vec2::ZERO);
+	particles.AddParticle(Vec2(105.f, 59.f), Vec2::ZERO);
+
+	for (int stepIndex = 0; stepIndex < 120; stepIndex++)
+	{
+		particles.Step(1.f / 60.f);
+	}
+
+	for (int particleIndex = 0; particleIndex < particles.GetNumParticles(); particleIndex++)
+	{
+		Vec2 position = particles.GetParticlePosition(particleIndex);
+		if (position.x < 100.f || position.x > 120.f || position.y < 60.f + PARTICLE_RADIUS * 0.9f || position.y > 60.f + PARTICLE_RADIUS * 1.5f)
+			return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("NavigationGraph", "MathUtils", 1)
+{
+	//A wall between start and goal, then a second wall is added that closes the short way round and removed again
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(45.f, 20.f), Vec2(55.f, 20.f), Vec2(55.f, 70.f), Vec2(45.f, 70.f) });
+
+	AABB2 worldBounds = AABB2(Vec2(0.f, 0.f), Vec2(100.f, 100.f));
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	VisibilityPolygonQuery visibilityQuery;
+	PointContainmentQuery pointQuery;
+	SceneQuery sceneQuery;
+	NavigationGraph navigationGraph;
+	std::vector<Vec2> path;
+
+	Vec2 start = Vec2(20.f, 50.f);
+	Vec2 goal = Vec2(80.f, 50.f);
+	int numEdgesPerStep[3];
+	float pathLengths[3];
+	for (int stepIndex = 0; stepIndex < 3; stepIndex++)
+	{
+		if (stepIndex == 1)
+		{
+			geometry.emplace_back(std::vector<Vec2>{ Vec2(45.f, 70.f), Vec2(55.f, 70.f), Vec2(55.f, 100.f), Vec2(45.f, 100.f) });
+		}
+		else if (stepIndex == 2)
+		{
+			geometry.pop_back();
+		}
+
+		for (int geometryIndex = 0; geometryIndex < (int)geometry.size(); geometryIndex++)
+		{
+			geometry[geometryIndex].SetBitFieldsForBitBucketBroadPhase(broadPhase.GetRegionForConvexPoly(geometry[geometryIndex].GetConvexPoly2D()));
+		}
+		visibilityQuery.BuildFromGeometry(geometry, broadPhase, worldBounds);
+		pointQuery.BuildFromGeometry(geometry, broadPhase);
+		sceneQuery.BuildFromGeometry(geometry, broadPhase);
+
+		int syncIndex = navigationGraph.SyncWithGeometry(geometry, worldBounds, visibilityQuery, pointQuery, sceneQuery);
+		if (syncIndex != ((stepIndex == 0) ? 0 : 1) || navigationGraph.SyncWithGeometry(geometry, worldBounds, visibilityQuery, pointQuery, sceneQuery) != -1)
+			return false;
+
+		if (!navigationGraph.FindPath(start, goal, visibilityQuery, pointQuery, path) || path.size() < 3 || !(path.front() == start) || !(path.back() == goal))
+			return false;
+
+		numEdgesPerStep[stepIndex] = navigationGraph.GetNumEdges();
+		pathLengths[stepIndex] = 0.f;
+		for (int pointIndex = 1; pointIndex < (int)path.size(); pointIndex++)
+		{
+			pathLengths[stepIndex] += (path[pointIndex] - path[pointIndex - 1]).GetLength();
+		}
+	}
+
+	//Round over the top of the wall at first, under it while the gap above is closed, and the same graph once it opens again
+	if (pathLengths[0] >= 76.f || pathLengths[1] <= 85.f || fabsf(pathLengths[2] - pathLengths[0]) >= 0.001f || numEdgesPerStep[2] != numEdgesPerStep[0]
+		|| navigationGraph.FindPath(Vec2(50.f, 50.f), goal, visibilityQuery, pointQuery, path))
+	{
+		return false;
+	}
+
+	//Blocks are added either side and the wall slid up, so pairs of block corners it kept apart open and ones above it close
+	//The wall is updated in place and has to match a graph built from scratch
+	for (int blockIndex = 0; blockIndex < 4; blockIndex++)
+	{
+		Vec2 blockMins = Vec2((blockIndex % 2 == 0) ? 20.f : 70.f, (blockIndex < 2) ? 25.f : 75.f);
+		geometry.emplace_back(std::vector<Vec2>{ blockMins, blockMins + Vec2(10.f, 0.f), blockMins + Vec2(10.f, 10.f), blockMins + Vec2(0.f, 10.f) });
+	}
+
+	for (int moveIndex = 0; moveIndex < 2; moveIndex++)
+	{
+		if (moveIndex == 1)
+		{
+			geometry[0].Translate(Vec2(0.f, 25.f));
+		}
+
+		MakeTestBroadPhase(geometry, broadPhase);
+		visibilityQuery.BuildFromGeometry(geometry, broadPhase, worldBounds);
+		pointQuery.BuildFromGeometry(geometry, broadPhase);
+		sceneQuery.BuildFromGeometry(geometry, broadPhase);
+		if (navigationGraph.SyncWithGeometry(geometry, worldBounds, visibilityQuery, pointQuery, sceneQuery) != 1 - moveIndex)
+			return false;
+	}
+
+	NavigationGraph rebuiltGraph;
+	rebuiltGraph.SyncWithGeometry(geometry, worldBounds, visibilityQuery, pointQuery, sceneQuery);
+
+	std::vector<Vec2> rebuiltPath;
+	if (navigationGraph.GetNumMovedInLastSync() != 1 || navigationGraph.GetNumEdges() != rebuiltGraph.GetNumEdges()
+		|| !navigationGraph.FindPath(start, goal, visibilityQuery, pointQuery, path) || !rebuiltGraph.FindPath(start, goal, visibilityQuery, pointQuery, rebuiltPath))
+	{
+		return false;
+	}
+
+	for (int nodeIndex = 0; nodeIndex < navigationGraph.GetNumNodes(); nodeIndex++)
+	{
+		if (navigationGraph.GetNeighbours(nodeIndex) != rebuiltGraph.GetNeighbours(nodeIndex) || navigationGraph.GetNode(nodeIndex).m_isOpen != rebuiltGraph.GetNode(nodeIndex).m_isOpen)
+			return false;
+	}
+
+	//Under the wall now, the way over it is closed
+	return path.size() == rebuiltPath.size() && path[1].y < 45.f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("PotentiallyVisibleSet", "MathUtils", 1)
+{
+	//A wall through the middle of the world and past its edges, the 16 columns of cells on each side only see each other
+	std::vector<Geometry> geometry;
+	geometry.emplace_back(std::vector<Vec2>{ Vec2(148.f, -10.f), Vec2(152.f, -10.f), Vec2(152.f, WORLD_HEIGHT + 10.f), Vec2(148.f, WORLD_HEIGHT + 10.f) });
+
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(geometry, broadPhase);
+
+	PotentiallyVisibleSet potentiallyVisibleSet;
+	potentiallyVisibleSet.Bake(geometry, broadPhase);
+
+	int numCellsPerSide = 16 * potentiallyVisibleSet.GetNumCellsPerAxis();
+	if (potentiallyVisibleSet.GetNumVisiblePairs() != numCellsPerSide * (numCellsPerSide - 1))
+		return false;
+
+	if (potentiallyVisibleSet.IsCellVisible(IntVec2(0, 16), IntVec2(31, 16)) || potentiallyVisibleSet.IsCellVisible(IntVec2(16, 0), IntVec2(15, 31))
+		|| !potentiallyVisibleSet.IsCellVisible(IntVec2(0, 16), IntVec2(15, 0)) || !potentiallyVisibleSet.IsCellVisible(IntVec2(31, 31), IntVec2(16, 0)))
+	{
+		return false;
+	}
+
+	//Rows as the cooker writes and reads them
+	PotentiallyVisibleSet loadedSet;
+	bool isLoaded = loadedSet.SetCompressed(potentiallyVisibleSet.GetNumCellsPerAxis(), potentiallyVisibleSet.GetSceneSignature(), potentiallyVisibleSet.GetRowIndices(),
+		potentiallyVisibleSet.GetRowOffsets(), potentiallyVisibleSet.GetCompressedBytes());
+	return isLoaded && loadedSet.GetNumVisiblePairs() == potentiallyVisibleSet.GetNumVisiblePairs() && !loadedSet.IsCellVisible(IntVec2(31, 16), IntVec2(0, 16))
+		&& loadedSet.GetSceneSignature() == PotentiallyVisibleSet::ComputeSceneSignature(geometry) && loadedSet.GetCompressedSizeInBytes() < loadedSet.GetDenseSizeInBytes();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("SceneGenerator", "MathUtils", 1)
+{
+	BitFieldBroadPhase broadPhase;
+	MakeTestBroadPhase(broadPhase);
+	AABB2 worldBounds(Vec2::ZERO, Vec2(WORLD_WIDTH, WORLD_HEIGHT));
+
+	SceneGenerator sceneGenerator;
+	SceneGeneratorSettings settings;
+	settings.m_seed = 7;
+	for (int distributionIndex = 0; distributionIndex < NUM_SCENE_DISTRIBUTIONS; distributionIndex++)
+	{
+		settings.m_distribution = (eSceneDistribution)distributionIndex;
+		sceneGenerator.SetSettings(settings);
+
+		//Growing a scene has to give the same polygons as making it in one go, grids excepted as they are laid out for the count
+		std::vector<Geometry> grownGeometry;
+		std::vector<Geometry> wholeGeometry;
+		sceneGenerator.Generate(50, 0, worldBounds, broadPhase, grownGeometry);
+		sceneGenerator.Generate(100, distributionIndex == SCENE_DISTRIBUTION_GRID ? 0 : 50, worldBounds, broadPhase, grownGeometry);
+		sceneGenerator.Generate(100, 0, worldBounds, broadPhase, wholeGeometry);
+
+		for (int geometryIndex = 0; geometryIndex < 100; geometryIndex++)
+		{
+			const std::vector<Vec2>& grownPoints = grownGeometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+			const std::vector<Vec2>& wholePoints = wholeGeometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+			if (grownPoints.size() < 3 || grownPoints.size() != wholePoints.size())
+				return false;
+
+			for (int pointIndex = 0; pointIndex < (int)grownPoints.size(); pointIndex++)
+			{
+				const Vec2& point = grownPoints[pointIndex];
+				if (point.x != wholePoints[pointIndex].x || point.y != wholePoints[pointIndex].y || point.x < 0.f || point.y < 0.f || point.x > WORLD_WIDTH || point.y > WORLD_HEIGHT)
+					return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("BinaryFileRead", "FileUtils", 1)
+{
+	std::string fileReadPath = BINARY_FILES_PATH + std::string("test.bin");
+	std::vector<uchar> testReadBuffer;
+	bool result = LoadBinaryFileToExistingBuffer(fileReadPath, testReadBuffer);
+
+	if (!result)
+	{
+		return false;
+	}
+
+	DebuggerPrintf("\n Binary File Read Unit Test \n");
+
+	for (int i = 0; i < testReadBuffer.size(); i++)
+	{
+		DebuggerPrintf("%c", testReadBuffer[i]);
+	}
+
+	return true;
+}
+
+UNITTEST("BufferParser", "ReadBufferTest", 1)
+{
+	// Just trying stuff out here initially to see if buffer writing/parsing seems to be working
+	Vec3 pos(3.f, 4.f, 5.f);
+	IntVec2 coords(3, 4);
+
+	BufferReadUtils bufVec3((unsigned char*)&pos, sizeof(pos));
+	float x = bufVec3.ParseFloat();
+	float y = bufVec3.ParseFloat();
+	float z = bufVec3.ParseFloat();
+
+	BufferReadUtils bufLittle((unsigned char*)&coords, sizeof(coords));
+	int x1 = bufLittle.ParseInt32();
+	int y1 = bufLittle.ParseInt32();
+
+	BufferReadUtils bufBig((unsigned char*)&coords, sizeof(coords), eBufferEndianness::BUFFER_BIG_ENDIAN);
+	int x2 = bufBig.ParseInt32();
+	int y2 = bufBig.ParseInt32();
+
+	BufferReadUtils bufNative((unsigned char*)&coords, sizeof(coords), eBufferEndianness::BUFFER_NATIVE);
+	int x3 = bufNative.ParseInt32();
+	int y3 = bufNative.ParseInt32();
+
+	Buffer b;
+	b.push_back(0xff);
+	b.push_back(0x00);
+	b.push_back(0xa3);
+
+	BufferWriteUtils bw(b, eBufferEndianness::BUFFER_BIG_ENDIAN);
+	bw.AppendByte(0x12);
+	bw.AppendByte(0x34);
+	bw.AppendByte(0x56);
+	bw.AppendByte(0x78);
+	bw.AppendInt32(42);
+	bw.AppendFloat(3.14159265f);
+
+	BufferWriteUtils bw2(b, eBufferEndianness::BUFFER_LITTLE_ENDIAN);
+	bw2.AppendInt32(15);
+
+	double dp1 = 3.1415926535897932384626433832795;
+	BufferReadUtils dpBuf((unsigned char*)&dp1, sizeof(dp1));
+	double dp2 = dpBuf.ParseDouble();
+	GUARANTEE_RECOVERABLE(dp1 == dp2, "Value read and value from write is not the same");
+
+	Buffer dpBuf2;
+	BufferWriteUtils dpWrite2(dpBuf2);
+	dpWrite2.AppendDouble(dp1);
+
+	BufferReadUtils dpParse2(dpBuf2);
+	double dp3 = dpParse2.ParseDouble();
+	GUARANTEE_RECOVERABLE(dp1 == dp3, "Value read and value from write is not the same");
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateImGUI()
+{
+	//Use this function to create and use an ImGUI widget
+	ImGui::Begin("Geometry Visualizer");
+
+	ImGui::ColorEdit3("Scene Background Color", (float*)&ui_cameraClearColor); // Edit 3 floats representing a color
+	ImGui::ColorEdit3("Polygon Color", (float*)ui_polygonColor);
+
+	ImGui::Text("Polygons :");
+	ImGui::SameLine();
+	if (ImGui::Button("Reduce by half"))
+	{
+		ui_numGeometry /= 2;
+		CreateConvexGeometry(ui_numGeometry);
+	}
+
+	ImGui::SameLine();
+	if (ImGui::Button("Double"))
+	{
+		ui_numGeometry *= 2;
+		CreateConvexGeometry(ui_numGeometry);
+	}
+
+	ImGui::SliderInt("Number of Polygons", &ui_numGeometry, ui_minGeometry, ui_maxGeometry);
+	ImGui::Checkbox("Reject Overlapping Placements", &m_rejectOverlappingPlacements);
+	ImGui::SameLine();
+	ImGui::Checkbox("Repeat Shapes", &m_repeatShapes);
+
+	ImGui::SameLine();
+	if (ImGui::Button("Find Overlapping Pairs"))
+	{
+		MeasureOverlappingPairs();
+	}
+
+	if (m_hasOverlapMeasurement)
+	{
+		ImGui::Text("Overlapping pairs: %d  SAT candidates: %d  time in ms: %f", (int)m_overlapPairs.size(), m_numOverlapCandidates, m_overlapSearchTime * 1000.f);
+
+		if (ImGui::Button("Measure GJK/EPA On Overlapping Pairs"))
+		{
+			MeasurePairPenetrations();
+		}
+
+		if (m_hasPenetrationMeasurement)
+		{
+			ImGui::Text("Max penetration: %f  cold in ms: %f  warm started one drift step on in ms: %f", m_maxPenetrationDepth, m_coldDistanceTime * 1000.f, m_warmDistanceTime * 1000.f);
+		}
+	}
+
+	ImGui::Text("Scene Distribution :");
+	const char* distributionNames[NUM_SCENE_DISTRIBUTIONS] = { "Uniform", "Clustered", "Grid", "Power Law" };
+	for (int distributionIndex = 0; distributionIndex < NUM_SCENE_DISTRIBUTIONS; distributionIndex++)
+	{
+		ImGui::SameLine();
+		if (ImGui::RadioButton(distributionNames[distributionIndex], m_sceneDistribution == distributionIndex) && m_sceneDistribution != distributionIndex)
+		{
+			m_sceneDistribution = (eSceneDistribution)distributionIndex;
+			RegenerateConvexGeometry();
+		}
+	}
+
+	if (ImGui::InputInt("Scene Seed", &ui_sceneSeed))
+	{
+		RegenerateConvexGeometry();
+	}
+
+	if (ImGui::Button("Measure Scene Generation (1M polygons)"))
+	{
+		MeasureSceneGeneration();
+	}
+
+	if (m_hasSceneGenerationMeasurement)
+	{
+		ImGui::SameLine();
+		ImGui::Text("Time in ms: %f", m_sceneGenerationTime * 1000.f);
+	}
+
+	ImGui::Checkbox("Drift Geometry", &ui_driftGeometry);
+	if (ui_driftGeometry)
+	{
+		ImGui::SameLine();
+		ImGui::Checkbox("Refit Instead Of Rebuild", &ui_refitDriftingGeometry);
+		ImGui::Text("Move in ms: %f  refit: %f  rebuild: %f  hulls changing cells: %d", m_driftMoveTime * 1000.f, m_driftRefitTime * 1000.f, m_driftRebuildTime * 1000.f, m_numDriftCellChanges);
+
+		ImGui::SliderFloat("Drift Speed Scale", &ui_driftSpeedScale, 1.f, 50.f);
+		ImGui::Checkbox("Stop At Time Of Impact", &ui_stopDriftAtImpact);
+		if (ui_stopDriftAtImpact)
+		{
+			ImGui::SameLine();
+			ImGui::Text("Swept pairs: %d  impacts: %d  passes: %d  time in ms: %f", (int)m_sweptPairs.size(), m_timeOfImpactSolver.GetNumHits(), m_timeOfImpactSolver.GetNumResolvePasses(), m_timeOfImpactTime * 1000.f);
+		}
+	}
+	
+	ImGui::Text("Rays :");
+	ImGui::SameLine();
+	if (ImGui::Button("Half"))
+	{
+		ui_numRays /= 2;
+		CreateRaycasts(ui_numRays);
+	}
+
+	ImGui::SameLine();
+	if (ImGui::Button("2X"))
+	{
+		ui_numRays *= 2;
+		CreateRaycasts(ui_numRays);
+	}
+
+	ImGui::SliderInt("Number of Rays", &ui_numRays, ui_minRays, ui_maxRays);
+	ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+	ImGui::Checkbox("Enable Bit Bucket Broad-phase Check", &m_toggleBroadPhaseMode);
+	ImGui::Text("Total Raycast Time last frame in ms: %f", m_cachedRaycastTime * 1000.f);
+
+	ImGui::Text("Raycast Batch Mode :");
+	ImGui::SameLine();
+	if (ImGui::RadioButton("Immediate", m_raycastBatchMode == RAYCAST_BATCH_IMMEDIATE))
+	{
+		m_raycastBatchMode = RAYCAST_BATCH_IMMEDIATE;
+	}
+
+	ImGui::SameLine();
+	if (ImGui::RadioButton("Pipelined", m_raycastBatchMode == RAYCAST_BATCH_PIPELINED))
+	{
+		m_raycastBatchMode = RAYCAST_BATCH_PIPELINED;
+	}
+
+	ImGui::SameLine();
+	if (ImGui::RadioButton("Time Budgeted", m_raycastBatchMode == RAYCAST_BATCH_TIME_BUDGETED))
+	{
+		m_raycastBatchMode = RAYCAST_BATCH_TIME_BUDGETED;
+	}
+
+	if (m_raycastBatchMode == RAYCAST_BATCH_TIME_BUDGETED)
+	{
+		ImGui::SliderFloat("Raycast Budget (ms)", &ui_raycastBudgetMS, 0.1f, 16.f);
+		UpdateImGUIRaycastAges();
+	}
+
+	ImGui::Checkbox("Render Raycast Hits", &ui_renderRaycastHits);
+	ImGui::Checkbox("Use Specialized Hull Kernels", &m_useSpecializedHullKernels);
+	if (m_useSpecializedHullKernels)
+	{
+		ImGui::SameLine();
+		ImGui::Text("Plane sets: %d for %d hulls  plane data: %.1f KB  (%.1f KB unshared)", m_hullStore.GetNumPlaneSets(), m_hullStore.GetNumHulls(),
+			(float)m_hullStore.GetPlaneDataBytes() / 1024.f, (float)m_hullStore.GetUnsharedPlaneDataBytes() / 1024.f);
+	}
+
+	ImGui::Checkbox("Sphere Trace Distance Field", &m_useDistanceFieldRaycasts);
+	if (m_useDistanceFieldRaycasts && m_distanceField.IsBaked())
+	{
+		ImGui::SameLine();
+		ImGui::Text("%d x %d samples baked in ms: %f", m_distanceField.GetNumSamples().x, m_distanceField.GetNumSamples().y, m_distanceFieldBakeTime * 1000.f);
+	}
+
+	ImGui::Text("Render Cast Shape :");
+	ImGui::SameLine();
+	if (ImGui::RadioButton("Ray", m_renderCastShape == RENDER_CAST_RAY))
+	{
+		m_renderCastShape = RENDER_CAST_RAY;
+	}
+
+	ImGui::SameLine();
+	if (ImGui::RadioButton("Disc", m_renderCastShape == RENDER_CAST_DISC))
+	{
+		m_renderCastShape = RENDER_CAST_DISC;
+	}
+
+	ImGui::SameLine();
+	if (ImGui::RadioButton("Capsule", m_renderCastShape == RENDER_CAST_CAPSULE))
+	{
+		m_renderCastShape = RENDER_CAST_CAPSULE;
+	}
+
+	ImGui::SliderFloat("Shape Cast Radius", &ui_shapeCastRadius, 0.25f, 10.f);
+
+	if (ImGui::Button("Measure Batched Disc Casts (one per ray)"))
+	{
+		MeasureBatchedDiscCasts();
+	}
+
+	if (m_hasShapeCastMeasurement)
+	{
+		ImGui::Text("Disc casts: %d  hits: %d  batch time in ms: %f", m_numShapeCastsMeasured, m_numShapeCastHitsMeasured, m_shapeCastBatchTime * 1000.f);
+	}
+
+	ImGui::Checkbox("Reflect Render Ray", &ui_showRayReflections);
+	ImGui::SliderInt("Reflection Bounces", &ui_numReflectionBounces, 1, MAX_REFLECTION_BOUNCES);
+
+	if (ImGui::Button("Measure Reflection Stream (all rays)"))
+	{
+		MeasureReflectionStream();
+	}
+
+	if (m_hasReflectionMeasurement)
+	{
+		double segmentsPerSecond = (m_reflectionTraceTime > 0.0) ? (double)m_numReflectionSegments / m_reflectionTraceTime : 0.0;
+		ImGui::Text("Bounce segments: %d  time in ms: %f  (%.2f M segments/s)", m_numReflectionSegments, m_reflectionTraceTime * 1000.f, segmentsPerSecond / 1000000.0);
+	}
+
+	ImGui::Checkbox("Show Hulls Crossed By Render Ray", &ui_showRayIntervals);
+	if (ui_showRayIntervals)
+	{
+		float totalThickness = 0.f;
+		for (int intervalIndex = 0; intervalIndex < m_numRenderRayIntervals; intervalIndex++)
+		{
+			totalThickness += m_renderRayIntervals[intervalIndex].m_timeExit - m_renderRayIntervals[intervalIndex].m_timeEnter;
+		}
+
+		ImGui::SameLine();
+		ImGui::Text("Hulls crossed: %d  total thickness: %f", m_numRenderRayIntervals, totalThickness);
+	}
+
+	if (ImGui::Button("Measure All Intersections (all rays)"))
+	{
+		MeasureAllIntersections();
+	}
+
+	if (m_hasIntervalMeasurement)
+	{
+		ImGui::SameLine();
+		ImGui::Text("Intervals: %d  time in ms: %f", m_numMeasuredIntervals, m_intervalQueryTime * 1000.f);
+	}
+
+	if (ImGui::Button("Load Primitives From SaveGame.xml"))
+	{
+		LoadMixedPrimitives();
+	}
+
+	if (m_hasMixedPrimitives)
+	{
+		ImGui::SameLine();
+		ImGui::Text("Discs: %d  capsules: %d  boxes: %d  hulls: %d", m_primitiveStore.GetNumPrimitives(PRIMITIVE_DISC), m_primitiveStore.GetNumPrimitives(PRIMITIVE_CAPSULE),
+			m_primitiveStore.GetNumPrimitives(PRIMITIVE_OBB), m_primitiveStore.GetNumPrimitives(PRIMITIVE_HULL));
+
+		if (ImGui::Button("Measure Mixed Primitive Raycasts (all rays)"))
+		{
+			MeasureMixedPrimitiveRaycasts();
+		}
+
+		if (m_hasMixedPrimitiveMeasurement)
+		{
+			ImGui::SameLine();
+			ImGui::Text("Hits: %d  time in ms: %f", m_numMixedPrimitiveHits, m_mixedPrimitiveRaycastTime * 1000.f);
+		}
+	}
+
+	if (ImGui::Button("Make Instances From Scene Geometry"))
+	{
+		BuildGeometryInstances();
+	}
+
+	if (m_hasGeometryInstances)
+	{
+		ImGui::SameLine();
+		ImGui::Checkbox("Spin Instances", &ui_spinGeometryInstances);
+		ImGui::Text("Instances: %d  refit in ms: %f", m_geometryInstances.GetNumInstances(), m_instanceRefitTime * 1000.f);
+
+		if (ImGui::Button("Measure Rebuilding Every Hull"))
+		{
+			MeasureHullRebuild();
+		}
+
+		if (m_hasHullRebuildMeasurement)
+		{
+			ImGui::SameLine();
+			ImGui::Text("Rebuild from polygons in ms: %f", m_hullRebuildTime * 1000.f);
+		}
+
+		ImGui::Text("Shared prototypes: %d  local data: %.1f KB  (%.1f KB unshared)", m_geometryInstances.GetNumPrototypes(),
+			(float)m_geometryInstances.GetPrototypeDataBytes() / 1024.f, (float)m_geometryInstances.GetUnsharedPrototypeDataBytes() / 1024.f);
+
+		if (ImGui::Button("Measure Instanced Raycasts (all rays)"))
+		{
+			MeasureInstancedRaycasts();
+		}
+
+		if (m_hasInstancedRaycastMeasurement)
+		{
+			ImGui::SameLine();
+			ImGui::Text("Hits: %d  time in ms: %f", m_numInstancedRaycastHits, m_instancedRaycastTime * 1000.f);
+		}
+	}
+
+	ImGui::SliderInt("Number of Particles", &ui_numParticles, 1, MAX_PARTICLES);
+	if (ImGui::Button("Spawn Particles"))
+	{
+		SpawnParticles(ui_numParticles);
+		ui_simulateParticles = true;
+	}
+
+	if (m_particleCollider.GetNumParticles() > 0)
+	{
+		ImGui::SameLine();
+		ImGui::Checkbox("Simulate Particles", &ui_simulateParticles);
+		ImGui::Text("Particles: %d  touching hulls: %d  step in ms: %f", m_particleCollider.GetNumParticles(), m_numParticleContacts, m_particleStepTime * 1000.f);
+	}
+
+	ImGui::Checkbox("Sort Rays For Coherence", &m_useRaySorting);
+	if (m_useRaySorting)
+	{
+		ImGui::Text("Ray sort pre-pass in ms: %f", m_raySortTime * 1000.f);
+	}
+
+	if (ImGui::Button("Measure Cache Misses (creation vs sorted order)"))
+	{
+		MeasureRayOrderCacheMisses();
+	}
+
+	if (m_hasCacheMissMeasurement)
+	{
+		float reduction = 0.f;
+		if (m_cacheMissesCreationOrder > 0)
+		{
+			reduction = 100.f * (1.f - (float)m_cacheMissesSortedOrder / (float)m_cacheMissesCreationOrder);
+		}
+
+		ImGui::Text("Simulated 32KB L1 line accesses per order: %llu  (%s)", (unsigned long long)m_cacheAccessesPerOrder, m_cacheMissesModelHullStore ? "hull store SoA" : "geometry AoS");
+		ImGui::Text("Misses creation order: %llu  sorted order: %llu  (%.1f%% fewer)", (unsigned long long)m_cacheMissesCreationOrder, (unsigned long long)m_cacheMissesSortedOrder, reduction);
+		ImGui::Text("Raycast time creation order: %.3f ms  sorted order: %.3f ms", m_raycastTimeCreationOrder * 1000.f, m_raycastTimeSortedOrder * 1000.f);
+	}
+
+	ImGui::Text("Select Region :");
+	ImGui::SameLine();
+	if (ImGui::RadioButton("None", m_regionSelectShape == REGION_SELECT_NONE))
+	{
+		m_regionSelectShape = REGION_SELECT_NONE;
+	}
+
+	ImGui::SameLine();
+	if (ImGui::RadioButton("Box", m_regionSelectShape == REGION_SELECT_BOX))
+	{
+		m_regionSelectShape = REGION_SELECT_BOX;
+	}
+
+	ImGui::SameLine();
+	if (ImGui::RadioButton("Circle", m_regionSelectShape == REGION_SELECT_DISC))
+	{
+		m_regionSelectShape = REGION_SELECT_DISC;
+	}
+
+	ImGui::Text("Geometry in view: %d  selected: %d", m_numGeometryInView, (int)m_selectedGeometry.size());
+
+	if (ImGui::Button("Sample Occupancy (1M random points)"))
+	{
+		MeasureOccupancySampling();
+	}
+
+	if (m_hasOccupancyMeasurement)
+	{
+		float pointsPerSecond = (m_occupancySampleTime > 0.f) ? (float)OCCUPANCY_SAMPLE_COUNT / m_occupancySampleTime : 0.f;
+		ImGui::Text("Occupied: %.2f%%  query time in ms: %f  (%.1f M points/s)", m_occupiedFraction * 100.f, m_occupancySampleTime * 1000.f, pointsPerSecond / 1000000.f);
+	}
+
+	ImGui::Checkbox("Enable Cursor Debugging: ", &ui_debugCursorPosition);
+	m_gameCursor->SetDebugMode(ui_debugCursorPosition);
+
+	ImGui::Checkbox("Show Cursor Clearance", &ui_showCursorClearance);
+	if (m_hasCursorNearestGeometry)
+	{
+		ImGui::SameLine();
+		ImGui::Text("Nearest geometry %d at distance %.3f", m_cursorNearestGeometry.m_geometryIndex, m_cursorNearestGeometry.m_signedDistance);
+	}
+
+	ImGui::Checkbox("Show Visibility Polygon", &ui_showVisibilityPolygon);
+	if (ui_showVisibilityPolygon)
+	{
+		ImGui::SameLine();
+		ImGui::Text("%d vertices from %d segments in ms: %f", (int)m_visibilityPolygon.size(), m_visibilityQuery.GetNumSegments(), m_visibilityQueryTime * 1000.f);
+	}
+
+	if (ImGui::Button("Measure Line Of Sight (512 random points)"))
+	{
+		MeasureLineOfSight();
+	}
+
+	if (m_hasLineOfSightMeasurement)
+	{
+		ImGui::SameLine();
+		ImGui::Text("Visible pairs: %d of %d  time in ms: %f", m_numVisiblePointPairs, LINE_OF_SIGHT_POINT_COUNT * (LINE_OF_SIGHT_POINT_COUNT - 1) / 2, m_lineOfSightTime * 1000.f);
+	}
+
+	if (ImGui::Button("Bake Potentially Visible Set"))
+	{
+		UpdatePotentiallyVisibleSet();
+	}
+
+	if (m_potentiallyVisibleSet.IsBaked())
+	{
+		int numCells = m_potentiallyVisibleSet.GetNumCellsPerAxis() * m_potentiallyVisibleSet.GetNumCellsPerAxis();
+		ImGui::SameLine();
+		ImGui::Text("Visible cell pairs: %d of %d  rows: %d  bytes: %d (dense %d)  bake in ms: %f%s", m_potentiallyVisibleSet.GetNumVisiblePairs(), numCells * (numCells - 1) / 2,
+			m_potentiallyVisibleSet.GetNumUniqueRows(), m_potentiallyVisibleSet.GetCompressedSizeInBytes(), m_potentiallyVisibleSet.GetDenseSizeInBytes(), m_potentiallyVisibleSetBakeTime * 1000.f, m_isPotentiallyVisibleSetStale ? "  (scene changed)" : "");
+		ImGui::Checkbox("Show Cells Hidden From Cursor Cell", &ui_showPotentiallyVisibleSet);
+	}
+
+	ImGui::Checkbox("Show Navigation Graph", &ui_showNavigationGraph);
+	if (ui_showNavigationGraph)
+	{
+		ImGui::SameLine();
+		ImGui::Checkbox("Path Ray Start To End", &ui_showNavigationPath);
+		ImGui::Text("Nav nodes: %d  edges: %d  last sync from geometry %d (%d moved in place) in ms: %f", m_navigationGraph.GetNumNodes(), m_navigationGraph.GetNumEdges(),
+			m_lastNavSyncIndex, m_navigationGraph.GetNumMovedInLastSync(), m_navigationSyncTime * 1000.f);
+		if (ui_driftGeometry)
+		{
+			ImGui::Text("Synced every %d frames while drifting", NAV_DRIFT_SYNC_INTERVAL);
+		}
+		if (ui_showNavigationPath)
+		{
+			ImGui::Text("Path: %s%s  points: %d  expanded nodes: %d  search in ms: %f", m_hasNavigationPath ? "found" : "none", m_isNavigationGraphStale ? " (stale, from the last sync)" : "",
+				(int)m_navigationPath.size(), m_numExpandedNavNodes, m_navigationPathTime * 1000.f);
+		}
+	}
+
+	ImGui::End();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateImGUIRaycastAges()
+{
+	int numResults = (int)m_hitFrameStamps.size();
+	int numUnsolved = 0;
+	int oldestAge = 0;
+	float totalAge = 0.f;
+
+	for (int rayIndex = 0; rayIndex < numResults; rayIndex++)
+	{
+		if (m_hitFrameStamps[rayIndex] < 0)
+		{
+			numUnsolved++;
+			continue;
+		}
+
+		int age = m_frameIndex - m_hitFrameStamps[rayIndex];
+		totalAge += (float)age;
+		if (age > oldestAge)
+		{
+			oldestAge = age;
+		}
+	}
+
+	int numSolved = numResults - numUnsolved;
+	float averageAge = (numSolved > 0) ? totalAge / (float)numSolved : 0.f;
+	ImGui::Text("Result age in frames, Avg: %.2f Max: %d Unsolved: %d", averageAge, oldestAge, numUnsolved);
+
+	if (ImGui::CollapsingHeader("Raycast Result Ages"))
+	{
+		ImGui::BeginChild("RaycastResultAges", ImVec2(0.f, 150.f), true);
+		for (int rayIndex = 0; rayIndex < numResults; rayIndex++)
+		{
+			if (m_hitFrameStamps[rayIndex] < 0)
+			{
+				ImGui::Text("Ray %d : not solved yet", rayIndex);
+			}
+			else
+			{
+				ImGui::Text("Ray %d : %d frames", rayIndex, m_frameIndex - m_hitFrameStamps[rayIndex]);
+			}
+		}
+		ImGui::EndChild();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateVisualRay()
+{
+	if (m_canMoveStart)
+	{
+		m_rayStart = m_gameCursor->GetCursorPositon();
+		m_renderedRay.m_start = m_gameCursor->GetCursorPositon();
+	}
+
+	if (m_canMoveEnd)
+	{
+		m_rayEnd = m_gameCursor->GetCursorPositon();
+	}
+
+	Vec2 rayDir = m_rayEnd - m_rayStart;
+	rayDir.Normalize();
+
+	m_renderedRay.m_direction = rayDir;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ShutDown()
+{
+	m_cooker->InitiateWriteSequence();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::HandleKeyPressed(unsigned char keyCode)
+{
+	if (g_devConsole->IsOpen())
+	{
+		g_devConsole->HandleKeyDown(keyCode);
+		return;
+	}
+
+	switch( keyCode )
+	{
+		case W_KEY:
+		case S_KEY:
+		{
+			m_canMoveStart = true;
+			m_mouseStart = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
+			m_renderedRay.m_start = m_mouseStart;
+			break;
+		}
+		case A_KEY:
+		case D_KEY:
+		break;
+		case E_KEY:
+		{
+			m_canMoveEnd = true;
+			m_mouseEnd = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
+			m_rayEnd = m_mouseEnd;
+			break;
+		}
+		case LCTRL_KEY:
+		{
+			m_toggleUI = !m_toggleUI;
+		}
+		break;
+		case DEL_KEY:
+		case G_KEY:
+		case TAB_KEY:
+		case K_KEY:
+		break;
+		case L_KEY:
+		break;
+		case NUM_1:
+		{
+			ui_numRays /= 2;
+			CreateRaycasts(ui_numRays);
+		}
+		break;
+		case NUM_2:
+		{
+			ui_numRays *= 2;
+			
+			if (ui_numRays == 0)
+				ui_numRays = 1;
+
+			CreateRaycasts(ui_numRays);
+		}
+		break;
+		case NUM_3:
+		{
+			ui_numGeometry /= 2;
+			
+			if (ui_numGeometry == 0)
+				ui_numGeometry = 1;
+
+			CreateConvexGeometry(ui_numGeometry);
+		}
+		break;
+		case NUM_4:
+		{
+			ui_numGeometry *= 2;
+			CreateConvexGeometry(ui_numGeometry);
+		}
+		break;
+		case NUM_5:
+		{
+			m_toggleBroadPhaseMode = !m_toggleBroadPhaseMode;
+		}
+		break;
+		case NUM_6:
+		{
+			ReRandomize();
+		}
+		break;
+		case NUM_7:
+		break;
+		case NUM_8:
+		break;
+		case NUM_9:
+		break;
+		case N_KEY:
+		break;
+		case M_KEY:
+		break;
+		case KEY_LESSER:
+		break;
+		case KEY_GREATER:
+		break;
+		case F1_KEY:
+		break;
+		case F2_KEY:
+		break;
+		case F3_KEY:
+		break;
+		case F4_KEY:
+		break;
+		case F5_KEY:
+		break;
+		case F6_KEY:
+		break;
+		case F7_KEY:
+		break;
+		default:
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::DebugEnabled()
+{
+	g_debugMode = !g_debugMode;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::HandleKeyReleased(unsigned char keyCode)
+{
+
+	switch( keyCode )
+	{
+		case UP_ARROW:
+		case DOWN_ARROW:
+		case RIGHT_ARROW:
+		case LEFT_ARROW:
+		break;
+		default:
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::HandleCharacter(unsigned char charCode)
+{
+	if (g_devConsole->IsOpen())
+	{
+		g_devConsole->HandleCharacter(charCode);
+		return;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::HandleMouseLBDown()
+{
+	m_canMoveStart = true;
+	m_mouseStart = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
+	m_renderedRay.m_start = m_mouseStart;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::HandleMouseLBUp()
+{
+	m_canMoveStart = false;
+	m_mouseStart = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
+	m_renderedRay.m_start = m_mouseStart;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::HandleMouseRBDown()
+{
+	m_canMoveEnd = true;
+	m_mouseEnd = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
+	m_rayEnd = m_mouseEnd;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::HandleMouseRBUp()
+{
+	m_canMoveEnd = false;
+	m_mouseEnd = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
+	m_rayEnd = m_mouseEnd;
+	return true;
+}
+
+/*
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::HandleMouseScroll(float wheelDelta)
+{
+	m_zoomLevel += wheelDelta;
+	m_zoomLevel = Clamp(m_zoomLevel, 0.00001f, MAX_ZOOM_STEPS);
+
+	//Recalculate mins and maxes based on the zoom level
+	float newMinX = 0.f + m_zoomLevel * SCREEN_ASPECT;
+	float newMinY = 0.f + m_zoomLevel;
+
+	float newMaxX = WORLD_WIDTH - m_zoomLevel * SCREEN_ASPECT;
+	float newMaxY = WORLD_HEIGHT - m_zoomLevel;
+
+	m_mainCamera->SetOrthoView(Vec2(newMinX, newMinY), Vec2(newMaxX, newMaxY));
+
+	return true;
+}
+*/
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::Render() const
+{
+	//Get the ColorTargetView from rendercontext
+	ColorTargetView *colorTargetView = g_renderContext->GetFrameColorTarget();
+
+	//Setup what we are rendering to
+	m_mainCamera->SetColorTarget(colorTargetView);
+	m_devConsoleCamera->SetColorTarget(colorTargetView);
+	m_mainCamera->SetViewport(Vec2::ZERO, Vec2::ONE);
+
+	g_renderContext->BeginCamera(*m_mainCamera);
+
+	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
+		
+	g_renderContext->ClearColorTargets(Rgba(ui_cameraClearColor[0], ui_cameraClearColor[1], ui_cameraClearColor[2], 1.f));
+
+	g_renderContext->BindShader( m_shader );
+
+	RenderAllGeometry();
+	RenderRaycast();
+	RenderShapeCast();
+	RenderRayReflections();
+	RenderRayIntervals();
+	RenderMixedPrimitives();
+	RenderGeometryInstances();
+	RenderParticles();
+	RenderSelectionRegion();
+	RenderCursorClearance();
+	RenderVisibilityPolygon();
+	RenderNavigation();
+	RenderPotentiallyVisibleSet();
+	RenderRaycastHits();
+
+	RenderWorldBounds();
+
+	//RenderPersistantUI();
+
+	if(m_toggleUI)
+	{
+		//RenderOnScreenInfo();
+	}
+
+	g_ImGUI->Render();
+
+	m_gameCursor->Render();
+
+	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
+
+	g_renderContext->EndCamera();
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderWorldBounds() const
+{
+	std::vector<Vertex_PCU> boxVerts;
+	AddVertsForBoundingBox(boxVerts, m_worldBounds, Rgba::DARK_GREY, 2.f);
+	
+	g_renderContext->DrawVertexArray(boxVerts);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderOnScreenInfo() const
+{
+	
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderPersistantUI() const
+{
+	
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderAllGeometry() const
+{
+	//Render all the geometry in the scene
+	std::vector<Vertex_PCU> convexPolyVerts;
+
+	//Only polygons overlapping the camera view get verts
+	AABB2 viewBounds = AABB2(m_mainCamera->GetOrthoBottomLeft(), m_mainCamera->GetOrthoTopRight());
+	std::vector<int> visibleGeometry(m_geometry.size());
+	int numVisible = m_sceneQuery.QueryAABB(viewBounds, visibleGeometry.data(), (int)visibleGeometry.size());
+	if (numVisible > visibleGeometry.size())
+	{
+		numVisible = (int)visibleGeometry.size();
+	}
+
+	//The query reports polygons in cell order, drawing in index order keeps the highest index on top for picking
+	std::sort(visibleGeometry.begin(), visibleGeometry.begin() + numVisible);
+
+	int hoveredGeometryIndex = m_gameCursor->GetHoveredGeometryIndex();
+	for (int visibleIndex = 0; visibleIndex < numVisible; visibleIndex++)
+	{
+		int polygonIndex = visibleGeometry[visibleIndex];
+
+		Rgba polygonColor = Rgba(ui_polygonColor[0], ui_polygonColor[1], ui_polygonColor[2], 1.f);
+		if (polygonIndex == hoveredGeometryIndex)
+		{
+			polygonColor = Rgba::ORGANIC_BLUE;
+		}
+		else if (polygonIndex < m_isGeometrySelected.size() && m_isGeometrySelected[polygonIndex])
+		{
+			polygonColor = Rgba::ORGANIC_ORANGE;
+		}
+
+		AddVertsForSolidConvexPoly2D(convexPolyVerts, m_geometry[polygonIndex].GetConvexPoly2D(), polygonColor);
+	}
+
+	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
+	g_renderContext->DrawVertexArray(convexPolyVerts);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::DebugRenderTestRandomPointsOnScreen() const
+{
+	//Debugging if the RandomPointsOnCircleAreCorrect
+	float angleUsed;
+	Vec2 randomPoint = GetRandomPointOnDisc2D(Vec2(50.f, 50.f), 50.f, 0.f, 360.f, angleUsed);
+	g_debugRenderer->DebugRenderPoint2D(randomPoint, 1.f, 5.f);
+
+	g_debugRenderer->DebugRenderDisc2D(Disc2D(Vec2(50.f, 50.f), 10.f), 0.f);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::DebugRenderToScreen() const
+{
+	Camera& debugCamera = g_debugRenderer->Get2DCamera();
+	debugCamera.m_colorTargetView = g_renderContext->GetFrameColorTarget();
+
+	g_renderContext->BindShader(m_shader);
+	g_renderContext->BeginCamera(debugCamera);
+
+	g_debugRenderer->DebugRenderToScreen();
+
+	g_renderContext->EndCamera();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::DebugRenderToCamera() const
+{
+	Camera& debugCamera3D = *m_mainCamera;
+	debugCamera3D.m_colorTargetView = g_renderContext->GetFrameColorTarget();
+
+	g_renderContext->BindShader(m_shader);
+	g_renderContext->BeginCamera(debugCamera3D);
+
+	g_debugRenderer->Setup3DCamera(&debugCamera3D);
+	g_debugRenderer->DebugRenderToCamera();
+
+	g_renderContext->EndCamera();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ReRandomize()
+{
+	m_rays.clear();	
+	m_areRaysSorted = false;
+
+	//The scene only changes with the seed
+	ui_sceneSeed++;
+	RegenerateConvexGeometry();
+	CreateRaycasts(ui_numRays);
+	ResetRaycastHits();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ResetRaycastHits()
+{
+	//New rays or a new scene make every stored hit stale, the budgeted sweep starts over so none are drawn or aged as current
+	RayHit2D noHit;
+	noHit.m_timeAtHit = MAX_RAYCAST_TIME;
+	m_hits.assign(m_rays.size(), noHit);
+	m_hitFrameStamps.assign(m_rays.size(), -1);
+	m_nextBudgetedRayIndex = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CheckRaycastsBroadPhase()
+{
+	double totalStartTime = GetCurrentTimeSeconds();
+
+	RaycastRangeVsConvexHulls(0, (int)m_rays.size(), true, m_hits);
+
+	double totalEndTime = GetCurrentTimeSeconds();
+	m_cachedRaycastTime = (float)(totalEndTime - totalStartTime);
+	//DebuggerPrintf("\n Total Time for Raycasts this frame: %f", m_cachedRaycastTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CheckRaycastsTimeBudgeted()
+{
+	double totalStartTime = GetCurrentTimeSeconds();
+	double budgetSeconds = (double)ui_raycastBudgetMS / 1000.0;
+
+	int numRays = (int)m_rays.size();
+	if ((int)m_hitFrameStamps.size() != numRays)
+	{
+		m_hitFrameStamps.resize(numRays, -1);
+	}
+
+	if (m_nextBudgetedRayIndex >= numRays)
+	{
+		m_nextBudgetedRayIndex = 0;
+	}
+
+	//Always solve at least one chunk so the batch makes progress even with a tiny budget
+	int numRaysSolved = 0;
+	while (numRaysSolved < numRays)
+	{
+		int endRayIndex = m_nextBudgetedRayIndex + RAYCAST_BUDGET_CHUNK_SIZE;
+		if (endRayIndex > numRays)
+		{
+			endRayIndex = numRays;
+		}
+
+		RaycastRangeVsConvexHulls(m_nextBudgetedRayIndex, endRayIndex, m_toggleBroadPhaseMode, m_hits);
+
+		for (int traversalIndex = m_nextBudgetedRayIndex; traversalIndex < endRayIndex; traversalIndex++)
+		{
+			m_hitFrameStamps[GetRayIndexForTraversalIndex(traversalIndex)] = m_frameIndex;
+		}
+
+		numRaysSolved += endRayIndex - m_nextBudgetedRayIndex;
+		m_nextBudgetedRayIndex = (endRayIndex == numRays) ? 0 : endRayIndex;
+
+		if (GetCurrentTimeSeconds() - totalStartTime >= budgetSeconds)
+			break;
+	}
+
+	double totalEndTime = GetCurrentTimeSeconds();
+	m_cachedRaycastTime = (float)(totalEndTime - totalStartTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RaycastRangeVsConvexHulls(int startRayIndex, int endRayIndex, bool useBroadPhase, std::vector<RayHit2D>& hitsOut) const
+{
+	//The engine Raycast can write a hit per plane of the hull so it gets its own scratch space instead of hitsOut
+	std::vector<RayHit2D> scratchHits;
+
+	//With sorting on, the range walks the sorted copy of the rays and the results get scattered back to creation order
+	const std::vector<Ray2D>& rays = m_useRaySorting ? m_raySorter.GetSortedRays() : m_rays;
+
+	for (int traversalIndex = startRayIndex; traversalIndex < endRayIndex; traversalIndex++)
+	{
+		Ray2D ray = rays[traversalIndex];
+		int rayIndex = GetRayIndexForTraversalIndex(traversalIndex);
+
+		RayHit2D bestHit;
+		bestHit.m_timeAtHit = MAX_RAYCAST_TIME;
+
+		//Skip the empty space in front of the ray, the exact tests below then start close to the first surface
+		float skippedTime = 0.f;
+		if (m_useDistanceFieldRaycasts && !m_distanceField.AdvanceRay(ray, skippedTime, m_broadPhaseChecker))
+		{
+			hitsOut[rayIndex] = bestHit;
+			continue;
+		}
+
+		if (m_useSpecializedHullKernels)
+		{
+			m_hullStore.RaycastClosest(bestHit, ray, useBroadPhase);
+			if (bestHit.m_timeAtHit < MAX_RAYCAST_TIME)
+			{
+				bestHit.m_timeAtHit += skippedTime;
+			}
+
+			hitsOut[rayIndex] = bestHit;
+			continue;
+		}
+
+		for (int hullIndex = 0; hullIndex < m_geometry.size(); hullIndex++)
+		{
+			if (useBroadPhase)
+			{
+				bool xOverlapCondition = (ray.m_bitFieldsXY.x & m_geometry[hullIndex].GetBitFields().x) != 0;
+				bool yOverlapCondition = (ray.m_bitFieldsXY.y & m_geometry[hullIndex].GetBitFields().y) != 0;
+
+				if (!xOverlapCondition || !yOverlapCondition)
+					continue;
+			}
+
+			//Run the regular collision check for ray vs convexHull here
+			const ConvexHull2D& hull = m_geometry[hullIndex].GetConvexHull2D();
+			if ((int)scratchHits.size() < hull.GetNumPlanes())
+			{
+				scratchHits.resize(hull.GetNumPlanes());
+			}
+
+			uint hits = Raycast(scratchHits.data(), ray, hull, 0.f);
+			if (hits > 0 && scratchHits[0].m_timeAtHit >= 0.f && scratchHits[0].m_timeAtHit < bestHit.m_timeAtHit)
+			{
+				bestHit = scratchHits[0];
+			}
+		}
+
+		if (bestHit.m_timeAtHit < MAX_RAYCAST_TIME)
+		{
+			bestHit.m_timeAtHit += skippedTime;
+		}
+
+		hitsOut[rayIndex] = bestHit;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateHullStore()
+{
+	if (!m_isHullStoreDirty)
+		return;
+
+	m_hullStore.BuildFromGeometry(m_geometry);
+	m_shapeCaster.BuildFromGeometry(m_geometry);
+	m_pointQuery.BuildFromGeometry(m_geometry, m_broadPhaseChecker);
+	m_sceneQuery.BuildFromGeometry(m_geometry, m_broadPhaseChecker);
+	if (m_hasMixedPrimitives)
+	{
+		AddSceneHullsToPrimitiveStore();
+	}
+	if (m_hasGeometryInstances)
+	{
+		BuildGeometryInstances();
+	}
+	m_isHullStoreDirty = false;
+	m_isDistanceFieldDirty = true;
+	m_isVisibilityQueryDirty = true;
+	m_isPotentiallyVisibleSetStale = true;
+	m_areParticleHullsDirty = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateDriftingGeometry(float deltaTime)
+{
+	if (!ui_driftGeometry || m_geometry.empty())
+		return;
+
+	AddMissingDriftVelocities();
+
+	//The speed scale lets the polygons cover more than their own size in a frame to show tunnelling
+	float driftSeconds = deltaTime * ui_driftSpeedScale;
+	m_driftDisplacements.resize(m_geometry.size());
+	for (int geometryIndex = 0; geometryIndex < (int)m_geometry.size(); geometryIndex++)
+	{
+		m_driftDisplacements[geometryIndex] = m_geometryVelocities[geometryIndex] * driftSeconds;
+	}
+
+	if (ui_stopDriftAtImpact)
+	{
+		StopDriftingGeometryAtImpacts(driftSeconds);
+	}
+
+	double moveStartTime = GetCurrentTimeSeconds();
+
+	std::vector<int> movedGeometry;
+	movedGeometry.reserve(m_geometry.size());
+	for (int geometryIndex = 0; geometryIndex < (int)m_geometry.size(); geometryIndex++)
+	{
+		const std::vector<Vec2>& points = m_geometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+		Vec2 mins = points[0];
+		Vec2 maxs = points[0];
+		for (int pointIndex = 1; pointIndex < (int)points.size(); pointIndex++)
+		{
+			mins = Vec2(GetLowerValue(mins.x, points[pointIndex].x), GetLowerValue(mins.y, points[pointIndex].y));
+			maxs = Vec2(GetHigherValue(maxs.x, points[pointIndex].x), GetHigherValue(maxs.y, points[pointIndex].y));
+		}
+
+		//Bounce off the world bounds
+		Vec2& velocity = m_geometryVelocities[geometryIndex];
+		Vec2 displacement = m_driftDisplacements[geometryIndex];
+		if (mins.x + displacement.x < m_worldBounds.m_minBounds.x || maxs.x + displacement.x > m_worldBounds.m_maxBounds.x)
+		{
+			velocity.x = -velocity.x;
+			displacement.x = 0.f;
+		}
+		if (mins.y + displacement.y < m_worldBounds.m_minBounds.y || maxs.y + displacement.y > m_worldBounds.m_maxBounds.y)
+		{
+			velocity.y = -velocity.y;
+			displacement.y = 0.f;
+		}
+
+		if (displacement == Vec2::ZERO)
+			continue;
+
+		Geometry& geometry = m_geometry[geometryIndex];
+		geometry.Translate(displacement);
+		geometry.SetBitFieldsForBitBucketBroadPhase(m_broadPhaseChecker.GetRegionForConvexPoly(geometry.GetConvexPoly2D()));
+		movedGeometry.push_back(geometryIndex);
+	}
+
+	m_driftMoveTime = GetCurrentTimeSeconds() - moveStartTime;
+
+	//Only the accelerators used every frame are timed, the rest are rebuilt the same way either way
+	double updateStartTime = GetCurrentTimeSeconds();
+	if (ui_refitDriftingGeometry)
+	{
+		m_hullStore.RefitMovedGeometry(m_geometry, movedGeometry);
+		m_shapeCaster.RefitMovedGeometry(m_geometry, movedGeometry);
+		m_pointQuery.RefitMovedGeometry(m_geometry, movedGeometry);
+		m_numDriftCellChanges = m_sceneQuery.RefitMovedGeometry(m_geometry, movedGeometry);
+		m_driftRefitTime = GetCurrentTimeSeconds() - updateStartTime;
+	}
+	else
+	{
+		m_hullStore.BuildFromGeometry(m_geometry);
+		m_shapeCaster.BuildFromGeometry(m_geometry);
+		m_pointQuery.BuildFromGeometry(m_geometry, m_broadPhaseChecker);
+		m_sceneQuery.BuildFromGeometry(m_geometry, m_broadPhaseChecker);
+		m_driftRebuildTime = GetCurrentTimeSeconds() - updateStartTime;
+	}
+
+	//The optional stores are not part of the comparison, they are refit in place either way so a rebuild does not
+	//show up uncounted in every drift frame and the instances keep their spin
+	if (m_hasMixedPrimitives)
+	{
+		m_primitiveStore.RefitMovedHulls(m_geometry, movedGeometry);
+	}
+	if (m_hasGeometryInstances)
+	{
+		RefitMovedGeometryInstances(movedGeometry);
+	}
+	m_isDistanceFieldDirty = true;
+	m_isVisibilityQueryDirty = true;
+	m_isPotentiallyVisibleSetStale = true;
+	m_areParticleHullsDirty = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::AddMissingDriftVelocities()
+{
+	//New polygons pick up a random velocity, the rest keep theirs
+	while (m_geometryVelocities.size() < m_geometry.size())
+	{
+		float angle = g_RNG->GetRandomFloatInRange(0.f, 6.2831853f);
+		float speed = g_RNG->GetRandomFloatInRange(0.f, MAX_DRIFT_SPEED);
+		m_geometryVelocities.push_back(Vec2(cosf(angle), sinf(angle)) * speed);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::StopDriftingGeometryAtImpacts(float driftSeconds)
+{
+	double impactStartTime = GetCurrentTimeSeconds();
+
+	m_timeOfImpactSolver.FindSweptPairs(m_geometry, m_geometryVelocities, driftSeconds, m_broadPhaseChecker, m_sweptPairs, m_jobPool);
+	m_timeOfImpactSolver.ComputeMoveTimes(m_geometry, m_geometryVelocities, driftSeconds, m_sweptPairs, m_pairImpacts, m_driftMoveTimes, m_jobPool);
+
+	//Pairs already overlapping are left to drift apart
+	for (int geometryIndex = 0; geometryIndex < (int)m_geometry.size(); geometryIndex++)
+	{
+		m_driftDisplacements[geometryIndex] = m_geometryVelocities[geometryIndex] * m_driftMoveTimes[geometryIndex];
+	}
+
+	//Equal masses bouncing off each other swap their velocities along the normal
+	for (int pairIndex = 0; pairIndex < (int)m_sweptPairs.size(); pairIndex++)
+	{
+		const TimeOfImpact2D& impact = m_pairImpacts[pairIndex];
+		if (impact.m_state != TOI_HIT)
+			continue;
+
+		Vec2& velocityA = m_geometryVelocities[m_sweptPairs[pairIndex].m_geometryIndexA];
+		Vec2& velocityB = m_geometryVelocities[m_sweptPairs[pairIndex].m_geometryIndexB];
+		Vec2 relativeVelocity = velocityA - velocityB;
+		float closingSpeed = relativeVelocity.x * impact.m_normal.x + relativeVelocity.y * impact.m_normal.y;
+		if (closingSpeed <= 0.f)
+			continue;
+
+		velocityA -= impact.m_normal * closingSpeed;
+		velocityB += impact.m_normal * closingSpeed;
+	}
+
+	m_timeOfImpactTime = GetCurrentTimeSeconds() - impactStartTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateDistanceField()
+{
+	if (!m_useDistanceFieldRaycasts)
+	{
+		//Drop the bake so a scene change while the mode is off can not leave a stale field behind
+		m_distanceField.Clear();
+		m_isDistanceFieldDirty = true;
+		return;
+	}
+
+	if (!m_isDistanceFieldDirty)
+		return;
+
+	double bakeStartTime = GetCurrentTimeSeconds();
+	m_distanceField.Bake(m_sceneQuery, m_worldBounds, DISTANCE_FIELD_CELL_SIZE, m_jobPool);
+	m_distanceFieldBakeTime = GetCurrentTimeSeconds() - bakeStartTime;
+
+	m_isDistanceFieldDirty = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateVisibilityQuery()
+{
+	if (!m_isVisibilityQueryDirty)
+		return;
+
+	m_visibilityQuery.BuildFromGeometry(m_geometry, m_broadPhaseChecker, m_worldBounds);
+	m_isVisibilityQueryDirty = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateVisibilityPolygon()
+{
+	m_visibilityPolygon.clear();
+	if (!ui_showVisibilityPolygon)
+		return;
+
+	UpdateVisibilityQuery();
+
+	double queryStartTime = GetCurrentTimeSeconds();
+	m_visibilityQuery.ComputeVisibilityPolygon(m_gameCursor->GetCursorPositon(), m_visibilityPolygon);
+	m_visibilityQueryTime = GetCurrentTimeSeconds() - queryStartTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::MeasureLineOfSight()
+{
+	//Runs from the UI before the frame's own rebuild, so bring the queries up to date with the scene first
+	UpdateHullStore();
+	UpdateVisibilityQuery();
+
+	std::vector<Vec2> points;
+	points.reserve(LINE_OF_SIGHT_POINT_COUNT);
+	for (int pointIndex = 0; pointIndex < LINE_OF_SIGHT_POINT_COUNT; pointIndex++)
+	{
+		Vec2 point;
+		point.x = g_RNG->GetRandomFloatInRange(m_worldBounds.m_minBounds.x, m_worldBounds.m_maxBounds.x);
+		point.y = g_RNG->GetRandomFloatInRange(m_worldBounds.m_minBounds.y, m_worldBounds.m_maxBounds.y);
+		points.push_back(point);
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+	m_lineOfSightMatrix.Compute(points, m_visibilityQuery, m_pointQuery, m_jobPool);
+	m_lineOfSightTime = GetCurrentTimeSeconds() - startTime;
+
+	m_numVisiblePointPairs = m_lineOfSightMatrix.CountVisiblePairs();
+	m_hasLineOfSightMeasurement = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateNavigation()
+{
+	if (!ui_showNavigationGraph)
+	{
+		m_navigationPath.clear();
+		m_hasNavigationPath = false;
+		return;
+	}
+
+	UpdateVisibilityQuery();
+
+	//A few moved polygons are updated in place and the tail is redone from the first one added or dropped
+	//Drifting moves every polygon and makes each sync a full rebuild, so the graph only catches up every few frames then
+	bool isDrifting = ui_driftGeometry && !m_geometry.empty();
+	m_isNavigationGraphStale = isDrifting && (m_frameIndex % NAV_DRIFT_SYNC_INTERVAL != 0);
+	if (!m_isNavigationGraphStale)
+	{
+		double syncStartTime = GetCurrentTimeSeconds();
+		int syncIndex = m_navigationGraph.SyncWithGeometry(m_geometry, m_worldBounds, m_visibilityQuery, m_pointQuery, m_sceneQuery, m_jobPool);
+		if (syncIndex != -1)
+		{
+			m_navigationSyncTime = GetCurrentTimeSeconds() - syncStartTime;
+			m_lastNavSyncIndex = syncIndex;
+		}
+	}
+
+	if (!ui_showNavigationPath)
+	{
+		m_navigationPath.clear();
+		m_hasNavigationPath = false;
+		return;
+	}
+
+	//The stale graph still has the polygons where they were at the last sync, so nothing is searched in it
+	//The path found at that sync is kept and drawn as stale until the graph catches up
+	if (m_isNavigationGraphStale)
+		return;
+
+	double pathStartTime = GetCurrentTimeSeconds();
+	m_hasNavigationPath = m_navigationGraph.FindPath(m_rayStart, m_rayEnd, m_visibilityQuery, m_pointQuery, m_navigationPath, &m_numExpandedNavNodes);
+	m_navigationPathTime = GetCurrentTimeSeconds() - pathStartTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdatePotentiallyVisibleSet()
+{
+	UpdateHullStore();
+
+	//A set cooked with the scene is kept as long as the polygons are the ones it was baked from
+	if (m_potentiallyVisibleSet.IsBaked() && m_potentiallyVisibleSet.GetSceneSignature() == PotentiallyVisibleSet::ComputeSceneSignature(m_geometry))
+	{
+		m_isPotentiallyVisibleSetStale = false;
+		return;
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+	m_potentiallyVisibleSet.Bake(m_geometry, m_broadPhaseChecker, m_jobPool);
+	m_potentiallyVisibleSetBakeTime = GetCurrentTimeSeconds() - startTime;
+	m_isPotentiallyVisibleSetStale = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int Game::GetRayIndexForTraversalIndex(int traversalIndex) const
+{
+	if (m_useRaySorting)
+	{
+		return m_raySorter.GetOriginalIndex(traversalIndex);
+	}
+
+	return traversalIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateRaySorting()
+{
+	if (!m_useRaySorting || m_areRaysSorted)
+		return;
+
+	double sortStartTime = GetCurrentTimeSeconds();
+	m_raySorter.SortRays(m_rays);
+	m_raySortTime = (float)(GetCurrentTimeSeconds() - sortStartTime);
+
+	m_areRaysSorted = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::MeasureRayOrderCacheMisses()
+{
+	//Replays the traversal through a software cache model for both orders and times the real batch for both
+	UpdateHullStore();
+	m_cacheMissesModelHullStore = m_useSpecializedHullKernels;
+	m_raySorter.SortRays(m_rays);
+	m_areRaysSorted = true;
+
+	bool wasSorting = m_useRaySorting;
+	CacheMissEstimator estimator;
+
+	m_useRaySorting = false;
+	ReplayRaycastTraversal(false, estimator);
+	m_cacheMissesCreationOrder = estimator.GetNumMisses();
+	m_cacheAccessesPerOrder = estimator.GetNumAccesses();
+
+	double startTime = GetCurrentTimeSeconds();
+	RaycastRangeVsConvexHulls(0, (int)m_rays.size(), m_toggleBroadPhaseMode, m_hits);
+	m_raycastTimeCreationOrder = (float)(GetCurrentTimeSeconds() - startTime);
+
+	estimator.Reset();
+	m_useRaySorting = true;
+	ReplayRaycastTraversal(true, estimator);
+	m_cacheMissesSortedOrder = estimator.GetNumMisses();
+
+	startTime = GetCurrentTimeSeconds();
+	RaycastRangeVsConvexHulls(0, (int)m_rays.size(), m_toggleBroadPhaseMode, m_hits);
+	m_raycastTimeSortedOrder = (float)(GetCurrentTimeSeconds() - startTime);
+
+	m_useRaySorting = wasSorting;
+	m_hasCacheMissMeasurement = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Touches what one hull store group's kernel reads for the ray: the bit fields of every hull, and the offset and shared
+//prototype planes of the ones it tests
+static void ReplayHullGroupTraversal(const HullGroup& group, const Ray2D& ray, bool useBroadPhase, CacheMissEstimator& estimator)
+{
+	for (int hullIndex = 0; hullIndex < group.GetNumHulls(); hullIndex++)
+	{
+		const IntVec2& bitFields = group.m_bitFields[hullIndex];
+		if (useBroadPhase)
+		{
+			estimator.Touch(&bitFields, sizeof(IntVec2));
+			if ((ray.m_bitFieldsXY.x & bitFields.x) == 0 || (ray.m_bitFieldsXY.y & bitFields.y) == 0)
+				continue;
+		}
+
+		estimator.Touch(&group.m_prototypeSlots[hullIndex], sizeof(int));
+		estimator.Touch(&group.m_offsetX[hullIndex], sizeof(float));
+		estimator.Touch(&group.m_offsetY[hullIndex], sizeof(float));
+
+		int prototypeSlot = group.m_prototypeSlots[hullIndex];
+		if (group.m_numPlanes == 0)
+		{
+			estimator.Touch(&group.m_planeOffsets[prototypeSlot], 2 * sizeof(int));
+		}
+
+		int planeStart = group.GetPlaneStart(prototypeSlot);
+		int numBytes = (group.GetPlaneEnd(prototypeSlot) - planeStart) * (int)sizeof(float);
+		estimator.Touch(&group.m_normalX[planeStart], numBytes);
+		estimator.Touch(&group.m_normalY[planeStart], numBytes);
+		estimator.Touch(&group.m_distance[planeStart], numBytes);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ReplayRaycastTraversal(bool useSortedOrder, CacheMissEstimator& estimator) const
+{
+	//Touches the same memory RaycastRangeVsConvexHulls reads: the hull store's SoA groups when the specialized kernels are on,
+	//otherwise each geometry's bit fields and the planes of tested hulls. The distance field skip is not modelled
+	const std::vector<Ray2D>& rays = useSortedOrder ? m_raySorter.GetSortedRays() : m_rays;
+
+	for (int traversalIndex = 0; traversalIndex < rays.size(); traversalIndex++)
+	{
+		const Ray2D& ray = rays[traversalIndex];
+		estimator.Touch(&ray, sizeof(Ray2D));
+
+		if (m_useSpecializedHullKernels)
+		{
+			for (int numPlanes = MIN_SPECIALIZED_PLANE_COUNT; numPlanes <= MAX_SPECIALIZED_PLANE_COUNT; numPlanes++)
+			{
+				ReplayHullGroupTraversal(m_hullStore.GetSpecializedGroup(numPlanes), ray, m_toggleBroadPhaseMode, estimator);
+			}
+			ReplayHullGroupTraversal(m_hullStore.GetGenericGroup(), ray, m_toggleBroadPhaseMode, estimator);
+
+			//The binary searches of a large hull are counted as reading its sorted angles and edges once
+			const std::vector<LargeHull>& largeHulls = m_hullStore.GetLargeHulls();
+			for (int hullIndex = 0; hullIndex < (int)largeHulls.size(); hullIndex++)
+			{
+				const LargeHull& largeHull = largeHulls[hullIndex];
+				estimator.Touch(&largeHull, sizeof(LargeHull));
+				if (m_toggleBroadPhaseMode && ((ray.m_bitFieldsXY.x & largeHull.m_bitFields.x) == 0 || (ray.m_bitFieldsXY.y & largeHull.m_bitFields.y) == 0))
+					continue;
+
+				estimator.Touch(largeHull.m_normalAngles.data(), largeHull.m_normalAngles.size() * sizeof(float));
+				estimator.Touch(largeHull.m_vertices.data(), largeHull.m_vertices.size() * sizeof(Vec2));
+			}
+			continue;
+		}
+
+		for (int hullIndex = 0; hullIndex < m_geometry.size(); hullIndex++)
+		{
+			const Geometry& geometry = m_geometry[hullIndex];
+			if (m_toggleBroadPhaseMode)
+			{
+				estimator.Touch(&geometry.GetBitFields(), sizeof(IntVec2));
+
+				bool xOverlapCondition = (ray.m_bitFieldsXY.x & geometry.GetBitFields().x) != 0;
+				bool yOverlapCondition = (ray.m_bitFieldsXY.y & geometry.GetBitFields().y) != 0;
+
+				if (!xOverlapCondition || !yOverlapCondition)
+					continue;
+			}
+
+			const std::vector<Plane2D>& planes = geometry.GetConvexHull2D().GetPlanes();
+			estimator.Touch(&geometry.GetConvexHull2D(), sizeof(ConvexHull2D));
+			estimator.Touch(planes.data(), planes.size() * sizeof(Plane2D));
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CheckRenderRayVsConvexHulls()
+{
+	float bestHit = 9999;
+
+	//Check the render ray vs all the convex hulls in the scene
+	for (int hullIndex = 0; hullIndex < m_geometry.size(); hullIndex++)
+	{
+		int numPossibleHits = m_geometry[hullIndex].GetConvexHull2D().GetNumPlanes();
+		RayHit2D* out = new RayHit2D[numPossibleHits];
+		
+		uint hits = Raycast(out, m_renderedRay, m_geometry[hullIndex].GetConvexHull2D(), 0.f);
+
+		if (hits > 0 && IsPointOnLineSegment2D(out->m_hitPoint, m_rayStart, m_rayEnd) && out->m_timeAtHit < bestHit)
+		{
+			m_isHitting = true;
+			//DebuggerPrintf("\n Ray hit convexHull");
+			bestHit = out->m_timeAtHit;
+			m_drawRayStart = m_rayStart;
+			m_drawRayEnd = out->m_hitPoint;
+			m_drawSurfanceNormal = out->m_impactNormal;
+		}
+		else if(hits == 0 && bestHit == 9999)
+		{
+			m_isHitting = false;
+			m_drawRayStart = m_rayStart;
+			m_drawRayEnd = m_rayStart;
+			m_drawSurfanceNormal = Vec2::ZERO;
+		}
+
+		delete out;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CheckRenderShapeCastVsConvexHulls()
+{
+	if (m_renderCastShape == RENDER_CAST_RAY)
+		return;
+
+	//Sweep the shape from the start handle to the end handle
+	Vec2 direction = m_renderedRay.m_direction;
+	float sweepLength = (m_rayEnd - m_rayStart).GetLength();
+
+	if (m_renderCastShape == RENDER_CAST_DISC)
+	{
+		m_renderShapeCast = ShapeCast2D::MakeDiscCast(m_rayStart, ui_shapeCastRadius, direction, sweepLength);
+	}
+	else
+	{
+		//Capsule lies across the sweep, the way an agent's body would
+		Vec2 halfSegment = 2.f * ui_shapeCastRadius * Vec2(-direction.y, direction.x);
+		m_renderShapeCast = ShapeCast2D::MakeCapsuleCast(m_rayStart - halfSegment, m_rayStart + halfSegment, ui_shapeCastRadius, direction, sweepLength);
+	}
+
+	const ShapeCast2D& cast = m_renderShapeCast;
+	m_renderShapeCast.m_bitFieldsXY = m_broadPhaseChecker.GetRegionForSweptCapsule(cast.m_segmentStart, cast.m_segmentEnd, cast.m_radius, cast.m_maxDistance * cast.m_direction);
+
+	m_isShapeCastHitting = (m_shapeCaster.CastShape(m_renderShapeCastHit, m_renderShapeCast, m_toggleBroadPhaseMode) >= 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::TraceRenderRayReflections()
+{
+	m_renderRayBounceSegments.clear();
+	if (!ui_showRayReflections || m_renderCastShape != RENDER_CAST_RAY)
+		return;
+
+	Ray2D renderRay = m_renderedRay;
+	renderRay.m_bitFieldsXY = m_broadPhaseChecker.GetRegionForRay(renderRay);
+
+	std::vector<Ray2D> primaryRays = { renderRay };
+	m_reflectionTracer.TracePaths(primaryRays, ui_numReflectionBounces, m_hullStore, m_broadPhaseChecker, m_worldBounds, m_renderRayBounceSegments);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::MeasureReflectionStream()
+{
+	//Runs from the UI before the frame's own rebuild, so bring the hull store up to date with the scene first
+	UpdateHullStore();
+
+	std::vector<BounceSegment> segments;
+
+	double startTime = GetCurrentTimeSeconds();
+	m_reflectionTracer.TracePaths(m_rays, ui_numReflectionBounces, m_hullStore, m_broadPhaseChecker, m_worldBounds, segments, m_jobPool);
+	m_reflectionTraceTime = GetCurrentTimeSeconds() - startTime;
+
+	m_numReflectionSegments = (int)segments.size();
+	m_hasReflectionMeasurement = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateRenderRayIntervals()
+{
+	m_numRenderRayIntervals = 0;
+	if (!ui_showRayIntervals || m_renderCastShape != RENDER_CAST_RAY)
+		return;
+
+	//Only the stretch between the two handles is drawn, so that is all that gets reported
+	float rayLength = (m_rayEnd - m_rayStart).GetLength();
+	m_numRenderRayIntervals = m_sceneQuery.RaycastAll(m_renderedRay, m_renderRayIntervals, MAX_RAY_INTERVALS, rayLength);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::MeasureAllIntersections()
+{
+	//Runs from the UI before the frame's own rebuild, so bring the scene query up to date with the scene first
+	UpdateHullStore();
+
+	int numRays = (int)m_rays.size();
+	std::vector<RayInterval2D> intervals((size_t)numRays * MAX_RAY_INTERVALS);
+	std::vector<int> numIntervalsPerRay(numRays, 0);
+
+	auto queryRange = [this, &intervals, &numIntervalsPerRay](int startIndex, int endIndex)
+	{
+		for (int rayIndex = startIndex; rayIndex < endIndex; rayIndex++)
+		{
+			numIntervalsPerRay[rayIndex] = m_sceneQuery.RaycastAll(m_rays[rayIndex], &intervals[(size_t)rayIndex * MAX_RAY_INTERVALS], MAX_RAY_INTERVALS);
+		}
+	};
+
+	double startTime = GetCurrentTimeSeconds();
+	m_jobPool->ParallelFor(numRays, RAYCAST_BATCH_GRAIN_SIZE, queryRange);
+	m_intervalQueryTime = GetCurrentTimeSeconds() - startTime;
+
+	m_numMeasuredIntervals = 0;
+	for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
+	{
+		m_numMeasuredIntervals += numIntervalsPerRay[rayIndex];
+	}
+
+	m_hasIntervalMeasurement = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static Vec2 ParseColliderVec2(const tinyxml2::XMLElement* collider, const char* attributeName)
+{
+	const char* text = collider->Attribute(attributeName);
+	if (text == nullptr)
+		return Vec2::ZERO;
+
+	//Written as "x,y"
+	char* afterX = nullptr;
+	float x = strtof(text, &afterX);
+	float y = (*afterX == ',') ? strtof(afterX + 1, nullptr) : 0.f;
+	return Vec2(x, y);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::LoadMixedPrimitives()
+{
+	const char* saveFilePath = "Data/Gameplay/SaveGame.xml";
+
+	tinyxml2::XMLDocument saveFile;
+	saveFile.LoadFile(saveFilePath);
+	if (saveFile.ErrorID() != tinyxml2::XML_SUCCESS)
+	{
+		g_devConsole->PrintString(g_devConsole->CONSOLE_ECHO_COLOR, Stringf("FAILED to load file %s\n", saveFilePath));
+		return;
+	}
+
+	m_primitiveStore.Clear();
+
+	//Shape 2 is a capsule, a disc when both ends match, and shape 3 a box. The owner index is the collider's place in the file
+	int colliderIndex = 0;
+	for (const tinyxml2::XMLElement* geometryData = saveFile.RootElement()->FirstChildElement("GeometryData"); geometryData != nullptr; geometryData = geometryData->NextSiblingElement("GeometryData"))
+	{
+		const tinyxml2::XMLElement* rigidBody = geometryData->FirstChildElement("RigidBody");
+		const tinyxml2::XMLElement* collider = geometryData->FirstChildElement("Collider");
+		if (rigidBody == nullptr || collider == nullptr)
+			continue;
+
+		int shape = rigidBody->IntAttribute("Shape");
+		if (shape == 2)
+		{
+			Vec2 start = ParseColliderVec2(collider, "Start");
+			Vec2 end = ParseColliderVec2(collider, "End");
+			float radius = collider->FloatAttribute("Radius");
+
+			if (start == end)
+			{
+				m_primitiveStore.AddDisc(start, radius, colliderIndex);
+			}
+			else
+			{
+				m_primitiveStore.AddCapsule(start, end, radius, colliderIndex);
+			}
 		}
-		break;
-		case NUM_7:
-		break;
-		case NUM_8:
-		break;
-		case NUM_9:
-		break;
-		case N_KEY:
-		break;
-		case M_KEY:
-		break;
-		case KEY_LESSER:
-		break;
-		case KEY_GREATER:
-		break;
-		case F1_KEY:
-		break;
-		case F2_KEY:
-		break;
-		case F3_KEY:
-		break;
-		case F4_KEY:
-		break;
-		case F5_KEY:
-		break;
-		case F6_KEY:
-		break;
-		case F7_KEY:
-		break;
-		default:
-		break;
+		else if (shape == 3)
+		{
+			Vec2 center = ParseColliderVec2(collider, "Center");
+			Vec2 size = ParseColliderVec2(collider, "Size");
+			m_primitiveStore.AddOBB(center, size * 0.5f, collider->FloatAttribute("Rotation"), colliderIndex);
+		}
+
+		colliderIndex++;
 	}
+
+	m_hasMixedPrimitives = true;
+	m_hasMixedPrimitiveMeasurement = false;
+	AddSceneHullsToPrimitiveStore();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::DebugEnabled()
+void Game::AddSceneHullsToPrimitiveStore()
 {
-	g_debugMode = !g_debugMode;
+	//The loaded colliders stay, only the hulls follow the scene
+	m_primitiveStore.RemovePrimitives(PRIMITIVE_HULL);
+	for (int geometryIndex = 0; geometryIndex < (int)m_geometry.size(); geometryIndex++)
+	{
+		m_primitiveStore.AddHull(m_geometry[geometryIndex], geometryIndex);
+	}
+
+	m_primitiveStore.BuildBuckets(m_broadPhaseChecker);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::HandleKeyReleased(unsigned char keyCode)
+void Game::MeasureMixedPrimitiveRaycasts()
 {
+	//Runs from the UI before the frame's own rebuild, so bring the hulls up to date with the scene first
+	UpdateHullStore();
 
-	switch( keyCode )
+	int numRays = (int)m_rays.size();
+	std::vector<uint8_t> didHit(numRays, 0);
+
+	auto raycastRange = [this, &didHit](int startIndex, int endIndex)
 	{
-		case UP_ARROW:
-		case DOWN_ARROW:
-		case RIGHT_ARROW:
-		case LEFT_ARROW:
-		break;
-		default:
-		break;
+		PrimitiveHit2D hit;
+		for (int rayIndex = startIndex; rayIndex < endIndex; rayIndex++)
+		{
+			didHit[rayIndex] = m_primitiveStore.RaycastClosest(hit, m_rays[rayIndex]) ? 1 : 0;
+		}
+	};
+
+	double startTime = GetCurrentTimeSeconds();
+	m_jobPool->ParallelFor(numRays, RAYCAST_BATCH_GRAIN_SIZE, raycastRange);
+	m_mixedPrimitiveRaycastTime = GetCurrentTimeSeconds() - startTime;
+
+	m_numMixedPrimitiveHits = 0;
+	for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
+	{
+		m_numMixedPrimitiveHits += didHit[rayIndex];
 	}
+
+	m_hasMixedPrimitiveMeasurement = true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::HandleCharacter(unsigned char charCode)
+void Game::AssignGeometryPrototypes(int firstGeometryIndex)
 {
-	if (g_devConsole->IsOpen())
+	//Shapes are hashed as the scene is made or loaded, so every polygon knows its shared prototype before any instances
+	//are asked for. Polygons from firstGeometryIndex on are new, a scene made again from the start drops the old shapes
+	if (firstGeometryIndex == 0)
 	{
-		g_devConsole->HandleCharacter(charCode);
+		m_geometryInstances.Clear();
+	}
+
+	std::vector<Vec2> scratchLocalPoints;
+	for (int geometryIndex = firstGeometryIndex; geometryIndex < (int)m_geometry.size(); geometryIndex++)
+	{
+		Geometry& geometry = m_geometry[geometryIndex];
+		const std::vector<Vec2>& points = geometry.GetConvexPoly2D().GetConvexPoly2DPoints();
+		if (points.size() < 3)
+		{
+			geometry.SetPrototype(-1, Vec2::ZERO);
+			continue;
+		}
+
+		Vec2 prototypeOffset;
+		int prototypeIndex = m_geometryInstances.FindOrAddPrototypeOfPolygon(points, prototypeOffset, scratchLocalPoints);
+		geometry.SetPrototype(prototypeIndex, prototypeOffset);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::BuildGeometryInstances()
+{
+	//The prototypes were shared out when the scene was made or loaded, each polygon only places an instance of its own
+	//at its prototype offset
+	m_geometryInstances.ClearInstances();
+	m_instanceIndexForGeometry.assign(m_geometry.size(), -1);
+
+	for (int geometryIndex = 0; geometryIndex < (int)m_geometry.size(); geometryIndex++)
+	{
+		const Geometry& geometry = m_geometry[geometryIndex];
+		if (geometry.GetPrototypeIndex() < 0)
+			continue;
+
+		InstanceTransform2D transform;
+		transform.m_position = geometry.GetPrototypeOffset();
+		m_instanceIndexForGeometry[geometryIndex] = m_geometryInstances.AddInstance(geometry.GetPrototypeIndex(), transform, m_broadPhaseChecker);
+	}
+
+	m_hasGeometryInstances = true;
+	m_hasInstancedRaycastMeasurement = false;
+	m_hasHullRebuildMeasurement = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RefitMovedGeometryInstances(const std::vector<int>& movedGeometryIndices)
+{
+	//Instances follow their polygon's prototype offset and keep their own rotation and scale
+	for (int movedIndex = 0; movedIndex < (int)movedGeometryIndices.size(); movedIndex++)
+	{
+		int geometryIndex = movedGeometryIndices[movedIndex];
+		if (geometryIndex >= (int)m_instanceIndexForGeometry.size() || m_instanceIndexForGeometry[geometryIndex] < 0)
+			continue;
+
+		int instanceIndex = m_instanceIndexForGeometry[geometryIndex];
+		InstanceTransform2D transform = m_geometryInstances.GetInstance(instanceIndex).m_transform;
+		transform.m_position = m_geometry[geometryIndex].GetPrototypeOffset();
+		m_geometryInstances.SetInstanceTransform(instanceIndex, transform, m_broadPhaseChecker);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::MeasureHullRebuild()
+{
+	//What moving the polygons costs without instances, every hull made again from its polygon, for comparison with the refit
+	//Done on a scratch copy so the scene hulls are left alone
+	std::vector<Geometry> rebuiltGeometry = m_geometry;
+	double rebuildStartTime = GetCurrentTimeSeconds();
+	for (int geometryIndex = 0; geometryIndex < (int)rebuiltGeometry.size(); geometryIndex++)
+	{
+		rebuiltGeometry[geometryIndex].MakeHullFromOwningPolygon();
+	}
+	m_hullRebuildTime = GetCurrentTimeSeconds() - rebuildStartTime;
+
+	m_hasHullRebuildMeasurement = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::SpawnParticles(int numParticles)
+{
+	m_particleCollider.ClearParticles();
+
+	//Spread over the top half of the world so they fall onto the hulls
+	Vec2 spawnMins = Vec2(m_worldBounds.m_minBounds.x, (m_worldBounds.m_minBounds.y + m_worldBounds.m_maxBounds.y) * 0.5f);
+	for (int particleIndex = 0; particleIndex < numParticles; particleIndex++)
+	{
+		Vec2 position;
+		position.x = g_RNG->GetRandomFloatInRange(spawnMins.x, m_worldBounds.m_maxBounds.x);
+		position.y = g_RNG->GetRandomFloatInRange(spawnMins.y, m_worldBounds.m_maxBounds.y);
+
+		Vec2 velocity;
+		velocity.x = g_RNG->GetRandomFloatInRange(-10.f, 10.f);
+		velocity.y = g_RNG->GetRandomFloatInRange(-10.f, 10.f);
+		m_particleCollider.AddParticle(position, velocity);
+	}
+
+	m_areParticleHullsDirty = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateParticles(float deltaTime)
+{
+	if (!ui_simulateParticles || m_particleCollider.GetNumParticles() == 0)
 		return;
+
+	if (m_areParticleHullsDirty)
+	{
+		m_particleCollider.BuildStaticHulls(m_geometry, m_broadPhaseChecker, m_worldBounds);
+		m_areParticleHullsDirty = false;
 	}
+
+	double stepStartTime = GetCurrentTimeSeconds();
+	m_numParticleContacts = m_particleCollider.Step(deltaTime, m_jobPool);
+	m_particleStepTime = GetCurrentTimeSeconds() - stepStartTime;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-bool Game::HandleMouseLBDown()
+void Game::UpdateGeometryInstances(float deltaTime)
 {
-	m_canMoveStart = true;
-	m_mouseStart = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
-	m_renderedRay.m_start = m_mouseStart;
-	return true;
+	if (!m_hasGeometryInstances || !ui_spinGeometryInstances)
+		return;
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int instanceIndex = 0; instanceIndex < m_geometryInstances.GetNumInstances(); instanceIndex++)
+	{
+		InstanceTransform2D transform = m_geometryInstances.GetInstance(instanceIndex).m_transform;
+		float spinDirection = (instanceIndex % 2 == 0) ? 1.f : -1.f;
+		transform.m_rotationDegrees += spinDirection * INSTANCE_SPIN_DEGREES_PER_SECOND * deltaTime;
+
+		m_geometryInstances.SetInstanceTransform(instanceIndex, transform, m_broadPhaseChecker);
+	}
+	m_instanceRefitTime = GetCurrentTimeSeconds() - startTime;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-bool Game::HandleMouseLBUp()
+void Game::MeasureInstancedRaycasts()
 {
-	m_canMoveStart = false;
-	m_mouseStart = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
-	m_renderedRay.m_start = m_mouseStart;
-	return true;
+	int numRays = (int)m_rays.size();
+	std::vector<uint8_t> didHit(numRays, 0);
+
+	auto raycastRange = [this, &didHit](int startIndex, int endIndex)
+	{
+		RayHit2D hit;
+		for (int rayIndex = startIndex; rayIndex < endIndex; rayIndex++)
+		{
+			didHit[rayIndex] = (m_geometryInstances.RaycastClosest(hit, m_rays[rayIndex]) >= 0) ? 1 : 0;
+		}
+	};
+
+	double startTime = GetCurrentTimeSeconds();
+	m_jobPool->ParallelFor(numRays, RAYCAST_BATCH_GRAIN_SIZE, raycastRange);
+	m_instancedRaycastTime = GetCurrentTimeSeconds() - startTime;
+
+	m_numInstancedRaycastHits = 0;
+	for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
+	{
+		m_numInstancedRaycastHits += didHit[rayIndex];
+	}
+
+	m_hasInstancedRaycastMeasurement = true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-bool Game::HandleMouseRBDown()
+void Game::MeasureBatchedDiscCasts()
 {
-	m_canMoveEnd = true;
-	m_mouseEnd = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
-	m_rayEnd = m_mouseEnd;
-	return true;
+	//Replaces each batch ray with a disc swept across the world, the way agent movement would use it
+	float maxDistance = (m_worldBounds.m_maxBounds - m_worldBounds.m_minBounds).GetLength();
+
+	std::vector<ShapeCast2D> casts;
+	casts.reserve(m_rays.size());
+	for (int rayIndex = 0; rayIndex < m_rays.size(); rayIndex++)
+	{
+		ShapeCast2D cast = ShapeCast2D::MakeDiscCast(m_rays[rayIndex].m_start, ui_shapeCastRadius, m_rays[rayIndex].m_direction, maxDistance);
+		cast.m_bitFieldsXY = m_broadPhaseChecker.GetRegionForSweptCapsule(cast.m_segmentStart, cast.m_segmentEnd, cast.m_radius, maxDistance * cast.m_direction);
+		casts.push_back(cast);
+	}
+
+	std::vector<ShapeCastHit2D> hits;
+
+	double startTime = GetCurrentTimeSeconds();
+	m_shapeCaster.CastShapes(casts, hits, m_toggleBroadPhaseMode, m_jobPool);
+	m_shapeCastBatchTime = (float)(GetCurrentTimeSeconds() - startTime);
+
+	m_numShapeCastsMeasured = (int)casts.size();
+	m_numShapeCastHitsMeasured = 0;
+	for (int castIndex = 0; castIndex < hits.size(); castIndex++)
+	{
+		if (hits[castIndex].m_geometryIndex >= 0)
+		{
+			m_numShapeCastHitsMeasured++;
+		}
+	}
+
+	m_hasShapeCastMeasurement = true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-bool Game::HandleMouseRBUp()
+void Game::MeasureOccupancySampling()
 {
-	m_canMoveEnd = false;
-	m_mouseEnd = GetClientToWorldPosition2D(g_windowContext->GetClientMousePosition(), g_windowContext->GetClientBounds());
-	m_rayEnd = m_mouseEnd;
-	return true;
+	//Uniform samples over the world, only the batched query itself is timed
+	std::vector<Vec2> points;
+	points.reserve(OCCUPANCY_SAMPLE_COUNT);
+	for (int pointIndex = 0; pointIndex < OCCUPANCY_SAMPLE_COUNT; pointIndex++)
+	{
+		Vec2 point;
+		point.x = g_RNG->GetRandomFloatInRange(m_worldBounds.m_minBounds.x, m_worldBounds.m_maxBounds.x);
+		point.y = g_RNG->GetRandomFloatInRange(m_worldBounds.m_minBounds.y, m_worldBounds.m_maxBounds.y);
+		points.push_back(point);
+	}
+
+	std::vector<int> geometryIndices;
+
+	double startTime = GetCurrentTimeSeconds();
+	m_pointQuery.QueryPoints(points, geometryIndices, m_jobPool);
+	m_occupancySampleTime = (float)(GetCurrentTimeSeconds() - startTime);
+
+	int numOccupied = 0;
+	for (int pointIndex = 0; pointIndex < geometryIndices.size(); pointIndex++)
+	{
+		if (geometryIndices[pointIndex] >= 0)
+		{
+			numOccupied++;
+		}
+	}
+
+	m_occupiedFraction = (float)numOccupied / (float)OCCUPANCY_SAMPLE_COUNT;
+	m_hasOccupancyMeasurement = true;
 }
 
-/*
 //------------------------------------------------------------------------------------------------------------------------------
-bool Game::HandleMouseScroll(float wheelDelta)
+void Game::UpdateRegionSelection()
 {
-	m_zoomLevel += wheelDelta;
-	m_zoomLevel = Clamp(m_zoomLevel, 0.00001f, MAX_ZOOM_STEPS);
+	m_numGeometryInView = m_sceneQuery.CountAABB(AABB2(m_mainCamera->GetOrthoBottomLeft(), m_mainCamera->GetOrthoTopRight()));
 
-	//Recalculate mins and maxes based on the zoom level
-	float newMinX = 0.f + m_zoomLevel * SCREEN_ASPECT;
-	float newMinY = 0.f + m_zoomLevel;
+	m_isGeometrySelected.assign(m_geometry.size(), false);
+	m_selectedGeometry.resize(m_geometry.size());
 
-	float newMaxX = WORLD_WIDTH - m_zoomLevel * SCREEN_ASPECT;
-	float newMaxY = WORLD_HEIGHT - m_zoomLevel;
+	int numSelected = 0;
+	if (m_regionSelectShape == REGION_SELECT_BOX)
+	{
+		Vec2 boxMins = Vec2(GetLowerValue(m_rayStart.x, m_rayEnd.x), GetLowerValue(m_rayStart.y, m_rayEnd.y));
+		Vec2 boxMaxs = Vec2(GetHigherValue(m_rayStart.x, m_rayEnd.x), GetHigherValue(m_rayStart.y, m_rayEnd.y));
+		numSelected = m_sceneQuery.QueryAABB(AABB2(boxMins, boxMaxs), m_selectedGeometry.data(), (int)m_selectedGeometry.size());
+	}
+	else if (m_regionSelectShape == REGION_SELECT_DISC)
+	{
+		float radius = (m_rayEnd - m_rayStart).GetLength();
+		numSelected = m_sceneQuery.QueryDisc(m_rayStart, radius, m_selectedGeometry.data(), (int)m_selectedGeometry.size());
+	}
 
-	m_mainCamera->SetOrthoView(Vec2(newMinX, newMinY), Vec2(newMaxX, newMaxY));
+	if (numSelected > m_selectedGeometry.size())
+	{
+		numSelected = (int)m_selectedGeometry.size();
+	}
+	m_selectedGeometry.resize(numSelected);
 
-	return true;
+	for (int selectedIndex = 0; selectedIndex < numSelected; selectedIndex++)
+	{
+		m_isGeometrySelected[m_selectedGeometry[selectedIndex]] = true;
+	}
 }
-*/
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::Render() const
+void Game::CheckAllRayCastsVsConvexHulls()
 {
-	//Get the ColorTargetView from rendercontext
-	ColorTargetView *colorTargetView = g_renderContext->GetFrameColorTarget();
+	double totalStartTime = GetCurrentTimeSeconds();
 
-	//Setup what we are rendering to
-	m_mainCamera->SetColorTarget(colorTargetView);
-	m_devConsoleCamera->SetColorTarget(colorTargetView);
-	m_mainCamera->SetViewport(Vec2::ZERO, Vec2::ONE);
+	gProfiler->ProfilerPush("Ray vs Convex");
 
-	g_renderContext->BeginCamera(*m_mainCamera);
+	RaycastRangeVsConvexHulls(0, (int)m_rays.size(), false, m_hits);
 
-	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
-		
-	g_renderContext->ClearColorTargets(Rgba(ui_cameraClearColor[0], ui_cameraClearColor[1], ui_cameraClearColor[2], 1.f));
+	double totalEndTime = GetCurrentTimeSeconds();
+	m_cachedRaycastTime = (float)(totalEndTime - totalStartTime);
+	DebuggerPrintf("\n Total Time for Raycasts this frame: %f", m_cachedRaycastTime);
 
-	g_renderContext->BindShader( m_shader );
+	gProfiler->ProfilerPop();
+}
 
-	RenderAllGeometry();
-	RenderRaycast();
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::KickPipelinedRaycasts()
+{
+	if (m_raycastBatchMode != RAYCAST_BATCH_PIPELINED)
+		return;
 
-	RenderWorldBounds();
+	//Update is done with the rays and geometry for this frame, nothing touches them until the batch is committed
+	m_pipelinedHits.resize(m_rays.size());
+	m_isPipelinedBatchInFlight = true;
 
-	//RenderPersistantUI();
+	bool useBroadPhase = m_toggleBroadPhaseMode;
+	m_jobPool->KickAsync([this, useBroadPhase]()
+	{
+		double totalStartTime = GetCurrentTimeSeconds();
 
-	if(m_toggleUI)
+		m_jobPool->ParallelFor((int)m_rays.size(), RAYCAST_BATCH_GRAIN_SIZE, [this, useBroadPhase](int startIndex, int endIndex)
+		{
+			RaycastRangeVsConvexHulls(startIndex, endIndex, useBroadPhase, m_pipelinedHits);
+		});
+
+		double totalEndTime = GetCurrentTimeSeconds();
+		m_pipelinedRaycastTime = (float)(totalEndTime - totalStartTime);
+	});
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::CommitPipelinedRaycasts()
+{
+	if (!m_isPipelinedBatchInFlight)
+		return;
+
+	m_jobPool->WaitForAsync();
+	m_isPipelinedBatchInFlight = false;
+
+	//Swap so the next frame renders these results while the old buffer gets reused for the next batch
+	m_hits.swap(m_pipelinedHits);
+	m_cachedRaycastTime = m_pipelinedRaycastTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderRaycast() const
+{
+	if (m_renderCastShape != RENDER_CAST_RAY)
+		return;
+
+	std::vector<Vertex_PCU> rayVerts;
+
+	AddVertsForArrow2D(rayVerts, m_rayStart, m_rayEnd, 0.5f, Rgba::DIM_TRANSLUCENT_GREY);
+	//Draw the surface normal, the reflected path draws its own when it is on
+	if (m_isHitting && !ui_showRayReflections)
 	{
-		//RenderOnScreenInfo();
+		Vec2 endAlongNormal = m_drawRayEnd + m_surfaceNormalLength * m_drawSurfanceNormal;
+		AddVertsForArrow2D(rayVerts, m_drawRayEnd, endAlongNormal, 0.5f, Rgba::ORGANIC_BLUE);
+
+		AddVertsForArrow2D(rayVerts, m_drawRayStart, m_drawRayEnd, 0.5f, Rgba::ORGANIC_ORANGE);
 	}
 
-	g_ImGUI->Render();
+	g_renderContext->DrawVertexArray(rayVerts);
+}
 
-	m_gameCursor->Render();
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderShapeCast() const
+{
+	if (m_renderCastShape == RENDER_CAST_RAY)
+		return;
 
-	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
+	std::vector<Vertex_PCU> castVerts;
+
+	const ShapeCast2D& cast = m_renderShapeCast;
+	AddVertsForArrow2D(castVerts, m_rayStart, m_rayEnd, 0.5f, Rgba::DIM_TRANSLUCENT_GREY);
+
+	//Shape at the start of the sweep
+	AddVertsForRing2D(castVerts, cast.m_segmentStart, cast.m_radius, 0.25f, Rgba::DIM_TRANSLUCENT_GREY);
+	if (!cast.IsDisc())
+	{
+		AddVertsForRing2D(castVerts, cast.m_segmentEnd, cast.m_radius, 0.25f, Rgba::DIM_TRANSLUCENT_GREY);
+		AddVertsForLine2D(castVerts, cast.m_segmentStart, cast.m_segmentEnd, 0.25f, Rgba::DIM_TRANSLUCENT_GREY);
+	}
+
+	//Shape where it first touches the geometry and the contact normal
+	if (m_isShapeCastHitting)
+	{
+		Vec2 displacement = m_renderShapeCastHit.m_timeAtHit * cast.m_direction;
+
+		AddVertsForRing2D(castVerts, cast.m_segmentStart + displacement, cast.m_radius, 0.25f, Rgba::ORGANIC_ORANGE);
+		if (!cast.IsDisc())
+		{
+			AddVertsForRing2D(castVerts, cast.m_segmentEnd + displacement, cast.m_radius, 0.25f, Rgba::ORGANIC_ORANGE);
+			AddVertsForLine2D(castVerts, cast.m_segmentStart + displacement, cast.m_segmentEnd + displacement, 0.25f, Rgba::ORGANIC_ORANGE);
+		}
 
-	g_renderContext->EndCamera();
+		Vec2 endAlongNormal = m_renderShapeCastHit.m_contactPoint + m_surfaceNormalLength * m_renderShapeCastHit.m_impactNormal;
+		AddVertsForArrow2D(castVerts, m_renderShapeCastHit.m_contactPoint, endAlongNormal, 0.5f, Rgba::ORGANIC_BLUE);
+	}
 
+	g_renderContext->DrawVertexArray(castVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderWorldBounds() const
+void Game::RenderRayReflections() const
 {
-	std::vector<Vertex_PCU> boxVerts;
-	AddVertsForBoundingBox(boxVerts, m_worldBounds, Rgba::DARK_GREY, 2.f);
-	
-	g_renderContext->DrawVertexArray(boxVerts);
-}
+	if (m_renderRayBounceSegments.empty())
+		return;
 
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderOnScreenInfo() const
-{
-	
-}
+	std::vector<Vertex_PCU> reflectionVerts;
 
-//------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderPersistantUI() const
-{
-	
+	for (int segmentIndex = 0; segmentIndex < (int)m_renderRayBounceSegments.size(); segmentIndex++)
+	{
+		const BounceSegment& segment = m_renderRayBounceSegments[segmentIndex];
+		AddVertsForArrow2D(reflectionVerts, segment.m_start, segment.m_end, 0.5f, Rgba::ORGANIC_ORANGE);
+
+		if (segment.m_impactNormal != Vec2::ZERO)
+		{
+			AddVertsForArrow2D(reflectionVerts, segment.m_end, segment.m_end + m_surfaceNormalLength * segment.m_impactNormal, 0.5f, Rgba::ORGANIC_BLUE);
+		}
+	}
+
+	g_renderContext->DrawVertexArray(reflectionVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderAllGeometry() const
+void Game::RenderRayIntervals() const
 {
-	//Render all the geometry in the scene
-	std::vector<Vertex_PCU> convexPolyVerts;
+	if (m_numRenderRayIntervals == 0)
+		return;
 
-	for (int polygonIndex = 0; polygonIndex < m_geometry.size(); polygonIndex++)
+	std::vector<Vertex_PCU> intervalVerts;
+
+	for (int intervalIndex = 0; intervalIndex < m_numRenderRayIntervals; intervalIndex++)
 	{
-		AddVertsForSolidConvexPoly2D(convexPolyVerts, m_geometry[polygonIndex].GetConvexPoly2D(), Rgba(ui_polygonColor[0], ui_polygonColor[1], ui_polygonColor[2], 1.f));
+		const RayInterval2D& interval = m_renderRayIntervals[intervalIndex];
+		Vec2 enterPoint = m_renderedRay.GetPointAtTime(interval.m_timeEnter);
+		Vec2 exitPoint = m_renderedRay.GetPointAtTime(interval.m_timeExit);
+
+		AddVertsForLine2D(intervalVerts, enterPoint, exitPoint, 1.f, Rgba::ORGANIC_RED);
 	}
 
-	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
-	g_renderContext->DrawVertexArray(convexPolyVerts);
+	g_renderContext->DrawVertexArray(intervalVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::DebugRenderTestRandomPointsOnScreen() const
+void Game::RenderParticles() const
 {
-	//Debugging if the RandomPointsOnCircleAreCorrect
-	float angleUsed;
-	Vec2 randomPoint = GetRandomPointOnDisc2D(Vec2(50.f, 50.f), 50.f, 0.f, 360.f, angleUsed);
-	g_debugRenderer->DebugRenderPoint2D(randomPoint, 1.f, 5.f);
+	int numParticles = m_particleCollider.GetNumParticles();
+	if (numParticles == 0)
+		return;
 
-	g_debugRenderer->DebugRenderDisc2D(Disc2D(Vec2(50.f, 50.f), 10.f), 0.f);
+	//A thick line one diameter long is a square the size of the disc, two triangles each
+	std::vector<Vertex_PCU> particleVerts;
+	particleVerts.reserve(numParticles * 6);
+	Vec2 halfWidth = Vec2(PARTICLE_RADIUS, 0.f);
+	for (int particleIndex = 0; particleIndex < numParticles; particleIndex++)
+	{
+		Vec2 position = m_particleCollider.GetParticlePosition(particleIndex);
+		AddVertsForLine2D(particleVerts, position - halfWidth, position + halfWidth, PARTICLE_RADIUS * 2.f, Rgba::ORGANIC_BLUE);
+	}
+
+	g_renderContext->DrawVertexArray(particleVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::DebugRenderToScreen() const
+void Game::RenderMixedPrimitives() const
 {
-	Camera& debugCamera = g_debugRenderer->Get2DCamera();
-	debugCamera.m_colorTargetView = g_renderContext->GetFrameColorTarget();
+	if (!m_hasMixedPrimitives)
+		return;
 
-	g_renderContext->BindShader(m_shader);
-	g_renderContext->BeginCamera(debugCamera);
+	//Hulls are already drawn with the scene geometry
+	std::vector<Vertex_PCU> primitiveVerts;
 
-	g_debugRenderer->DebugRenderToScreen();
+	const std::vector<DiscPrimitive>& discs = m_primitiveStore.GetDiscs();
+	for (int discIndex = 0; discIndex < (int)discs.size(); discIndex++)
+	{
+		AddVertsForRing2D(primitiveVerts, discs[discIndex].m_center, discs[discIndex].m_radius, 0.25f, Rgba::ORGANIC_GREEN);
+	}
 
-	g_renderContext->EndCamera();
+	const std::vector<CapsulePrimitive>& capsules = m_primitiveStore.GetCapsules();
+	for (int capsuleIndex = 0; capsuleIndex < (int)capsules.size(); capsuleIndex++)
+	{
+		const CapsulePrimitive& capsule = capsules[capsuleIndex];
+		Vec2 boneDirection = capsule.m_end - capsule.m_start;
+		boneDirection.Normalize();
+		Vec2 sideOffset = Vec2(-boneDirection.y, boneDirection.x) * capsule.m_radius;
+
+		AddVertsForRing2D(primitiveVerts, capsule.m_start, capsule.m_radius, 0.25f, Rgba::ORGANIC_GREEN);
+		AddVertsForRing2D(primitiveVerts, capsule.m_end, capsule.m_radius, 0.25f, Rgba::ORGANIC_GREEN);
+		AddVertsForLine2D(primitiveVerts, capsule.m_start + sideOffset, capsule.m_end + sideOffset, 0.25f, Rgba::ORGANIC_GREEN);
+		AddVertsForLine2D(primitiveVerts, capsule.m_start - sideOffset, capsule.m_end - sideOffset, 0.25f, Rgba::ORGANIC_GREEN);
+	}
+
+	const std::vector<OBBPrimitive>& obbs = m_primitiveStore.GetOBBs();
+	for (int obbIndex = 0; obbIndex < (int)obbs.size(); obbIndex++)
+	{
+		const OBBPrimitive& obb = obbs[obbIndex];
+		Vec2 right = obb.m_axisX * obb.m_halfExtents.x;
+		Vec2 up = Vec2(-obb.m_axisX.y, obb.m_axisX.x) * obb.m_halfExtents.y;
+		Vec2 corners[4] = { obb.m_center - right - up, obb.m_center + right - up, obb.m_center + right + up, obb.m_center - right + up };
+
+		for (int cornerIndex = 0; cornerIndex < 4; cornerIndex++)
+		{
+			AddVertsForLine2D(primitiveVerts, corners[cornerIndex], corners[(cornerIndex + 1) % 4], 0.25f, Rgba::ORGANIC_GREEN);
+		}
+	}
+
+	g_renderContext->DrawVertexArray(primitiveVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::DebugRenderToCamera() const
+void Game::RenderGeometryInstances() const
 {
-	Camera& debugCamera3D = *m_mainCamera;
-	debugCamera3D.m_colorTargetView = g_renderContext->GetFrameColorTarget();
+	if (!m_hasGeometryInstances)
+		return;
 
-	g_renderContext->BindShader(m_shader);
-	g_renderContext->BeginCamera(debugCamera3D);
+	std::vector<Vertex_PCU> instanceVerts;
+	std::vector<Vec2> worldPoints;
 
-	g_debugRenderer->Setup3DCamera(&debugCamera3D);
-	g_debugRenderer->DebugRenderToCamera();
+	for (int instanceIndex = 0; instanceIndex < m_geometryInstances.GetNumInstances(); instanceIndex++)
+	{
+		m_geometryInstances.GetInstanceWorldPoints(instanceIndex, worldPoints);
 
-	g_renderContext->EndCamera();
+		int numPoints = (int)worldPoints.size();
+		for (int pointIndex = 0; pointIndex < numPoints; pointIndex++)
+		{
+			AddVertsForLine2D(instanceVerts, worldPoints[pointIndex], worldPoints[(pointIndex + 1) % numPoints], 0.25f, Rgba::ORGANIC_BLUE);
+		}
+	}
+
+	g_renderContext->DrawVertexArray(instanceVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::ReRandomize()
+void Game::RenderSelectionRegion() const
 {
-	m_rays.clear();	
-	m_geometry.clear();
+	if (m_regionSelectShape == REGION_SELECT_NONE)
+		return;
 
-	CreateConvexGeometry(ui_numGeometry);
-	CreateRaycasts(ui_numRays);
+	std::vector<Vertex_PCU> regionVerts;
+
+	if (m_regionSelectShape == REGION_SELECT_BOX)
+	{
+		Vec2 otherCornerA = Vec2(m_rayStart.x, m_rayEnd.y);
+		Vec2 otherCornerB = Vec2(m_rayEnd.x, m_rayStart.y);
+
+		AddVertsForLine2D(regionVerts, m_rayStart, otherCornerA, 0.25f, Rgba::ORGANIC_ORANGE);
+		AddVertsForLine2D(regionVerts, otherCornerA, m_rayEnd, 0.25f, Rgba::ORGANIC_ORANGE);
+		AddVertsForLine2D(regionVerts, m_rayEnd, otherCornerB, 0.25f, Rgba::ORGANIC_ORANGE);
+		AddVertsForLine2D(regionVerts, otherCornerB, m_rayStart, 0.25f, Rgba::ORGANIC_ORANGE);
+	}
+	else
+	{
+		AddVertsForRing2D(regionVerts, m_rayStart, (m_rayEnd - m_rayStart).GetLength(), 0.25f, Rgba::ORGANIC_ORANGE);
+	}
+
+	g_renderContext->DrawVertexArray(regionVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::CheckRaycastsBroadPhase()
+void Game::RenderCursorClearance() const
 {
-	double totalStartTime = GetCurrentTimeSeconds();
+	if (!m_hasCursorNearestGeometry)
+		return;
 
-	for (int rayIndex = 0; rayIndex < m_rays.size(); rayIndex++)
-	{
-		for (int hullIndex = 0; hullIndex < m_geometry.size(); hullIndex++)
-		{
-			bool xOverlapCondition = (m_rays[rayIndex].m_bitFieldsXY.x & m_geometry[hullIndex].GetBitFields().x) != 0;
-			bool yOverlapCondition = (m_rays[rayIndex].m_bitFieldsXY.y & m_geometry[hullIndex].GetBitFields().y) != 0;
+	std::vector<Vertex_PCU> clearanceVerts;
 
-			if (xOverlapCondition && yOverlapCondition)
-			{
-				//Run the regular collision check for ray vs convexHull here
-				uint hits = 0;
-				hits = Raycast(&m_hits[rayIndex], m_renderedRay, m_geometry[hullIndex].GetConvexHull2D(), 0.f);
-			}
-		}
+	//Ring shows the free space around the cursor, inside a polygon only the line to its boundary is drawn
+	const Vec2& cursorPosition = m_gameCursor->GetCursorPositon();
+	Rgba clearanceColor = (m_cursorNearestGeometry.m_signedDistance < 0.f) ? Rgba::ORGANIC_RED : Rgba::ORGANIC_GREEN;
+	if (m_cursorNearestGeometry.m_signedDistance > 0.f)
+	{
+		AddVertsForRing2D(clearanceVerts, cursorPosition, m_cursorNearestGeometry.m_signedDistance, 0.25f, clearanceColor);
 	}
+	AddVertsForLine2D(clearanceVerts, cursorPosition, m_cursorNearestGeometry.m_closestPoint, 0.25f, clearanceColor);
 
-	double totalEndTime = GetCurrentTimeSeconds();
-	m_cachedRaycastTime = (float)(totalEndTime - totalStartTime);
-	//DebuggerPrintf("\n Total Time for Raycasts this frame: %f", m_cachedRaycastTime);
+	g_renderContext->DrawVertexArray(clearanceVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::CheckRenderRayVsConvexHulls()
+void Game::RenderVisibilityPolygon() const
 {
-	float bestHit = 9999;
+	int numPoints = (int)m_visibilityPolygon.size();
+	if (numPoints < 2)
+		return;
 
-	//Check the render ray vs all the convex hulls in the scene
-	for (int hullIndex = 0; hullIndex < m_geometry.size(); hullIndex++)
-	{
-		int numPossibleHits = m_geometry[hullIndex].GetConvexHull2D().GetNumPlanes();
-		RayHit2D* out = new RayHit2D[numPossibleHits];
-		
-		uint hits = Raycast(out, m_renderedRay, m_geometry[hullIndex].GetConvexHull2D(), 0.f);
+	std::vector<Vertex_PCU> visibilityVerts;
+	visibilityVerts.reserve(numPoints * 3);
 
-		if (hits > 0 && IsPointOnLineSegment2D(out->m_hitPoint, m_rayStart, m_rayEnd) && out->m_timeAtHit < bestHit)
-		{
-			m_isHitting = true;
-			//DebuggerPrintf("\n Ray hit convexHull");
-			bestHit = out->m_timeAtHit;
-			m_drawRayStart = m_rayStart;
-			m_drawRayEnd = out->m_hitPoint;
-			m_drawSurfanceNormal = out->m_impactNormal;
-		}
-		else if(hits == 0 && bestHit == 9999)
-		{
-			m_isHitting = false;
-			m_drawRayStart = m_rayStart;
-			m_drawRayEnd = m_rayStart;
-			m_drawSurfanceNormal = Vec2::ZERO;
-		}
+	//Fan from the cursor, the polygon is star shaped around it but not convex
+	Vec3 viewerPosition = Vec3(m_gameCursor->GetCursorPositon().x, m_gameCursor->GetCursorPositon().y, 0.f);
+	Rgba visibleColor = Rgba(1.f, 1.f, 0.6f, 0.25f);
+	for (int pointIndex = 0; pointIndex < numPoints; pointIndex++)
+	{
+		const Vec2& fanStart = m_visibilityPolygon[pointIndex];
+		const Vec2& fanEnd = m_visibilityPolygon[(pointIndex + 1) % numPoints];
 
-		delete out;
+		visibilityVerts.push_back(Vertex_PCU(viewerPosition, visibleColor, Vec2::ZERO));
+		visibilityVerts.push_back(Vertex_PCU(Vec3(fanStart.x, fanStart.y, 0.f), visibleColor, Vec2::ZERO));
+		visibilityVerts.push_back(Vertex_PCU(Vec3(fanEnd.x, fanEnd.y, 0.f), visibleColor, Vec2::ZERO));
 	}
+
+	g_renderContext->DrawVertexArray(visibilityVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::CheckAllRayCastsVsConvexHulls()
+void Game::RenderNavigation() const
 {
-	double totalStartTime = GetCurrentTimeSeconds();
+	if (!ui_showNavigationGraph)
+		return;
 
-	gProfiler->ProfilerPush("Ray vs Convex");
+	std::vector<Vertex_PCU> navigationVerts;
 
-	for (int rayIndex = 0; rayIndex < m_rays.size(); rayIndex++)
+	Rgba edgeColor = Rgba(0.6f, 0.6f, 0.6f, 0.2f);
+	for (int nodeIndex = 0; nodeIndex < m_navigationGraph.GetNumNodes(); nodeIndex++)
 	{
-		for (int hullIndex = 0; hullIndex < m_geometry.size(); hullIndex++)
+		const std::vector<int>& neighbours = m_navigationGraph.GetNeighbours(nodeIndex);
+		for (int listIndex = 0; listIndex < (int)neighbours.size(); listIndex++)
 		{
-			uint hits = 0;
-			hits = Raycast(&m_hits[rayIndex], m_renderedRay, m_geometry[hullIndex].GetConvexHull2D(), 0.f);
+			if (neighbours[listIndex] < nodeIndex)
+				continue;
+
+			AddVertsForLine2D(navigationVerts, m_navigationGraph.GetNode(nodeIndex).m_position, m_navigationGraph.GetNode(neighbours[listIndex]).m_position, 0.05f, edgeColor);
 		}
 	}
 
-	double totalEndTime = GetCurrentTimeSeconds();
-	m_cachedRaycastTime = (float)(totalEndTime - totalStartTime);
-	DebuggerPrintf("\n Total Time for Raycasts this frame: %f", m_cachedRaycastTime);
+	//A path kept from the last sync may cross polygons that have drifted since, it is faded until the graph catches up
+	Rgba pathColor = m_isNavigationGraphStale ? Rgba(0.5f, 0.5f, 0.5f, 0.5f) : Rgba::ORGANIC_GREEN;
+	for (int pointIndex = 1; pointIndex < (int)m_navigationPath.size(); pointIndex++)
+	{
+		AddVertsForLine2D(navigationVerts, m_navigationPath[pointIndex - 1], m_navigationPath[pointIndex], 0.3f, pathColor);
+	}
 
-	gProfiler->ProfilerPop();
+	if (navigationVerts.size() > 0)
+	{
+		g_renderContext->DrawVertexArray(navigationVerts);
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderRaycast() const
+void Game::RenderPotentiallyVisibleSet() const
 {
-	std::vector<Vertex_PCU> rayVerts;
+	if (!ui_showPotentiallyVisibleSet || !m_potentiallyVisibleSet.IsBaked() || m_isPotentiallyVisibleSetStale)
+		return;
 
-	AddVertsForArrow2D(rayVerts, m_rayStart, m_rayEnd, 0.5f, Rgba::DIM_TRANSLUCENT_GREY);
-	//Draw the surface normal
-	if (m_isHitting)
+	//Shade every cell the cursor's cell can not see, answered from the baked rows without tracing anything
+	IntVec2 cursorCell = m_broadPhaseChecker.GetCellForPoint(m_gameCursor->GetCursorPositon());
+	int numCellsPerAxis = m_potentiallyVisibleSet.GetNumCellsPerAxis();
+
+	std::vector<uint8_t> rowBits;
+	m_potentiallyVisibleSet.DecompressRow(cursorCell, rowBits);
+
+	std::vector<Vertex_PCU> cellVerts;
+	Rgba hiddenColor = Rgba(0.f, 0.f, 0.f, 0.5f);
+	for (int cellIndex = 0; cellIndex < numCellsPerAxis * numCellsPerAxis; cellIndex++)
 	{
-		Vec2 endAlongNormal = m_drawRayEnd + m_surfaceNormalLength * m_drawSurfanceNormal;
-		AddVertsForArrow2D(rayVerts, m_drawRayEnd, endAlongNormal, 0.5f, Rgba::ORGANIC_BLUE);
+		if (rowBits[cellIndex / 8] & (1 << (cellIndex % 8)))
+			continue;
 
-		AddVertsForArrow2D(rayVerts, m_drawRayStart, m_drawRayEnd, 0.5f, Rgba::ORGANIC_ORANGE);
+		Vec2 cellMins;
+		Vec2 cellMaxs;
+		m_broadPhaseChecker.GetCellBounds(IntVec2(cellIndex % numCellsPerAxis, cellIndex / numCellsPerAxis), cellMins, cellMaxs);
+
+		cellVerts.push_back(Vertex_PCU(Vec3(cellMins.x, cellMins.y, 0.f), hiddenColor, Vec2::ZERO));
+		cellVerts.push_back(Vertex_PCU(Vec3(cellMaxs.x, cellMins.y, 0.f), hiddenColor, Vec2::ZERO));
+		cellVerts.push_back(Vertex_PCU(Vec3(cellMaxs.x, cellMaxs.y, 0.f), hiddenColor, Vec2::ZERO));
+
+		cellVerts.push_back(Vertex_PCU(Vec3(cellMins.x, cellMins.y, 0.f), hiddenColor, Vec2::ZERO));
+		cellVerts.push_back(Vertex_PCU(Vec3(cellMaxs.x, cellMaxs.y, 0.f), hiddenColor, Vec2::ZERO));
+		cellVerts.push_back(Vertex_PCU(Vec3(cellMins.x, cellMaxs.y, 0.f), hiddenColor, Vec2::ZERO));
 	}
 
-	g_renderContext->DrawVertexArray(rayVerts);
+	if (cellVerts.size() > 0)
+	{
+		g_renderContext->DrawVertexArray(cellVerts);
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-ConvexPoly2D Game::MakeConvexPoly2DFromDisc(const Vec2& center, float radius) const
+void Game::RenderRaycastHits() const
 {
-	std::vector<Vec2> convexPolyPoints;
-
-	float startAngle;
-	Vec2 point = GetRandomPointOnDisc2D(center, radius, 10.f, 110.f, startAngle);
-	convexPolyPoints.push_back(point);
+	if (!ui_renderRaycastHits)
+		return;
 
-	float currentAngle = startAngle;
-	bool completedCircle = false;
+	//Draws the committed batch results, in pipelined mode these were solved while the last frame rendered
+	std::vector<Vertex_PCU> hitVerts;
 
-	while (!completedCircle)
+	for (int rayIndex = 0; rayIndex < m_hits.size() && rayIndex < m_rays.size(); rayIndex++)
 	{
-		point = GetRandomPointOnDisc2D(center, radius, currentAngle, currentAngle + 110.f, currentAngle);
-		
-		if (currentAngle > 360.f)
-		{
-			completedCircle = true;
-			break;
-		}
-
-		convexPolyPoints.push_back(point);
-	}
+		if (m_hits[rayIndex].m_timeAtHit == MAX_RAYCAST_TIME)
+			continue;
 
-	if (convexPolyPoints.size() < 3)
-	{
-		MakeConvexPoly2DFromDisc(center, radius);
+		AddVertsForLine2D(hitVerts, m_rays[rayIndex].m_start, m_hits[rayIndex].m_hitPoint, 0.1f, Rgba::ORGANIC_ORANGE);
 	}
 
-	ConvexPoly2D polygon(convexPolyPoints);
-	return polygon;
+	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
+	g_renderContext->DrawVertexArray(hitVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -991,6 +3751,8 @@ void Game::Update( float deltaTime )
 	gProfiler->ProfilerPush("Game::Update");
 	//UpdateCamera(deltaTime);
 
+	m_frameIndex++;
+
 	m_gameCursor->Update(deltaTime);
 
 	if (g_devConsole->GetFrameCount() > 1 && !m_consoleDebugOnce)
@@ -1017,13 +3779,44 @@ void Game::Update( float deltaTime )
 	UpdateVisualRay();
 	CheckRenderRayVsConvexHulls();
 
-	if (m_toggleBroadPhaseMode)
+	UpdateRaySorting();
+	UpdateHullStore();
+	UpdateDriftingGeometry(deltaTime);
+	UpdateDistanceField();
+	UpdateGeometryInstances(deltaTime);
+	UpdateParticles(deltaTime);
+	UpdateNavigation();
+
+	CheckRenderShapeCastVsConvexHulls();
+	TraceRenderRayReflections();
+	UpdateRenderRayIntervals();
+
+	m_gameCursor->SetHoveredGeometryIndex(m_pointQuery.GetGeometryContainingPoint(m_gameCursor->GetCursorPositon()));
+	UpdateRegionSelection();
+
+	m_hasCursorNearestGeometry = false;
+	if (ui_showCursorClearance)
 	{
-		CheckRaycastsBroadPhase();
+		m_hasCursorNearestGeometry = m_sceneQuery.FindNearestGeometry(m_gameCursor->GetCursorPositon(), m_cursorNearestGeometry, m_cursorNearestScratch);
 	}
-	else
+
+	UpdateVisibilityPolygon();
+
+	//In pipelined mode App kicks the batch once Update is done so it runs alongside Render
+	if (m_raycastBatchMode == RAYCAST_BATCH_IMMEDIATE)
+	{
+		if (m_toggleBroadPhaseMode)
+		{
+			CheckRaycastsBroadPhase();
+		}
+		else
+		{
+			CheckAllRayCastsVsConvexHulls();
+		}
+	}
+	else if (m_raycastBatchMode == RAYCAST_BATCH_TIME_BUDGETED)
 	{
-		CheckAllRayCastsVsConvexHulls();
+		CheckRaycastsTimeBudgeted();
 	}
 
 	gProfiler->ProfilerPop();
@@ -1155,6 +3948,12 @@ std::vector<Geometry>& Game::GetAllGameGeometry()
 void Game::SetAllGameGeometry(std::vector<Geometry>& geometry)
 {
 	m_geometry = geometry;
+	m_isHullStoreDirty = true;
+	ClearOverlapMeasurements();
+	ResetRaycastHits();
+
+	//Loaded scenes share out their repeated shapes the same way generated ones do
+	AssignGeometryPrototypes(0);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -1164,29 +3963,30 @@ void Game::CreateConvexGeometry(int numPolygons)
 	if (numPolygons == m_geometry.size())
 		return;
 
+	m_isHullStoreDirty = true;
+	ClearOverlapMeasurements();
+	ResetRaycastHits();
+
 	//If we have lesser than what we need, let's make some
 	if (numPolygons > m_geometry.size())
 	{
-		for (int polygonIndex = 0; polygonIndex < numPolygons; polygonIndex++)
-		{
-			//Make polygons here and push them into the vector
-			float randomRadius = g_RNG->GetRandomFloatInRange(MIN_CONSTRUCTION_RADIUS, MAX_CONSTRUCTION_RADIUS);
-
-			Vec2 randomPosition;
-			randomPosition.x = g_RNG->GetRandomFloatInRange(m_worldBounds.m_minBounds.x + randomRadius + BUFFER_SPACE, m_worldBounds.m_maxBounds.x - randomRadius - BUFFER_SPACE);
-			randomPosition.y = g_RNG->GetRandomFloatInRange(m_worldBounds.m_minBounds.y + randomRadius + BUFFER_SPACE, m_worldBounds.m_maxBounds.y - randomRadius - BUFFER_SPACE);
+		UpdateSceneGeneratorSettings();
 
-			Geometry geometry;
-			geometry.m_convexPoly = MakeConvexPoly2DFromDisc(randomPosition, randomRadius);
-			IntVec2 bitField;
-			
-			bitField = m_broadPhaseChecker.GetRegionForConvexPoly(geometry.m_convexPoly);
-			geometry.SetBitFieldsForBitBucketBroadPhase(bitField);
+		//Only the missing polygons are made, a grid is laid out for the whole count so it is made again from the start
+		int firstNewGeometryIndex = (int)m_geometry.size();
+		if (m_sceneDistribution == SCENE_DISTRIBUTION_GRID)
+		{
+			firstNewGeometryIndex = 0;
+		}
 
-			geometry.m_convexHull.MakeConvexHullFromConvexPolyon(geometry.m_convexPoly);
+		m_sceneGenerator.Generate(numPolygons, firstNewGeometryIndex, m_worldBounds, m_broadPhaseChecker, m_geometry, m_jobPool);
 
-			m_geometry.push_back(geometry);
+		if (m_rejectOverlappingPlacements)
+		{
+			RejectOverlappingPlacements(firstNewGeometryIndex);
 		}
+
+		AssignGeometryPrototypes(firstNewGeometryIndex);
 	}
 	else
 	{
@@ -1198,6 +3998,147 @@ void Game::CreateConvexGeometry(int numPolygons)
 	}
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RegenerateConvexGeometry()
+{
+	m_geometry.clear();
+	m_isHullStoreDirty = true;
+	ClearOverlapMeasurements();
+	ResetRaycastHits();
+	CreateConvexGeometry(ui_numGeometry);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateSceneGeneratorSettings()
+{
+	SceneGeneratorSettings settings = m_sceneGenerator.GetSettings();
+	settings.m_distribution = m_sceneDistribution;
+	settings.m_seed = (uint32_t)ui_sceneSeed;
+	settings.m_repeatShapes = m_repeatShapes;
+	m_sceneGenerator.SetSettings(settings);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::MeasureSceneGeneration()
+{
+	//Made into a scratch scene with the current settings so the scene on screen is left alone
+	UpdateSceneGeneratorSettings();
+
+	std::vector<Geometry> measuredGeometry;
+	double startTime = GetCurrentTimeSeconds();
+	m_sceneGenerator.Generate(SCENE_GENERATION_MEASURE_COUNT, 0, m_worldBounds, m_broadPhaseChecker, measuredGeometry, m_jobPool);
+	m_sceneGenerationTime = GetCurrentTimeSeconds() - startTime;
+
+	m_hasSceneGenerationMeasurement = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RejectOverlappingPlacements(int firstNewGeometryIndex)
+{
+	//New polygons that land on anything get a new random placement, the ones still overlapping after the last round are dropped
+	//Pairs stay local, the indices go stale once the rejected polygons are compacted away
+	std::vector<OverlapPair> overlapPairs;
+	std::vector<bool> isRejected;
+	std::vector<Vec2> scratchPoints;
+	int numPolygons = (int)m_geometry.size();
+	for (int attemptIndex = 0; attemptIndex <= MAX_PLACEMENT_ATTEMPTS; attemptIndex++)
+	{
+		m_overlapFinder.FindOverlappingPairs(m_geometry, m_broadPhaseChecker, overlapPairs, m_jobPool);
+
+		//Pairs have the lower index first so B is always the newer polygon of the two
+		isRejected.assign(m_geometry.size(), false);
+		int numRejected = 0;
+		for (int pairIndex = 0; pairIndex < (int)overlapPairs.size(); pairIndex++)
+		{
+			int geometryIndex = overlapPairs[pairIndex].m_geometryIndexB;
+			if (geometryIndex >= firstNewGeometryIndex && !isRejected[geometryIndex])
+			{
+				isRejected[geometryIndex] = true;
+				numRejected++;
+			}
+		}
+
+		if (numRejected == 0)
+			return;
+
+		if (attemptIndex == MAX_PLACEMENT_ATTEMPTS)
+			break;
+
+		for (int geometryIndex = firstNewGeometryIndex; geometryIndex < (int)m_geometry.size(); geometryIndex++)
+		{
+			if (isRejected[geometryIndex])
+			{
+				//Attempt 0 is the first placement so a re-placement is the next one along
+				m_sceneGenerator.MakePolygon(geometryIndex, numPolygons, attemptIndex + 1, m_worldBounds, m_broadPhaseChecker, m_geometry[geometryIndex], scratchPoints);
+			}
+		}
+	}
+
+	int numKept = firstNewGeometryIndex;
+	for (int geometryIndex = firstNewGeometryIndex; geometryIndex < (int)m_geometry.size(); geometryIndex++)
+	{
+		if (!isRejected[geometryIndex])
+		{
+			m_geometry[numKept++] = m_geometry[geometryIndex];
+		}
+	}
+	m_geometry.resize(numKept);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::MeasureOverlappingPairs()
+{
+	double startTime = GetCurrentTimeSeconds();
+	m_overlapFinder.FindOverlappingPairs(m_geometry, m_broadPhaseChecker, m_overlapPairs, m_jobPool);
+	m_overlapSearchTime = GetCurrentTimeSeconds() - startTime;
+
+	m_numOverlapCandidates = m_overlapFinder.GetNumCandidatePairs();
+	m_hasOverlapMeasurement = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::MeasurePairPenetrations()
+{
+	//Drifting moves the polygons every frame, so the pairs are found again for the scene as it is now
+	MeasureOverlappingPairs();
+
+	//Cold pass fills the caches
+	double coldStartTime = GetCurrentTimeSeconds();
+	m_convexDistanceSolver.ComputeDistances(m_geometry, m_overlapPairs, m_pairDistances, m_jobPool, false);
+	m_coldDistanceTime = GetCurrentTimeSeconds() - coldStartTime;
+
+	m_maxPenetrationDepth = 0.f;
+	for (int pairIndex = 0; pairIndex < (int)m_pairDistances.size(); pairIndex++)
+	{
+		m_maxPenetrationDepth = GetHigherValue(m_maxPenetrationDepth, -m_pairDistances[pairIndex].m_signedDistance);
+	}
+
+	//Warm starting pays off when the shapes moved a little since the cached simplex, so the second pass runs on a copy
+	//of the scene one drift step on. The scene on screen is left where it is
+	AddMissingDriftVelocities();
+	m_penetrationDriftedGeometry = m_geometry;
+	for (int geometryIndex = 0; geometryIndex < (int)m_penetrationDriftedGeometry.size(); geometryIndex++)
+	{
+		m_penetrationDriftedGeometry[geometryIndex].Translate(m_geometryVelocities[geometryIndex] * PENETRATION_DRIFT_SECONDS);
+	}
+
+	double warmStartTime = GetCurrentTimeSeconds();
+	m_convexDistanceSolver.ComputeDistances(m_penetrationDriftedGeometry, m_overlapPairs, m_pairDistances, m_jobPool, true);
+	m_warmDistanceTime = GetCurrentTimeSeconds() - warmStartTime;
+
+	m_hasPenetrationMeasurement = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ClearOverlapMeasurements()
+{
+	//Pair indices belong to the scene they were found in
+	m_overlapPairs.clear();
+	m_pairDistances.clear();
+	m_hasOverlapMeasurement = false;
+	m_hasPenetrationMeasurement = false;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::CreateRaycasts(int numRaycasts)
 {
@@ -1208,7 +4149,7 @@ void Game::CreateRaycasts(int numRaycasts)
 	//If we have lesser than what we need, let's make some
 	if (numRaycasts > m_rays.size())
 	{
-		for (int rayIndex = 0; rayIndex < numRaycasts; rayIndex++)
+		for (int rayIndex = (int)m_rays.size(); rayIndex < numRaycasts; rayIndex++)
 		{
 			//Make rays here and push them into the vector
 			Vec2 randomPosition;
@@ -1227,6 +4168,7 @@ void Game::CreateRaycasts(int numRaycasts)
 			RayHit2D hit;
 
 			m_rays.push_back(ray);
+			m_areRaysSorted = false;
 			m_hits.push_back(hit);
 		}
 	}
@@ -1236,6 +4178,7 @@ void Game::CreateRaycasts(int numRaycasts)
 		while (m_rays.size() > numRaycasts)
 		{
 			m_rays.pop_back();
+			m_areRaysSorted = false;
 			m_hits.pop_back();
 		}
 	}
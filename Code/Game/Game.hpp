@@ -12,6 +12,24 @@
 #include "Game/GameCommon.hpp"
 #include "Game/Geometry.hpp"
 #include "Game/BitBucketBroadPhase.hpp"
+#include "Game/HullStore.hpp"
+#include "Game/PointQuery.hpp"
+#include "Game/SceneQuery.hpp"
+#include "Game/DistanceFieldGrid.hpp"
+#include "Game/OverlapPairs.hpp"
+#include "Game/GeometryInstances.hpp"
+#include "Game/PrimitiveStore.hpp"
+#include "Game/ConvexDistance.hpp"
+#include "Game/VisibilityPolygon.hpp"
+#include "Game/LineOfSightMatrix.hpp"
+#include "Game/RaySorter.hpp"
+#include "Game/ReflectionTracer.hpp"
+#include "Game/ShapeCast.hpp"
+#include "Game/TimeOfImpact.hpp"
+#include "Game/ParticleCollider.hpp"
+#include "Game/NavigationGraph.hpp"
+#include "Game/PotentiallyVisibleSet.hpp"
+#include "Game/SceneGenerator.hpp"
 
 //------------------------------------------------------------------------------------------------------------------------------
 class Texture;
@@ -23,6 +41,7 @@ class Geometry;
 class Shader;
 class Trigger2D;
 class SceneCooker;
+class JobPool;
 struct Camera;
 struct IntVec2;
 
@@ -50,11 +69,14 @@ public:
 	//bool					HandleMouseScroll(float wheelDelta);
 	
 	void					Render() const;
-	ConvexPoly2D			MakeConvexPoly2DFromDisc(const Vec2& center, float radius) const;
 
 	void					PostRender();
 
 	void					Update( float deltaTime );
+
+	//Pipelined raycasts, kicked after Update and committed once the frame has been rendered
+	void					KickPipelinedRaycasts();
+	void					CommitPipelinedRaycasts();
 	void					ClearGarbageEntities();
 
 	bool					IsAlive();
@@ -67,6 +89,13 @@ public:
 
 private:
 	void					CreateConvexGeometry(int numPolygons);
+	void					RegenerateConvexGeometry();
+	void					UpdateSceneGeneratorSettings();
+	void					MeasureSceneGeneration();
+	void					RejectOverlappingPlacements(int firstNewGeometryIndex);
+	void					MeasureOverlappingPairs();
+	void					MeasurePairPenetrations();
+	void					ClearOverlapMeasurements();
 	void					CreateRaycasts(int numRaycasts);
 	void					CreateRenderRay();
 	
@@ -74,18 +103,70 @@ private:
 	void					UpdateCamera( float deltaTime );
 	void					UpdateCameraMovement(unsigned char keyCode);
 	void					UpdateImGUI();
+	void					UpdateImGUIRaycastAges();
 	void					UpdateVisualRay();
 
 	//Check Rays vs ConvexHulls
 	void					CheckRenderRayVsConvexHulls();
+	void					CheckRenderShapeCastVsConvexHulls();
+	void					TraceRenderRayReflections();
+	void					MeasureReflectionStream();
+	void					UpdateRenderRayIntervals();
+	void					MeasureAllIntersections();
+	void					LoadMixedPrimitives();
+	void					AddSceneHullsToPrimitiveStore();
+	void					MeasureMixedPrimitiveRaycasts();
+	void					AssignGeometryPrototypes(int firstGeometryIndex);
+	void					BuildGeometryInstances();
+	void					RefitMovedGeometryInstances(const std::vector<int>& movedGeometryIndices);
+	void					MeasureHullRebuild();
+	void					UpdateGeometryInstances(float deltaTime);
+	void					MeasureInstancedRaycasts();
+	void					SpawnParticles(int numParticles);
+	void					UpdateParticles(float deltaTime);
+	void					MeasureBatchedDiscCasts();
+	void					MeasureOccupancySampling();
+	void					UpdateRegionSelection();
 	void					CheckAllRayCastsVsConvexHulls();
 	void					CheckRaycastsBroadPhase();
+	void					RaycastRangeVsConvexHulls(int startRayIndex, int endRayIndex, bool useBroadPhase, std::vector<RayHit2D>& hitsOut) const;
+	void					CheckRaycastsTimeBudgeted();
+	void					ResetRaycastHits();
+	int						GetRayIndexForTraversalIndex(int traversalIndex) const;
+
+	void					UpdateHullStore();
+	void					UpdateDriftingGeometry(float deltaTime);
+	void					AddMissingDriftVelocities();
+	void					StopDriftingGeometryAtImpacts(float driftSeconds);
+	void					UpdateDistanceField();
+	void					UpdateVisibilityQuery();
+	void					UpdateVisibilityPolygon();
+	void					MeasureLineOfSight();
+	void					UpdateNavigation();
+	void					UpdatePotentiallyVisibleSet();
+
+	//Ray coherence sorting
+	void					UpdateRaySorting();
+	void					MeasureRayOrderCacheMisses();
+	void					ReplayRaycastTraversal(bool useSortedOrder, CacheMissEstimator& estimator) const;
 
 	void					RenderWorldBounds() const;
 	void					RenderOnScreenInfo() const;
 	void					RenderPersistantUI() const;
 	void					RenderAllGeometry() const;
 	void					RenderRaycast() const;
+	void					RenderRaycastHits() const;
+	void					RenderShapeCast() const;
+	void					RenderRayReflections() const;
+	void					RenderRayIntervals() const;
+	void					RenderMixedPrimitives() const;
+	void					RenderGeometryInstances() const;
+	void					RenderParticles() const;
+	void					RenderSelectionRegion() const;
+	void					RenderCursorClearance() const;
+	void					RenderVisibilityPolygon() const;
+	void					RenderNavigation() const;
+	void					RenderPotentiallyVisibleSet() const;
 
 	void					DebugRenderTestRandomPointsOnScreen() const;
 	void					DebugRenderToScreen() const;
@@ -142,6 +223,25 @@ public:
 	int ui_maxRays = 4096;
 
 	bool ui_debugCursorPosition = false;
+	bool ui_showCursorClearance = false;
+	bool ui_showVisibilityPolygon = false;
+	bool ui_renderRaycastHits = false;
+	float ui_raycastBudgetMS = 2.f;
+	float ui_shapeCastRadius = 2.f;
+	bool ui_showRayReflections = false;
+	int ui_numReflectionBounces = 4;
+	bool ui_showRayIntervals = false;
+	bool ui_spinGeometryInstances = false;
+	bool ui_driftGeometry = false;
+	bool ui_refitDriftingGeometry = true;
+	bool ui_stopDriftAtImpact = false;
+	float ui_driftSpeedScale = 1.f;
+	int ui_numParticles = 100000;
+	bool ui_simulateParticles = false;
+	bool ui_showNavigationGraph = false;
+	bool ui_showNavigationPath = true;
+	bool ui_showPotentiallyVisibleSet = false;
+	int ui_sceneSeed = 0;
 
 	//Geometry Objects repository
 	std::vector<Geometry>		m_geometry;
@@ -167,6 +267,183 @@ public:
 	BitFieldBroadPhase			m_broadPhaseChecker;
 	float						m_cachedRaycastTime;
 
+	//Batch raycasts on worker threads
+	JobPool*					m_jobPool = nullptr;
+	eRaycastBatchMode			m_raycastBatchMode = RAYCAST_BATCH_IMMEDIATE;
+
+	//Double buffered results for the pipelined mode, m_hits is the committed copy that rendering reads
+	std::vector<RayHit2D>		m_pipelinedHits;
+	float						m_pipelinedRaycastTime = 0.f;
+	bool						m_isPipelinedBatchInFlight = false;
+
+	//Incremental raycasts for the time budgeted mode, stamps hold the frame each hit was solved on (-1 if never)
+	int							m_frameIndex = 0;
+	int							m_nextBudgetedRayIndex = 0;
+	std::vector<int>			m_hitFrameStamps;
+
+	//SoA hulls grouped by plane count for the specialized ray vs hull kernels
+	HullStore					m_hullStore;
+	bool						m_isHullStoreDirty = true;
+	bool						m_useSpecializedHullKernels = true;
+
+	//Sphere traced raycasts, the field is rebaked from the scene query whenever the hull store is rebuilt
+	DistanceFieldGrid			m_distanceField;
+	bool						m_useDistanceFieldRaycasts = false;
+	bool						m_isDistanceFieldDirty = true;
+	double						m_distanceFieldBakeTime = 0.0;
+
+	//All pairs overlap detection, also used to re-place new random polygons that land on others
+	OverlapPairFinder			m_overlapFinder;
+	std::vector<OverlapPair>	m_overlapPairs;
+	bool						m_rejectOverlappingPlacements = false;
+	bool						m_hasOverlapMeasurement = false;
+	int							m_numOverlapCandidates = 0;
+	double						m_overlapSearchTime = 0.0;
+
+	//New polygons can be copies of a few shapes moved into place instead of all being different
+	bool						m_repeatShapes = false;
+
+	//Random polygons come from the seed and their index, so the same seed and distribution always make the same scene
+	SceneGenerator				m_sceneGenerator;
+	eSceneDistribution			m_sceneDistribution = SCENE_DISTRIBUTION_UNIFORM;
+	bool						m_hasSceneGenerationMeasurement = false;
+	double						m_sceneGenerationTime = 0.0;
+
+	//Drift mode moves every polygon each frame, the accelerators are either refit in place or rebuilt to compare
+	std::vector<Vec2>			m_geometryVelocities;
+	double						m_driftMoveTime = 0.0;
+	double						m_driftRefitTime = 0.0;
+	double						m_driftRebuildTime = 0.0;
+	int							m_numDriftCellChanges = 0;
+
+	//Optionally each drifting polygon stops at its first time of impact this frame and swaps velocity along the normal
+	TimeOfImpactSolver			m_timeOfImpactSolver;
+	std::vector<OverlapPair>	m_sweptPairs;
+	std::vector<TimeOfImpact2D>	m_pairImpacts;
+	std::vector<Vec2>			m_driftDisplacements;
+	std::vector<float>			m_driftMoveTimes;
+	double						m_timeOfImpactTime = 0.0;
+
+	//GJK / EPA over the overlapping pairs, timed without and then with warm starting after one drift step
+	ConvexDistanceSolver		m_convexDistanceSolver;
+	std::vector<Geometry>		m_penetrationDriftedGeometry;
+	std::vector<ConvexDistance2D>	m_pairDistances;
+	bool						m_hasPenetrationMeasurement = false;
+	double						m_coldDistanceTime = 0.0;
+	double						m_warmDistanceTime = 0.0;
+	float						m_maxPenetrationDepth = 0.f;
+
+	//Optional pre-pass that sorts rays by direction octant and origin morton code before traversal
+	RaySorter					m_raySorter;
+	bool						m_useRaySorting = false;
+	bool						m_areRaysSorted = false;
+	float						m_raySortTime = 0.f;
+
+	//Results of the last cache miss measurement, creation order vs sorted order
+	bool						m_hasCacheMissMeasurement = false;
+	uint64_t					m_cacheMissesCreationOrder = 0;
+	uint64_t					m_cacheMissesSortedOrder = 0;
+	bool						m_cacheMissesModelHullStore = true;		//Which raycast path the replay modelled
+	uint64_t					m_cacheAccessesPerOrder = 0;
+	float						m_raycastTimeCreationOrder = 0.f;
+	float						m_raycastTimeSortedOrder = 0.f;
+
+	//Swept disc and capsule queries, the render ray can be swapped for either shape
+	ShapeCaster					m_shapeCaster;
+	eRenderCastShape			m_renderCastShape = RENDER_CAST_RAY;
+	ShapeCast2D					m_renderShapeCast;
+	ShapeCastHit2D				m_renderShapeCastHit;
+	bool						m_isShapeCastHitting = false;
+
+	//Multi bounce reflections, traced for the render ray every frame and for all batch rays on demand
+	ReflectionTracer			m_reflectionTracer;
+	std::vector<BounceSegment>	m_renderRayBounceSegments;
+	bool						m_hasReflectionMeasurement = false;
+	int							m_numReflectionSegments = 0;
+	double						m_reflectionTraceTime = 0.0;
+
+	//Every hull crossed by the render ray in order, and the last measurement of the same query over all batch rays
+	RayInterval2D				m_renderRayIntervals[MAX_RAY_INTERVALS];
+	int							m_numRenderRayIntervals = 0;
+	bool						m_hasIntervalMeasurement = false;
+	int							m_numMeasuredIntervals = 0;
+	double						m_intervalQueryTime = 0.0;
+
+	//Colliders from the save file kept as exact discs, capsules and boxes next to the scene hulls
+	PrimitiveStore				m_primitiveStore;
+	bool						m_hasMixedPrimitives = false;
+	bool						m_hasMixedPrimitiveMeasurement = false;
+	int							m_numMixedPrimitiveHits = 0;
+	double						m_mixedPrimitiveRaycastTime = 0.0;
+
+	//Shared local space prototypes of the scene shapes, assigned as the scene is made or loaded, and optionally the scene
+	//polygons as instances of them placed by transforms. Spinning the instances only refits bounds
+	InstancedGeometryStore		m_geometryInstances;
+	std::vector<int>			m_instanceIndexForGeometry;		//-1 for polygons without a prototype
+	bool						m_hasGeometryInstances = false;
+	double						m_instanceRefitTime = 0.0;
+	bool						m_hasHullRebuildMeasurement = false;
+	double						m_hullRebuildTime = 0.0;
+	bool						m_hasInstancedRaycastMeasurement = false;
+	int							m_numInstancedRaycastHits = 0;
+	double						m_instancedRaycastTime = 0.0;
+
+	//Discs falling through the scene hulls, the hulls are taken again whenever the scene changes
+	DiscParticleCollider		m_particleCollider;
+	bool						m_areParticleHullsDirty = true;
+	double						m_particleStepTime = 0.0;
+	int							m_numParticleContacts = 0;
+
+	//Results of the last batched disc cast measurement, one disc per batch ray
+	bool						m_hasShapeCastMeasurement = false;
+	int							m_numShapeCastsMeasured = 0;
+	int							m_numShapeCastHitsMeasured = 0;
+	float						m_shapeCastBatchTime = 0.f;
+
+	//Point containment for cursor picking and occupancy sampling
+	PointContainmentQuery		m_pointQuery;
+
+	bool						m_hasOccupancyMeasurement = false;
+	float						m_occupiedFraction = 0.f;
+	float						m_occupancySampleTime = 0.f;
+
+	//Region queries for viewport culling and the selection region
+	SceneQuery					m_sceneQuery;
+	eRegionSelectShape			m_regionSelectShape = REGION_SELECT_NONE;
+	std::vector<int>			m_selectedGeometry;
+	std::vector<bool>			m_isGeometrySelected;
+	int							m_numGeometryInView = 0;
+	NearestGeometry2D			m_cursorNearestGeometry;
+	NearestGeometryScratch		m_cursorNearestScratch;
+	bool						m_hasCursorNearestGeometry = false;
+
+	//Region visible from the cursor, the segments are only rebuilt when the scene changed while the view is on
+	VisibilityPolygonQuery		m_visibilityQuery;
+	std::vector<Vec2>			m_visibilityPolygon;
+	bool						m_isVisibilityQueryDirty = true;
+	double						m_visibilityQueryTime = 0.0;
+
+	//Mutual visibility between random points, built from one visibility polygon per point
+	LineOfSightMatrix			m_lineOfSightMatrix;
+	bool						m_hasLineOfSightMeasurement = false;
+	int							m_numVisiblePointPairs = 0;
+	double						m_lineOfSightTime = 0.0;
+
+	//Visibility graph between the polygon corners, synced with the scene while shown and searched from ray start to ray end
+	NavigationGraph				m_navigationGraph;
+	std::vector<Vec2>			m_navigationPath;
+	bool						m_hasNavigationPath = false;
+	bool						m_isNavigationGraphStale = false;		//Not synced this frame while drifting, the path is the one from the last sync
+	int							m_numExpandedNavNodes = 0;
+	int							m_lastNavSyncIndex = -1;
+	double						m_navigationSyncTime = 0.0;
+	double						m_navigationPathTime = 0.0;
+
+	//Cell to cell visibility baked over the broadphase grid, loaded with the cooked scene when it matches the polygons
+	PotentiallyVisibleSet		m_potentiallyVisibleSet;
+	bool						m_isPotentiallyVisibleSetStale = true;
+	double						m_potentiallyVisibleSetBakeTime = 0.0;
+
 	SceneCooker*				m_cooker = nullptr;
 
 	//Loading and saving custom file format
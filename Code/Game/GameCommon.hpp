@@ -39,6 +39,59 @@ constexpr float MIN_CONSTRUCTION_RADIUS = 5.f;
 constexpr float MAX_CONSTRUCTION_RADIUS = 20.f;
 constexpr float BUFFER_SPACE = 2.f;
 
+constexpr float MAX_RAYCAST_TIME = 9999.f;		//Time stored in a RayHit2D that did not hit anything
+constexpr int RAYCAST_BATCH_GRAIN_SIZE = 64;	//Rays handed to a worker at a time
+constexpr int RAYCAST_BUDGET_CHUNK_SIZE = 16;	//Rays solved between checks of the frame budget
+constexpr int POINT_QUERY_GRAIN_SIZE = 4096;	//Points handed to a worker at a time
+constexpr int OCCUPANCY_SAMPLE_COUNT = 1 << 20;	//Random points used by the occupancy measurement
+constexpr int MAX_PLACEMENT_ATTEMPTS = 8;		//Rounds of re-placing overlapping random polygons before giving up on them
+constexpr int PAIR_QUERY_GRAIN_SIZE = 256;		//Polygon pairs handed to a worker at a time
+constexpr int LINE_OF_SIGHT_GRAIN_SIZE = 8;		//Source points handed to a worker at a time, each one builds a visibility polygon
+constexpr int LINE_OF_SIGHT_POINT_COUNT = 512;	//Random points used by the line of sight measurement
+constexpr int MAX_REFLECTION_BOUNCES = 16;		//Upper end of the reflection bounce slider
+constexpr int MAX_RAY_INTERVALS = 64;			//Hull intervals kept per ray by the all intersections query
+constexpr float MAX_DRIFT_SPEED = 5.f;				//World units per second of the fastest drifting polygon
+constexpr float PENETRATION_DRIFT_SECONDS = 1.f / 60.f;	//Drift step between the cold and warm started GJK passes, one frame at 60 Hz
+constexpr int NUM_REPEATED_SHAPES = 16;			//Shapes new polygons are copied from when repeating shapes, like the tiles of a level
+constexpr float INSTANCE_SPIN_DEGREES_PER_SECOND = 45.f;	//Turn rate of spinning geometry instances, every other one turns the other way
+constexpr int PARTICLE_STEP_GRAIN_SIZE = 2048;	//Particles handed to a worker at a time
+constexpr int MAX_PARTICLES = 262144;			//Upper end of the particle count slider
+constexpr int NAV_GRAPH_GRAIN_SIZE = 16;		//Navigation nodes handed to a worker at a time when re-testing edges
+constexpr int NAV_DRIFT_SYNC_INTERVAL = 30;		//Frames between navigation graph syncs while the geometry drifts, each one is a full rebuild
+constexpr int PVS_BAKE_GRAIN_SIZE = 4;			//Rows of the potentially visible set handed to a worker at a time, early rows are the longest
+constexpr int SCENE_GENERATION_GRAIN_SIZE = 1024;	//Polygons handed to a worker at a time by the scene generator
+constexpr int SCENE_GENERATION_MEASURE_COUNT = 1000000;	//Polygons made by the scene generation measurement
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eRaycastBatchMode
+{
+	RAYCAST_BATCH_IMMEDIATE = 0,	//Raycasts are solved in Game::Update before rendering
+	RAYCAST_BATCH_PIPELINED,		//Raycasts for the next frame are solved on the job pool while this frame renders
+	RAYCAST_BATCH_TIME_BUDGETED,	//Raycasts are solved until the frame budget runs out and resume on the next frame
+
+	NUM_RAYCAST_BATCH_MODES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eRenderCastShape
+{
+	RENDER_CAST_RAY = 0,			//Thin ray from the start to the end handle
+	RENDER_CAST_DISC,				//Disc swept from the start handle towards the end handle
+	RENDER_CAST_CAPSULE,			//Capsule across the sweep direction swept the same way
+
+	NUM_RENDER_CAST_SHAPES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eRegionSelectShape
+{
+	REGION_SELECT_NONE = 0,
+	REGION_SELECT_BOX,				//Box with the ray start and end handles as opposite corners
+	REGION_SELECT_DISC,				//Disc centered on the ray start handle reaching the end handle
+
+	NUM_REGION_SELECT_SHAPES
+};
+
 extern AudioSystem* g_audio;
 extern Clock* g_gameClock;
 extern InputSystem* g_inputSystem;
@@ -44,15 +44,17 @@ void GameCursor::Update( float deltaTime )
 //------------------------------------------------------------------------------------------------------------------------------
 void GameCursor::Render() const
 {
+	Rgba cursorColor = (m_hoveredGeometryIndex >= 0) ? m_cursorHoverColor : m_cursorColor;
+
 	std::vector<Vertex_PCU> ringVerts;
-	AddVertsForRing2D(ringVerts, m_cursorPosition, m_cursorRingRadius, m_cursorThickness, m_cursorColor);
+	AddVertsForRing2D(ringVerts, m_cursorPosition, m_cursorRingRadius, m_cursorThickness, cursorColor);
 
 	std::vector<Vertex_PCU>	lineVerts;
 	Vec2 vertLineOffset = Vec2(0.f, m_cursorRingRadius);
 	Vec2 horLineOffset = Vec2(m_cursorRingRadius, 0.f);
 
-	AddVertsForLine2D(lineVerts, m_cursorPosition - vertLineOffset - Vec2(0.f, 0.5f), m_cursorPosition + vertLineOffset + Vec2(0.f, 0.5f), m_cursorThickness, m_cursorColor);
-	AddVertsForLine2D(lineVerts, m_cursorPosition - horLineOffset - Vec2(0.5f, 0.f), m_cursorPosition + horLineOffset + Vec2(0.5f, 0.f), m_cursorThickness, m_cursorColor);
+	AddVertsForLine2D(lineVerts, m_cursorPosition - vertLineOffset - Vec2(0.f, 0.5f), m_cursorPosition + vertLineOffset + Vec2(0.f, 0.5f), m_cursorThickness, cursorColor);
+	AddVertsForLine2D(lineVerts, m_cursorPosition - horLineOffset - Vec2(0.5f, 0.f), m_cursorPosition + horLineOffset + Vec2(0.5f, 0.f), m_cursorThickness, cursorColor);
 
 	//g_renderContext->BindTexture(nullptr);
 	g_renderContext->BindTextureViewWithSampler(0U, nullptr);
@@ -136,3 +138,14 @@ void GameCursor::SetDebugMode(bool debugMode)
 	m_enableDebug = debugMode;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void GameCursor::SetHoveredGeometryIndex(int geometryIndex)
+{
+	m_hoveredGeometryIndex = geometryIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int GameCursor::GetHoveredGeometryIndex() const
+{
+	return m_hoveredGeometryIndex;
+}
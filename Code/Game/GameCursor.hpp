@@ -30,9 +30,15 @@ public:
 
 	void			SetDebugMode(bool debugMode);
 
+	//Geometry under the cursor, picked by Game through the point containment query (-1 for none)
+	void			SetHoveredGeometryIndex(int geometryIndex);
+	int				GetHoveredGeometryIndex() const;
+
 private:
 	Vec2			m_cursorPosition = Vec2::ZERO;
 	Rgba			m_cursorColor = Rgba::ORGANIC_RED;
+	Rgba			m_cursorHoverColor = Rgba::ORGANIC_BLUE;
+	int				m_hoveredGeometryIndex = -1;
 	float			m_cursorThickness = 0.25f;
 	float			m_cursorRingRadius = 1.25f;
 
@@ -70,3 +70,45 @@ void Geometry::MakeHullFromOwningPolygon()
 	m_convexHull.MakeConvexHullFromConvexPolyon(m_convexPoly);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void Geometry::Translate(const Vec2& displacement)
+{
+	std::vector<Vec2> points = m_convexPoly.GetConvexPoly2DPoints();
+	for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+	{
+		points[pointIndex] += displacement;
+	}
+	m_convexPoly = ConvexPoly2D(points);
+
+	//Moving keeps every normal, so the planes only need their distances shifted instead of a rebuild from the polygon
+	std::vector<Plane2D> planes = m_convexHull.GetPlanes();
+	for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++)
+	{
+		const Vec2& normal = planes[planeIndex].GetNormal();
+		float distance = planes[planeIndex].GetSignedDistance() + normal.x * displacement.x + normal.y * displacement.y;
+		planes[planeIndex] = Plane2D(normal, distance);
+	}
+	m_convexHull = ConvexHull2D(planes);
+
+	m_prototypeOffset += displacement;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Geometry::SetPrototype(int prototypeIndex, const Vec2& prototypeOffset)
+{
+	m_prototypeIndex = prototypeIndex;
+	m_prototypeOffset = prototypeOffset;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int Geometry::GetPrototypeIndex() const
+{
+	return m_prototypeIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const Vec2& Geometry::GetPrototypeOffset() const
+{
+	return m_prototypeOffset;
+}
+
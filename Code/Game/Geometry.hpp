@@ -20,6 +20,11 @@ public:
 	const IntVec2&				GetBitFields() const;
 
 	void						MakeHullFromOwningPolygon();	//Makes m_convexHull using m_convexPoly;
+	void						Translate(const Vec2& displacement);	//Moves the polygon and shifts the hull planes, bit fields are left to the caller
+
+	void						SetPrototype(int prototypeIndex, const Vec2& prototypeOffset);
+	int							GetPrototypeIndex() const;
+	const Vec2&					GetPrototypeOffset() const;
 
 public:
 	
@@ -28,4 +33,9 @@ public:
 
 	//For broad-phase checks using bitBuckets
 	IntVec2				m_bitFieldsXY;
+
+	//Shared local space shape this polygon is a moved copy of, -1 until the scene assigns one
+	//The hull store and the instance store read their planes from it, the world polygon and hull above are still kept for everything else
+	int					m_prototypeIndex = -1;
+	Vec2				m_prototypeOffset = Vec2::ZERO;
 };
@@ -0,0 +1,314 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/GeometryInstances.hpp"
+#include "Engine/Math/ConvexHull2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include "Game/Geometry.hpp"
+#include <cfloat>
+#include <cmath>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static constexpr float INSTANCE_DEGREES_TO_RADIANS = 0.01745329252f;
+
+//------------------------------------------------------------------------------------------------------------------------------
+InstancedGeometryStore::InstancedGeometryStore()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+InstancedGeometryStore::~InstancedGeometryStore()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedGeometryStore::Clear()
+{
+	m_prototypes.clear();
+	m_instances.clear();
+	m_localNormalX.clear();
+	m_localNormalY.clear();
+	m_localDistance.clear();
+	m_localPoints.clear();
+	m_prototypesByHash.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedGeometryStore::ClearInstances()
+{
+	m_instances.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int InstancedGeometryStore::AddPrototype(const std::vector<Vec2>& localPoints)
+{
+	//The only time planes get made, instances never touch them again
+	Geometry localGeometry(localPoints);
+	const std::vector<Plane2D>& planes = localGeometry.GetConvexHull2D().GetPlanes();
+
+	GeometryPrototype prototype;
+	prototype.m_firstPlane = (int)m_localDistance.size();
+	prototype.m_numPlanes = (int)planes.size();
+	prototype.m_firstPoint = (int)m_localPoints.size();
+	prototype.m_numPoints = (int)localPoints.size();
+	prototype.m_contentHash = HashLocalPoints(localPoints);
+
+	for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++)
+	{
+		m_localNormalX.push_back(planes[planeIndex].GetNormal().x);
+		m_localNormalY.push_back(planes[planeIndex].GetNormal().y);
+		m_localDistance.push_back(planes[planeIndex].GetSignedDistance());
+	}
+
+	Vec2 mins(FLT_MAX, FLT_MAX);
+	Vec2 maxs(-FLT_MAX, -FLT_MAX);
+	for (int pointIndex = 0; pointIndex < (int)localPoints.size(); pointIndex++)
+	{
+		const Vec2& point = localPoints[pointIndex];
+		mins = Vec2(GetLowerValue(mins.x, point.x), GetLowerValue(mins.y, point.y));
+		maxs = Vec2(GetHigherValue(maxs.x, point.x), GetHigherValue(maxs.y, point.y));
+		m_localPoints.push_back(point);
+	}
+
+	prototype.m_localCenter = (mins + maxs) * 0.5f;
+	prototype.m_localHalfExtents = (maxs - mins) * 0.5f;
+
+	m_prototypes.push_back(prototype);
+	int prototypeIndex = (int)m_prototypes.size() - 1;
+	m_prototypesByHash.emplace(prototype.m_contentHash, prototypeIndex);
+	return prototypeIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint64_t InstancedGeometryStore::HashLocalPoints(const std::vector<Vec2>& localPoints)
+{
+	//FNV-1a over the points snapped to hash cells, so copies moved by float noise still hash the same unless a
+	//coordinate sits right on a cell boundary, which only costs a missed share. Matches are checked point by point
+	uint64_t hash = 14695981039346656037ULL;
+	auto hashValue = [&hash](int32_t value)
+	{
+		for (int byteIndex = 0; byteIndex < 4; byteIndex++)
+		{
+			hash ^= (uint64_t)((value >> (byteIndex * 8)) & 0xFF);
+			hash *= 1099511628211ULL;
+		}
+	};
+
+	hashValue((int32_t)localPoints.size());
+	for (int pointIndex = 0; pointIndex < (int)localPoints.size(); pointIndex++)
+	{
+		hashValue((int32_t)floorf(localPoints[pointIndex].x / PROTOTYPE_HASH_CELL_SIZE + 0.5f));
+		hashValue((int32_t)floorf(localPoints[pointIndex].y / PROTOTYPE_HASH_CELL_SIZE + 0.5f));
+	}
+
+	return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool InstancedGeometryStore::DoesPrototypeMatch(int prototypeIndex, const std::vector<Vec2>& localPoints) const
+{
+	const GeometryPrototype& prototype = m_prototypes[prototypeIndex];
+	if (prototype.m_numPoints != (int)localPoints.size())
+		return false;
+
+	for (int pointIndex = 0; pointIndex < prototype.m_numPoints; pointIndex++)
+	{
+		Vec2 difference = m_localPoints[prototype.m_firstPoint + pointIndex] - localPoints[pointIndex];
+		if (fabsf(difference.x) > PROTOTYPE_MATCH_TOLERANCE || fabsf(difference.y) > PROTOTYPE_MATCH_TOLERANCE)
+			return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int InstancedGeometryStore::FindOrAddPrototype(const std::vector<Vec2>& localPoints)
+{
+	auto hashRange = m_prototypesByHash.equal_range(HashLocalPoints(localPoints));
+	for (auto hashIterator = hashRange.first; hashIterator != hashRange.second; hashIterator++)
+	{
+		if (DoesPrototypeMatch(hashIterator->second, localPoints))
+			return hashIterator->second;
+	}
+
+	return AddPrototype(localPoints);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int InstancedGeometryStore::FindOrAddPrototypeOfPolygon(const std::vector<Vec2>& worldPoints, Vec2& originOut, std::vector<Vec2>& scratchLocalPoints)
+{
+	Vec2 centroid = Vec2::ZERO;
+	for (int pointIndex = 0; pointIndex < (int)worldPoints.size(); pointIndex++)
+	{
+		centroid += worldPoints[pointIndex];
+	}
+	centroid = centroid / (float)worldPoints.size();
+
+	scratchLocalPoints.clear();
+	for (int pointIndex = 0; pointIndex < (int)worldPoints.size(); pointIndex++)
+	{
+		scratchLocalPoints.push_back(worldPoints[pointIndex] - centroid);
+	}
+
+	originOut = centroid;
+	return FindOrAddPrototype(scratchLocalPoints);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int InstancedGeometryStore::AddInstanceOfPolygon(const std::vector<Vec2>& worldPoints, const BitFieldBroadPhase& broadPhase)
+{
+	std::vector<Vec2> localPoints;
+	InstanceTransform2D transform;
+	int prototypeIndex = FindOrAddPrototypeOfPolygon(worldPoints, transform.m_position, localPoints);
+	return AddInstance(prototypeIndex, transform, broadPhase);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+size_t InstancedGeometryStore::GetPrototypeDataBytes() const
+{
+	return m_localDistance.size() * 3 * sizeof(float) + m_localPoints.size() * sizeof(Vec2) + m_prototypes.size() * sizeof(GeometryPrototype);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+size_t InstancedGeometryStore::GetUnsharedPrototypeDataBytes() const
+{
+	size_t numBytes = 0;
+	for (int instanceIndex = 0; instanceIndex < (int)m_instances.size(); instanceIndex++)
+	{
+		const GeometryPrototype& prototype = m_prototypes[m_instances[instanceIndex].m_prototypeIndex];
+		numBytes += prototype.m_numPlanes * 3 * sizeof(float) + prototype.m_numPoints * sizeof(Vec2) + sizeof(GeometryPrototype);
+	}
+
+	return numBytes;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int InstancedGeometryStore::AddInstance(int prototypeIndex, const InstanceTransform2D& transform, const BitFieldBroadPhase& broadPhase)
+{
+	GeometryInstance instance;
+	instance.m_prototypeIndex = prototypeIndex;
+	m_instances.push_back(instance);
+
+	int instanceIndex = (int)m_instances.size() - 1;
+	SetInstanceTransform(instanceIndex, transform, broadPhase);
+	return instanceIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedGeometryStore::SetInstanceTransform(int instanceIndex, const InstanceTransform2D& transform, const BitFieldBroadPhase& broadPhase)
+{
+	GeometryInstance& instance = m_instances[instanceIndex];
+
+	float rotationRadians = transform.m_rotationDegrees * INSTANCE_DEGREES_TO_RADIANS;
+	instance.m_transform = transform;
+	instance.m_axisX = Vec2(cosf(rotationRadians), sinf(rotationRadians));
+
+	RefitInstanceBounds(instance, broadPhase);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedGeometryStore::RefitInstanceBounds(GeometryInstance& instance, const BitFieldBroadPhase& broadPhase) const
+{
+	//World box around the turned local box, its half extents are the local ones through the absolute rotation
+	const GeometryPrototype& prototype = m_prototypes[instance.m_prototypeIndex];
+	const Vec2& axisX = instance.m_axisX;
+	Vec2 axisY(-axisX.y, axisX.x);
+	float scale = instance.m_transform.m_scale;
+
+	Vec2 worldCenter = instance.m_transform.m_position + (axisX * prototype.m_localCenter.x + axisY * prototype.m_localCenter.y) * scale;
+	float cosine = fabsf(axisX.x);
+	float sine = fabsf(axisX.y);
+	Vec2 worldHalfExtents = Vec2(cosine * prototype.m_localHalfExtents.x + sine * prototype.m_localHalfExtents.y,
+		sine * prototype.m_localHalfExtents.x + cosine * prototype.m_localHalfExtents.y) * scale;
+
+	instance.m_worldMins = worldCenter - worldHalfExtents;
+	instance.m_worldMaxs = worldCenter + worldHalfExtents;
+	instance.m_bitFieldsXY = broadPhase.GetRegionIDForMinMaxs(instance.m_worldMins, instance.m_worldMaxs);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int InstancedGeometryStore::RaycastClosest(RayHit2D& hitOut, const Ray2D& ray, float maxTime) const
+{
+	float bestTime = maxTime;
+	Vec2 bestNormal = Vec2::ZERO;
+	int bestInstance = -1;
+
+	for (int instanceIndex = 0; instanceIndex < (int)m_instances.size(); instanceIndex++)
+	{
+		const GeometryInstance& instance = m_instances[instanceIndex];
+		if ((ray.m_bitFieldsXY.x & instance.m_bitFieldsXY.x) == 0 || (ray.m_bitFieldsXY.y & instance.m_bitFieldsXY.y) == 0)
+			continue;
+
+		//Into local space, the direction stays unit length so local times are world times over the scale
+		const Vec2& axisX = instance.m_axisX;
+		float inverseScale = 1.f / instance.m_transform.m_scale;
+		Vec2 startFromPosition = ray.m_start - instance.m_transform.m_position;
+		float localStartX = (startFromPosition.x * axisX.x + startFromPosition.y * axisX.y) * inverseScale;
+		float localStartY = (startFromPosition.y * axisX.x - startFromPosition.x * axisX.y) * inverseScale;
+		float localDirectionX = ray.m_direction.x * axisX.x + ray.m_direction.y * axisX.y;
+		float localDirectionY = ray.m_direction.y * axisX.x - ray.m_direction.x * axisX.y;
+
+		const GeometryPrototype& prototype = m_prototypes[instance.m_prototypeIndex];
+		float tEnter = -FLT_MAX;
+		float tExit = FLT_MAX;
+		int enterPlane = -1;
+		bool isSeparated = false;
+
+		int planeEnd = prototype.m_firstPlane + prototype.m_numPlanes;
+		for (int planeIndex = prototype.m_firstPlane; planeIndex < planeEnd; planeIndex++)
+		{
+			float denominator = m_localNormalX[planeIndex] * localDirectionX + m_localNormalY[planeIndex] * localDirectionY;
+			float startDistance = m_localDistance[planeIndex] - (m_localNormalX[planeIndex] * localStartX + m_localNormalY[planeIndex] * localStartY);
+
+			if (denominator == 0.f)
+			{
+				isSeparated |= startDistance < 0.f;
+				continue;
+			}
+
+			float time = startDistance / denominator;
+			if (denominator < 0.f && time > tEnter)
+			{
+				tEnter = time;
+				enterPlane = planeIndex;
+			}
+			else if (denominator > 0.f && time < tExit)
+			{
+				tExit = time;
+			}
+		}
+
+		float worldTime = tEnter * instance.m_transform.m_scale;
+		if (isSeparated || enterPlane < 0 || tEnter > tExit || tEnter < 0.f || worldTime >= bestTime)
+			continue;
+
+		//Back out to world space, uniform scale leaves the normal alone
+		bestTime = worldTime;
+		bestNormal = Vec2(m_localNormalX[enterPlane] * axisX.x - m_localNormalY[enterPlane] * axisX.y, m_localNormalX[enterPlane] * axisX.y + m_localNormalY[enterPlane] * axisX.x);
+		bestInstance = instanceIndex;
+	}
+
+	if (bestInstance < 0)
+		return -1;
+
+	hitOut.m_timeAtHit = bestTime;
+	hitOut.m_hitPoint = ray.GetPointAtTime(bestTime);
+	hitOut.m_impactNormal = bestNormal;
+	return bestInstance;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void InstancedGeometryStore::GetInstanceWorldPoints(int instanceIndex, std::vector<Vec2>& pointsOut) const
+{
+	const GeometryInstance& instance = m_instances[instanceIndex];
+	const GeometryPrototype& prototype = m_prototypes[instance.m_prototypeIndex];
+	const Vec2& axisX = instance.m_axisX;
+	Vec2 axisY(-axisX.y, axisX.x);
+	float scale = instance.m_transform.m_scale;
+
+	pointsOut.clear();
+	for (int pointIndex = prototype.m_firstPoint; pointIndex < prototype.m_firstPoint + prototype.m_numPoints; pointIndex++)
+	{
+		const Vec2& localPoint = m_localPoints[pointIndex];
+		pointsOut.push_back(instance.m_transform.m_position + (axisX * localPoint.x + axisY * localPoint.y) * scale);
+	}
+}
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Ray2D.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Game/GameCommon.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class BitFieldBroadPhase;
+
+constexpr float PROTOTYPE_MATCH_TOLERANCE = 1.f / 1024.f;	//Centroid relative points closer than this count as the same shape
+constexpr float PROTOTYPE_HASH_CELL_SIZE = 1.f / 16.f;		//Points are snapped to this for hashing, coarse so float noise rarely crosses a cell
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Local to world is scale, then rotate, then move. Scale is uniform so ray times and normals carry over unchanged
+struct InstanceTransform2D
+{
+	Vec2	m_position = Vec2::ZERO;
+	float	m_rotationDegrees = 0.f;
+	float	m_scale = 1.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Shape shared by every instance of it, in local space around its own origin. Planes are made once and never change
+struct GeometryPrototype
+{
+	int						m_firstPlane = 0;
+	int						m_numPlanes = 0;
+	int						m_firstPoint = 0;
+	int						m_numPoints = 0;
+	uint64_t				m_contentHash = 0;
+	Vec2					m_localCenter = Vec2::ZERO;		//Of the local bounds
+	Vec2					m_localHalfExtents = Vec2::ZERO;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct GeometryInstance
+{
+	int						m_prototypeIndex = -1;
+	InstanceTransform2D		m_transform;
+	Vec2					m_axisX = Vec2(1.f, 0.f);		//Rotation cached as a unit vector
+	IntVec2					m_bitFieldsXY = IntVec2::ZERO;
+	Vec2					m_worldMins = Vec2::ZERO;
+	Vec2					m_worldMaxs = Vec2::ZERO;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Geometry as shared local space hulls placed by per instance transforms
+//Moving, turning or scaling an instance only refits its world bounds and bit fields from the transformed local bounds,
+//the planes stay in local space and rays are taken into the instance's space for the narrowphase instead
+//Polygons added from world points are hashed relative to their centroid, copies of a shape already in the store
+//share its prototype and only add an instance placed at their centroid
+//------------------------------------------------------------------------------------------------------------------------------
+class InstancedGeometryStore
+{
+public:
+	InstancedGeometryStore();
+	~InstancedGeometryStore();
+
+	void					Clear();
+	void					ClearInstances();		//Keeps the prototypes, for placing the same shapes again
+
+	//Points are counter clockwise in local space, returns the prototype index
+	int						AddPrototype(const std::vector<Vec2>& localPoints);
+	int						AddInstance(int prototypeIndex, const InstanceTransform2D& transform, const BitFieldBroadPhase& broadPhase);
+
+	//Returns a prototype with the same points within PROTOTYPE_MATCH_TOLERANCE, adding one when there is none
+	int						FindOrAddPrototype(const std::vector<Vec2>& localPoints);
+
+	//Prototype of the polygon's shape around its centroid, which is written to originOut. Returns the prototype index
+	int						FindOrAddPrototypeOfPolygon(const std::vector<Vec2>& worldPoints, Vec2& originOut, std::vector<Vec2>& scratchLocalPoints);
+
+	//Instance of the polygon placed at its centroid, returns the instance index
+	int						AddInstanceOfPolygon(const std::vector<Vec2>& worldPoints, const BitFieldBroadPhase& broadPhase);
+	void					SetInstanceTransform(int instanceIndex, const InstanceTransform2D& transform, const BitFieldBroadPhase& broadPhase);
+
+	//Returns the index of the closest instance entered by the ray with time in [0, maxTime) or -1 on a miss
+	//Needs the ray's bit fields, rays that start inside an instance do not report it
+	int						RaycastClosest(RayHit2D& hitOut, const Ray2D& ray, float maxTime = MAX_RAYCAST_TIME) const;
+
+	void					GetInstanceWorldPoints(int instanceIndex, std::vector<Vec2>& pointsOut) const;
+
+	int						GetNumPrototypes() const { return (int)m_prototypes.size(); }
+	int						GetNumInstances() const { return (int)m_instances.size(); }
+	const GeometryInstance&	GetInstance(int instanceIndex) const { return m_instances[instanceIndex]; }
+
+	//Bytes of local planes and points held, and what the instances would hold with a prototype each
+	size_t					GetPrototypeDataBytes() const;
+	size_t					GetUnsharedPrototypeDataBytes() const;
+
+private:
+	void					RefitInstanceBounds(GeometryInstance& instance, const BitFieldBroadPhase& broadPhase) const;
+	static uint64_t			HashLocalPoints(const std::vector<Vec2>& localPoints);
+	bool					DoesPrototypeMatch(int prototypeIndex, const std::vector<Vec2>& localPoints) const;
+
+private:
+	std::vector<GeometryPrototype>	m_prototypes;
+	std::vector<GeometryInstance>	m_instances;
+
+	//Local space planes and points of every prototype back to back
+	std::vector<float>		m_localNormalX;
+	std::vector<float>		m_localNormalY;
+	std::vector<float>		m_localDistance;
+	std::vector<Vec2>		m_localPoints;
+
+	//Content hash to the prototypes with it, more than one only when different shapes collide
+	std::unordered_multimap<uint64_t, int>	m_prototypesByHash;
+};
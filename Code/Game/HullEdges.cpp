@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/HullEdges.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/Geometry.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec2 GetClosestPointOnSegment(const Vec2& point, const Vec2& segmentStart, const Vec2& segmentEnd)
+{
+	Vec2 segment = segmentEnd - segmentStart;
+	float lengthSquared = segment.x * segment.x + segment.y * segment.y;
+	if (lengthSquared == 0.f)
+		return segmentStart;
+
+	Vec2 toPoint = point - segmentStart;
+	float fraction = Clamp((toPoint.x * segment.x + toPoint.y * segment.y) / lengthSquared, 0.f, 1.f);
+	return segmentStart + fraction * segment;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HullEdgeArrays::Clear()
+{
+	m_vertexX.clear();
+	m_vertexY.clear();
+	m_normalX.clear();
+	m_normalY.clear();
+	m_distance.clear();
+	m_vertexOffsets.clear();
+
+	m_hullMins.clear();
+	m_hullMaxs.clear();
+	m_bitFields.clear();
+	m_geometryIndices.clear();
+	m_hullIndexForGeometry.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HullEdgeArrays::BuildFromGeometry(const std::vector<Geometry>& geometry)
+{
+	Clear();
+	m_vertexOffsets.push_back(0);
+	m_hullIndexForGeometry.assign(geometry.size(), -1);
+
+	for (int geometryIndex = 0; geometryIndex < (int)geometry.size(); geometryIndex++)
+	{
+		const std::vector<Vec2>& points = geometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+		int numPoints = (int)points.size();
+		if (numPoints < 3)
+			continue;
+
+		m_hullIndexForGeometry[geometryIndex] = (int)m_geometryIndices.size();
+
+		//Winding decides which side of each edge is outside
+		float doubleArea = 0.f;
+		for (int pointIndex = 0; pointIndex < numPoints; pointIndex++)
+		{
+			const Vec2& point = points[pointIndex];
+			const Vec2& nextPoint = points[(pointIndex + 1) % numPoints];
+			doubleArea += point.x * nextPoint.y - nextPoint.x * point.y;
+		}
+		float windingSign = (doubleArea >= 0.f) ? 1.f : -1.f;
+
+		Vec2 hullMins = points[0];
+		Vec2 hullMaxs = points[0];
+		for (int pointIndex = 0; pointIndex < numPoints; pointIndex++)
+		{
+			const Vec2& point = points[pointIndex];
+			const Vec2& nextPoint = points[(pointIndex + 1) % numPoints];
+
+			Vec2 normal = windingSign * Vec2(nextPoint.y - point.y, point.x - nextPoint.x);
+			normal.Normalize();
+
+			m_vertexX.push_back(point.x);
+			m_vertexY.push_back(point.y);
+			m_normalX.push_back(normal.x);
+			m_normalY.push_back(normal.y);
+			m_distance.push_back(normal.x * point.x + normal.y * point.y);
+
+			hullMins.x = GetLowerValue(hullMins.x, point.x);
+			hullMins.y = GetLowerValue(hullMins.y, point.y);
+			hullMaxs.x = GetHigherValue(hullMaxs.x, point.x);
+			hullMaxs.y = GetHigherValue(hullMaxs.y, point.y);
+		}
+
+		m_vertexOffsets.push_back((int)m_vertexX.size());
+		m_hullMins.push_back(hullMins);
+		m_hullMaxs.push_back(hullMaxs);
+		m_bitFields.push_back(geometry[geometryIndex].GetBitFields());
+		m_geometryIndices.push_back(geometryIndex);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int HullEdgeArrays::RefitMovedGeometry(const std::vector<Geometry>& geometry, int geometryIndex)
+{
+	int hullIndex = m_hullIndexForGeometry[geometryIndex];
+	if (hullIndex < 0)
+		return -1;
+
+	const std::vector<Vec2>& points = geometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+	int vertexStart = m_vertexOffsets[hullIndex];
+	Vec2 hullMins = points[0];
+	Vec2 hullMaxs = points[0];
+	for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+	{
+		const Vec2& point = points[pointIndex];
+		int vertexIndex = vertexStart + pointIndex;
+
+		m_vertexX[vertexIndex] = point.x;
+		m_vertexY[vertexIndex] = point.y;
+		m_distance[vertexIndex] = m_normalX[vertexIndex] * point.x + m_normalY[vertexIndex] * point.y;
+
+		hullMins.x = GetLowerValue(hullMins.x, point.x);
+		hullMins.y = GetLowerValue(hullMins.y, point.y);
+		hullMaxs.x = GetHigherValue(hullMaxs.x, point.x);
+		hullMaxs.y = GetHigherValue(hullMaxs.y, point.y);
+	}
+
+	m_hullMins[hullIndex] = hullMins;
+	m_hullMaxs[hullIndex] = hullMaxs;
+	return hullIndex;
+}
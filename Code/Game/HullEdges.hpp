@@ -0,0 +1,41 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec2	GetClosestPointOnSegment(const Vec2& point, const Vec2& segmentStart, const Vec2& segmentEnd);
+
+//------------------------------------------------------------------------------------------------------------------------------
+//SoA vertices and outward edge planes of the scene polygons, shared by the queries that walk hull edges
+//Hull i owns vertices and edges [m_vertexOffsets[i], m_vertexOffsets[i + 1]), edge j runs from vertex j to vertex j + 1
+//Normals come from the polygon winding so clockwise and counter clockwise polygons both face out
+//------------------------------------------------------------------------------------------------------------------------------
+struct HullEdgeArrays
+{
+	std::vector<float>		m_vertexX;
+	std::vector<float>		m_vertexY;
+	std::vector<float>		m_normalX;
+	std::vector<float>		m_normalY;
+	std::vector<float>		m_distance;
+	std::vector<int>		m_vertexOffsets;
+
+	std::vector<Vec2>		m_hullMins;
+	std::vector<Vec2>		m_hullMaxs;
+	std::vector<IntVec2>	m_bitFields;
+	std::vector<int>		m_geometryIndices;			//Ascending, geometry with too few points to be a hull is skipped
+	std::vector<int>		m_hullIndexForGeometry;		//-1 for geometry with too few points to be a hull
+
+	void					Clear();
+	void					BuildFromGeometry(const std::vector<Geometry>& geometry);
+
+	//Moving keeps the normals, only the vertices, plane distances and bounds follow the polygon. The bit fields are left
+	//to the caller, which may need the old ones. Returns the hull index or -1 for geometry without a hull
+	int						RefitMovedGeometry(const std::vector<Geometry>& geometry, int geometryIndex);
+
+	int						GetNumHulls() const { return (int)m_geometryIndices.size(); }
+};
@@ -0,0 +1,584 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/HullStore.hpp"
+#include "Engine/Math/ConvexHull2D.hpp"
+#include "Game/Geometry.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Running state while a ray is clipped against the planes of a single hull
+struct RayClipState
+{
+	float	m_tEnter = -FLT_MAX;
+	float	m_tExit = FLT_MAX;
+	int		m_enterPlane = 0;
+	bool	m_isSeparated = false;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Closest hit found so far across all the groups
+struct RaycastBestHit
+{
+	float	m_time = MAX_RAYCAST_TIME;
+	Vec2	m_normal = Vec2::ZERO;
+	int		m_geometryIndex = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static inline void ClipRayAgainstPlane(float normalX, float normalY, float distance, const Vec2& localStart, const Vec2& direction, int planeIndex, RayClipState& state)
+{
+	float denominator = normalX * direction.x + normalY * direction.y;
+	float startDistance = distance - (normalX * localStart.x + normalY * localStart.y);	//Positive when the start is behind the plane
+
+	//Written with selects so the compiler can keep the unrolled kernels free of branches
+	bool isParallel = (denominator == 0.f);
+	float time = startDistance / (isParallel ? 1.f : denominator);
+
+	bool isEntering = (denominator < 0.f) && (time > state.m_tEnter);
+	state.m_tEnter = isEntering ? time : state.m_tEnter;
+	state.m_enterPlane = isEntering ? planeIndex : state.m_enterPlane;
+
+	bool isExiting = (denominator > 0.f) && (time < state.m_tExit);
+	state.m_tExit = isExiting ? time : state.m_tExit;
+
+	state.m_isSeparated |= isParallel && (startDistance < 0.f);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <size_t... PLANE_INDICES>
+static inline void ClipRayAgainstHullUnrolled(const float* normalX, const float* normalY, const float* distance, const Vec2& localStart, const Vec2& direction, RayClipState& state, std::index_sequence<PLANE_INDICES...>)
+{
+	(ClipRayAgainstPlane(normalX[PLANE_INDICES], normalY[PLANE_INDICES], distance[PLANE_INDICES], localStart, direction, (int)PLANE_INDICES, state), ...);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static inline bool IsBroadPhaseOverlapping(const IntVec2& rayBitFields, const IntVec2& hullBitFields)
+{
+	return ((rayBitFields.x & hullBitFields.x) != 0) && ((rayBitFields.y & hullBitFields.y) != 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static inline void ResolveClipState(const RayClipState& state, const HullGroup& group, int hullIndex, int planeStart, RaycastBestHit& best)
+{
+	if (!state.m_isSeparated && state.m_tEnter >= 0.f && state.m_tEnter <= state.m_tExit && state.m_tEnter < best.m_time)
+	{
+		int planeIndex = planeStart + state.m_enterPlane;
+
+		best.m_time = state.m_tEnter;
+		best.m_normal = Vec2(group.m_normalX[planeIndex], group.m_normalY[planeIndex]);
+		best.m_geometryIndex = group.m_geometryIndices[hullIndex];
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <int NUM_PLANES>
+static void RaycastSpecializedGroup(const HullGroup& group, const Ray2D& ray, bool useBroadPhase, RaycastBestHit& best)
+{
+	int numHulls = group.GetNumHulls();
+	for (int hullIndex = 0; hullIndex < numHulls; hullIndex++)
+	{
+		if (useBroadPhase && !IsBroadPhaseOverlapping(ray.m_bitFieldsXY, group.m_bitFields[hullIndex]))
+			continue;
+
+		int planeStart = group.m_prototypeSlots[hullIndex] * NUM_PLANES;
+		Vec2 localStart = Vec2(ray.m_start.x - group.m_offsetX[hullIndex], ray.m_start.y - group.m_offsetY[hullIndex]);
+
+		RayClipState state;
+		ClipRayAgainstHullUnrolled(&group.m_normalX[planeStart], &group.m_normalY[planeStart], &group.m_distance[planeStart], localStart, ray.m_direction, state, std::make_index_sequence<NUM_PLANES>());
+
+		ResolveClipState(state, group, hullIndex, planeStart, best);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void RaycastGenericGroup(const HullGroup& group, const Ray2D& ray, bool useBroadPhase, RaycastBestHit& best)
+{
+	int numHulls = group.GetNumHulls();
+	for (int hullIndex = 0; hullIndex < numHulls; hullIndex++)
+	{
+		if (useBroadPhase && !IsBroadPhaseOverlapping(ray.m_bitFieldsXY, group.m_bitFields[hullIndex]))
+			continue;
+
+		int prototypeSlot = group.m_prototypeSlots[hullIndex];
+		int planeStart = group.m_planeOffsets[prototypeSlot];
+		int planeEnd = group.m_planeOffsets[prototypeSlot + 1];
+		Vec2 localStart = Vec2(ray.m_start.x - group.m_offsetX[hullIndex], ray.m_start.y - group.m_offsetY[hullIndex]);
+
+		RayClipState state;
+		for (int planeIndex = planeStart; planeIndex < planeEnd; planeIndex++)
+		{
+			ClipRayAgainstPlane(group.m_normalX[planeIndex], group.m_normalY[planeIndex], group.m_distance[planeIndex], localStart, ray.m_direction, planeIndex - planeStart, state);
+		}
+
+		ResolveClipState(state, group, hullIndex, planeStart, best);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void RaycastLargeHulls(const std::vector<LargeHull>& largeHulls, const Ray2D& ray, bool useBroadPhase, RaycastBestHit& best)
+{
+	for (int hullIndex = 0; hullIndex < (int)largeHulls.size(); hullIndex++)
+	{
+		const LargeHull& largeHull = largeHulls[hullIndex];
+		if (useBroadPhase && !IsBroadPhaseOverlapping(ray.m_bitFieldsXY, largeHull.m_bitFields))
+			continue;
+
+		Ray2D localRay = ray;
+		localRay.m_start -= largeHull.m_offset;
+
+		float tEnter;
+		float tExit;
+		int enterEdge;
+		if (!largeHull.ClipLine(localRay, tEnter, tExit, enterEdge))
+			continue;
+
+		if (tEnter >= 0.f && tEnter < best.m_time)
+		{
+			best.m_time = tEnter;
+			best.m_normal = largeHull.m_normals[enterEdge];
+			best.m_geometryIndex = largeHull.m_geometryIndex;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//atan2f gives (-PI, PI] except for -PI on a -0 y, which is folded back to PI so the sorted angles and the queries agree on the seam
+//The literal rounds to the same float as that -PI and nothing atan2f returns is below it, so <= only catches the seam
+static float GetNormalAngle(const Vec2& direction)
+{
+	float angle = atan2f(direction.y, direction.x);
+	return (angle <= -3.14159265f) ? -angle : angle;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LargeHull::MakeFromPlanes(const std::vector<Plane2D>& planes)
+{
+	int numPlanes = (int)planes.size();
+
+	std::vector<int> sortedOrder(numPlanes);
+	std::vector<float> angles(numPlanes);
+	for (int planeIndex = 0; planeIndex < numPlanes; planeIndex++)
+	{
+		sortedOrder[planeIndex] = planeIndex;
+		angles[planeIndex] = GetNormalAngle(planes[planeIndex].GetNormal());
+	}
+
+	std::sort(sortedOrder.begin(), sortedOrder.end(), [&angles](int lhs, int rhs) { return angles[lhs] < angles[rhs]; });
+
+	m_normalAngles.resize(numPlanes);
+	m_normals.resize(numPlanes);
+	m_distances.resize(numPlanes);
+	for (int sortedIndex = 0; sortedIndex < numPlanes; sortedIndex++)
+	{
+		const Plane2D& plane = planes[sortedOrder[sortedIndex]];
+		m_normalAngles[sortedIndex] = angles[sortedOrder[sortedIndex]];
+		m_normals[sortedIndex] = plane.GetNormal();
+		m_distances[sortedIndex] = plane.GetSignedDistance();
+	}
+
+	//Vertex i is shared by plane i - 1 and plane i
+	m_vertices.resize(numPlanes);
+	for (int planeIndex = 0; planeIndex < numPlanes; planeIndex++)
+	{
+		int previousIndex = (planeIndex + numPlanes - 1) % numPlanes;
+		const Vec2& normalA = m_normals[previousIndex];
+		const Vec2& normalB = m_normals[planeIndex];
+		float distanceA = m_distances[previousIndex];
+		float distanceB = m_distances[planeIndex];
+
+		float determinant = normalA.x * normalB.y - normalA.y * normalB.x;
+		m_vertices[planeIndex].x = (distanceA * normalB.y - distanceB * normalA.y) / determinant;
+		m_vertices[planeIndex].y = (normalA.x * distanceB - normalB.x * distanceA) / determinant;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int LargeHull::GetSupportVertexIndex(const Vec2& direction) const
+{
+	//The vertex furthest along direction sits between the last edge with a smaller normal angle and the first with a larger one
+	//Past the last angle (up to PI) wraps to the first edge, since the angles go around the circle
+	float angle = GetNormalAngle(direction);
+	int edgeIndex = (int)(std::lower_bound(m_normalAngles.begin(), m_normalAngles.end(), angle) - m_normalAngles.begin());
+	if (edgeIndex == (int)m_normalAngles.size())
+	{
+		edgeIndex = 0;
+	}
+
+	return edgeIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LargeHull::ClipLine(const Ray2D& ray, float& tEnterOut, float& tExitOut, int& enterEdgeOut) const
+{
+	int numVertices = (int)m_vertices.size();
+	if (numVertices < 3)
+		return false;
+
+	Vec2 lineNormal = Vec2(-ray.m_direction.y, ray.m_direction.x);
+	float lineOffset = lineNormal.x * ray.m_start.x + lineNormal.y * ray.m_start.y;
+
+	//Support points across the line tell us if the line touches the hull at all
+	int minIndex = GetSupportVertexIndex(-lineNormal);
+	int maxIndex = GetSupportVertexIndex(lineNormal);
+
+	float minOffset = lineNormal.x * m_vertices[minIndex].x + lineNormal.y * m_vertices[minIndex].y;
+	float maxOffset = lineNormal.x * m_vertices[maxIndex].x + lineNormal.y * m_vertices[maxIndex].y;
+	if (lineOffset < minOffset || lineOffset > maxOffset || minIndex == maxIndex)
+		return false;
+
+	//Going around from the min to the max support point the offset increases, coming back it decreases
+	//Binary search each chain for the edge the line crosses
+	int crossingEdges[2];
+	for (int chainIndex = 0; chainIndex < 2; chainIndex++)
+	{
+		int chainStart = (chainIndex == 0) ? minIndex : maxIndex;
+		int chainEnd = (chainIndex == 0) ? maxIndex : minIndex;
+		int chainLength = (chainEnd - chainStart + numVertices) % numVertices;
+		float chainSign = (chainIndex == 0) ? 1.f : -1.f;
+
+		//Largest step along the chain whose vertex has not passed the line yet
+		int low = 0;
+		int high = chainLength - 1;
+		while (low < high)
+		{
+			int middle = (low + high + 1) / 2;
+			const Vec2& vertex = m_vertices[(chainStart + middle) % numVertices];
+			float offset = lineNormal.x * vertex.x + lineNormal.y * vertex.y;
+
+			if (chainSign * offset <= chainSign * lineOffset)
+			{
+				low = middle;
+			}
+			else
+			{
+				high = middle - 1;
+			}
+		}
+
+		crossingEdges[chainIndex] = (chainStart + low) % numVertices;
+	}
+
+	//Intersect the line with the planes of both crossing edges, the planes are exact where the vertices are derived
+	float crossingTimes[2];
+	for (int crossingIndex = 0; crossingIndex < 2; crossingIndex++)
+	{
+		const Vec2& normal = m_normals[crossingEdges[crossingIndex]];
+		float denominator = normal.x * ray.m_direction.x + normal.y * ray.m_direction.y;
+		float startDistance = m_distances[crossingEdges[crossingIndex]] - (normal.x * ray.m_start.x + normal.y * ray.m_start.y);
+
+		crossingTimes[crossingIndex] = (denominator != 0.f) ? startDistance / denominator : 0.f;
+	}
+
+	int enterCrossing = (crossingTimes[0] <= crossingTimes[1]) ? 0 : 1;
+	tEnterOut = crossingTimes[enterCrossing];
+	tExitOut = crossingTimes[1 - enterCrossing];
+	enterEdgeOut = crossingEdges[enterCrossing];
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//The geometry's world planes moved back by its prototype offset, a plane's distance changes by the offset along its normal
+static void GetLocalPlanes(const Geometry& geometry, std::vector<Plane2D>& localPlanesOut)
+{
+	const std::vector<Plane2D>& planes = geometry.GetConvexHull2D().GetPlanes();
+	const Vec2& offset = geometry.GetPrototypeOffset();
+
+	localPlanesOut.resize(planes.size());
+	for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++)
+	{
+		const Vec2& normal = planes[planeIndex].GetNormal();
+		float distance = planes[planeIndex].GetSignedDistance() - (normal.x * offset.x + normal.y * offset.y);
+		localPlanesOut[planeIndex] = Plane2D(normal, distance);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HullGroup::Clear()
+{
+	m_normalX.clear();
+	m_normalY.clear();
+	m_distance.clear();
+	m_planeOffsets.clear();
+	m_prototypeSlots.clear();
+	m_offsetX.clear();
+	m_offsetY.clear();
+	m_geometryIndices.clear();
+	m_bitFields.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int HullGroup::AddPrototype(const Geometry& geometry)
+{
+	int prototypeSlot = GetNumPrototypes();
+
+	std::vector<Plane2D> localPlanes;
+	GetLocalPlanes(geometry, localPlanes);
+
+	if (m_numPlanes == 0 && m_planeOffsets.empty())
+	{
+		m_planeOffsets.push_back(0);
+	}
+
+	for (int planeIndex = 0; planeIndex < (int)localPlanes.size(); planeIndex++)
+	{
+		m_normalX.push_back(localPlanes[planeIndex].GetNormal().x);
+		m_normalY.push_back(localPlanes[planeIndex].GetNormal().y);
+		m_distance.push_back(localPlanes[planeIndex].GetSignedDistance());
+	}
+
+	if (m_numPlanes == 0)
+	{
+		m_planeOffsets.push_back((int)m_distance.size());
+	}
+
+	return prototypeSlot;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HullGroup::AddHull(int geometryIndex, int prototypeSlot, const Geometry& geometry)
+{
+	m_prototypeSlots.push_back(prototypeSlot);
+	m_offsetX.push_back(geometry.GetPrototypeOffset().x);
+	m_offsetY.push_back(geometry.GetPrototypeOffset().y);
+	m_geometryIndices.push_back(geometryIndex);
+	m_bitFields.push_back(geometry.GetBitFields());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int HullGroup::GetNumPrototypes() const
+{
+	if (m_numPlanes > 0)
+		return (int)m_distance.size() / m_numPlanes;
+
+	return m_planeOffsets.empty() ? 0 : (int)m_planeOffsets.size() - 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int HullGroup::GetPlaneStart(int prototypeSlot) const
+{
+	return (m_numPlanes > 0) ? prototypeSlot * m_numPlanes : m_planeOffsets[prototypeSlot];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int HullGroup::GetPlaneEnd(int prototypeSlot) const
+{
+	return (m_numPlanes > 0) ? (prototypeSlot + 1) * m_numPlanes : m_planeOffsets[prototypeSlot + 1];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+HullStore::HullStore()
+{
+	for (int groupIndex = 0; groupIndex < NUM_SPECIALIZED_HULL_GROUPS; groupIndex++)
+	{
+		m_specializedGroups[groupIndex].m_numPlanes = MIN_SPECIALIZED_PLANE_COUNT + groupIndex;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+HullStore::~HullStore()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HullStore::BuildFromGeometry(const std::vector<Geometry>& geometry)
+{
+	Clear();
+	m_hullSlots.resize(geometry.size());
+
+	//Prototype slot already made for each prototype index and plane count, the plane count is part of the key since
+	//polygons matched within the prototype tolerance could still have made a different number of planes
+	std::unordered_map<long long, int> prototypeSlots;
+
+	for (int geometryIndex = 0; geometryIndex < (int)geometry.size(); geometryIndex++)
+	{
+		const Geometry& currentGeometry = geometry[geometryIndex];
+		int numPlanes = currentGeometry.GetConvexHull2D().GetNumPlanes();
+
+		if (numPlanes >= MIN_LARGE_HULL_PLANE_COUNT)
+		{
+			//Large hulls are rare enough that each keeps its own local planes
+			std::vector<Plane2D> localPlanes;
+			GetLocalPlanes(currentGeometry, localPlanes);
+
+			m_hullSlots[geometryIndex] = IntVec2(NUM_SPECIALIZED_HULL_GROUPS + 1, (int)m_largeHulls.size());
+			m_largeHulls.emplace_back();
+			LargeHull& largeHull = m_largeHulls.back();
+			largeHull.m_geometryIndex = geometryIndex;
+			largeHull.m_bitFields = currentGeometry.GetBitFields();
+			largeHull.m_offset = currentGeometry.GetPrototypeOffset();
+			largeHull.MakeFromPlanes(localPlanes);
+			continue;
+		}
+
+		bool isSpecialized = (numPlanes >= MIN_SPECIALIZED_PLANE_COUNT && numPlanes <= MAX_SPECIALIZED_PLANE_COUNT);
+		int groupIndex = isSpecialized ? numPlanes - MIN_SPECIALIZED_PLANE_COUNT : NUM_SPECIALIZED_HULL_GROUPS;
+		HullGroup& group = isSpecialized ? m_specializedGroups[groupIndex] : m_genericGroup;
+
+		//Geometry without a prototype gets planes of its own
+		int prototypeSlot = -1;
+		int prototypeIndex = currentGeometry.GetPrototypeIndex();
+		long long prototypeKey = ((long long)prototypeIndex << 32) | (long long)numPlanes;
+		if (prototypeIndex >= 0)
+		{
+			std::unordered_map<long long, int>::const_iterator foundSlot = prototypeSlots.find(prototypeKey);
+			if (foundSlot != prototypeSlots.end())
+			{
+				prototypeSlot = foundSlot->second;
+			}
+		}
+
+		if (prototypeSlot < 0)
+		{
+			prototypeSlot = group.AddPrototype(currentGeometry);
+			if (prototypeIndex >= 0)
+			{
+				prototypeSlots[prototypeKey] = prototypeSlot;
+			}
+		}
+
+		m_hullSlots[geometryIndex] = IntVec2(groupIndex, group.GetNumHulls());
+		group.AddHull(geometryIndex, prototypeSlot, currentGeometry);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HullStore::RefitMovedGeometry(const std::vector<Geometry>& geometry, const std::vector<int>& movedGeometryIndices)
+{
+	//Moving geometry only changes where its prototype is placed, the shared local planes stay as they are
+	for (int movedIndex = 0; movedIndex < (int)movedGeometryIndices.size(); movedIndex++)
+	{
+		int geometryIndex = movedGeometryIndices[movedIndex];
+		const IntVec2& hullSlot = m_hullSlots[geometryIndex];
+		const Geometry& movedGeometry = geometry[geometryIndex];
+
+		if (hullSlot.x > NUM_SPECIALIZED_HULL_GROUPS)
+		{
+			LargeHull& largeHull = m_largeHulls[hullSlot.y];
+			largeHull.m_bitFields = movedGeometry.GetBitFields();
+			largeHull.m_offset = movedGeometry.GetPrototypeOffset();
+			continue;
+		}
+
+		HullGroup& group = (hullSlot.x < NUM_SPECIALIZED_HULL_GROUPS) ? m_specializedGroups[hullSlot.x] : m_genericGroup;
+		group.m_offsetX[hullSlot.y] = movedGeometry.GetPrototypeOffset().x;
+		group.m_offsetY[hullSlot.y] = movedGeometry.GetPrototypeOffset().y;
+		group.m_bitFields[hullSlot.y] = movedGeometry.GetBitFields();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void HullStore::Clear()
+{
+	for (int groupIndex = 0; groupIndex < NUM_SPECIALIZED_HULL_GROUPS; groupIndex++)
+	{
+		m_specializedGroups[groupIndex].Clear();
+	}
+
+	m_genericGroup.Clear();
+	m_largeHulls.clear();
+	m_hullSlots.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int HullStore::RaycastClosest(RayHit2D& hitOut, const Ray2D& ray, bool useBroadPhase, float maxTime) const
+{
+	RaycastBestHit best;
+	best.m_time = maxTime;
+
+	//One dispatch per group, every hull in a group runs the same unrolled kernel
+	static_assert(NUM_SPECIALIZED_HULL_GROUPS == 6, "Update the group dispatch below to match the specialized plane counts");
+	RaycastSpecializedGroup<3>(m_specializedGroups[0], ray, useBroadPhase, best);
+	RaycastSpecializedGroup<4>(m_specializedGroups[1], ray, useBroadPhase, best);
+	RaycastSpecializedGroup<5>(m_specializedGroups[2], ray, useBroadPhase, best);
+	RaycastSpecializedGroup<6>(m_specializedGroups[3], ray, useBroadPhase, best);
+	RaycastSpecializedGroup<7>(m_specializedGroups[4], ray, useBroadPhase, best);
+	RaycastSpecializedGroup<8>(m_specializedGroups[5], ray, useBroadPhase, best);
+	RaycastGenericGroup(m_genericGroup, ray, useBroadPhase, best);
+	RaycastLargeHulls(m_largeHulls, ray, useBroadPhase, best);
+
+	if (best.m_geometryIndex < 0)
+		return -1;
+
+	hitOut.m_timeAtHit = best.m_time;
+	hitOut.m_hitPoint = ray.GetPointAtTime(best.m_time);
+	hitOut.m_impactNormal = best.m_normal;
+	return best.m_geometryIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const HullGroup& HullStore::GetSpecializedGroup(int numPlanes) const
+{
+	return m_specializedGroups[numPlanes - MIN_SPECIALIZED_PLANE_COUNT];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const HullGroup& HullStore::GetGenericGroup() const
+{
+	return m_genericGroup;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const std::vector<LargeHull>& HullStore::GetLargeHulls() const
+{
+	return m_largeHulls;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int HullStore::GetNumHulls() const
+{
+	int numHulls = m_genericGroup.GetNumHulls() + (int)m_largeHulls.size();
+	for (int groupIndex = 0; groupIndex < NUM_SPECIALIZED_HULL_GROUPS; groupIndex++)
+	{
+		numHulls += m_specializedGroups[groupIndex].GetNumHulls();
+	}
+
+	return numHulls;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int HullStore::GetNumPlaneSets() const
+{
+	int numPlaneSets = m_genericGroup.GetNumPrototypes() + (int)m_largeHulls.size();
+	for (int groupIndex = 0; groupIndex < NUM_SPECIALIZED_HULL_GROUPS; groupIndex++)
+	{
+		numPlaneSets += m_specializedGroups[groupIndex].GetNumPrototypes();
+	}
+
+	return numPlaneSets;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+size_t HullStore::GetPlaneDataBytes() const
+{
+	size_t numPlanes = m_genericGroup.m_distance.size();
+	for (int groupIndex = 0; groupIndex < NUM_SPECIALIZED_HULL_GROUPS; groupIndex++)
+	{
+		numPlanes += m_specializedGroups[groupIndex].m_distance.size();
+	}
+
+	return numPlanes * 3 * sizeof(float) + m_genericGroup.m_planeOffsets.size() * sizeof(int);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+size_t HullStore::GetUnsharedPlaneDataBytes() const
+{
+	size_t numPlanes = 0;
+	for (int groupIndex = 0; groupIndex < NUM_SPECIALIZED_HULL_GROUPS; groupIndex++)
+	{
+		const HullGroup& group = m_specializedGroups[groupIndex];
+		numPlanes += (size_t)group.GetNumHulls() * group.m_numPlanes;
+	}
+
+	for (int hullIndex = 0; hullIndex < m_genericGroup.GetNumHulls(); hullIndex++)
+	{
+		int prototypeSlot = m_genericGroup.m_prototypeSlots[hullIndex];
+		numPlanes += m_genericGroup.GetPlaneEnd(prototypeSlot) - m_genericGroup.GetPlaneStart(prototypeSlot);
+	}
+
+	size_t numPlaneOffsets = (m_genericGroup.GetNumHulls() > 0) ? m_genericGroup.GetNumHulls() + 1 : 0;
+	return numPlanes * 3 * sizeof(float) + numPlaneOffsets * sizeof(int);
+}
@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Ray2D.hpp"
+#include "Game/GameCommon.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+
+//Hulls with plane counts in this range get a kernel unrolled for their exact plane count
+constexpr int MIN_SPECIALIZED_PLANE_COUNT = 3;
+constexpr int MAX_SPECIALIZED_PLANE_COUNT = 8;
+constexpr int NUM_SPECIALIZED_HULL_GROUPS = MAX_SPECIALIZED_PLANE_COUNT - MIN_SPECIALIZED_PLANE_COUNT + 1;
+
+//Hulls with at least this many planes are tested in O(log n) using planes sorted by normal angle
+constexpr int MIN_LARGE_HULL_PLANE_COUNT = 32;
+
+//------------------------------------------------------------------------------------------------------------------------------
+//SoA plane data for a set of hulls. Planes are kept in the local space of each prototype and shared by every hull
+//placed from it, a hull is its prototype slot plus the offset that moves it into the world.
+//Fixed groups store numPlanes planes per prototype back to back, the generic group uses m_planeOffsets to find them
+//------------------------------------------------------------------------------------------------------------------------------
+struct HullGroup
+{
+	int						m_numPlanes = 0;		//0 for the generic group
+
+	//Per prototype
+	std::vector<float>		m_normalX;
+	std::vector<float>		m_normalY;
+	std::vector<float>		m_distance;
+	std::vector<int>		m_planeOffsets;			//numPrototypes + 1 entries, only used by the generic group
+
+	//Per hull
+	std::vector<int>		m_prototypeSlots;
+	std::vector<float>		m_offsetX;
+	std::vector<float>		m_offsetY;
+	std::vector<int>		m_geometryIndices;
+	std::vector<IntVec2>	m_bitFields;
+
+	void					Clear();
+	int						AddPrototype(const Geometry& geometry);	//Stores the geometry's planes moved back by its prototype offset
+	void					AddHull(int geometryIndex, int prototypeSlot, const Geometry& geometry);
+	int						GetNumHulls() const { return (int)m_geometryIndices.size(); }
+	int						GetNumPrototypes() const;
+	int						GetPlaneStart(int prototypeSlot) const;
+	int						GetPlaneEnd(int prototypeSlot) const;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Hull with many planes, stored with its planes sorted by normal angle and the vertex shared by each pair of
+//neighbouring planes. Edge i runs from m_vertices[i] to m_vertices[i + 1] and has normal m_normals[i].
+//The planes are in local space, m_offset moves them into the world
+//------------------------------------------------------------------------------------------------------------------------------
+struct LargeHull
+{
+	int						m_geometryIndex = -1;
+	IntVec2					m_bitFields;
+	Vec2					m_offset = Vec2::ZERO;
+
+	std::vector<float>		m_normalAngles;			//Radians in (-PI, PI], ascending
+	std::vector<Vec2>		m_normals;
+	std::vector<float>		m_distances;
+	std::vector<Vec2>		m_vertices;
+
+	void					MakeFromPlanes(const std::vector<Plane2D>& planes);
+	int						GetSupportVertexIndex(const Vec2& direction) const;
+
+	//Finds the entry and exit of the ray's line with binary searches, returns false if the line misses the hull
+	//The ray is in the hull's local space
+	bool					ClipLine(const Ray2D& ray, float& tEnterOut, float& tExitOut, int& enterEdgeOut) const;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Narrowphase store for the batch raycasts. Hulls are grouped by plane count so each group is dispatched
+//once to its specialized kernel instead of switching per hull. Geometry sharing a prototype shares one set of
+//local planes, rays are moved into that local space by the hull's offset before clipping
+//------------------------------------------------------------------------------------------------------------------------------
+class HullStore
+{
+public:
+	HullStore();
+	~HullStore();
+
+	void					BuildFromGeometry(const std::vector<Geometry>& geometry);
+	void					Clear();
+
+	//Copies the prototype offsets and bit fields of geometry moved since the build into the slots it already has
+	//The local planes are not touched, so the geometry must only have been translated
+	void					RefitMovedGeometry(const std::vector<Geometry>& geometry, const std::vector<int>& movedGeometryIndices);
+
+	//Returns the index of the closest geometry entered by the ray with time in [0, maxTime) or -1 on a miss
+	//Rays that start inside a hull do not report that hull
+	int						RaycastClosest(RayHit2D& hitOut, const Ray2D& ray, bool useBroadPhase, float maxTime = MAX_RAYCAST_TIME) const;
+
+	const HullGroup&		GetSpecializedGroup(int numPlanes) const;
+	const HullGroup&		GetGenericGroup() const;
+	const std::vector<LargeHull>&	GetLargeHulls() const;
+	int						GetNumHulls() const;
+	int						GetNumPlaneSets() const;		//Local plane sets stored, at most one per prototype and plane count
+
+	//Plane bytes held by the fixed and generic groups, against what one plane set per hull would take
+	//Large hulls are never shared so they are left out of both
+	size_t					GetPlaneDataBytes() const;
+	size_t					GetUnsharedPlaneDataBytes() const;
+
+private:
+	HullGroup				m_specializedGroups[NUM_SPECIALIZED_HULL_GROUPS];
+	HullGroup				m_genericGroup;
+	std::vector<LargeHull>	m_largeHulls;
+
+	//Per geometry, the group it went into (the generic group after the specialized ones, then the large hulls) and its slot there
+	std::vector<IntVec2>	m_hullSlots;
+};
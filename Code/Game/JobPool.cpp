@@ -0,0 +1,195 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/JobPool.hpp"
+#include <memory>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Shared state for a single ParallelFor call. Helper jobs that get picked up after all chunks are claimed simply
+//find nothing left to do, so the state is reference counted instead of living on the caller's stack
+struct ParallelForState
+{
+	std::function<void(int, int)>	m_work;
+	int								m_count = 0;
+	int								m_grainSize = 1;
+	int								m_numChunks = 0;
+
+	std::atomic<int>				m_nextChunk{ 0 };
+	std::atomic<int>				m_chunksDone{ 0 };
+
+	std::mutex						m_doneMutex;
+	std::condition_variable			m_doneCondition;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void RunParallelForChunks(ParallelForState& state)
+{
+	int chunkIndex = state.m_nextChunk.fetch_add(1);
+	while (chunkIndex < state.m_numChunks)
+	{
+		int startIndex = chunkIndex * state.m_grainSize;
+		int endIndex = startIndex + state.m_grainSize;
+		if (endIndex > state.m_count)
+		{
+			endIndex = state.m_count;
+		}
+
+		state.m_work(startIndex, endIndex);
+
+		if (state.m_chunksDone.fetch_add(1) + 1 == state.m_numChunks)
+		{
+			std::lock_guard<std::mutex> lock(state.m_doneMutex);
+			state.m_doneCondition.notify_all();
+		}
+
+		chunkIndex = state.m_nextChunk.fetch_add(1);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+JobPool::JobPool(int numWorkers)
+{
+	if (numWorkers <= 0)
+	{
+		numWorkers = (int)std::thread::hardware_concurrency() - 1;
+		if (numWorkers < 1)
+		{
+			numWorkers = 1;
+		}
+	}
+
+	for (int workerIndex = 0; workerIndex < numWorkers; workerIndex++)
+	{
+		m_workers.emplace_back(&JobPool::WorkerMain, this);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+JobPool::~JobPool()
+{
+	WaitForAsync();
+
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		m_isShuttingDown = true;
+	}
+	m_jobAvailable.notify_all();
+
+	for (int workerIndex = 0; workerIndex < (int)m_workers.size(); workerIndex++)
+	{
+		m_workers[workerIndex].join();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobPool::ParallelFor(int count, int grainSize, const std::function<void(int startIndex, int endIndex)>& work)
+{
+	if (count <= 0)
+		return;
+
+	if (grainSize < 1)
+	{
+		grainSize = 1;
+	}
+
+	//Not worth waking anyone up for a single chunk
+	if (count <= grainSize)
+	{
+		work(0, count);
+		return;
+	}
+
+	std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+	state->m_work = work;
+	state->m_count = count;
+	state->m_grainSize = grainSize;
+	state->m_numChunks = (count + grainSize - 1) / grainSize;
+
+	int numHelpers = state->m_numChunks - 1;
+	if (numHelpers > (int)m_workers.size())
+	{
+		numHelpers = (int)m_workers.size();
+	}
+
+	for (int helperIndex = 0; helperIndex < numHelpers; helperIndex++)
+	{
+		PushJob([state]() { RunParallelForChunks(*state); });
+	}
+
+	//The calling thread works too, then waits on whatever chunks are still being processed by the workers
+	RunParallelForChunks(*state);
+
+	std::unique_lock<std::mutex> lock(state->m_doneMutex);
+	state->m_doneCondition.wait(lock, [&state]() { return state->m_chunksDone.load() == state->m_numChunks; });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobPool::KickAsync(const std::function<void()>& work)
+{
+	//Only one async job is tracked at a time, so finish the previous one first
+	WaitForAsync();
+
+	{
+		std::lock_guard<std::mutex> lock(m_asyncMutex);
+		m_isAsyncInFlight = true;
+	}
+
+	PushJob([this, work]()
+	{
+		work();
+
+		std::lock_guard<std::mutex> lock(m_asyncMutex);
+		m_isAsyncInFlight = false;
+		m_asyncFinished.notify_all();
+	});
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobPool::WaitForAsync()
+{
+	std::unique_lock<std::mutex> lock(m_asyncMutex);
+	m_asyncFinished.wait(lock, [this]() { return !m_isAsyncInFlight; });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool JobPool::IsAsyncInFlight() const
+{
+	std::lock_guard<std::mutex> lock(m_asyncMutex);
+	return m_isAsyncInFlight;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int JobPool::GetNumWorkers() const
+{
+	return (int)m_workers.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobPool::WorkerMain()
+{
+	while (true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(m_jobMutex);
+			m_jobAvailable.wait(lock, [this]() { return m_isShuttingDown || !m_jobs.empty(); });
+
+			if (m_isShuttingDown && m_jobs.empty())
+				return;
+
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		job();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobPool::PushJob(const std::function<void()>& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		m_jobs.push_back(job);
+	}
+	m_jobAvailable.notify_one();
+}
@@ -0,0 +1,46 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Small pool of worker threads used by the game to spread batch queries across cores
+//ParallelFor splits an index range into chunks that the workers (and the calling thread) pull from
+//KickAsync runs a single job in the background that we can wait on later (used to overlap raycasts with rendering)
+//------------------------------------------------------------------------------------------------------------------------------
+class JobPool
+{
+public:
+	explicit JobPool(int numWorkers = 0);	//0 will use (hardware threads - 1) workers
+	~JobPool();
+
+	void				ParallelFor(int count, int grainSize, const std::function<void(int startIndex, int endIndex)>& work);
+
+	void				KickAsync(const std::function<void()>& work);
+	void				WaitForAsync();
+	bool				IsAsyncInFlight() const;
+
+	int					GetNumWorkers() const;
+
+private:
+	void				WorkerMain();
+	void				PushJob(const std::function<void()>& job);
+
+private:
+	std::vector<std::thread>			m_workers;
+	std::deque<std::function<void()>>	m_jobs;
+
+	std::mutex							m_jobMutex;
+	std::condition_variable				m_jobAvailable;
+	bool								m_isShuttingDown = false;
+
+	//Async job tracking
+	mutable std::mutex					m_asyncMutex;
+	std::condition_variable				m_asyncFinished;
+	bool								m_isAsyncInFlight = false;
+};
@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/LineOfSightMatrix.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/JobPool.hpp"
+#include "Game/PointQuery.hpp"
+#include "Game/VisibilityPolygon.hpp"
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static int CountBitsInWord(uint64_t word)
+{
+	word = word - ((word >> 1) & 0x5555555555555555ULL);
+	word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int)((word * 0x0101010101010101ULL) >> 56);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+LineOfSightMatrix::LineOfSightMatrix()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+LineOfSightMatrix::~LineOfSightMatrix()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LineOfSightMatrix::Compute(const std::vector<Vec2>& points, const VisibilityPolygonQuery& visibilityQuery, const PointContainmentQuery& pointQuery, JobPool* jobPool)
+{
+	m_numPoints = (int)points.size();
+	m_numWordsPerRow = (m_numPoints + 63) / 64;
+	m_bits.assign((size_t)m_numPoints * m_numWordsPerRow, 0ULL);
+
+	std::vector<int> containingGeometry;
+	pointQuery.QueryPoints(points, containingGeometry, jobPool);
+
+	//Each source only writes its own row, the columns after it
+	auto solveRows = [this, &points, &visibilityQuery, &containingGeometry](int startIndex, int endIndex)
+	{
+		std::vector<Vec2> polygon;
+		std::vector<float> angles;
+
+		for (int sourceIndex = startIndex; sourceIndex < endIndex; sourceIndex++)
+		{
+			if (containingGeometry[sourceIndex] != -1)
+				continue;
+
+			const Vec2& viewer = points[sourceIndex];
+			visibilityQuery.ComputeVisibilityPolygon(viewer, polygon, &angles);
+			if (polygon.empty())
+				continue;
+
+			uint64_t* row = &m_bits[(size_t)sourceIndex * m_numWordsPerRow];
+			for (int targetIndex = sourceIndex + 1; targetIndex < m_numPoints; targetIndex++)
+			{
+				if (containingGeometry[targetIndex] != -1)
+					continue;
+
+				if (IsInsideVisibilityPolygon(viewer, points[targetIndex], polygon, angles))
+				{
+					row[targetIndex >> 6] |= 1ULL << (targetIndex & 63);
+				}
+			}
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(m_numPoints, LINE_OF_SIGHT_GRAIN_SIZE, solveRows);
+	}
+	else
+	{
+		solveRows(0, m_numPoints);
+	}
+
+	//The lower triangle is mirrored in on this thread. Rows close together share 64 bit words across the diagonal, so a
+	//worker filling one row's lower triangle would read words another worker is still writing
+	for (int rowIndex = 0; rowIndex < m_numPoints; rowIndex++)
+	{
+		const uint64_t* row = &m_bits[(size_t)rowIndex * m_numWordsPerRow];
+		uint64_t rowBit = 1ULL << (rowIndex & 63);
+		int rowWord = rowIndex >> 6;
+
+		for (int columnIndex = rowIndex + 1; columnIndex < m_numPoints; columnIndex++)
+		{
+			if (row[columnIndex >> 6] & (1ULL << (columnIndex & 63)))
+			{
+				m_bits[(size_t)columnIndex * m_numWordsPerRow + rowWord] |= rowBit;
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LineOfSightMatrix::Clear()
+{
+	m_numPoints = 0;
+	m_numWordsPerRow = 0;
+	m_bits.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LineOfSightMatrix::IsVisible(int pointIndexA, int pointIndexB) const
+{
+	return (m_bits[(size_t)pointIndexA * m_numWordsPerRow + (pointIndexB >> 6)] >> (pointIndexB & 63)) & 1ULL;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int LineOfSightMatrix::CountVisiblePairs() const
+{
+	int numSetBits = 0;
+	for (int wordIndex = 0; wordIndex < (int)m_bits.size(); wordIndex++)
+	{
+		numSetBits += CountBitsInWord(m_bits[wordIndex]);
+	}
+
+	//Every pair is stored in both rows
+	return numSetBits / 2;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LineOfSightMatrix::IsInsideVisibilityPolygon(const Vec2& viewer, const Vec2& target, const std::vector<Vec2>& polygon, const std::vector<float>& angles)
+{
+	Vec2 toTarget = target - viewer;
+	if (toTarget.x == 0.f && toTarget.y == 0.f)
+		return true;
+
+	//The polygon edge spanning the target's angle is the only one that can be between it and the viewer
+	float targetAngle = atan2f(toTarget.y, toTarget.x);
+	int edgeStartIndex = (int)(std::upper_bound(angles.begin(), angles.end(), targetAngle) - angles.begin()) - 1;
+	if (edgeStartIndex < 0)
+	{
+		edgeStartIndex = (int)polygon.size() - 1;
+	}
+
+	const Vec2& edgeStart = polygon[edgeStartIndex];
+	const Vec2& edgeEnd = polygon[(edgeStartIndex + 1) % polygon.size()];
+	Vec2 edge = edgeEnd - edgeStart;
+	Vec2 edgeToTarget = target - edgeStart;
+
+	float side = edge.x * edgeToTarget.y - edge.y * edgeToTarget.x;
+	if (side != 0.f)
+		return side > 0.f;
+
+	//Edge lies along the target's ray, which happens where the sweep wraps around, or the target sits right on the edge
+	float targetDistanceSquared = toTarget.x * toTarget.x + toTarget.y * toTarget.y;
+	Vec2 toEdgeStart = edgeStart - viewer;
+	Vec2 toEdgeEnd = edgeEnd - viewer;
+	float edgeDistanceSquared = GetHigherValue(toEdgeStart.x * toEdgeStart.x + toEdgeStart.y * toEdgeStart.y, toEdgeEnd.x * toEdgeEnd.x + toEdgeEnd.y * toEdgeEnd.y);
+	return targetDistanceSquared <= edgeDistanceSquared;
+}
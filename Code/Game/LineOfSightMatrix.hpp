@@ -0,0 +1,45 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class JobPool;
+class PointContainmentQuery;
+class VisibilityPolygonQuery;
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Mutual visibility between every pair of a set of points, stored as a packed bit matrix with one row per point
+//Each source point builds its visibility polygon once and tests every later point against it with a binary search on
+//angle, so the scene is traversed N times rather than N * N. Only the upper triangle is solved and then mirrored
+//Points inside geometry see nothing and are seen by nothing, the diagonal is left clear
+//------------------------------------------------------------------------------------------------------------------------------
+class LineOfSightMatrix
+{
+public:
+	LineOfSightMatrix();
+	~LineOfSightMatrix();
+
+	//Source points are spread across the job pool when one is passed in
+	void					Compute(const std::vector<Vec2>& points, const VisibilityPolygonQuery& visibilityQuery, const PointContainmentQuery& pointQuery, JobPool* jobPool = nullptr);
+	void					Clear();
+
+	bool					IsVisible(int pointIndexA, int pointIndexB) const;
+	int						GetNumPoints() const { return m_numPoints; }
+	int						GetNumWordsPerRow() const { return m_numWordsPerRow; }
+	const uint64_t*			GetRow(int pointIndex) const { return &m_bits[pointIndex * m_numWordsPerRow]; }
+
+	//Unordered pairs that can see each other
+	int						CountVisiblePairs() const;
+
+	//Target against a visibility polygon built from the viewer with its sweep angles, O(log n) in the polygon size
+	static bool				IsInsideVisibilityPolygon(const Vec2& viewer, const Vec2& target, const std::vector<Vec2>& polygon, const std::vector<float>& angles);
+
+private:
+	int						m_numPoints = 0;
+	int						m_numWordsPerRow = 0;
+
+	//Row major, bit (column % 64) of word (row * m_numWordsPerRow + column / 64)
+	std::vector<uint64_t>	m_bits;
+};
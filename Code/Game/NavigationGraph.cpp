@@ -0,0 +1,884 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/NavigationGraph.hpp"
+#include "Engine/Math/ConvexHull2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/Ray2D.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/JobPool.hpp"
+#include "Game/LineOfSightMatrix.hpp"
+#include "Game/PointQuery.hpp"
+#include "Game/SceneQuery.hpp"
+#include "Game/VisibilityPolygon.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static float GetDistanceBetween(const Vec2& pointA, const Vec2& pointB)
+{
+	Vec2 displacement = pointB - pointA;
+	return sqrtf(displacement.x * displacement.x + displacement.y * displacement.y);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void GetPointBounds(const std::vector<Vec2>& points, Vec2& minsOut, Vec2& maxsOut)
+{
+	minsOut = points.empty() ? Vec2::ZERO : points[0];
+	maxsOut = minsOut;
+	for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+	{
+		minsOut = Vec2(GetLowerValue(minsOut.x, points[pointIndex].x), GetLowerValue(minsOut.y, points[pointIndex].y));
+		maxsOut = Vec2(GetHigherValue(maxsOut.x, points[pointIndex].x), GetHigherValue(maxsOut.y, points[pointIndex].y));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//One node per corner, pushed out along the corner's bisector so it sits clear of the polygon
+static Vec2 GetNodePosition(const std::vector<Vec2>& points, int pointIndex)
+{
+	int numPoints = (int)points.size();
+	const Vec2& corner = points[pointIndex];
+	Vec2 fromPrevious = corner - points[(pointIndex + numPoints - 1) % numPoints];
+	Vec2 fromNext = corner - points[(pointIndex + 1) % numPoints];
+	fromPrevious.Normalize();
+	fromNext.Normalize();
+
+	Vec2 outward = fromPrevious + fromNext;
+	outward.Normalize();
+
+	return corner + outward * NAV_NODE_CLEARANCE;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool IsPointInBounds(const Vec2& point, const Vec2& mins, const Vec2& maxs)
+{
+	return point.x >= mins.x && point.x <= maxs.x && point.y >= mins.y && point.y <= maxs.y;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+NavigationGraph::NavigationGraph()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+NavigationGraph::~NavigationGraph()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int NavigationGraph::SyncWithGeometry(const std::vector<Geometry>& geometry, const AABB2& worldBounds, const VisibilityPolygonQuery& visibilityQuery,
+	const PointContainmentQuery& pointQuery, const SceneQuery& sceneQuery, JobPool* jobPool)
+{
+	std::vector<int> movedGeometry;
+	int firstRedoneIndex = FindChangedGeometry(geometry, movedGeometry);
+	if (firstRedoneIndex < 0 && movedGeometry.empty())
+		return -1;
+
+	//Every moved polygon is tested against the node pairs on its own, past a few of them redoing the tail is cheaper
+	if ((int)movedGeometry.size() > NAV_MAX_MOVED_GEOMETRY)
+	{
+		firstRedoneIndex = movedGeometry[0];
+		movedGeometry.clear();
+	}
+
+	int firstChangedIndex = movedGeometry.empty() ? firstRedoneIndex : movedGeometry[0];
+	m_numMovedInLastSync = (int)movedGeometry.size();
+
+	//The tail goes first so the moved polygons only meet nodes that stay, the new tail then cuts and connects against them
+	if (firstRedoneIndex >= 0 && firstRedoneIndex < (int)m_geometryPoints.size())
+	{
+		RemoveGeometryFrom(firstRedoneIndex, worldBounds, visibilityQuery, pointQuery, sceneQuery, jobPool);
+	}
+
+	if (!movedGeometry.empty())
+	{
+		MoveGeometry(movedGeometry, geometry, worldBounds, visibilityQuery, pointQuery, sceneQuery, jobPool);
+	}
+
+	if (firstRedoneIndex >= 0 && firstRedoneIndex < (int)geometry.size())
+	{
+		AddGeometryFrom(firstRedoneIndex, geometry, worldBounds, visibilityQuery, pointQuery, jobPool);
+	}
+
+	m_numEdges = 0;
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		m_numEdges += (int)m_neighbours[nodeIndex].size();
+	}
+	m_numEdges /= 2;
+
+	return firstChangedIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void NavigationGraph::Clear()
+{
+	m_nodes.clear();
+	m_neighbours.clear();
+	m_numEdges = 0;
+	m_numMovedInLastSync = 0;
+
+	m_firstNodes.clear();
+	m_geometryPoints.clear();
+	m_hullMins.clear();
+	m_hullMaxs.clear();
+	m_normalX.clear();
+	m_normalY.clear();
+	m_distance.clear();
+	m_planeOffsets.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool NavigationGraph::FindPath(const Vec2& start, const Vec2& goal, const VisibilityPolygonQuery& visibilityQuery, const PointContainmentQuery& pointQuery,
+	std::vector<Vec2>& pathOut, int* numExpandedNodesOut) const
+{
+	pathOut.clear();
+	if (numExpandedNodesOut != nullptr)
+	{
+		*numExpandedNodesOut = 0;
+	}
+
+	if (pointQuery.GetGeometryContainingPoint(start) != -1 || pointQuery.GetGeometryContainingPoint(goal) != -1)
+		return false;
+
+	std::vector<Vec2> polygon;
+	std::vector<float> angles;
+	visibilityQuery.ComputeVisibilityPolygon(start, polygon, &angles);
+	if (polygon.empty())
+		return false;
+
+	if (LineOfSightMatrix::IsInsideVisibilityPolygon(start, goal, polygon, angles))
+	{
+		pathOut.push_back(start);
+		pathOut.push_back(goal);
+		return true;
+	}
+
+	//The goal is one more node past the graph ones, linked to every node it can see
+	int numNodes = (int)m_nodes.size();
+	int goalNodeIndex = numNodes;
+
+	std::vector<float> scores(numNodes + 1, FLT_MAX);
+	std::vector<int> previousNodes(numNodes + 1, -1);
+	std::vector<bool> isClosed(numNodes + 1, false);
+
+	typedef std::pair<float, int> QueueEntry;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> openQueue;
+
+	for (int nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		const NavNode& node = m_nodes[nodeIndex];
+		if (node.m_isOpen && LineOfSightMatrix::IsInsideVisibilityPolygon(start, node.m_position, polygon, angles))
+		{
+			scores[nodeIndex] = GetDistanceBetween(start, node.m_position);
+			openQueue.push(QueueEntry(scores[nodeIndex] + GetDistanceBetween(node.m_position, goal), nodeIndex));
+		}
+	}
+
+	std::vector<float> costsToGoal(numNodes, -1.f);
+	visibilityQuery.ComputeVisibilityPolygon(goal, polygon, &angles);
+	for (int nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		const NavNode& node = m_nodes[nodeIndex];
+		if (node.m_isOpen && LineOfSightMatrix::IsInsideVisibilityPolygon(goal, node.m_position, polygon, angles))
+		{
+			costsToGoal[nodeIndex] = GetDistanceBetween(node.m_position, goal);
+		}
+	}
+
+	//Straight line distance never overestimates, so the first time the goal comes off the queue its path is the shortest
+	int numExpandedNodes = 0;
+	bool hasReachedGoal = false;
+	while (!openQueue.empty())
+	{
+		int nodeIndex = openQueue.top().second;
+		openQueue.pop();
+		if (isClosed[nodeIndex])
+			continue;
+
+		isClosed[nodeIndex] = true;
+		numExpandedNodes++;
+		if (nodeIndex == goalNodeIndex)
+		{
+			hasReachedGoal = true;
+			break;
+		}
+
+		const Vec2& position = m_nodes[nodeIndex].m_position;
+		const std::vector<int>& neighbours = m_neighbours[nodeIndex];
+		for (int neighbourIndex = 0; neighbourIndex < (int)neighbours.size(); neighbourIndex++)
+		{
+			int nextNodeIndex = neighbours[neighbourIndex];
+			const Vec2& nextPosition = m_nodes[nextNodeIndex].m_position;
+			float score = scores[nodeIndex] + GetDistanceBetween(position, nextPosition);
+			if (score < scores[nextNodeIndex])
+			{
+				scores[nextNodeIndex] = score;
+				previousNodes[nextNodeIndex] = nodeIndex;
+				openQueue.push(QueueEntry(score + GetDistanceBetween(nextPosition, goal), nextNodeIndex));
+			}
+		}
+
+		if (costsToGoal[nodeIndex] >= 0.f && scores[nodeIndex] + costsToGoal[nodeIndex] < scores[goalNodeIndex])
+		{
+			scores[goalNodeIndex] = scores[nodeIndex] + costsToGoal[nodeIndex];
+			previousNodes[goalNodeIndex] = nodeIndex;
+			openQueue.push(QueueEntry(scores[goalNodeIndex], goalNodeIndex));
+		}
+	}
+
+	if (numExpandedNodesOut != nullptr)
+	{
+		*numExpandedNodesOut = numExpandedNodes;
+	}
+
+	if (!hasReachedGoal)
+		return false;
+
+	pathOut.push_back(goal);
+	for (int nodeIndex = previousNodes[goalNodeIndex]; nodeIndex != -1; nodeIndex = previousNodes[nodeIndex])
+	{
+		pathOut.push_back(m_nodes[nodeIndex].m_position);
+	}
+	pathOut.push_back(start);
+	std::reverse(pathOut.begin(), pathOut.end());
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int NavigationGraph::FindChangedGeometry(const std::vector<Geometry>& geometry, std::vector<int>& movedGeometryOut) const
+{
+	movedGeometryOut.clear();
+
+	int numSynced = (int)m_geometryPoints.size();
+	int numShared = GetLowerValue(numSynced, (int)geometry.size());
+	for (int geometryIndex = 0; geometryIndex < numShared; geometryIndex++)
+	{
+		const std::vector<Vec2>& points = geometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+		const std::vector<Vec2>& syncedPoints = m_geometryPoints[geometryIndex];
+		int numSyncedPlanes = m_planeOffsets[geometryIndex + 1] - m_planeOffsets[geometryIndex];
+		if (points.size() != syncedPoints.size() || geometry[geometryIndex].GetConvexHull2D().GetNumPlanes() != numSyncedPlanes)
+			return geometryIndex;
+
+		for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+		{
+			if (!(points[pointIndex] == syncedPoints[pointIndex]))
+			{
+				movedGeometryOut.push_back(geometryIndex);
+				break;
+			}
+		}
+	}
+
+	return (numSynced == (int)geometry.size()) ? -1 : numShared;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void NavigationGraph::RemoveGeometryFrom(int firstGeometryIndex, const AABB2& worldBounds, const VisibilityPolygonQuery& visibilityQuery,
+	const PointContainmentQuery& pointQuery, const SceneQuery& sceneQuery, JobPool* jobPool)
+{
+	int numSynced = (int)m_geometryPoints.size();
+	int firstRemovedNode = m_firstNodes[firstGeometryIndex];
+
+	//Pairs kept apart only by the dropped polygons get tested again against what is left, before their planes go
+	Vec2 removedMins = m_hullMins[firstGeometryIndex];
+	Vec2 removedMaxs = m_hullMaxs[firstGeometryIndex];
+	for (int geometryIndex = firstGeometryIndex + 1; geometryIndex < numSynced; geometryIndex++)
+	{
+		removedMins = Vec2(GetLowerValue(removedMins.x, m_hullMins[geometryIndex].x), GetLowerValue(removedMins.y, m_hullMins[geometryIndex].y));
+		removedMaxs = Vec2(GetHigherValue(removedMaxs.x, m_hullMaxs[geometryIndex].x), GetHigherValue(removedMaxs.y, m_hullMaxs[geometryIndex].y));
+	}
+
+	std::vector<std::vector<int>> unblockedNeighbours(firstRemovedNode);
+	auto findUnblocked = [this, firstGeometryIndex, numSynced, firstRemovedNode, &removedMins, &removedMaxs, &sceneQuery, &unblockedNeighbours](int startIndex, int endIndex)
+	{
+		for (int nodeIndexA = startIndex; nodeIndexA < endIndex; nodeIndexA++)
+		{
+			if (!m_nodes[nodeIndexA].m_isOpen)
+				continue;
+
+			const Vec2& positionA = m_nodes[nodeIndexA].m_position;
+			for (int nodeIndexB = nodeIndexA + 1; nodeIndexB < firstRemovedNode; nodeIndexB++)
+			{
+				const Vec2& positionB = m_nodes[nodeIndexB].m_position;
+				if (!m_nodes[nodeIndexB].m_isOpen)
+					continue;
+
+				if (GetHigherValue(positionA.x, positionB.x) < removedMins.x || GetLowerValue(positionA.x, positionB.x) > removedMaxs.x
+					|| GetHigherValue(positionA.y, positionB.y) < removedMins.y || GetLowerValue(positionA.y, positionB.y) > removedMaxs.y)
+				{
+					continue;
+				}
+
+				if (HasEdge(nodeIndexA, nodeIndexB))
+					continue;
+
+				bool wasCrossingRemoved = false;
+				for (int geometryIndex = firstGeometryIndex; geometryIndex < numSynced && !wasCrossingRemoved; geometryIndex++)
+				{
+					wasCrossingRemoved = DoesSegmentCrossHull(positionA, positionB, geometryIndex);
+				}
+
+				if (wasCrossingRemoved && IsSegmentClear(positionA, positionB, sceneQuery))
+				{
+					unblockedNeighbours[nodeIndexA].push_back(nodeIndexB);
+				}
+			}
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(firstRemovedNode, NAV_GRAPH_GRAIN_SIZE, findUnblocked);
+	}
+	else
+	{
+		findUnblocked(0, firstRemovedNode);
+	}
+
+	//Drop the tail nodes and every edge into them, neighbour lists are sorted so those are all at the end
+	for (int nodeIndex = 0; nodeIndex < firstRemovedNode; nodeIndex++)
+	{
+		std::vector<int>& neighbours = m_neighbours[nodeIndex];
+		neighbours.erase(std::lower_bound(neighbours.begin(), neighbours.end(), firstRemovedNode), neighbours.end());
+	}
+
+	m_nodes.resize(firstRemovedNode);
+	m_neighbours.resize(firstRemovedNode);
+	m_firstNodes.resize(firstGeometryIndex + 1);
+	m_geometryPoints.resize(firstGeometryIndex);
+	m_hullMins.resize(firstGeometryIndex);
+	m_hullMaxs.resize(firstGeometryIndex);
+
+	int firstRemovedPlane = m_planeOffsets[firstGeometryIndex];
+	m_normalX.resize(firstRemovedPlane);
+	m_normalY.resize(firstRemovedPlane);
+	m_distance.resize(firstRemovedPlane);
+	m_planeOffsets.resize(firstGeometryIndex + 1);
+
+	for (int nodeIndexA = 0; nodeIndexA < firstRemovedNode; nodeIndexA++)
+	{
+		for (int listIndex = 0; listIndex < (int)unblockedNeighbours[nodeIndexA].size(); listIndex++)
+		{
+			AddEdge(nodeIndexA, unblockedNeighbours[nodeIndexA][listIndex]);
+		}
+	}
+
+	//Nodes that were inside a dropped polygon may be free now
+	std::vector<int> reopenedNodes;
+	for (int nodeIndex = 0; nodeIndex < firstRemovedNode; nodeIndex++)
+	{
+		NavNode& node = m_nodes[nodeIndex];
+		if (!node.m_isOpen && IsNodePositionOpen(node.m_position, worldBounds, pointQuery))
+		{
+			node.m_isOpen = true;
+			reopenedNodes.push_back(nodeIndex);
+		}
+	}
+
+	ConnectNodes(reopenedNodes, visibilityQuery, jobPool);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void NavigationGraph::AddGeometryFrom(int firstGeometryIndex, const std::vector<Geometry>& geometry, const AABB2& worldBounds,
+	const VisibilityPolygonQuery& visibilityQuery, const PointContainmentQuery& pointQuery, JobPool* jobPool)
+{
+	if (m_firstNodes.empty())
+	{
+		m_firstNodes.push_back(0);
+		m_planeOffsets.push_back(0);
+	}
+
+	int numGeometry = (int)geometry.size();
+	for (int geometryIndex = firstGeometryIndex; geometryIndex < numGeometry; geometryIndex++)
+	{
+		const std::vector<Vec2>& points = geometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+		m_geometryPoints.push_back(points);
+
+		Vec2 hullMins;
+		Vec2 hullMaxs;
+		GetPointBounds(points, hullMins, hullMaxs);
+		m_hullMins.push_back(hullMins);
+		m_hullMaxs.push_back(hullMaxs);
+
+		const std::vector<Plane2D>& planes = geometry[geometryIndex].GetConvexHull2D().GetPlanes();
+		for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++)
+		{
+			m_normalX.push_back(planes[planeIndex].GetNormal().x);
+			m_normalY.push_back(planes[planeIndex].GetNormal().y);
+			m_distance.push_back(planes[planeIndex].GetSignedDistance());
+		}
+		m_planeOffsets.push_back((int)m_distance.size());
+	}
+
+	//Existing edges crossing a new polygon are cut
+	int firstNewNode = (int)m_nodes.size();
+	std::vector<std::vector<int>> blockedNeighbours(firstNewNode);
+	auto findBlocked = [this, firstGeometryIndex, numGeometry, &blockedNeighbours](int startIndex, int endIndex)
+	{
+		for (int nodeIndexA = startIndex; nodeIndexA < endIndex; nodeIndexA++)
+		{
+			const Vec2& positionA = m_nodes[nodeIndexA].m_position;
+			const std::vector<int>& neighbours = m_neighbours[nodeIndexA];
+			for (int listIndex = 0; listIndex < (int)neighbours.size(); listIndex++)
+			{
+				int nodeIndexB = neighbours[listIndex];
+				if (nodeIndexB < nodeIndexA)
+					continue;
+
+				for (int geometryIndex = firstGeometryIndex; geometryIndex < numGeometry; geometryIndex++)
+				{
+					if (DoesSegmentCrossHull(positionA, m_nodes[nodeIndexB].m_position, geometryIndex))
+					{
+						blockedNeighbours[nodeIndexA].push_back(nodeIndexB);
+						break;
+					}
+				}
+			}
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(firstNewNode, NAV_GRAPH_GRAIN_SIZE, findBlocked);
+	}
+	else
+	{
+		findBlocked(0, firstNewNode);
+	}
+
+	for (int nodeIndexA = 0; nodeIndexA < firstNewNode; nodeIndexA++)
+	{
+		for (int listIndex = 0; listIndex < (int)blockedNeighbours[nodeIndexA].size(); listIndex++)
+		{
+			RemoveEdge(nodeIndexA, blockedNeighbours[nodeIndexA][listIndex]);
+		}
+	}
+
+	//Nodes now buried in a new polygon close
+	for (int nodeIndex = 0; nodeIndex < firstNewNode; nodeIndex++)
+	{
+		NavNode& node = m_nodes[nodeIndex];
+		if (node.m_isOpen && !IsNodePositionOpen(node.m_position, worldBounds, pointQuery))
+		{
+			node.m_isOpen = false;
+			RemoveAllEdges(nodeIndex);
+		}
+	}
+
+	std::vector<int> newOpenNodes;
+	for (int geometryIndex = firstGeometryIndex; geometryIndex < numGeometry; geometryIndex++)
+	{
+		const std::vector<Vec2>& points = m_geometryPoints[geometryIndex];
+		for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+		{
+			NavNode node;
+			node.m_position = GetNodePosition(points, pointIndex);
+			node.m_geometryIndex = geometryIndex;
+			node.m_isOpen = IsNodePositionOpen(node.m_position, worldBounds, pointQuery);
+			if (node.m_isOpen)
+			{
+				newOpenNodes.push_back((int)m_nodes.size());
+			}
+
+			m_nodes.push_back(node);
+			m_neighbours.push_back(std::vector<int>());
+		}
+
+		m_firstNodes.push_back((int)m_nodes.size());
+	}
+
+	ConnectNodes(newOpenNodes, visibilityQuery, jobPool);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void NavigationGraph::MoveGeometry(const std::vector<int>& movedGeometry, const std::vector<Geometry>& geometry, const AABB2& worldBounds,
+	const VisibilityPolygonQuery& visibilityQuery, const PointContainmentQuery& pointQuery, const SceneQuery& sceneQuery, JobPool* jobPool)
+{
+	int numNodes = (int)m_nodes.size();
+	int numMoved = (int)movedGeometry.size();
+
+	//The moved polygons' own nodes lose all their edges and are placed and connected again at the end
+	std::vector<bool> isMovedNode(numNodes, false);
+	for (int movedIndex = 0; movedIndex < numMoved; movedIndex++)
+	{
+		int geometryIndex = movedGeometry[movedIndex];
+		for (int nodeIndex = m_firstNodes[geometryIndex]; nodeIndex < m_firstNodes[geometryIndex + 1]; nodeIndex++)
+		{
+			isMovedNode[nodeIndex] = true;
+		}
+	}
+
+	std::vector<Vec2> oldMins(numMoved);
+	std::vector<Vec2> oldMaxs(numMoved);
+	Vec2 movedMins = m_hullMins[movedGeometry[0]];
+	Vec2 movedMaxs = m_hullMaxs[movedGeometry[0]];
+	for (int movedIndex = 0; movedIndex < numMoved; movedIndex++)
+	{
+		oldMins[movedIndex] = m_hullMins[movedGeometry[movedIndex]];
+		oldMaxs[movedIndex] = m_hullMaxs[movedGeometry[movedIndex]];
+		movedMins = Vec2(GetLowerValue(movedMins.x, oldMins[movedIndex].x), GetLowerValue(movedMins.y, oldMins[movedIndex].y));
+		movedMaxs = Vec2(GetHigherValue(movedMaxs.x, oldMaxs[movedIndex].x), GetHigherValue(movedMaxs.y, oldMaxs[movedIndex].y));
+	}
+
+	//Pairs a moved polygon used to keep apart get tested again against the scene, before its old planes are overwritten
+	std::vector<std::vector<int>> unblockedNeighbours(numNodes);
+	auto findUnblocked = [this, numNodes, &movedGeometry, &isMovedNode, &movedMins, &movedMaxs, &sceneQuery, &unblockedNeighbours](int startIndex, int endIndex)
+	{
+		for (int nodeIndexA = startIndex; nodeIndexA < endIndex; nodeIndexA++)
+		{
+			if (!m_nodes[nodeIndexA].m_isOpen || isMovedNode[nodeIndexA])
+				continue;
+
+			const Vec2& positionA = m_nodes[nodeIndexA].m_position;
+			for (int nodeIndexB = nodeIndexA + 1; nodeIndexB < numNodes; nodeIndexB++)
+			{
+				if (!m_nodes[nodeIndexB].m_isOpen || isMovedNode[nodeIndexB])
+					continue;
+
+				const Vec2& positionB = m_nodes[nodeIndexB].m_position;
+				if (GetHigherValue(positionA.x, positionB.x) < movedMins.x || GetLowerValue(positionA.x, positionB.x) > movedMaxs.x
+					|| GetHigherValue(positionA.y, positionB.y) < movedMins.y || GetLowerValue(positionA.y, positionB.y) > movedMaxs.y)
+				{
+					continue;
+				}
+
+				if (HasEdge(nodeIndexA, nodeIndexB))
+					continue;
+
+				bool wasCrossingMoved = false;
+				for (int movedIndex = 0; movedIndex < (int)movedGeometry.size() && !wasCrossingMoved; movedIndex++)
+				{
+					wasCrossingMoved = DoesSegmentCrossHull(positionA, positionB, movedGeometry[movedIndex]);
+				}
+
+				if (wasCrossingMoved && IsSegmentClear(positionA, positionB, sceneQuery))
+				{
+					unblockedNeighbours[nodeIndexA].push_back(nodeIndexB);
+				}
+			}
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(numNodes, NAV_GRAPH_GRAIN_SIZE, findUnblocked);
+	}
+	else
+	{
+		findUnblocked(0, numNodes);
+	}
+
+	for (int movedIndex = 0; movedIndex < numMoved; movedIndex++)
+	{
+		StoreGeometryShape(movedGeometry[movedIndex], geometry[movedGeometry[movedIndex]]);
+	}
+
+	//Edges crossing where a moved polygon is now are cut, the unblocked pairs were tested against the moved scene already
+	std::vector<std::vector<int>> blockedNeighbours(numNodes);
+	auto findBlocked = [this, &movedGeometry, &isMovedNode, &blockedNeighbours](int startIndex, int endIndex)
+	{
+		for (int nodeIndexA = startIndex; nodeIndexA < endIndex; nodeIndexA++)
+		{
+			if (isMovedNode[nodeIndexA])
+				continue;
+
+			const Vec2& positionA = m_nodes[nodeIndexA].m_position;
+			const std::vector<int>& neighbours = m_neighbours[nodeIndexA];
+			for (int listIndex = 0; listIndex < (int)neighbours.size(); listIndex++)
+			{
+				int nodeIndexB = neighbours[listIndex];
+				if (nodeIndexB < nodeIndexA || isMovedNode[nodeIndexB])
+					continue;
+
+				for (int movedIndex = 0; movedIndex < (int)movedGeometry.size(); movedIndex++)
+				{
+					if (DoesSegmentCrossHull(positionA, m_nodes[nodeIndexB].m_position, movedGeometry[movedIndex]))
+					{
+						blockedNeighbours[nodeIndexA].push_back(nodeIndexB);
+						break;
+					}
+				}
+			}
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(numNodes, NAV_GRAPH_GRAIN_SIZE, findBlocked);
+	}
+	else
+	{
+		findBlocked(0, numNodes);
+	}
+
+	for (int nodeIndexA = 0; nodeIndexA < numNodes; nodeIndexA++)
+	{
+		for (int listIndex = 0; listIndex < (int)unblockedNeighbours[nodeIndexA].size(); listIndex++)
+		{
+			AddEdge(nodeIndexA, unblockedNeighbours[nodeIndexA][listIndex]);
+		}
+
+		for (int listIndex = 0; listIndex < (int)blockedNeighbours[nodeIndexA].size(); listIndex++)
+		{
+			RemoveEdge(nodeIndexA, blockedNeighbours[nodeIndexA][listIndex]);
+		}
+	}
+
+	std::vector<int> sourceNodes;
+	for (int movedIndex = 0; movedIndex < numMoved; movedIndex++)
+	{
+		int geometryIndex = movedGeometry[movedIndex];
+		const std::vector<Vec2>& points = m_geometryPoints[geometryIndex];
+		for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+		{
+			int nodeIndex = m_firstNodes[geometryIndex] + pointIndex;
+			NavNode& node = m_nodes[nodeIndex];
+			RemoveAllEdges(nodeIndex);
+
+			node.m_position = GetNodePosition(points, pointIndex);
+			node.m_isOpen = IsNodePositionOpen(node.m_position, worldBounds, pointQuery);
+			if (node.m_isOpen)
+			{
+				sourceNodes.push_back(nodeIndex);
+			}
+		}
+	}
+
+	//Other nodes under where a moved polygon was or is now may have opened or closed
+	for (int nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		if (isMovedNode[nodeIndex])
+			continue;
+
+		NavNode& node = m_nodes[nodeIndex];
+		bool isUnderMoved = false;
+		for (int movedIndex = 0; movedIndex < numMoved && !isUnderMoved; movedIndex++)
+		{
+			int geometryIndex = movedGeometry[movedIndex];
+			isUnderMoved = IsPointInBounds(node.m_position, oldMins[movedIndex], oldMaxs[movedIndex])
+				|| IsPointInBounds(node.m_position, m_hullMins[geometryIndex], m_hullMaxs[geometryIndex]);
+		}
+
+		if (!isUnderMoved)
+			continue;
+
+		bool isOpen = IsNodePositionOpen(node.m_position, worldBounds, pointQuery);
+		if (isOpen && !node.m_isOpen)
+		{
+			node.m_isOpen = true;
+			sourceNodes.push_back(nodeIndex);
+		}
+		else if (!isOpen && node.m_isOpen)
+		{
+			node.m_isOpen = false;
+			RemoveAllEdges(nodeIndex);
+		}
+	}
+
+	ConnectNodes(sourceNodes, visibilityQuery, jobPool);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void NavigationGraph::StoreGeometryShape(int geometryIndex, const Geometry& geometry)
+{
+	m_geometryPoints[geometryIndex] = geometry.GetConvexPoly2D().GetConvexPoly2DPoints();
+	GetPointBounds(m_geometryPoints[geometryIndex], m_hullMins[geometryIndex], m_hullMaxs[geometryIndex]);
+
+	//The plane count matches what was synced, so the planes go back into the same range
+	const std::vector<Plane2D>& planes = geometry.GetConvexHull2D().GetPlanes();
+	int planeStart = m_planeOffsets[geometryIndex];
+	for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++)
+	{
+		m_normalX[planeStart + planeIndex] = planes[planeIndex].GetNormal().x;
+		m_normalY[planeStart + planeIndex] = planes[planeIndex].GetNormal().y;
+		m_distance[planeStart + planeIndex] = planes[planeIndex].GetSignedDistance();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void NavigationGraph::ConnectNodes(const std::vector<int>& sourceNodes, const VisibilityPolygonQuery& visibilityQuery, JobPool* jobPool)
+{
+	int numSources = (int)sourceNodes.size();
+	if (numSources == 0)
+		return;
+
+	std::vector<int> sourceOrder(m_nodes.size(), -1);
+	for (int sourceIndex = 0; sourceIndex < numSources; sourceIndex++)
+	{
+		sourceOrder[sourceNodes[sourceIndex]] = sourceIndex;
+	}
+
+	//Each source keeps the targets it sees, a pair of sources is only taken from the earlier one
+	std::vector<std::vector<int>> visibleTargets(numSources);
+	auto solveSources = [this, &sourceNodes, &sourceOrder, &visibleTargets, &visibilityQuery](int startIndex, int endIndex)
+	{
+		std::vector<Vec2> polygon;
+		std::vector<float> angles;
+
+		for (int sourceIndex = startIndex; sourceIndex < endIndex; sourceIndex++)
+		{
+			const Vec2& viewer = m_nodes[sourceNodes[sourceIndex]].m_position;
+			visibilityQuery.ComputeVisibilityPolygon(viewer, polygon, &angles);
+			if (polygon.empty())
+				continue;
+
+			for (int targetIndex = 0; targetIndex < (int)m_nodes.size(); targetIndex++)
+			{
+				if (!m_nodes[targetIndex].m_isOpen || (sourceOrder[targetIndex] != -1 && sourceOrder[targetIndex] <= sourceIndex))
+					continue;
+
+				if (LineOfSightMatrix::IsInsideVisibilityPolygon(viewer, m_nodes[targetIndex].m_position, polygon, angles))
+				{
+					visibleTargets[sourceIndex].push_back(targetIndex);
+				}
+			}
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(numSources, LINE_OF_SIGHT_GRAIN_SIZE, solveSources);
+	}
+	else
+	{
+		solveSources(0, numSources);
+	}
+
+	for (int sourceIndex = 0; sourceIndex < numSources; sourceIndex++)
+	{
+		for (int listIndex = 0; listIndex < (int)visibleTargets[sourceIndex].size(); listIndex++)
+		{
+			AddEdge(sourceNodes[sourceIndex], visibleTargets[sourceIndex][listIndex]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void NavigationGraph::AddEdge(int nodeIndexA, int nodeIndexB)
+{
+	std::vector<int>& neighboursA = m_neighbours[nodeIndexA];
+	std::vector<int>::iterator insertA = std::lower_bound(neighboursA.begin(), neighboursA.end(), nodeIndexB);
+	if (insertA != neighboursA.end() && *insertA == nodeIndexB)
+		return;
+
+	neighboursA.insert(insertA, nodeIndexB);
+
+	std::vector<int>& neighboursB = m_neighbours[nodeIndexB];
+	neighboursB.insert(std::lower_bound(neighboursB.begin(), neighboursB.end(), nodeIndexA), nodeIndexA);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void NavigationGraph::RemoveEdge(int nodeIndexA, int nodeIndexB)
+{
+	std::vector<int>& neighboursA = m_neighbours[nodeIndexA];
+	std::vector<int>::iterator foundA = std::lower_bound(neighboursA.begin(), neighboursA.end(), nodeIndexB);
+	if (foundA == neighboursA.end() || *foundA != nodeIndexB)
+		return;
+
+	neighboursA.erase(foundA);
+
+	std::vector<int>& neighboursB = m_neighbours[nodeIndexB];
+	neighboursB.erase(std::lower_bound(neighboursB.begin(), neighboursB.end(), nodeIndexA));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void NavigationGraph::RemoveAllEdges(int nodeIndex)
+{
+	std::vector<int> neighbours;
+	neighbours.swap(m_neighbours[nodeIndex]);
+	for (int listIndex = 0; listIndex < (int)neighbours.size(); listIndex++)
+	{
+		std::vector<int>& otherNeighbours = m_neighbours[neighbours[listIndex]];
+		otherNeighbours.erase(std::lower_bound(otherNeighbours.begin(), otherNeighbours.end(), nodeIndex));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool NavigationGraph::HasEdge(int nodeIndexA, int nodeIndexB) const
+{
+	const std::vector<int>& neighbours = m_neighbours[nodeIndexA];
+	return std::binary_search(neighbours.begin(), neighbours.end(), nodeIndexB);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool NavigationGraph::IsNodePositionOpen(const Vec2& position, const AABB2& worldBounds, const PointContainmentQuery& pointQuery) const
+{
+	if (position.x <= worldBounds.m_minBounds.x || position.x >= worldBounds.m_maxBounds.x || position.y <= worldBounds.m_minBounds.y || position.y >= worldBounds.m_maxBounds.y)
+		return false;
+
+	return pointQuery.GetGeometryContainingPoint(position) == -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool NavigationGraph::DoesSegmentCrossHull(const Vec2& start, const Vec2& end, int geometryIndex) const
+{
+	const Vec2& hullMins = m_hullMins[geometryIndex];
+	const Vec2& hullMaxs = m_hullMaxs[geometryIndex];
+	if (GetHigherValue(start.x, end.x) < hullMins.x || GetLowerValue(start.x, end.x) > hullMaxs.x
+		|| GetHigherValue(start.y, end.y) < hullMins.y || GetLowerValue(start.y, end.y) > hullMaxs.y)
+	{
+		return false;
+	}
+
+	//Clip the segment to the planes and see if enough of it is left to be more than a graze
+	Vec2 displacement = end - start;
+	float timeEnter = 0.f;
+	float timeExit = 1.f;
+	for (int planeIndex = m_planeOffsets[geometryIndex]; planeIndex < m_planeOffsets[geometryIndex + 1]; planeIndex++)
+	{
+		float startDistance = m_normalX[planeIndex] * start.x + m_normalY[planeIndex] * start.y - m_distance[planeIndex];
+		float approachSpeed = m_normalX[planeIndex] * displacement.x + m_normalY[planeIndex] * displacement.y;
+		if (approachSpeed == 0.f)
+		{
+			if (startDistance > 0.f)
+				return false;
+
+			continue;
+		}
+
+		float planeTime = -startDistance / approachSpeed;
+		if (approachSpeed < 0.f)
+		{
+			timeEnter = GetHigherValue(timeEnter, planeTime);
+		}
+		else
+		{
+			timeExit = GetLowerValue(timeExit, planeTime);
+		}
+
+		if (timeEnter > timeExit)
+			return false;
+	}
+
+	return (timeExit - timeEnter) * GetDistanceBetween(start, end) > NAV_BLOCKING_LENGTH;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool NavigationGraph::IsSegmentClear(const Vec2& start, const Vec2& end, const SceneQuery& sceneQuery)
+{
+	float length = GetDistanceBetween(start, end);
+	if (length == 0.f)
+		return true;
+
+	Ray2D ray(start, (end - start) * (1.f / length));
+	RayInterval2D intervals[NAV_SEGMENT_INTERVALS];
+	int numIntervals = sceneQuery.RaycastAll(ray, intervals, NAV_SEGMENT_INTERVALS, length);
+
+	//A full buffer may have left a blocking hull out
+	if (numIntervals == NAV_SEGMENT_INTERVALS)
+		return false;
+
+	for (int intervalIndex = 0; intervalIndex < numIntervals; intervalIndex++)
+	{
+		if (GetLowerValue(intervals[intervalIndex].m_timeExit, length) - intervals[intervalIndex].m_timeEnter > NAV_BLOCKING_LENGTH)
+			return false;
+	}
+
+	return true;
+}
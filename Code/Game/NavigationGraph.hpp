@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+class JobPool;
+class PointContainmentQuery;
+class SceneQuery;
+class VisibilityPolygonQuery;
+
+constexpr float NAV_NODE_CLEARANCE = 0.25f;			//Nodes sit this far out from the polygon corner they belong to
+constexpr float NAV_BLOCKING_LENGTH = 0.0001f;		//Shortest stretch inside a hull that blocks a segment, grazing a corner does not
+constexpr int NAV_SEGMENT_INTERVALS = 8;			//Hull intervals a re-tested segment reads, a full buffer counts as blocked
+constexpr int NAV_MAX_MOVED_GEOMETRY = 8;			//Moved polygons updated in place by one sync, more than this redoes the graph from the first one
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct NavNode
+{
+	Vec2	m_position;
+	int		m_geometryIndex = -1;
+	bool	m_isOpen = false;		//Closed nodes are inside some other polygon or outside the world and have no edges
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Visibility graph over the polygon corners for shortest paths around the scene, answered with A*
+//Rows of the graph come from one visibility polygon per node, the same batched occlusion test as the line of sight matrix,
+//so a full build is N sweeps across the job pool instead of N * N segment tests
+//Syncing finds the first polygon whose point or plane count differs from the synced scene and redoes the tail from it:
+//dropped polygons take their nodes with them and the node pairs they used to block are tested again against the scene,
+//new polygons cut the edges crossing them and connect their own nodes. That is cheap when the polygon count slider adds
+//or drops polygons at the end of the list. Polygons before it that only moved are updated in place: the pairs they used
+//to block are tested again, the edges crossing where they are now are cut and their own nodes are placed and connected
+//again. Each moved polygon costs a pass over the node pairs, so past NAV_MAX_MOVED_GEOMETRY of them the tail is redone
+//from the first moved one instead. Drifting moves every polygon and a regenerated scene changes it from the start, both
+//of which are a full rebuild
+//------------------------------------------------------------------------------------------------------------------------------
+class NavigationGraph
+{
+public:
+	NavigationGraph();
+	~NavigationGraph();
+
+	//The queries have to be built from the same geometry. Returns the first geometry index moved or redone, -1 when nothing changed
+	int						SyncWithGeometry(const std::vector<Geometry>& geometry, const AABB2& worldBounds, const VisibilityPolygonQuery& visibilityQuery,
+								const PointContainmentQuery& pointQuery, const SceneQuery& sceneQuery, JobPool* jobPool = nullptr);
+	void					Clear();
+
+	//Shortest path from start to goal through the graph, pathOut starts at start and ends at goal
+	//False when either end is inside geometry or the goal can not be reached
+	bool					FindPath(const Vec2& start, const Vec2& goal, const VisibilityPolygonQuery& visibilityQuery, const PointContainmentQuery& pointQuery,
+								std::vector<Vec2>& pathOut, int* numExpandedNodesOut = nullptr) const;
+
+	int						GetNumNodes() const { return (int)m_nodes.size(); }
+	int						GetNumEdges() const { return m_numEdges; }
+	int						GetNumMovedInLastSync() const { return m_numMovedInLastSync; }
+	const NavNode&			GetNode(int nodeIndex) const { return m_nodes[nodeIndex]; }
+	const std::vector<int>&	GetNeighbours(int nodeIndex) const { return m_neighbours[nodeIndex]; }
+
+private:
+	//Returns the first geometry index whose point or plane count changed or that is new or dropped, -1 if there is none
+	//movedGeometryOut gets the ones before it whose points moved
+	int						FindChangedGeometry(const std::vector<Geometry>& geometry, std::vector<int>& movedGeometryOut) const;
+
+	void					RemoveGeometryFrom(int firstGeometryIndex, const AABB2& worldBounds, const VisibilityPolygonQuery& visibilityQuery,
+								const PointContainmentQuery& pointQuery, const SceneQuery& sceneQuery, JobPool* jobPool);
+	void					AddGeometryFrom(int firstGeometryIndex, const std::vector<Geometry>& geometry, const AABB2& worldBounds,
+								const VisibilityPolygonQuery& visibilityQuery, const PointContainmentQuery& pointQuery, JobPool* jobPool);
+	void					MoveGeometry(const std::vector<int>& movedGeometry, const std::vector<Geometry>& geometry, const AABB2& worldBounds,
+								const VisibilityPolygonQuery& visibilityQuery, const PointContainmentQuery& pointQuery, const SceneQuery& sceneQuery, JobPool* jobPool);
+	void					StoreGeometryShape(int geometryIndex, const Geometry& geometry);	//Overwrites the points, bounds and planes kept for it
+
+	//Connects each source node to every open node inside its visibility polygon, source pairs are only linked once
+	void					ConnectNodes(const std::vector<int>& sourceNodes, const VisibilityPolygonQuery& visibilityQuery, JobPool* jobPool);
+
+	void					AddEdge(int nodeIndexA, int nodeIndexB);
+	void					RemoveEdge(int nodeIndexA, int nodeIndexB);
+	void					RemoveAllEdges(int nodeIndex);
+	bool					HasEdge(int nodeIndexA, int nodeIndexB) const;
+
+	bool					IsNodePositionOpen(const Vec2& position, const AABB2& worldBounds, const PointContainmentQuery& pointQuery) const;
+	bool					DoesSegmentCrossHull(const Vec2& start, const Vec2& end, int geometryIndex) const;
+	static bool				IsSegmentClear(const Vec2& start, const Vec2& end, const SceneQuery& sceneQuery);
+
+private:
+	std::vector<NavNode>			m_nodes;
+	std::vector<std::vector<int>>	m_neighbours;		//Kept sorted
+	int								m_numEdges = 0;
+	int								m_numMovedInLastSync = 0;
+
+	//Per geometry synced: nodes [m_firstNodes[i], m_firstNodes[i + 1]), the points the nodes were made from,
+	//and the planes and bounds used to cut edges. Planes of geometry i are [m_planeOffsets[i], m_planeOffsets[i + 1])
+	std::vector<int>				m_firstNodes;
+	std::vector<std::vector<Vec2>>	m_geometryPoints;
+	std::vector<Vec2>				m_hullMins;
+	std::vector<Vec2>				m_hullMaxs;
+	std::vector<float>				m_normalX;
+	std::vector<float>				m_normalY;
+	std::vector<float>				m_distance;
+	std::vector<int>				m_planeOffsets;
+};
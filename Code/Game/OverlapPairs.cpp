@@ -0,0 +1,163 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/OverlapPairs.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/JobPool.hpp"
+#include <algorithm>
+
+//------------------------------------------------------------------------------------------------------------------------------
+OverlapPairFinder::OverlapPairFinder()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+OverlapPairFinder::~OverlapPairFinder()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void OverlapPairFinder::FindOverlappingPairs(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase, std::vector<OverlapPair>& pairsOut, JobPool* jobPool)
+{
+	BuildFromGeometry(geometry, broadPhase);
+
+	int numCells = m_cellBuckets.GetNumCellsPerAxis() * m_cellBuckets.GetNumCellsPerAxis();
+	std::vector<std::vector<OverlapPair>> cellPairs(numCells);
+	std::vector<int> cellCandidates(numCells, 0);
+
+	auto findRange = [this, &cellPairs, &cellCandidates](int startCell, int endCell)
+	{
+		std::vector<OverlapCellEntry> scratchEntries;
+		for (int cellIndex = startCell; cellIndex < endCell; cellIndex++)
+		{
+			FindPairsInCell(cellIndex, scratchEntries, cellPairs[cellIndex], cellCandidates[cellIndex]);
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(numCells, 1, findRange);
+	}
+	else
+	{
+		findRange(0, numCells);
+	}
+
+	pairsOut.clear();
+	m_numCandidatePairs = 0;
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		pairsOut.insert(pairsOut.end(), cellPairs[cellIndex].begin(), cellPairs[cellIndex].end());
+		m_numCandidatePairs += cellCandidates[cellIndex];
+	}
+
+	std::sort(pairsOut.begin(), pairsOut.end(), [](const OverlapPair& lhs, const OverlapPair& rhs)
+	{
+		if (lhs.m_geometryIndexA != rhs.m_geometryIndexA)
+			return lhs.m_geometryIndexA < rhs.m_geometryIndexA;
+
+		return lhs.m_geometryIndexB < rhs.m_geometryIndexB;
+	});
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void OverlapPairFinder::BuildFromGeometry(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase)
+{
+	m_edges.BuildFromGeometry(geometry);
+	m_cellBuckets.Build(m_edges.m_bitFields, broadPhase.GetNumBitFields());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void OverlapPairFinder::FindPairsInCell(int cellIndex, std::vector<OverlapCellEntry>& scratchEntries, std::vector<OverlapPair>& pairsOut, int& numCandidatesOut) const
+{
+	int numCellsPerAxis = m_cellBuckets.GetNumCellsPerAxis();
+	IntVec2 cell = IntVec2(cellIndex % numCellsPerAxis, cellIndex / numCellsPerAxis);
+
+	//Copy the cell's hulls next to each other so the sweep below does not jump around the hull arrays
+	scratchEntries.clear();
+	for (int bucketIndex = m_cellBuckets.GetCellStart(cellIndex); bucketIndex < m_cellBuckets.GetCellEnd(cellIndex); bucketIndex++)
+	{
+		OverlapCellEntry entry;
+		entry.m_hullIndex = m_cellBuckets.GetEntry(bucketIndex);
+		entry.m_mins = m_edges.m_hullMins[entry.m_hullIndex];
+		entry.m_maxs = m_edges.m_hullMaxs[entry.m_hullIndex];
+		entry.m_firstCell = m_cellBuckets.GetFirstCell(entry.m_hullIndex);
+		scratchEntries.push_back(entry);
+	}
+
+	std::sort(scratchEntries.begin(), scratchEntries.end(), [](const OverlapCellEntry& lhs, const OverlapCellEntry& rhs)
+	{
+		return lhs.m_mins.x < rhs.m_mins.x;
+	});
+
+	int numEntries = (int)scratchEntries.size();
+	for (int entryIndexA = 0; entryIndexA < numEntries; entryIndexA++)
+	{
+		const OverlapCellEntry& entryA = scratchEntries[entryIndexA];
+
+		//Sorted on the min x, so the first entry starting past A's max x ends the sweep for A
+		for (int entryIndexB = entryIndexA + 1; entryIndexB < numEntries && scratchEntries[entryIndexB].m_mins.x <= entryA.m_maxs.x; entryIndexB++)
+		{
+			const OverlapCellEntry& entryB = scratchEntries[entryIndexB];
+			if (entryA.m_mins.y > entryB.m_maxs.y || entryB.m_mins.y > entryA.m_maxs.y)
+				continue;
+
+			//The cells both hulls cover start at the larger of their first cells, only that cell reports the pair
+			int sharedFirstX = (entryA.m_firstCell.x > entryB.m_firstCell.x) ? entryA.m_firstCell.x : entryB.m_firstCell.x;
+			int sharedFirstY = (entryA.m_firstCell.y > entryB.m_firstCell.y) ? entryA.m_firstCell.y : entryB.m_firstCell.y;
+			if (cell.x != sharedFirstX || cell.y != sharedFirstY)
+				continue;
+
+			numCandidatesOut++;
+			if (DoHullsOverlap(entryA.m_hullIndex, entryB.m_hullIndex))
+			{
+				//Hulls are in geometry order so the lower hull index is also the lower geometry index
+				OverlapPair pair;
+				bool isAFirst = entryA.m_hullIndex < entryB.m_hullIndex;
+				pair.m_geometryIndexA = m_edges.m_geometryIndices[isAFirst ? entryA.m_hullIndex : entryB.m_hullIndex];
+				pair.m_geometryIndexB = m_edges.m_geometryIndices[isAFirst ? entryB.m_hullIndex : entryA.m_hullIndex];
+				pairsOut.push_back(pair);
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool OverlapPairFinder::DoHullsOverlap(int hullIndexA, int hullIndexB) const
+{
+	//Two convex polygons are disjoint exactly when a face normal of one of them separates them
+	if (IsSeparatedByFaceOf(hullIndexA, hullIndexB))
+		return false;
+
+	return !IsSeparatedByFaceOf(hullIndexB, hullIndexA);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool OverlapPairFinder::IsSeparatedByFaceOf(int faceHullIndex, int vertexHullIndex) const
+{
+	int vertexStart = m_edges.m_vertexOffsets[vertexHullIndex];
+	int vertexEnd = m_edges.m_vertexOffsets[vertexHullIndex + 1];
+
+	const float* vertexX = m_edges.m_vertexX.data();
+	const float* vertexY = m_edges.m_vertexY.data();
+
+	//Edge planes share the vertex indexing, edge j is the face starting at vertex j
+	for (int planeIndex = m_edges.m_vertexOffsets[faceHullIndex]; planeIndex < m_edges.m_vertexOffsets[faceHullIndex + 1]; planeIndex++)
+	{
+		float normalX = m_edges.m_normalX[planeIndex];
+		float normalY = m_edges.m_normalY[planeIndex];
+		float distance = m_edges.m_distance[planeIndex];
+
+		//The face separates when every vertex of the other hull is in front of it
+		bool isSeparating = true;
+		for (int vertexIndex = vertexStart; vertexIndex < vertexEnd; vertexIndex++)
+		{
+			isSeparating &= (normalX * vertexX[vertexIndex] + normalY * vertexY[vertexIndex] > distance);
+		}
+
+		if (isSeparating)
+			return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include "Game/HullEdges.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+class JobPool;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct OverlapPair
+{
+	int		m_geometryIndexA = -1;		//Always the lower of the two indices
+	int		m_geometryIndexB = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct OverlapCellEntry
+{
+	Vec2	m_mins;
+	Vec2	m_maxs;
+	IntVec2	m_firstCell;
+	int		m_hullIndex = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Finds every pair of overlapping polygons. Candidate pairs come from hulls sharing a broadphase cell, each pair only
+//from the first cell both are in. Inside a cell the hulls are swept along x so only bounds overlapping on x get paired,
+//and those are confirmed with a separating axis test over the polygon edge normals
+//Cells are independent so they are spread across the job pool, results are merged back in cell order
+//------------------------------------------------------------------------------------------------------------------------------
+class OverlapPairFinder
+{
+public:
+	OverlapPairFinder();
+	~OverlapPairFinder();
+
+	//Pairs are sorted by geometry index, touching polygons count as overlapping
+	void					FindOverlappingPairs(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase, std::vector<OverlapPair>& pairsOut, JobPool* jobPool = nullptr);
+
+	int						GetNumCandidatePairs() const { return m_numCandidatePairs; }
+
+private:
+	void					BuildFromGeometry(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase);
+	void					FindPairsInCell(int cellIndex, std::vector<OverlapCellEntry>& scratchEntries, std::vector<OverlapPair>& pairsOut, int& numCandidatesOut) const;
+
+	bool					DoHullsOverlap(int hullIndexA, int hullIndexB) const;
+	bool					IsSeparatedByFaceOf(int faceHullIndex, int vertexHullIndex) const;
+
+private:
+	HullEdgeArrays			m_edges;
+	BitFieldCellBuckets		m_cellBuckets;
+
+	int						m_numCandidatePairs = 0;
+};
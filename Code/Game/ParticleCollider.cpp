@@ -0,0 +1,326 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/ParticleCollider.hpp"
+#include "Engine/Math/ConvexHull2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/JobPool.hpp"
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+
+//------------------------------------------------------------------------------------------------------------------------------
+DiscParticleCollider::DiscParticleCollider()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+DiscParticleCollider::~DiscParticleCollider()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void DiscParticleCollider::BuildStaticHulls(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase, const AABB2& worldBounds)
+{
+	ClearStaticHulls();
+
+	m_broadPhase = &broadPhase;
+	m_worldBounds = worldBounds;
+	m_planeOffsets.push_back(0);
+	m_vertexOffsets.push_back(0);
+
+	std::vector<IntVec2> bitFields;
+	bitFields.reserve(geometry.size());
+	for (int geometryIndex = 0; geometryIndex < (int)geometry.size(); geometryIndex++)
+	{
+		const std::vector<Plane2D>& planes = geometry[geometryIndex].GetConvexHull2D().GetPlanes();
+		for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++)
+		{
+			m_normalX.push_back(planes[planeIndex].GetNormal().x);
+			m_normalY.push_back(planes[planeIndex].GetNormal().y);
+			m_distance.push_back(planes[planeIndex].GetSignedDistance());
+		}
+		m_planeOffsets.push_back((int)m_distance.size());
+
+		const std::vector<Vec2>& points = geometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+		Vec2 hullMins = points.empty() ? Vec2::ZERO : points[0];
+		Vec2 hullMaxs = hullMins;
+		for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+		{
+			m_vertexX.push_back(points[pointIndex].x);
+			m_vertexY.push_back(points[pointIndex].y);
+
+			hullMins.x = GetLowerValue(hullMins.x, points[pointIndex].x);
+			hullMins.y = GetLowerValue(hullMins.y, points[pointIndex].y);
+			hullMaxs.x = GetHigherValue(hullMaxs.x, points[pointIndex].x);
+			hullMaxs.y = GetHigherValue(hullMaxs.y, points[pointIndex].y);
+		}
+		m_vertexOffsets.push_back((int)m_vertexX.size());
+
+		//Grown by the radius so a particle only has to look in the cell its center is in
+		Vec2 radiusOffset = Vec2(PARTICLE_RADIUS, PARTICLE_RADIUS);
+		bitFields.push_back(points.empty() ? IntVec2::ZERO : broadPhase.GetRegionIDForMinMaxs(hullMins - radiusOffset, hullMaxs + radiusOffset));
+	}
+
+	m_cellBuckets.Build(bitFields, broadPhase.GetNumBitFields());
+	m_numStepsSinceSort = PARTICLE_SORT_INTERVAL;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void DiscParticleCollider::ClearStaticHulls()
+{
+	m_broadPhase = nullptr;
+
+	m_normalX.clear();
+	m_normalY.clear();
+	m_distance.clear();
+	m_planeOffsets.clear();
+
+	m_vertexX.clear();
+	m_vertexY.clear();
+	m_vertexOffsets.clear();
+
+	m_cellBuckets.Clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void DiscParticleCollider::AddParticle(const Vec2& position, const Vec2& velocity)
+{
+	m_positionX.push_back(position.x);
+	m_positionY.push_back(position.y);
+	m_velocityX.push_back(velocity.x);
+	m_velocityY.push_back(velocity.y);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void DiscParticleCollider::ClearParticles()
+{
+	m_positionX.clear();
+	m_positionY.clear();
+	m_velocityX.clear();
+	m_velocityY.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int DiscParticleCollider::Step(float deltaSeconds, JobPool* jobPool)
+{
+	if (m_broadPhase == nullptr)
+		return 0;
+
+	if (m_numStepsSinceSort >= PARTICLE_SORT_INTERVAL)
+	{
+		SortParticlesByCell();
+		m_numStepsSinceSort = 0;
+	}
+	m_numStepsSinceSort++;
+
+	//Particles only touch hulls, so any split of the arrays can run at once
+	std::atomic<int> numContacts{ 0 };
+	auto stepRange = [this, deltaSeconds, &numContacts](int startIndex, int endIndex)
+	{
+		IntegrateRange(startIndex, endIndex, deltaSeconds);
+		numContacts += CollideRange(startIndex, endIndex);
+	};
+
+	int numParticles = GetNumParticles();
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(numParticles, PARTICLE_STEP_GRAIN_SIZE, stepRange);
+	}
+	else
+	{
+		stepRange(0, numParticles);
+	}
+
+	return numContacts;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void DiscParticleCollider::IntegrateRange(int startIndex, int endIndex, float deltaSeconds)
+{
+	float* positionX = m_positionX.data();
+	float* positionY = m_positionY.data();
+	float* velocityX = m_velocityX.data();
+	float* velocityY = m_velocityY.data();
+
+	//No branches or calls, so the compiler turns this into packed float math
+	float gravityStep = PARTICLE_GRAVITY * deltaSeconds;
+	for (int particleIndex = startIndex; particleIndex < endIndex; particleIndex++)
+	{
+		velocityY[particleIndex] += gravityStep;
+		positionX[particleIndex] += velocityX[particleIndex] * deltaSeconds;
+		positionY[particleIndex] += velocityY[particleIndex] * deltaSeconds;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int DiscParticleCollider::CollideRange(int startIndex, int endIndex)
+{
+	float minX = m_worldBounds.m_minBounds.x + PARTICLE_RADIUS;
+	float minY = m_worldBounds.m_minBounds.y + PARTICLE_RADIUS;
+	float maxX = m_worldBounds.m_maxBounds.x - PARTICLE_RADIUS;
+	float maxY = m_worldBounds.m_maxBounds.y - PARTICLE_RADIUS;
+
+	int numContacts = 0;
+	for (int particleIndex = startIndex; particleIndex < endIndex; particleIndex++)
+	{
+		float positionX = m_positionX[particleIndex];
+		float positionY = m_positionY[particleIndex];
+		float velocityX = m_velocityX[particleIndex];
+		float velocityY = m_velocityY[particleIndex];
+
+		int cellIndex = m_cellBuckets.GetCellIndex(m_broadPhase->GetCellForPoint(Vec2(positionX, positionY)));
+		bool isTouching = false;
+		for (int bucketIndex = m_cellBuckets.GetCellStart(cellIndex); bucketIndex < m_cellBuckets.GetCellEnd(cellIndex); bucketIndex++)
+		{
+			isTouching |= PushOutOfHull(m_cellBuckets.GetEntry(bucketIndex), positionX, positionY, velocityX, velocityY);
+		}
+		numContacts += isTouching ? 1 : 0;
+
+		//The world bounds are walls
+		if (positionX < minX || positionX > maxX)
+		{
+			positionX = Clamp(positionX, minX, maxX);
+			velocityX = -velocityX * PARTICLE_RESTITUTION;
+		}
+		if (positionY < minY || positionY > maxY)
+		{
+			positionY = Clamp(positionY, minY, maxY);
+			velocityY = -velocityY * PARTICLE_RESTITUTION;
+		}
+
+		m_positionX[particleIndex] = positionX;
+		m_positionY[particleIndex] = positionY;
+		m_velocityX[particleIndex] = velocityX;
+		m_velocityY[particleIndex] = velocityY;
+	}
+
+	return numContacts;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool DiscParticleCollider::PushOutOfHull(int hullIndex, float& positionX, float& positionY, float& velocityX, float& velocityY) const
+{
+	int planeStart = m_planeOffsets[hullIndex];
+	int planeEnd = m_planeOffsets[hullIndex + 1];
+
+	//Furthest plane first, nearly every particle is rejected by it being further than the radius
+	float maxSeparation = -FLT_MAX;
+	int maxPlaneIndex = planeStart;
+	for (int planeIndex = planeStart; planeIndex < planeEnd; planeIndex++)
+	{
+		float separation = m_normalX[planeIndex] * positionX + m_normalY[planeIndex] * positionY - m_distance[planeIndex];
+		if (separation > maxSeparation)
+		{
+			maxSeparation = separation;
+			maxPlaneIndex = planeIndex;
+		}
+	}
+
+	if (maxSeparation >= PARTICLE_RADIUS || planeEnd == planeStart)
+		return false;
+
+	float normalX = m_normalX[maxPlaneIndex];
+	float normalY = m_normalY[maxPlaneIndex];
+	float depth = PARTICLE_RADIUS - maxSeparation;
+
+	//Outside the hull the closest feature can be a corner, which is further away than the plane says
+	if (maxSeparation > 0.f)
+	{
+		int vertexStart = m_vertexOffsets[hullIndex];
+		int vertexEnd = m_vertexOffsets[hullIndex + 1];
+
+		float closestDistanceSquared = FLT_MAX;
+		float closestX = positionX;
+		float closestY = positionY;
+		for (int vertexIndex = vertexStart; vertexIndex < vertexEnd; vertexIndex++)
+		{
+			int nextIndex = (vertexIndex + 1 < vertexEnd) ? vertexIndex + 1 : vertexStart;
+			float edgeX = m_vertexX[nextIndex] - m_vertexX[vertexIndex];
+			float edgeY = m_vertexY[nextIndex] - m_vertexY[vertexIndex];
+			float edgeLengthSquared = edgeX * edgeX + edgeY * edgeY;
+
+			float fraction = 0.f;
+			if (edgeLengthSquared > 0.f)
+			{
+				fraction = ((positionX - m_vertexX[vertexIndex]) * edgeX + (positionY - m_vertexY[vertexIndex]) * edgeY) / edgeLengthSquared;
+				fraction = Clamp(fraction, 0.f, 1.f);
+			}
+
+			float pointX = m_vertexX[vertexIndex] + edgeX * fraction;
+			float pointY = m_vertexY[vertexIndex] + edgeY * fraction;
+			float distanceSquared = (positionX - pointX) * (positionX - pointX) + (positionY - pointY) * (positionY - pointY);
+			if (distanceSquared < closestDistanceSquared)
+			{
+				closestDistanceSquared = distanceSquared;
+				closestX = pointX;
+				closestY = pointY;
+			}
+		}
+
+		if (closestDistanceSquared >= PARTICLE_RADIUS * PARTICLE_RADIUS)
+			return false;
+
+		float closestDistance = sqrtf(closestDistanceSquared);
+		if (closestDistance > 0.f)
+		{
+			normalX = (positionX - closestX) / closestDistance;
+			normalY = (positionY - closestY) / closestDistance;
+		}
+		depth = PARTICLE_RADIUS - closestDistance;
+	}
+
+	positionX += normalX * depth;
+	positionY += normalY * depth;
+
+	//Only the speed into the surface bounces, sliding along it is kept
+	float normalSpeed = velocityX * normalX + velocityY * normalY;
+	if (normalSpeed < 0.f)
+	{
+		velocityX -= (1.f + PARTICLE_RESTITUTION) * normalSpeed * normalX;
+		velocityY -= (1.f + PARTICLE_RESTITUTION) * normalSpeed * normalY;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void DiscParticleCollider::SortParticlesByCell()
+{
+	//Counting sort on the cell index, stable so particles keep their order inside a cell
+	int numParticles = GetNumParticles();
+	int numCells = m_cellBuckets.GetNumCellsPerAxis() * m_cellBuckets.GetNumCellsPerAxis();
+
+	std::vector<int> particleCells(numParticles);
+	std::vector<int> cellStarts(numCells + 1, 0);
+	for (int particleIndex = 0; particleIndex < numParticles; particleIndex++)
+	{
+		particleCells[particleIndex] = m_cellBuckets.GetCellIndex(m_broadPhase->GetCellForPoint(Vec2(m_positionX[particleIndex], m_positionY[particleIndex])));
+		cellStarts[particleCells[particleIndex] + 1]++;
+	}
+
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		cellStarts[cellIndex + 1] += cellStarts[cellIndex];
+	}
+
+	std::vector<float> sortedPositionX(numParticles);
+	std::vector<float> sortedPositionY(numParticles);
+	std::vector<float> sortedVelocityX(numParticles);
+	std::vector<float> sortedVelocityY(numParticles);
+	for (int particleIndex = 0; particleIndex < numParticles; particleIndex++)
+	{
+		int sortedIndex = cellStarts[particleCells[particleIndex]]++;
+		sortedPositionX[sortedIndex] = m_positionX[particleIndex];
+		sortedPositionY[sortedIndex] = m_positionY[particleIndex];
+		sortedVelocityX[sortedIndex] = m_velocityX[particleIndex];
+		sortedVelocityY[sortedIndex] = m_velocityY[particleIndex];
+	}
+
+	m_positionX.swap(sortedPositionX);
+	m_positionY.swap(sortedPositionY);
+	m_velocityX.swap(sortedVelocityX);
+	m_velocityY.swap(sortedVelocityY);
+}
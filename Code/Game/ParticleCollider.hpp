@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+class JobPool;
+
+constexpr float PARTICLE_RADIUS = 0.2f;
+constexpr float PARTICLE_RESTITUTION = 0.5f;		//Share of the speed into a surface a particle keeps bouncing off it
+constexpr float PARTICLE_GRAVITY = -20.f;			//World units per second squared along y
+constexpr int PARTICLE_SORT_INTERVAL = 16;			//Steps between re-sorting the particles by cell
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Discs of one radius colliding with the static scene hulls, nothing else. Positions and velocities are separate float
+//arrays and each step is one pass over them across the job pool: a straight integration loop the compiler can vectorize,
+//then every particle tests the hulls bucketed in its broadphase cell and is pushed out of any it ends up in
+//Hulls are bucketed with their bounds grown by the radius, so the cell under a particle's center holds all it can touch
+//Particles are sorted by cell every few steps so neighbours in the arrays read the same hulls
+//------------------------------------------------------------------------------------------------------------------------------
+class DiscParticleCollider
+{
+public:
+	DiscParticleCollider();
+	~DiscParticleCollider();
+
+	void					BuildStaticHulls(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase, const AABB2& worldBounds);
+	void					ClearStaticHulls();
+
+	void					AddParticle(const Vec2& position, const Vec2& velocity);
+	void					ClearParticles();
+
+	//Returns the number of particles that touched a hull
+	int						Step(float deltaSeconds, JobPool* jobPool = nullptr);
+
+	int						GetNumParticles() const { return (int)m_positionX.size(); }
+	Vec2					GetParticlePosition(int particleIndex) const { return Vec2(m_positionX[particleIndex], m_positionY[particleIndex]); }
+	Vec2					GetParticleVelocity(int particleIndex) const { return Vec2(m_velocityX[particleIndex], m_velocityY[particleIndex]); }
+
+private:
+	void					IntegrateRange(int startIndex, int endIndex, float deltaSeconds);
+	int						CollideRange(int startIndex, int endIndex);
+
+	//Moves the disc out of the hull along the shortest way and takes out its speed into it, false when they do not touch
+	bool					PushOutOfHull(int hullIndex, float& positionX, float& positionY, float& velocityX, float& velocityY) const;
+
+	void					SortParticlesByCell();
+
+private:
+	const BitFieldBroadPhase*	m_broadPhase = nullptr;
+	AABB2					m_worldBounds;
+
+	std::vector<float>		m_positionX;
+	std::vector<float>		m_positionY;
+	std::vector<float>		m_velocityX;
+	std::vector<float>		m_velocityY;
+
+	//Planes and vertices of hull i are [m_planeOffsets[i], m_planeOffsets[i + 1]) and [m_vertexOffsets[i], m_vertexOffsets[i + 1])
+	std::vector<float>		m_normalX;
+	std::vector<float>		m_normalY;
+	std::vector<float>		m_distance;
+	std::vector<int>		m_planeOffsets;
+
+	std::vector<float>		m_vertexX;
+	std::vector<float>		m_vertexY;
+	std::vector<int>		m_vertexOffsets;
+
+	BitFieldCellBuckets		m_cellBuckets;
+
+	int						m_numStepsSinceSort = 0;
+};
@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PointQuery.hpp"
+#include "Engine/Math/ConvexHull2D.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/JobPool.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+PointContainmentQuery::PointContainmentQuery()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PointContainmentQuery::~PointContainmentQuery()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PointContainmentQuery::BuildFromGeometry(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase)
+{
+	Clear();
+
+	m_broadPhase = &broadPhase;
+	m_planeOffsets.push_back(0);
+
+	for (int geometryIndex = 0; geometryIndex < (int)geometry.size(); geometryIndex++)
+	{
+		const std::vector<Plane2D>& planes = geometry[geometryIndex].GetConvexHull2D().GetPlanes();
+		for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++)
+		{
+			m_normalX.push_back(planes[planeIndex].GetNormal().x);
+			m_normalY.push_back(planes[planeIndex].GetNormal().y);
+			m_distance.push_back(planes[planeIndex].GetSignedDistance());
+		}
+
+		m_planeOffsets.push_back((int)m_distance.size());
+		m_geometryIndices.push_back(geometryIndex);
+		m_hullBitFields.push_back(geometry[geometryIndex].GetBitFields());
+	}
+
+	m_cellBuckets.Build(m_hullBitFields, broadPhase.GetNumBitFields(), CELL_BUCKET_REFIT_SLACK);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int PointContainmentQuery::RefitMovedGeometry(const std::vector<Geometry>& geometry, const std::vector<int>& movedGeometryIndices)
+{
+	int numCellChanges = 0;
+	bool needsBucketRebuild = false;
+
+	//Every geometry is a hull here, so the indices match
+	for (int movedIndex = 0; movedIndex < (int)movedGeometryIndices.size(); movedIndex++)
+	{
+		int hullIndex = movedGeometryIndices[movedIndex];
+		const std::vector<Plane2D>& planes = geometry[hullIndex].GetConvexHull2D().GetPlanes();
+		int planeStart = m_planeOffsets[hullIndex];
+		for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++)
+		{
+			m_distance[planeStart + planeIndex] = planes[planeIndex].GetSignedDistance();
+		}
+
+		const IntVec2& newBitFields = geometry[hullIndex].GetBitFields();
+		IntVec2& hullBitFields = m_hullBitFields[hullIndex];
+		if (hullBitFields.x == newBitFields.x && hullBitFields.y == newBitFields.y)
+			continue;
+
+		numCellChanges++;
+		if (!needsBucketRebuild && !m_cellBuckets.MoveEntry(hullIndex, hullBitFields, newBitFields))
+		{
+			needsBucketRebuild = true;
+		}
+		hullBitFields = newBitFields;
+	}
+
+	if (needsBucketRebuild)
+	{
+		m_cellBuckets.Build(m_hullBitFields, m_broadPhase->GetNumBitFields(), CELL_BUCKET_REFIT_SLACK);
+	}
+
+	return numCellChanges;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PointContainmentQuery::Clear()
+{
+	m_broadPhase = nullptr;
+
+	m_normalX.clear();
+	m_normalY.clear();
+	m_distance.clear();
+	m_planeOffsets.clear();
+	m_geometryIndices.clear();
+	m_hullBitFields.clear();
+	m_cellBuckets.Clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int PointContainmentQuery::GetGeometryContainingPoint(const Vec2& point) const
+{
+	if (m_broadPhase == nullptr)
+		return -1;
+
+	int cellIndex = m_cellBuckets.GetCellIndex(m_broadPhase->GetCellForPoint(point));
+
+	//Walk the bucket backwards so the first hull that contains the point is also the top most one
+	for (int bucketIndex = m_cellBuckets.GetCellEnd(cellIndex) - 1; bucketIndex >= m_cellBuckets.GetCellStart(cellIndex); bucketIndex--)
+	{
+		int hullIndex = m_cellBuckets.GetEntry(bucketIndex);
+		if (IsPointInsideHull(hullIndex, point.x, point.y))
+			return m_geometryIndices[hullIndex];
+	}
+
+	return -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PointContainmentQuery::QueryPoints(const std::vector<Vec2>& points, std::vector<int>& geometryIndicesOut, JobPool* jobPool) const
+{
+	int numPoints = (int)points.size();
+	geometryIndicesOut.resize(numPoints);
+
+	auto queryRange = [this, &points, &geometryIndicesOut](int startIndex, int endIndex)
+	{
+		for (int pointIndex = startIndex; pointIndex < endIndex; pointIndex++)
+		{
+			geometryIndicesOut[pointIndex] = GetGeometryContainingPoint(points[pointIndex]);
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(numPoints, POINT_QUERY_GRAIN_SIZE, queryRange);
+	}
+	else
+	{
+		queryRange(0, numPoints);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PointContainmentQuery::IsPointInsideHull(int hullIndex, float pointX, float pointY) const
+{
+	int planeStart = m_planeOffsets[hullIndex];
+	int planeEnd = m_planeOffsets[hullIndex + 1];
+
+	const float* normalX = m_normalX.data();
+	const float* normalY = m_normalY.data();
+	const float* distance = m_distance.data();
+
+	//No early out, hulls are small and a straight loop over the SoA arrays vectorizes
+	bool isInside = true;
+	for (int planeIndex = planeStart; planeIndex < planeEnd; planeIndex++)
+	{
+		isInside &= (normalX[planeIndex] * pointX + normalY[planeIndex] * pointY <= distance[planeIndex]);
+	}
+
+	return isInside;
+}
@@ -0,0 +1,52 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+class JobPool;
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Answers which geometry contains a point. Hulls are bucketed per broadphase cell using their bit fields so a point
+//only tests the hulls in its own cell, and the test itself is a half-plane check over SoA plane arrays
+//When hulls overlap the highest geometry index wins since that is the one drawn on top
+//------------------------------------------------------------------------------------------------------------------------------
+class PointContainmentQuery
+{
+public:
+	PointContainmentQuery();
+	~PointContainmentQuery();
+
+	void					BuildFromGeometry(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase);
+	void					Clear();
+
+	//Follows geometry moved since the build, plane distances are copied and only changed bit fields touch the buckets
+	//Returns how many hulls changed cells
+	int						RefitMovedGeometry(const std::vector<Geometry>& geometry, const std::vector<int>& movedGeometryIndices);
+
+	//Returns the geometry index containing the point or -1, points on a hull boundary count as inside
+	int						GetGeometryContainingPoint(const Vec2& point) const;
+
+	//Batched form, geometryIndicesOut is resized to match points. Runs across the job pool when one is passed in
+	void					QueryPoints(const std::vector<Vec2>& points, std::vector<int>& geometryIndicesOut, JobPool* jobPool = nullptr) const;
+
+	int						GetNumHulls() const { return (int)m_geometryIndices.size(); }
+
+private:
+	bool					IsPointInsideHull(int hullIndex, float pointX, float pointY) const;
+
+private:
+	const BitFieldBroadPhase*	m_broadPhase = nullptr;
+
+	//Planes of hull i are [m_planeOffsets[i], m_planeOffsets[i + 1])
+	std::vector<float>		m_normalX;
+	std::vector<float>		m_normalY;
+	std::vector<float>		m_distance;
+	std::vector<int>		m_planeOffsets;
+	std::vector<int>		m_geometryIndices;
+	std::vector<IntVec2>	m_hullBitFields;
+
+	BitFieldCellBuckets		m_cellBuckets;
+};
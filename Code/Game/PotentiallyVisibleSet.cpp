@@ -0,0 +1,469 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PotentiallyVisibleSet.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/Ray2D.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/JobPool.hpp"
+#include "Game/SceneQuery.hpp"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static int CountBitsInByte(uint8_t value)
+{
+	value = value - ((value >> 1) & 0x55);
+	value = (value & 0x33) + ((value >> 2) & 0x33);
+	return (value + (value >> 4)) & 0x0F;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Lowest and highest of dot(normal, x - origin) over the box
+static void GetBoxRangeAlongNormal(const Vec2& mins, const Vec2& maxs, const Vec2& origin, const Vec2& normal, float& lowestOut, float& highestOut)
+{
+	float lowX = normal.x * ((normal.x > 0.f ? mins.x : maxs.x) - origin.x);
+	float highX = normal.x * ((normal.x > 0.f ? maxs.x : mins.x) - origin.x);
+	float lowY = normal.y * ((normal.y > 0.f ? mins.y : maxs.y) - origin.y);
+	float highY = normal.y * ((normal.y > 0.f ? maxs.y : mins.y) - origin.y);
+	lowestOut = lowX + lowY;
+	highestOut = highX + highY;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PotentiallyVisibleSet::PotentiallyVisibleSet()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PotentiallyVisibleSet::~PotentiallyVisibleSet()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PotentiallyVisibleSet::Bake(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase, JobPool* jobPool)
+{
+	Clear();
+	m_numCellsPerAxis = broadPhase.GetNumBitFields();
+	m_sceneSignature = ComputeSceneSignature(geometry);
+
+	//Hulls narrower than the cells in every direction can never block a pair, they are left out of the occluder scene
+	Vec2 firstCellMins;
+	Vec2 firstCellMaxs;
+	broadPhase.GetCellBounds(IntVec2::ZERO, firstCellMins, firstCellMaxs);
+	float narrowestCellSide = GetLowerValue(firstCellMaxs.x - firstCellMins.x, firstCellMaxs.y - firstCellMins.y);
+
+	std::vector<Geometry> occluders;
+	m_planeOffsets.push_back(0);
+	m_vertexOffsets.push_back(0);
+	for (int geometryIndex = 0; geometryIndex < (int)geometry.size(); geometryIndex++)
+	{
+		const std::vector<Vec2>& points = geometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+		if (points.empty())
+			continue;
+
+		Vec2 hullMins = points[0];
+		Vec2 hullMaxs = points[0];
+		for (int pointIndex = 1; pointIndex < (int)points.size(); pointIndex++)
+		{
+			hullMins = Vec2(GetLowerValue(hullMins.x, points[pointIndex].x), GetLowerValue(hullMins.y, points[pointIndex].y));
+			hullMaxs = Vec2(GetHigherValue(hullMaxs.x, points[pointIndex].x), GetHigherValue(hullMaxs.y, points[pointIndex].y));
+		}
+
+		if ((hullMaxs - hullMins).GetLength() < narrowestCellSide - PVS_TOLERANCE)
+			continue;
+
+		occluders.push_back(geometry[geometryIndex]);
+
+		const std::vector<Plane2D>& planes = geometry[geometryIndex].GetConvexHull2D().GetPlanes();
+		for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++)
+		{
+			m_normalX.push_back(planes[planeIndex].GetNormal().x);
+			m_normalY.push_back(planes[planeIndex].GetNormal().y);
+			m_distance.push_back(planes[planeIndex].GetSignedDistance());
+		}
+		m_planeOffsets.push_back((int)m_distance.size());
+
+		m_vertices.insert(m_vertices.end(), points.begin(), points.end());
+		m_vertexOffsets.push_back((int)m_vertices.size());
+	}
+
+	SceneQuery occluderQuery;
+	occluderQuery.BuildFromGeometry(occluders, broadPhase);
+
+	int numCells = m_numCellsPerAxis * m_numCellsPerAxis;
+	std::vector<Vec2> cellMins(numCells);
+	std::vector<Vec2> cellMaxs(numCells);
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		broadPhase.GetCellBounds(IntVec2(cellIndex % m_numCellsPerAxis, cellIndex / m_numCellsPerAxis), cellMins[cellIndex], cellMaxs[cellIndex]);
+	}
+
+	//Each row solves the cells after it, the lower triangle is mirrored in afterwards so no two workers write the same byte
+	int numBytesPerRow = GetNumBytesPerRow();
+	std::vector<uint8_t> denseBits(numCells * numBytesPerRow, 0);
+	auto solveRows = [this, numCells, numBytesPerRow, &cellMins, &cellMaxs, &occluderQuery, &denseBits](int startIndex, int endIndex)
+	{
+		RayInterval2D intervals[PVS_MAX_OCCLUDERS];
+
+		for (int rowIndex = startIndex; rowIndex < endIndex; rowIndex++)
+		{
+			uint8_t* rowBits = &denseBits[rowIndex * numBytesPerRow];
+			rowBits[rowIndex / 8] |= (uint8_t)(1 << (rowIndex % 8));
+
+			Vec2 centerA = (cellMins[rowIndex] + cellMaxs[rowIndex]) * 0.5f;
+			for (int columnIndex = rowIndex + 1; columnIndex < numCells; columnIndex++)
+			{
+				Vec2 centerB = (cellMins[columnIndex] + cellMaxs[columnIndex]) * 0.5f;
+				Vec2 displacement = centerB - centerA;
+				float length = displacement.GetLength();
+
+				Ray2D ray(centerA, displacement * (1.f / length));
+				int numIntervals = occluderQuery.RaycastAll(ray, intervals, PVS_MAX_OCCLUDERS, length);
+
+				bool isHidden = false;
+				for (int intervalIndex = 0; intervalIndex < numIntervals && !isHidden; intervalIndex++)
+				{
+					isHidden = DoesHullBlockCells(intervals[intervalIndex].m_geometryIndex, cellMins[rowIndex], cellMaxs[rowIndex], cellMins[columnIndex], cellMaxs[columnIndex]);
+				}
+
+				if (!isHidden)
+				{
+					rowBits[columnIndex / 8] |= (uint8_t)(1 << (columnIndex % 8));
+				}
+			}
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(numCells, PVS_BAKE_GRAIN_SIZE, solveRows);
+	}
+	else
+	{
+		solveRows(0, numCells);
+	}
+
+	for (int rowIndex = 0; rowIndex < numCells; rowIndex++)
+	{
+		const uint8_t* rowBits = &denseBits[rowIndex * numBytesPerRow];
+		for (int columnIndex = rowIndex + 1; columnIndex < numCells; columnIndex++)
+		{
+			if (rowBits[columnIndex / 8] & (1 << (columnIndex % 8)))
+			{
+				denseBits[columnIndex * numBytesPerRow + rowIndex / 8] |= (uint8_t)(1 << (rowIndex % 8));
+				m_numVisiblePairs++;
+			}
+		}
+	}
+
+	//Cells on the same side of the same occluders see the same cells, their row is stored once
+	std::map<std::vector<uint8_t>, uint16_t> uniqueRows;
+	m_rowIndices.reserve(numCells);
+	for (int rowIndex = 0; rowIndex < numCells; rowIndex++)
+	{
+		std::vector<uint8_t> rowBits(denseBits.begin() + rowIndex * numBytesPerRow, denseBits.begin() + (rowIndex + 1) * numBytesPerRow);
+		std::map<std::vector<uint8_t>, uint16_t>::iterator foundRow = uniqueRows.find(rowBits);
+		if (foundRow != uniqueRows.end())
+		{
+			m_rowIndices.push_back(foundRow->second);
+			continue;
+		}
+
+		uint16_t uniqueRowIndex = (uint16_t)m_rowOffsets.size();
+		uniqueRows[rowBits] = uniqueRowIndex;
+		m_rowIndices.push_back(uniqueRowIndex);
+
+		m_rowOffsets.push_back((uint32_t)m_compressedBytes.size());
+		CompressRow(rowBits.data(), numBytesPerRow, m_compressedBytes);
+	}
+	m_rowOffsets.push_back((uint32_t)m_compressedBytes.size());
+
+	m_normalX.clear();
+	m_normalY.clear();
+	m_distance.clear();
+	m_planeOffsets.clear();
+	m_vertices.clear();
+	m_vertexOffsets.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PotentiallyVisibleSet::Clear()
+{
+	m_numCellsPerAxis = 0;
+	m_numVisiblePairs = 0;
+	m_sceneSignature = 0;
+	m_rowIndices.clear();
+	m_rowOffsets.clear();
+	m_compressedBytes.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PotentiallyVisibleSet::SetCompressed(int numCellsPerAxis, uint32_t sceneSignature, const std::vector<uint16_t>& rowIndices, const std::vector<uint32_t>& rowOffsets,
+	const std::vector<uint8_t>& compressedBytes)
+{
+	Clear();
+
+	int numCells = numCellsPerAxis * numCellsPerAxis;
+	int numUniqueRows = (int)rowOffsets.size() - 1;
+	if (numCellsPerAxis <= 0 || (int)rowIndices.size() != numCells || numUniqueRows < 1 || rowOffsets[0] != 0 || rowOffsets[numUniqueRows] != (uint32_t)compressedBytes.size())
+		return false;
+
+	for (int uniqueRowIndex = 0; uniqueRowIndex < numUniqueRows; uniqueRowIndex++)
+	{
+		if (rowOffsets[uniqueRowIndex] > rowOffsets[uniqueRowIndex + 1])
+			return false;
+	}
+
+	for (int rowIndex = 0; rowIndex < numCells; rowIndex++)
+	{
+		if (rowIndices[rowIndex] >= numUniqueRows)
+			return false;
+	}
+
+	m_numCellsPerAxis = numCellsPerAxis;
+	m_sceneSignature = sceneSignature;
+	m_rowIndices = rowIndices;
+	m_rowOffsets = rowOffsets;
+	m_compressedBytes = compressedBytes;
+
+	//Every pair is stored in both rows and every cell sees itself
+	int numSetBits = 0;
+	std::vector<uint8_t> rowBits;
+	for (int rowIndex = 0; rowIndex < numCells; rowIndex++)
+	{
+		DecompressRow(IntVec2(rowIndex % numCellsPerAxis, rowIndex / numCellsPerAxis), rowBits);
+		for (int byteIndex = 0; byteIndex < (int)rowBits.size(); byteIndex++)
+		{
+			numSetBits += CountBitsInByte(rowBits[byteIndex]);
+		}
+	}
+	m_numVisiblePairs = (numSetBits - numCells) / 2;
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PotentiallyVisibleSet::IsCellVisible(const IntVec2& fromCell, const IntVec2& toCell) const
+{
+	if (m_numCellsPerAxis == 0)
+		return true;
+
+	int columnIndex = toCell.y * m_numCellsPerAxis + toCell.x;
+	int targetByte = columnIndex / 8;
+
+	//Walk the row's runs up to the byte holding the column
+	int byteIndex = 0;
+	uint32_t readIndex;
+	uint32_t rowEnd;
+	GetRowRange(fromCell, readIndex, rowEnd);
+	while (readIndex < rowEnd)
+	{
+		uint8_t value = m_compressedBytes[readIndex++];
+		int runLength = 1;
+		if ((value == 0x00 || value == 0xFF) && readIndex < rowEnd)
+		{
+			runLength = m_compressedBytes[readIndex++];
+		}
+
+		if (targetByte < byteIndex + runLength)
+			return (value & (1 << (columnIndex % 8))) != 0;
+
+		byteIndex += runLength;
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PotentiallyVisibleSet::DecompressRow(const IntVec2& fromCell, std::vector<uint8_t>& rowBitsOut) const
+{
+	rowBitsOut.assign(GetNumBytesPerRow(), 0);
+	if (m_numCellsPerAxis == 0)
+		return;
+
+	int byteIndex = 0;
+	uint32_t readIndex;
+	uint32_t rowEnd;
+	GetRowRange(fromCell, readIndex, rowEnd);
+	while (readIndex < rowEnd && byteIndex < (int)rowBitsOut.size())
+	{
+		uint8_t value = m_compressedBytes[readIndex++];
+		int runLength = 1;
+		if ((value == 0x00 || value == 0xFF) && readIndex < rowEnd)
+		{
+			runLength = m_compressedBytes[readIndex++];
+		}
+
+		runLength = GetLowerValue(runLength, (int)rowBitsOut.size() - byteIndex);
+		memset(&rowBitsOut[byteIndex], value, runLength);
+		byteIndex += runLength;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int PotentiallyVisibleSet::GetCompressedSizeInBytes() const
+{
+	return (int)(m_rowIndices.size() * sizeof(uint16_t) + m_rowOffsets.size() * sizeof(uint32_t) + m_compressedBytes.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint32_t PotentiallyVisibleSet::ComputeSceneSignature(const std::vector<Geometry>& geometry)
+{
+	//FNV-1a over the point bits
+	uint32_t signature = 2166136261u;
+	for (int geometryIndex = 0; geometryIndex < (int)geometry.size(); geometryIndex++)
+	{
+		const std::vector<Vec2>& points = geometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+		for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+		{
+			uint32_t words[2];
+			memcpy(&words[0], &points[pointIndex].x, sizeof(float));
+			memcpy(&words[1], &points[pointIndex].y, sizeof(float));
+			for (int wordIndex = 0; wordIndex < 2; wordIndex++)
+			{
+				signature = (signature ^ words[wordIndex]) * 16777619u;
+			}
+		}
+
+		signature = (signature ^ (uint32_t)points.size()) * 16777619u;
+	}
+
+	return signature;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PotentiallyVisibleSet::DoesHullBlockCells(int hullIndex, const Vec2& minsA, const Vec2& maxsA, const Vec2& minsB, const Vec2& maxsB) const
+{
+	//Blocking the segments parallel to the one between the centers needs the hull to be at least as wide as the cell across them
+	Vec2 across = Vec2((minsA.y + maxsA.y) - (minsB.y + maxsB.y), (maxsB.x + minsB.x) - (maxsA.x + minsA.x));
+	across.Normalize();
+
+	float lowestA;
+	float highestA;
+	GetBoxRangeAlongNormal(minsA, maxsA, Vec2::ZERO, across, lowestA, highestA);
+
+	float lowestHull = FLT_MAX;
+	float highestHull = -FLT_MAX;
+	for (int vertexIndex = m_vertexOffsets[hullIndex]; vertexIndex < m_vertexOffsets[hullIndex + 1]; vertexIndex++)
+	{
+		float projection = across.x * m_vertices[vertexIndex].x + across.y * m_vertices[vertexIndex].y;
+		lowestHull = GetLowerValue(lowestHull, projection);
+		highestHull = GetHigherValue(highestHull, projection);
+	}
+
+	if (highestHull - lowestHull < highestA - lowestA - PVS_TOLERANCE)
+		return false;
+
+	//A segment misses a convex hull when some line keeps them apart, and that line is either along a hull face or the segment itself
+	//Hull faces first: both cells reaching past the same face give a segment outside it
+	for (int planeIndex = m_planeOffsets[hullIndex]; planeIndex < m_planeOffsets[hullIndex + 1]; planeIndex++)
+	{
+		Vec2 normal = Vec2(m_normalX[planeIndex], m_normalY[planeIndex]);
+		float lowestB;
+		float highestB;
+		GetBoxRangeAlongNormal(minsA, maxsA, Vec2::ZERO, normal, lowestA, highestA);
+		GetBoxRangeAlongNormal(minsB, maxsB, Vec2::ZERO, normal, lowestB, highestB);
+		if (highestA >= m_distance[planeIndex] - PVS_TOLERANCE && highestB >= m_distance[planeIndex] - PVS_TOLERANCE)
+			return false;
+	}
+
+	//Then lines through both cells with the hull to one side. Where there is one, there is one through two of the corners
+	//and hull vertices, which is where the region of such lines has its vertices
+	int firstHullVertex = m_vertexOffsets[hullIndex];
+	int numPoints = 8 + m_vertexOffsets[hullIndex + 1] - firstHullVertex;
+	auto getPoint = [this, &minsA, &maxsA, &minsB, &maxsB, firstHullVertex](int pointIndex)
+	{
+		if (pointIndex < 4)
+			return Vec2((pointIndex & 1) ? maxsA.x : minsA.x, (pointIndex & 2) ? maxsA.y : minsA.y);
+
+		if (pointIndex < 8)
+			return Vec2((pointIndex & 1) ? maxsB.x : minsB.x, (pointIndex & 2) ? maxsB.y : minsB.y);
+
+		return m_vertices[firstHullVertex + pointIndex - 8];
+	};
+
+	for (int pointIndexA = 0; pointIndexA < 8; pointIndexA++)
+	{
+		Vec2 linePoint = getPoint(pointIndexA);
+		for (int pointIndexB = pointIndexA + 1; pointIndexB < numPoints; pointIndexB++)
+		{
+			if (IsSeparatingLine(hullIndex, linePoint, getPoint(pointIndexB), minsA, maxsA, minsB, maxsB))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PotentiallyVisibleSet::IsSeparatingLine(int hullIndex, const Vec2& linePoint, const Vec2& lineOtherPoint, const Vec2& minsA, const Vec2& maxsA, const Vec2& minsB, const Vec2& maxsB) const
+{
+	Vec2 normal = Vec2(linePoint.y - lineOtherPoint.y, lineOtherPoint.x - linePoint.x);
+	float normalLength = normal.GetLength();
+	if (normalLength < PVS_TOLERANCE)
+		return false;
+
+	normal *= 1.f / normalLength;
+
+	float lowest;
+	float highest;
+	GetBoxRangeAlongNormal(minsA, maxsA, linePoint, normal, lowest, highest);
+	if (lowest > PVS_TOLERANCE || highest < -PVS_TOLERANCE)
+		return false;
+
+	GetBoxRangeAlongNormal(minsB, maxsB, linePoint, normal, lowest, highest);
+	if (lowest > PVS_TOLERANCE || highest < -PVS_TOLERANCE)
+		return false;
+
+	bool hasVertexAbove = false;
+	bool hasVertexBelow = false;
+	for (int vertexIndex = m_vertexOffsets[hullIndex]; vertexIndex < m_vertexOffsets[hullIndex + 1]; vertexIndex++)
+	{
+		const Vec2& vertex = m_vertices[vertexIndex];
+		float side = normal.x * (vertex.x - linePoint.x) + normal.y * (vertex.y - linePoint.y);
+		hasVertexAbove = hasVertexAbove || side > PVS_TOLERANCE;
+		hasVertexBelow = hasVertexBelow || side < -PVS_TOLERANCE;
+		if (hasVertexAbove && hasVertexBelow)
+			return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PotentiallyVisibleSet::GetRowRange(const IntVec2& fromCell, uint32_t& rowStartOut, uint32_t& rowEndOut) const
+{
+	int uniqueRowIndex = m_rowIndices[fromCell.y * m_numCellsPerAxis + fromCell.x];
+	rowStartOut = m_rowOffsets[uniqueRowIndex];
+	rowEndOut = m_rowOffsets[uniqueRowIndex + 1];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void PotentiallyVisibleSet::CompressRow(const uint8_t* rowBits, int numBytes, std::vector<uint8_t>& compressedOut)
+{
+	int byteIndex = 0;
+	while (byteIndex < numBytes)
+	{
+		uint8_t value = rowBits[byteIndex];
+		compressedOut.push_back(value);
+		if (value != 0x00 && value != 0xFF)
+		{
+			byteIndex++;
+			continue;
+		}
+
+		int runLength = 1;
+		while (byteIndex + runLength < numBytes && runLength < 255 && rowBits[byteIndex + runLength] == value)
+		{
+			runLength++;
+		}
+
+		compressedOut.push_back((uint8_t)runLength);
+		byteIndex += runLength;
+	}
+}
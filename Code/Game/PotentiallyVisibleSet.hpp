@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class BitFieldBroadPhase;
+class Geometry;
+class JobPool;
+
+constexpr int PVS_MAX_OCCLUDERS = 16;			//Hulls on the line between two cell centers tried as the occluder of the pair
+constexpr float PVS_TOLERANCE = 0.001f;			//Segments grazing a hull by less than this are taken as seen past it
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Cell to cell potentially visible set over the broadphase grid, baked once per scene and stored with the cooked scene
+//A pair of cells is only hidden when one hull blocks every segment between them, so the set is conservative:
+//a hidden pair never sees each other, a visible pair might. The blocker has to cross the line between the cell centers,
+//so the candidates come from one all intersections raycast per pair, against a scene of only the hulls wide enough to block
+//a cell, and the job pool takes rows of the matrix
+//Cells seeing the same cells share one stored row, and rows are run length coded: 0x00 and 0xFF bytes are followed by
+//how many of them there are, other bytes are literal
+//------------------------------------------------------------------------------------------------------------------------------
+class PotentiallyVisibleSet
+{
+public:
+	PotentiallyVisibleSet();
+	~PotentiallyVisibleSet();
+
+	//The geometry needs its bit fields set for the broadphase
+	void					Bake(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase, JobPool* jobPool = nullptr);
+	void					Clear();
+
+	//Takes rows written out by the getters below, false when they do not fit together
+	bool					SetCompressed(int numCellsPerAxis, uint32_t sceneSignature, const std::vector<uint16_t>& rowIndices, const std::vector<uint32_t>& rowOffsets,
+								const std::vector<uint8_t>& compressedBytes);
+
+	bool					IsBaked() const { return m_numCellsPerAxis > 0; }
+	bool					IsCellVisible(const IntVec2& fromCell, const IntVec2& toCell) const;
+	void					DecompressRow(const IntVec2& fromCell, std::vector<uint8_t>& rowBitsOut) const;
+
+	int						GetNumCellsPerAxis() const { return m_numCellsPerAxis; }
+	int						GetNumVisiblePairs() const { return m_numVisiblePairs; }
+	int						GetDenseSizeInBytes() const { return m_numCellsPerAxis * m_numCellsPerAxis * GetNumBytesPerRow(); }
+	int						GetCompressedSizeInBytes() const;
+	int						GetNumUniqueRows() const { return (int)m_rowOffsets.size() - 1; }
+	uint32_t				GetSceneSignature() const { return m_sceneSignature; }
+	const std::vector<uint16_t>&	GetRowIndices() const { return m_rowIndices; }
+	const std::vector<uint32_t>&	GetRowOffsets() const { return m_rowOffsets; }
+	const std::vector<uint8_t>&		GetCompressedBytes() const { return m_compressedBytes; }
+
+	//Hash of the polygon points, a cooked set is only used with the scene it was baked from
+	static uint32_t			ComputeSceneSignature(const std::vector<Geometry>& geometry);
+
+private:
+	int						GetNumBytesPerRow() const { return (m_numCellsPerAxis * m_numCellsPerAxis + 7) / 8; }
+
+	bool					DoesHullBlockCells(int hullIndex, const Vec2& minsA, const Vec2& maxsA, const Vec2& minsB, const Vec2& maxsB) const;
+	bool					IsSeparatingLine(int hullIndex, const Vec2& linePoint, const Vec2& lineOtherPoint, const Vec2& minsA, const Vec2& maxsA, const Vec2& minsB, const Vec2& maxsB) const;
+
+	//Start of the stored row the cell uses, and the end of it
+	void					GetRowRange(const IntVec2& fromCell, uint32_t& rowStartOut, uint32_t& rowEndOut) const;
+
+	static void				CompressRow(const uint8_t* rowBits, int numBytes, std::vector<uint8_t>& compressedOut);
+
+private:
+	int						m_numCellsPerAxis = 0;
+	int						m_numVisiblePairs = 0;
+	uint32_t				m_sceneSignature = 0;
+
+	std::vector<uint16_t>	m_rowIndices;			//Stored row of each cell
+	std::vector<uint32_t>	m_rowOffsets;			//Stored row i is [m_rowOffsets[i], m_rowOffsets[i + 1]) of m_compressedBytes
+	std::vector<uint8_t>	m_compressedBytes;
+
+	//Only used while baking, for the occluders. Planes and vertices of hull i are [m_planeOffsets[i], m_planeOffsets[i + 1]) and the same in m_vertexOffsets
+	std::vector<float>		m_normalX;
+	std::vector<float>		m_normalY;
+	std::vector<float>		m_distance;
+	std::vector<int>		m_planeOffsets;
+	std::vector<Vec2>		m_vertices;
+	std::vector<int>		m_vertexOffsets;
+};
@@ -0,0 +1,609 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/PrimitiveStore.hpp"
+#include "Engine/Math/ConvexHull2D.hpp"
+#include "Engine/Math/ConvexPoly2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/Geometry.hpp"
+#include <cfloat>
+#include <cmath>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static constexpr float PRIMITIVE_DEGREES_TO_RADIANS = 0.01745329252f;
+static constexpr int PRIMITIVE_DISPATCH_BATCH_SIZE = 256;		//Longer runs of one type in a cell go to their kernel in several batches
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Closest hit so far, shared by the kernels of every type
+struct PrimitiveBestHit
+{
+	float			m_time = MAX_RAYCAST_TIME;
+	Vec2			m_normal = Vec2::ZERO;
+	ePrimitiveType	m_type = NUM_PRIMITIVE_TYPES;
+	int				m_typeIndex = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static inline void RecordPrimitiveHit(PrimitiveBestHit& best, float time, const Vec2& normal, ePrimitiveType type, int typeIndex)
+{
+	best.m_time = time;
+	best.m_normal = normal;
+	best.m_type = type;
+	best.m_typeIndex = typeIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Entry time of the ray into a disc the ray starts outside of, false when it misses
+static inline bool GetRayDiscEnterTime(const Ray2D& ray, const Vec2& center, float radius, float& timeOut)
+{
+	Vec2 startFromCenter = ray.m_start - center;
+	float halfB = startFromCenter.x * ray.m_direction.x + startFromCenter.y * ray.m_direction.y;
+	float c = startFromCenter.x * startFromCenter.x + startFromCenter.y * startFromCenter.y - radius * radius;
+
+	//Moving away from the disc, or starting inside it
+	if (halfB > 0.f || c <= 0.f)
+	{
+		return false;
+	}
+
+	//Squared radius less the squared distance from the center to the ray, stays accurate for rays from far away
+	Vec2 closestFromCenter = startFromCenter - ray.m_direction * halfB;
+	float discriminant = radius * radius - (closestFromCenter.x * closestFromCenter.x + closestFromCenter.y * closestFromCenter.y);
+	if (discriminant < 0.f)
+	{
+		return false;
+	}
+
+	timeOut = -halfB - sqrtf(discriminant);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void RaycastDiscs(const std::vector<DiscPrimitive>& discs, const int* typeIndices, int numIndices, const Ray2D& ray, PrimitiveBestHit& best)
+{
+	for (int index = 0; index < numIndices; index++)
+	{
+		const DiscPrimitive& disc = discs[typeIndices[index]];
+
+		float time;
+		if (GetRayDiscEnterTime(ray, disc.m_center, disc.m_radius, time) && time < best.m_time)
+		{
+			Vec2 normal = (ray.GetPointAtTime(time) - disc.m_center) / disc.m_radius;
+			RecordPrimitiveHit(best, time, normal, PRIMITIVE_DISC, typeIndices[index]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//A capsule is entered through one of its two flat sides or one of its end caps, the closest candidate wins
+static void RaycastCapsules(const std::vector<CapsulePrimitive>& capsules, const int* typeIndices, int numIndices, const Ray2D& ray, PrimitiveBestHit& best)
+{
+	for (int index = 0; index < numIndices; index++)
+	{
+		const CapsulePrimitive& capsule = capsules[typeIndices[index]];
+
+		Vec2 bone = capsule.m_end - capsule.m_start;
+		float boneLengthSquared = bone.x * bone.x + bone.y * bone.y;
+
+		//Skip capsules the ray starts inside of
+		Vec2 startFromBoneStart = ray.m_start - capsule.m_start;
+		float boneFraction = (boneLengthSquared > 0.f) ? Clamp((startFromBoneStart.x * bone.x + startFromBoneStart.y * bone.y) / boneLengthSquared, 0.f, 1.f) : 0.f;
+		Vec2 startFromBone = startFromBoneStart - bone * boneFraction;
+		if (startFromBone.x * startFromBone.x + startFromBone.y * startFromBone.y <= capsule.m_radius * capsule.m_radius)
+		{
+			continue;
+		}
+
+		float closestTime = best.m_time;
+		Vec2 closestNormal;
+
+		float capTime;
+		if (GetRayDiscEnterTime(ray, capsule.m_start, capsule.m_radius, capTime) && capTime < closestTime)
+		{
+			closestTime = capTime;
+			closestNormal = (ray.GetPointAtTime(capTime) - capsule.m_start) / capsule.m_radius;
+		}
+		if (GetRayDiscEnterTime(ray, capsule.m_end, capsule.m_radius, capTime) && capTime < closestTime)
+		{
+			closestTime = capTime;
+			closestNormal = (ray.GetPointAtTime(capTime) - capsule.m_end) / capsule.m_radius;
+		}
+
+		if (boneLengthSquared > 0.f)
+		{
+			float boneLength = sqrtf(boneLengthSquared);
+			Vec2 boneDirection = bone / boneLength;
+			Vec2 sideNormal(-boneDirection.y, boneDirection.x);
+
+			for (float sideSign = -1.f; sideSign <= 1.f; sideSign += 2.f)
+			{
+				Vec2 normal = sideNormal * sideSign;
+				float denominator = normal.x * ray.m_direction.x + normal.y * ray.m_direction.y;
+				if (denominator >= 0.f)
+				{
+					continue;
+				}
+
+				Vec2 sideStart = capsule.m_start + normal * capsule.m_radius;
+				Vec2 startToSide = sideStart - ray.m_start;
+				float sideTime = (startToSide.x * normal.x + startToSide.y * normal.y) / denominator;
+				if (sideTime < 0.f || sideTime >= closestTime)
+				{
+					continue;
+				}
+
+				Vec2 alongSide = ray.GetPointAtTime(sideTime) - sideStart;
+				float alongBone = alongSide.x * boneDirection.x + alongSide.y * boneDirection.y;
+				if (alongBone >= 0.f && alongBone <= boneLength)
+				{
+					closestTime = sideTime;
+					closestNormal = normal;
+				}
+			}
+		}
+
+		if (closestTime < best.m_time)
+		{
+			RecordPrimitiveHit(best, closestTime, closestNormal, PRIMITIVE_CAPSULE, typeIndices[index]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Slab test in the box's own frame
+static void RaycastOBBs(const std::vector<OBBPrimitive>& obbs, const int* typeIndices, int numIndices, const Ray2D& ray, PrimitiveBestHit& best)
+{
+	for (int index = 0; index < numIndices; index++)
+	{
+		const OBBPrimitive& obb = obbs[typeIndices[index]];
+		Vec2 axisY(-obb.m_axisX.y, obb.m_axisX.x);
+
+		Vec2 startFromCenter = ray.m_start - obb.m_center;
+		float localStart[2] = { startFromCenter.x * obb.m_axisX.x + startFromCenter.y * obb.m_axisX.y, startFromCenter.x * axisY.x + startFromCenter.y * axisY.y };
+		float localDirection[2] = { ray.m_direction.x * obb.m_axisX.x + ray.m_direction.y * obb.m_axisX.y, ray.m_direction.x * axisY.x + ray.m_direction.y * axisY.y };
+		float halfExtents[2] = { obb.m_halfExtents.x, obb.m_halfExtents.y };
+
+		float tEnter = -FLT_MAX;
+		float tExit = FLT_MAX;
+		Vec2 enterNormal = Vec2::ZERO;
+		bool isSeparated = false;
+
+		for (int axis = 0; axis < 2; axis++)
+		{
+			if (localDirection[axis] == 0.f)
+			{
+				isSeparated |= fabsf(localStart[axis]) > halfExtents[axis];
+				continue;
+			}
+
+			//Entering through the face the ray is moving towards the inside of
+			float faceSign = (localDirection[axis] > 0.f) ? -1.f : 1.f;
+			float nearTime = (faceSign * halfExtents[axis] - localStart[axis]) / localDirection[axis];
+			float farTime = (-faceSign * halfExtents[axis] - localStart[axis]) / localDirection[axis];
+
+			if (nearTime > tEnter)
+			{
+				tEnter = nearTime;
+				enterNormal = ((axis == 0) ? obb.m_axisX : axisY) * faceSign;
+			}
+			tExit = GetLowerValue(tExit, farTime);
+		}
+
+		//A negative entry time means the ray starts inside the box
+		if (isSeparated || tEnter > tExit || tEnter < 0.f || tEnter >= best.m_time)
+		{
+			continue;
+		}
+
+		RecordPrimitiveHit(best, tEnter, enterNormal, PRIMITIVE_OBB, typeIndices[index]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void RaycastHulls(const std::vector<HullPrimitive>& hulls, const float* normalX, const float* normalY, const float* distance,
+	const int* typeIndices, int numIndices, const Ray2D& ray, PrimitiveBestHit& best)
+{
+	for (int index = 0; index < numIndices; index++)
+	{
+		const HullPrimitive& hull = hulls[typeIndices[index]];
+
+		float tEnter = -FLT_MAX;
+		float tExit = FLT_MAX;
+		int enterPlane = -1;
+		bool isSeparated = false;
+
+		int planeEnd = hull.m_firstPlane + hull.m_numPlanes;
+		for (int planeIndex = hull.m_firstPlane; planeIndex < planeEnd; planeIndex++)
+		{
+			float denominator = normalX[planeIndex] * ray.m_direction.x + normalY[planeIndex] * ray.m_direction.y;
+			float startDistance = distance[planeIndex] - (normalX[planeIndex] * ray.m_start.x + normalY[planeIndex] * ray.m_start.y);
+
+			if (denominator == 0.f)
+			{
+				isSeparated |= startDistance < 0.f;
+				continue;
+			}
+
+			float time = startDistance / denominator;
+			if (denominator < 0.f && time > tEnter)
+			{
+				tEnter = time;
+				enterPlane = planeIndex;
+			}
+			else if (denominator > 0.f && time < tExit)
+			{
+				tExit = time;
+			}
+		}
+
+		if (isSeparated || enterPlane < 0 || tEnter > tExit || tEnter < 0.f || tEnter >= best.m_time)
+		{
+			continue;
+		}
+
+		RecordPrimitiveHit(best, tEnter, Vec2(normalX[enterPlane], normalY[enterPlane]), PRIMITIVE_HULL, typeIndices[index]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PrimitiveStore::PrimitiveStore()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PrimitiveStore::~PrimitiveStore()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PrimitiveStore::Clear()
+{
+	for (int typeIndex = 0; typeIndex < NUM_PRIMITIVE_TYPES; typeIndex++)
+	{
+		RemovePrimitives((ePrimitiveType)typeIndex);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PrimitiveStore::RemovePrimitives(ePrimitiveType type)
+{
+	switch (type)
+	{
+	case PRIMITIVE_DISC:
+		m_discs.clear();
+		break;
+	case PRIMITIVE_CAPSULE:
+		m_capsules.clear();
+		break;
+	case PRIMITIVE_OBB:
+		m_obbs.clear();
+		break;
+	case PRIMITIVE_HULL:
+		m_hulls.clear();
+		m_hullNormalX.clear();
+		m_hullNormalY.clear();
+		m_hullDistance.clear();
+		m_hullMins.clear();
+		m_hullMaxs.clear();
+		break;
+	default:
+		break;
+	}
+
+	//The buckets no longer line up with the primitives
+	m_broadPhase = nullptr;
+	m_cellBuckets.Clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PrimitiveStore::AddDisc(const Vec2& center, float radius, int ownerIndex)
+{
+	DiscPrimitive disc;
+	disc.m_center = center;
+	disc.m_radius = radius;
+	disc.m_ownerIndex = ownerIndex;
+	m_discs.push_back(disc);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PrimitiveStore::AddCapsule(const Vec2& start, const Vec2& end, float radius, int ownerIndex)
+{
+	CapsulePrimitive capsule;
+	capsule.m_start = start;
+	capsule.m_end = end;
+	capsule.m_radius = radius;
+	capsule.m_ownerIndex = ownerIndex;
+	m_capsules.push_back(capsule);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PrimitiveStore::AddOBB(const Vec2& center, const Vec2& halfExtents, float rotationDegrees, int ownerIndex)
+{
+	float rotationRadians = rotationDegrees * PRIMITIVE_DEGREES_TO_RADIANS;
+
+	OBBPrimitive obb;
+	obb.m_center = center;
+	obb.m_axisX = Vec2(cosf(rotationRadians), sinf(rotationRadians));
+	obb.m_halfExtents = halfExtents;
+	obb.m_ownerIndex = ownerIndex;
+	m_obbs.push_back(obb);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PrimitiveStore::AddHull(const Geometry& geometry, int ownerIndex)
+{
+	const std::vector<Plane2D>& planes = geometry.GetConvexHull2D().GetPlanes();
+
+	HullPrimitive hull;
+	hull.m_firstPlane = (int)m_hullDistance.size();
+	hull.m_numPlanes = (int)planes.size();
+	hull.m_ownerIndex = ownerIndex;
+	m_hulls.push_back(hull);
+
+	for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++)
+	{
+		m_hullNormalX.push_back(planes[planeIndex].GetNormal().x);
+		m_hullNormalY.push_back(planes[planeIndex].GetNormal().y);
+		m_hullDistance.push_back(planes[planeIndex].GetSignedDistance());
+	}
+
+	//Bounds come from the owning polygon, the planes alone do not give them cheaply
+	const std::vector<Vec2>& points = geometry.GetConvexPoly2D().GetConvexPoly2DPoints();
+	Vec2 mins(FLT_MAX, FLT_MAX);
+	Vec2 maxs(-FLT_MAX, -FLT_MAX);
+	for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+	{
+		mins = Vec2(GetLowerValue(mins.x, points[pointIndex].x), GetLowerValue(mins.y, points[pointIndex].y));
+		maxs = Vec2(GetHigherValue(maxs.x, points[pointIndex].x), GetHigherValue(maxs.y, points[pointIndex].y));
+	}
+	m_hullMins.push_back(mins);
+	m_hullMaxs.push_back(maxs);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int PrimitiveStore::GetNumPrimitives(ePrimitiveType type) const
+{
+	switch (type)
+	{
+	case PRIMITIVE_DISC:
+		return (int)m_discs.size();
+	case PRIMITIVE_CAPSULE:
+		return (int)m_capsules.size();
+	case PRIMITIVE_OBB:
+		return (int)m_obbs.size();
+	case PRIMITIVE_HULL:
+		return (int)m_hulls.size();
+	default:
+		return 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PrimitiveStore::GetPrimitiveBounds(ePrimitiveType type, int typeIndex, Vec2& minsOut, Vec2& maxsOut) const
+{
+	switch (type)
+	{
+	case PRIMITIVE_DISC:
+	{
+		const DiscPrimitive& disc = m_discs[typeIndex];
+		Vec2 radius(disc.m_radius, disc.m_radius);
+		minsOut = disc.m_center - radius;
+		maxsOut = disc.m_center + radius;
+		break;
+	}
+	case PRIMITIVE_CAPSULE:
+	{
+		const CapsulePrimitive& capsule = m_capsules[typeIndex];
+		Vec2 radius(capsule.m_radius, capsule.m_radius);
+		minsOut = Vec2(GetLowerValue(capsule.m_start.x, capsule.m_end.x), GetLowerValue(capsule.m_start.y, capsule.m_end.y)) - radius;
+		maxsOut = Vec2(GetHigherValue(capsule.m_start.x, capsule.m_end.x), GetHigherValue(capsule.m_start.y, capsule.m_end.y)) + radius;
+		break;
+	}
+	case PRIMITIVE_OBB:
+	{
+		const OBBPrimitive& obb = m_obbs[typeIndex];
+		float cosine = fabsf(obb.m_axisX.x);
+		float sine = fabsf(obb.m_axisX.y);
+		Vec2 extents(cosine * obb.m_halfExtents.x + sine * obb.m_halfExtents.y, sine * obb.m_halfExtents.x + cosine * obb.m_halfExtents.y);
+		minsOut = obb.m_center - extents;
+		maxsOut = obb.m_center + extents;
+		break;
+	}
+	case PRIMITIVE_HULL:
+	{
+		minsOut = m_hullMins[typeIndex];
+		maxsOut = m_hullMaxs[typeIndex];
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PrimitiveStore::BuildBuckets(const BitFieldBroadPhase& broadPhase)
+{
+	m_broadPhase = &broadPhase;
+
+	m_typeStarts[0] = 0;
+	for (int typeIndex = 0; typeIndex < NUM_PRIMITIVE_TYPES; typeIndex++)
+	{
+		m_typeStarts[typeIndex + 1] = m_typeStarts[typeIndex] + GetNumPrimitives((ePrimitiveType)typeIndex);
+	}
+
+	m_entryBitFields.clear();
+	m_entryBitFields.reserve(m_typeStarts[NUM_PRIMITIVE_TYPES]);
+	for (int typeIndex = 0; typeIndex < NUM_PRIMITIVE_TYPES; typeIndex++)
+	{
+		int numPrimitives = GetNumPrimitives((ePrimitiveType)typeIndex);
+		for (int primitiveIndex = 0; primitiveIndex < numPrimitives; primitiveIndex++)
+		{
+			Vec2 mins;
+			Vec2 maxs;
+			GetPrimitiveBounds((ePrimitiveType)typeIndex, primitiveIndex, mins, maxs);
+			m_entryBitFields.push_back(broadPhase.GetRegionIDForMinMaxs(mins, maxs));
+		}
+	}
+
+	m_cellBuckets.Build(m_entryBitFields, broadPhase.GetNumBitFields(), CELL_BUCKET_REFIT_SLACK);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int PrimitiveStore::RefitMovedHulls(const std::vector<Geometry>& geometry, const std::vector<int>& movedGeometryIndices)
+{
+	if (m_broadPhase == nullptr)
+		return 0;
+
+	int numCellChanges = 0;
+	bool needsBucketRebuild = false;
+
+	for (int movedIndex = 0; movedIndex < (int)movedGeometryIndices.size(); movedIndex++)
+	{
+		int geometryIndex = movedGeometryIndices[movedIndex];
+		if (geometryIndex >= (int)m_hulls.size() || m_hulls[geometryIndex].m_ownerIndex != geometryIndex)
+			continue;
+
+		//Moving keeps the normals, the distances were already shifted on the geometry's own hull
+		const HullPrimitive& hull = m_hulls[geometryIndex];
+		const std::vector<Plane2D>& planes = geometry[geometryIndex].GetConvexHull2D().GetPlanes();
+		int numPlanes = GetLowerValue(hull.m_numPlanes, (int)planes.size());
+		for (int planeIndex = 0; planeIndex < numPlanes; planeIndex++)
+		{
+			m_hullDistance[hull.m_firstPlane + planeIndex] = planes[planeIndex].GetSignedDistance();
+		}
+
+		const std::vector<Vec2>& points = geometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+		Vec2 mins(FLT_MAX, FLT_MAX);
+		Vec2 maxs(-FLT_MAX, -FLT_MAX);
+		for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+		{
+			mins = Vec2(GetLowerValue(mins.x, points[pointIndex].x), GetLowerValue(mins.y, points[pointIndex].y));
+			maxs = Vec2(GetHigherValue(maxs.x, points[pointIndex].x), GetHigherValue(maxs.y, points[pointIndex].y));
+		}
+		m_hullMins[geometryIndex] = mins;
+		m_hullMaxs[geometryIndex] = maxs;
+
+		int entryIndex = m_typeStarts[PRIMITIVE_HULL] + geometryIndex;
+		IntVec2 newBitFields = m_broadPhase->GetRegionIDForMinMaxs(mins, maxs);
+		IntVec2& entryBitFields = m_entryBitFields[entryIndex];
+		if (entryBitFields.x == newBitFields.x && entryBitFields.y == newBitFields.y)
+			continue;
+
+		numCellChanges++;
+		if (!needsBucketRebuild && !m_cellBuckets.MoveEntry(entryIndex, entryBitFields, newBitFields))
+		{
+			needsBucketRebuild = true;
+		}
+		entryBitFields = newBitFields;
+	}
+
+	//A cell ran out of slack, starting over from the current bit fields gives every cell fresh room
+	if (needsBucketRebuild)
+	{
+		m_cellBuckets.Build(m_entryBitFields, m_broadPhase->GetNumBitFields(), CELL_BUCKET_REFIT_SLACK);
+	}
+
+	return numCellChanges;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PrimitiveStore::RaycastClosest(PrimitiveHit2D& hitOut, const Ray2D& ray, float maxTime) const
+{
+	hitOut = PrimitiveHit2D();
+	if (m_broadPhase == nullptr)
+	{
+		return false;
+	}
+
+	BitFieldRayWalker walker;
+	if (!walker.Begin(*m_broadPhase, ray, maxTime))
+	{
+		return false;
+	}
+
+	PrimitiveBestHit best;
+	best.m_time = maxTime;
+
+	//Type local indices of one run of a cell
+	int typeIndices[PRIMITIVE_DISPATCH_BATCH_SIZE];
+	do
+	{
+		int cellIndex = m_cellBuckets.GetCellIndex(walker.GetCell());
+		int bucketIndex = m_cellBuckets.GetCellStart(cellIndex);
+		int bucketEnd = m_cellBuckets.GetCellEnd(cellIndex);
+
+		while (bucketIndex < bucketEnd)
+		{
+			//Gather the run of entries sharing a type, entries are ascending so each type is one run
+			int type = 0;
+			int entry = m_cellBuckets.GetEntry(bucketIndex);
+			while (entry >= m_typeStarts[type + 1])
+			{
+				type++;
+			}
+
+			int numIndices = 0;
+			while (bucketIndex < bucketEnd && numIndices < PRIMITIVE_DISPATCH_BATCH_SIZE)
+			{
+				entry = m_cellBuckets.GetEntry(bucketIndex);
+				if (entry >= m_typeStarts[type + 1])
+				{
+					break;
+				}
+
+				typeIndices[numIndices++] = entry - m_typeStarts[type];
+				bucketIndex++;
+			}
+
+			switch ((ePrimitiveType)type)
+			{
+			case PRIMITIVE_DISC:
+				RaycastDiscs(m_discs, typeIndices, numIndices, ray, best);
+				break;
+			case PRIMITIVE_CAPSULE:
+				RaycastCapsules(m_capsules, typeIndices, numIndices, ray, best);
+				break;
+			case PRIMITIVE_OBB:
+				RaycastOBBs(m_obbs, typeIndices, numIndices, ray, best);
+				break;
+			case PRIMITIVE_HULL:
+				RaycastHulls(m_hulls, m_hullNormalX.data(), m_hullNormalY.data(), m_hullDistance.data(), typeIndices, numIndices, ray, best);
+				break;
+			default:
+				break;
+			}
+		}
+
+		//Nothing in a later cell can be hit before the exit of this one
+		if (best.m_typeIndex >= 0 && best.m_time <= walker.GetCellExitTime())
+		{
+			break;
+		}
+	} while (walker.Advance());
+
+	if (best.m_typeIndex < 0)
+	{
+		return false;
+	}
+
+	hitOut.m_timeAtHit = best.m_time;
+	hitOut.m_hitPoint = ray.GetPointAtTime(best.m_time);
+	hitOut.m_impactNormal = best.m_normal;
+	hitOut.m_type = best.m_type;
+	switch (best.m_type)
+	{
+	case PRIMITIVE_DISC:
+		hitOut.m_ownerIndex = m_discs[best.m_typeIndex].m_ownerIndex;
+		break;
+	case PRIMITIVE_CAPSULE:
+		hitOut.m_ownerIndex = m_capsules[best.m_typeIndex].m_ownerIndex;
+		break;
+	case PRIMITIVE_OBB:
+		hitOut.m_ownerIndex = m_obbs[best.m_typeIndex].m_ownerIndex;
+		break;
+	case PRIMITIVE_HULL:
+		hitOut.m_ownerIndex = m_hulls[best.m_typeIndex].m_ownerIndex;
+		break;
+	default:
+		break;
+	}
+	return true;
+}
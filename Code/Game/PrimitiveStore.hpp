@@ -0,0 +1,125 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Ray2D.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include "Game/GameCommon.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum ePrimitiveType
+{
+	PRIMITIVE_DISC = 0,
+	PRIMITIVE_CAPSULE,
+	PRIMITIVE_OBB,
+	PRIMITIVE_HULL,
+
+	NUM_PRIMITIVE_TYPES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct DiscPrimitive
+{
+	Vec2	m_center;
+	float	m_radius = 0.f;
+	int		m_ownerIndex = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct CapsulePrimitive
+{
+	Vec2	m_start;
+	Vec2	m_end;
+	float	m_radius = 0.f;
+	int		m_ownerIndex = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct OBBPrimitive
+{
+	Vec2	m_center;
+	Vec2	m_axisX = Vec2(1.f, 0.f);		//Unit, the local y axis is this turned 90 degrees counter clockwise
+	Vec2	m_halfExtents;
+	int		m_ownerIndex = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Planes are [m_firstPlane, m_firstPlane + m_numPlanes) of the store's plane arrays
+struct HullPrimitive
+{
+	int		m_firstPlane = 0;
+	int		m_numPlanes = 0;
+	int		m_ownerIndex = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct PrimitiveHit2D
+{
+	float			m_timeAtHit = MAX_RAYCAST_TIME;
+	Vec2			m_hitPoint;
+	Vec2			m_impactNormal;
+	ePrimitiveType	m_type = NUM_PRIMITIVE_TYPES;
+	int				m_ownerIndex = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Discs, capsules, oriented boxes and convex hulls in one broadphase. Each keeps its exact shape and is tested with the
+//ray kernel for its type instead of being turned into a many sided hull
+//Primitives are numbered type by type, so the ascending entries of each cell bucket come out as one run per type and
+//every run goes to its kernel in one dispatch. Cells are walked in ray order and the walk stops at the first hit
+//Rays that start inside a primitive do not report it
+//------------------------------------------------------------------------------------------------------------------------------
+class PrimitiveStore
+{
+public:
+	PrimitiveStore();
+	~PrimitiveStore();
+
+	void					Clear();
+	void					RemovePrimitives(ePrimitiveType type);
+
+	//The owner index is handed back in hits, the geometry index for hulls made from the scene
+	void					AddDisc(const Vec2& center, float radius, int ownerIndex);
+	void					AddCapsule(const Vec2& start, const Vec2& end, float radius, int ownerIndex);
+	void					AddOBB(const Vec2& center, const Vec2& halfExtents, float rotationDegrees, int ownerIndex);
+	void					AddHull(const Geometry& geometry, int ownerIndex);
+
+	//Buckets everything added so far, needed again after adding or removing primitives
+	void					BuildBuckets(const BitFieldBroadPhase& broadPhase);
+
+	//Hulls owned by moved geometry take its plane distances and bounds and move between cells in place. Only hulls whose
+	//owner index is the geometry index they were added in order of are found. Returns the number that changed cells
+	int						RefitMovedHulls(const std::vector<Geometry>& geometry, const std::vector<int>& movedGeometryIndices);
+
+	bool					RaycastClosest(PrimitiveHit2D& hitOut, const Ray2D& ray, float maxTime = MAX_RAYCAST_TIME) const;
+
+	int						GetNumPrimitives(ePrimitiveType type) const;
+	const std::vector<DiscPrimitive>&		GetDiscs() const { return m_discs; }
+	const std::vector<CapsulePrimitive>&	GetCapsules() const { return m_capsules; }
+	const std::vector<OBBPrimitive>&		GetOBBs() const { return m_obbs; }
+
+private:
+	void					GetPrimitiveBounds(ePrimitiveType type, int typeIndex, Vec2& minsOut, Vec2& maxsOut) const;
+
+private:
+	const BitFieldBroadPhase*	m_broadPhase = nullptr;
+
+	std::vector<DiscPrimitive>		m_discs;
+	std::vector<CapsulePrimitive>	m_capsules;
+	std::vector<OBBPrimitive>		m_obbs;
+	std::vector<HullPrimitive>		m_hulls;
+
+	std::vector<float>		m_hullNormalX;
+	std::vector<float>		m_hullNormalY;
+	std::vector<float>		m_hullDistance;
+	std::vector<Vec2>		m_hullMins;
+	std::vector<Vec2>		m_hullMaxs;
+
+	//Bucket entry e is primitive e - m_typeStarts[type] of the type whose range holds it
+	int						m_typeStarts[NUM_PRIMITIVE_TYPES + 1] = {};
+	std::vector<IntVec2>	m_entryBitFields;
+	BitFieldCellBuckets		m_cellBuckets;
+};
@@ -0,0 +1,186 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/RaySorter.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <algorithm>
+
+//------------------------------------------------------------------------------------------------------------------------------
+RaySorter::RaySorter()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+RaySorter::~RaySorter()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RaySorter::SetWorldDimensions(const Vec2& mins, const Vec2& maxs)
+{
+	m_worldMins = mins;
+	m_worldMaxs = maxs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RaySorter::SortRays(const std::vector<Ray2D>& rays)
+{
+	int numRays = (int)rays.size();
+
+	m_sortKeys.resize(numRays);
+	for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
+	{
+		m_sortKeys[rayIndex] = (MakeSortKey(rays[rayIndex]) << 32) | (uint64_t)rayIndex;
+	}
+
+	std::sort(m_sortKeys.begin(), m_sortKeys.end());
+
+	//Gather the rays into sorted order, results get scattered back using m_originalIndices
+	m_sortedRays.resize(numRays);
+	m_originalIndices.resize(numRays);
+	for (int sortedIndex = 0; sortedIndex < numRays; sortedIndex++)
+	{
+		int originalIndex = (int)(m_sortKeys[sortedIndex] & 0xFFFFFFFF);
+		m_originalIndices[sortedIndex] = originalIndex;
+		m_sortedRays[sortedIndex] = rays[originalIndex];
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const std::vector<Ray2D>& RaySorter::GetSortedRays() const
+{
+	return m_sortedRays;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int RaySorter::GetOriginalIndex(int sortedIndex) const
+{
+	return m_originalIndices[sortedIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint64_t RaySorter::MakeSortKey(const Ray2D& ray) const
+{
+	//Quantize the origin to 14 bits per axis so octant (3 bits) + morton code (28 bits) fit in the upper 32 bits
+	constexpr float QUANTIZE_STEPS = 16383.f;
+
+	float normalizedX = (ray.m_start.x - m_worldMins.x) / (m_worldMaxs.x - m_worldMins.x);
+	float normalizedY = (ray.m_start.y - m_worldMins.y) / (m_worldMaxs.y - m_worldMins.y);
+
+	uint quantizedX = (uint)(Clamp(normalizedX, 0.f, 1.f) * QUANTIZE_STEPS);
+	uint quantizedY = (uint)(Clamp(normalizedY, 0.f, 1.f) * QUANTIZE_STEPS);
+
+	uint64_t octant = GetDirectionOctant(ray.m_direction);
+	uint64_t morton = GetMortonCode(quantizedX, quantizedY);
+
+	return (octant << 28) | morton;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint RaySorter::GetDirectionOctant(const Vec2& direction)
+{
+	//Sign of x, sign of y and which axis dominates picks one of the 8 45 degree wedges
+	uint octant = 0;
+	if (direction.x < 0.f)
+	{
+		octant |= 1;
+	}
+
+	if (direction.y < 0.f)
+	{
+		octant |= 2;
+	}
+
+	float absX = direction.x < 0.f ? -direction.x : direction.x;
+	float absY = direction.y < 0.f ? -direction.y : direction.y;
+	if (absY > absX)
+	{
+		octant |= 4;
+	}
+
+	return octant;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint RaySorter::GetMortonCode(uint x, uint y)
+{
+	//Spread the lower 16 bits of each coordinate so they interleave as yxyx...
+	x &= 0x0000FFFF;
+	x = (x | (x << 8)) & 0x00FF00FF;
+	x = (x | (x << 4)) & 0x0F0F0F0F;
+	x = (x | (x << 2)) & 0x33333333;
+	x = (x | (x << 1)) & 0x55555555;
+
+	y &= 0x0000FFFF;
+	y = (y | (y << 8)) & 0x00FF00FF;
+	y = (y | (y << 4)) & 0x0F0F0F0F;
+	y = (y | (y << 2)) & 0x33333333;
+	y = (y | (y << 1)) & 0x55555555;
+
+	return x | (y << 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+CacheMissEstimator::CacheMissEstimator(int cacheSizeBytes, int lineSizeBytes, int numWays)
+{
+	m_lineSizeBytes = lineSizeBytes;
+	m_numWays = numWays;
+	m_numSets = cacheSizeBytes / (lineSizeBytes * numWays);
+
+	Reset();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CacheMissEstimator::Reset()
+{
+	m_lineTags.assign(m_numSets * m_numWays, 0);
+	m_lineLastUse.assign(m_numSets * m_numWays, 0);
+	m_useCounter = 0;
+
+	m_numAccesses = 0;
+	m_numMisses = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CacheMissEstimator::Touch(const void* address, size_t numBytes)
+{
+	if (numBytes == 0)
+		return;
+
+	uintptr_t firstLine = (uintptr_t)address / m_lineSizeBytes;
+	uintptr_t lastLine = ((uintptr_t)address + numBytes - 1) / m_lineSizeBytes;
+
+	for (uintptr_t line = firstLine; line <= lastLine; line++)
+	{
+		m_numAccesses++;
+		m_useCounter++;
+
+		//Tags are stored off by one so that 0 can mean an empty way
+		uintptr_t tag = line + 1;
+		int setStart = (int)(line % m_numSets) * m_numWays;
+
+		int victimWay = setStart;
+		bool isHit = false;
+		for (int way = setStart; way < setStart + m_numWays; way++)
+		{
+			if (m_lineTags[way] == tag)
+			{
+				m_lineLastUse[way] = m_useCounter;
+				isHit = true;
+				break;
+			}
+
+			if (m_lineLastUse[way] < m_lineLastUse[victimWay])
+			{
+				victimWay = way;
+			}
+		}
+
+		if (!isHit)
+		{
+			m_numMisses++;
+			m_lineTags[victimWay] = tag;
+			m_lineLastUse[victimWay] = m_useCounter;
+		}
+	}
+}
@@ -0,0 +1,65 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Ray2D.hpp"
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Reorders rays so that rays with similar origins and directions get traversed together
+//Rays are binned by direction octant first and then by the Morton code of their origin inside the world bounds
+//------------------------------------------------------------------------------------------------------------------------------
+class RaySorter
+{
+public:
+	RaySorter();
+	~RaySorter();
+
+	void						SetWorldDimensions(const Vec2& mins, const Vec2& maxs);
+
+	void						SortRays(const std::vector<Ray2D>& rays);
+
+	const std::vector<Ray2D>&	GetSortedRays() const;
+	int							GetOriginalIndex(int sortedIndex) const;
+
+	uint64_t					MakeSortKey(const Ray2D& ray) const;
+
+	static uint					GetDirectionOctant(const Vec2& direction);
+	static uint					GetMortonCode(uint x, uint y);
+
+private:
+	Vec2						m_worldMins;
+	Vec2						m_worldMaxs;
+
+	std::vector<uint64_t>		m_sortKeys;			//Key in the upper bits, original ray index in the lower 32
+	std::vector<Ray2D>			m_sortedRays;
+	std::vector<int>			m_originalIndices;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Software model of a set associative cache with LRU replacement
+//Used to estimate how many cache lines a traversal order misses on without needing hardware counters
+//------------------------------------------------------------------------------------------------------------------------------
+class CacheMissEstimator
+{
+public:
+	explicit CacheMissEstimator(int cacheSizeBytes = 32 * 1024, int lineSizeBytes = 64, int numWays = 8);
+
+	void						Reset();
+	void						Touch(const void* address, size_t numBytes);
+
+	uint64_t					GetNumAccesses() const	{ return m_numAccesses; }
+	uint64_t					GetNumMisses() const	{ return m_numMisses; }
+
+private:
+	int							m_lineSizeBytes = 64;
+	int							m_numSets = 64;
+	int							m_numWays = 8;
+
+	std::vector<uintptr_t>		m_lineTags;			//numSets * numWays, 0 means empty
+	std::vector<uint64_t>		m_lineLastUse;
+	uint64_t					m_useCounter = 0;
+
+	uint64_t					m_numAccesses = 0;
+	uint64_t					m_numMisses = 0;
+};
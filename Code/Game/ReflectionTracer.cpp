@@ -0,0 +1,134 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/ReflectionTracer.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/HullStore.hpp"
+#include "Game/JobPool.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+ReflectionTracer::ReflectionTracer()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ReflectionTracer::~ReflectionTracer()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ReflectionTracer::TracePaths(const std::vector<Ray2D>& primaryRays, int maxBounces, const HullStore& hullStore, const BitFieldBroadPhase& broadPhase, const AABB2& worldBounds, std::vector<BounceSegment>& segmentsOut, JobPool* jobPool)
+{
+	m_activeRaysPerGeneration.clear();
+
+	m_activeRays = primaryRays;
+	m_activePathIndices.resize(primaryRays.size());
+	for (int pathIndex = 0; pathIndex < (int)primaryRays.size(); pathIndex++)
+	{
+		m_activePathIndices[pathIndex] = pathIndex;
+	}
+
+	for (int bounceIndex = 0; bounceIndex <= maxBounces && !m_activeRays.empty(); bounceIndex++)
+	{
+		int numActiveRays = (int)m_activeRays.size();
+		m_activeRaysPerGeneration.push_back(numActiveRays);
+
+		//Each ray owns slot firstSegmentIndex + its index, so the batch writes its segments without any locking
+		int firstSegmentIndex = (int)segmentsOut.size();
+		segmentsOut.resize(firstSegmentIndex + numActiveRays);
+		m_reflectedRays.resize(numActiveRays);
+		m_didHit.assign(numActiveRays, 0);
+
+		bool canReflect = bounceIndex < maxBounces;
+		auto traceRange = [this, &segmentsOut, &hullStore, &broadPhase, &worldBounds, firstSegmentIndex, bounceIndex, canReflect](int startIndex, int endIndex)
+		{
+			for (int rayIndex = startIndex; rayIndex < endIndex; rayIndex++)
+			{
+				const Ray2D& ray = m_activeRays[rayIndex];
+
+				RayHit2D hit;
+				bool didHit = hullStore.RaycastClosest(hit, ray, true) != -1;
+
+				BounceSegment& segment = segmentsOut[firstSegmentIndex + rayIndex];
+				segment.m_start = ray.m_start;
+				segment.m_pathIndex = m_activePathIndices[rayIndex];
+				segment.m_bounceIndex = bounceIndex;
+
+				if (!didHit)
+				{
+					segment.m_end = ray.GetPointAtTime(GetWorldExitTime(ray, worldBounds));
+					segment.m_impactNormal = Vec2::ZERO;
+					continue;
+				}
+
+				segment.m_end = hit.m_hitPoint;
+				segment.m_impactNormal = hit.m_impactNormal;
+
+				if (!canReflect)
+					continue;
+
+				//Mirror the direction about the surface and step off it so the next trace does not hit the same point
+				float directionAlongNormal = ray.m_direction.x * hit.m_impactNormal.x + ray.m_direction.y * hit.m_impactNormal.y;
+				Ray2D reflectedRay;
+				reflectedRay.m_start = hit.m_hitPoint + REFLECTION_SURFACE_OFFSET * hit.m_impactNormal;
+				reflectedRay.m_direction = ray.m_direction - (2.f * directionAlongNormal) * hit.m_impactNormal;
+				reflectedRay.m_bitFieldsXY = broadPhase.GetRegionForRay(reflectedRay);
+
+				m_reflectedRays[rayIndex] = reflectedRay;
+				m_didHit[rayIndex] = 1;
+			}
+		};
+
+		if (jobPool != nullptr)
+		{
+			jobPool->ParallelFor(numActiveRays, RAYCAST_BATCH_GRAIN_SIZE, traceRange);
+		}
+		else
+		{
+			traceRange(0, numActiveRays);
+		}
+
+		//Compact the rays that hit into the next generation, keeping their order so paths stay grouped the same way
+		int numSurvivors = 0;
+		for (int rayIndex = 0; rayIndex < numActiveRays; rayIndex++)
+		{
+			if (m_didHit[rayIndex] == 0)
+				continue;
+
+			m_activeRays[numSurvivors] = m_reflectedRays[rayIndex];
+			m_activePathIndices[numSurvivors] = m_activePathIndices[rayIndex];
+			numSurvivors++;
+		}
+
+		m_activeRays.resize(numSurvivors);
+		m_activePathIndices.resize(numSurvivors);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float ReflectionTracer::GetWorldExitTime(const Ray2D& ray, const AABB2& worldBounds)
+{
+	float exitTime = MAX_RAYCAST_TIME;
+
+	if (ray.m_direction.x > 0.f)
+	{
+		exitTime = GetLowerValue(exitTime, (worldBounds.m_maxBounds.x - ray.m_start.x) / ray.m_direction.x);
+	}
+	else if (ray.m_direction.x < 0.f)
+	{
+		exitTime = GetLowerValue(exitTime, (worldBounds.m_minBounds.x - ray.m_start.x) / ray.m_direction.x);
+	}
+
+	if (ray.m_direction.y > 0.f)
+	{
+		exitTime = GetLowerValue(exitTime, (worldBounds.m_maxBounds.y - ray.m_start.y) / ray.m_direction.y);
+	}
+	else if (ray.m_direction.y < 0.f)
+	{
+		exitTime = GetLowerValue(exitTime, (worldBounds.m_minBounds.y - ray.m_start.y) / ray.m_direction.y);
+	}
+
+	return GetHigherValue(exitTime, 0.f);
+}
@@ -0,0 +1,55 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/Ray2D.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class BitFieldBroadPhase;
+class HullStore;
+class JobPool;
+
+constexpr float REFLECTION_SURFACE_OFFSET = 0.001f;		//Reflected rays start this far off the surface they bounced from
+
+//------------------------------------------------------------------------------------------------------------------------------
+//One straight piece of a reflected path. Segments that did not hit anything end where they leave the world
+struct BounceSegment
+{
+	Vec2	m_start;
+	Vec2	m_end;
+	Vec2	m_impactNormal = Vec2::ZERO;	//Zero when the segment left the world
+	int		m_pathIndex = -1;				//Index of the primary ray the path started from
+	int		m_bounceIndex = 0;				//0 for the primary ray
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Multi bounce reflections traced as a stream. Every generation of rays is traced as one batch across the job pool,
+//rays that hit something are reflected about the impact normal into the next generation and the ones that missed
+//are compacted out, so each batch only holds live rays and the workers never idle on finished paths
+//------------------------------------------------------------------------------------------------------------------------------
+class ReflectionTracer
+{
+public:
+	ReflectionTracer();
+	~ReflectionTracer();
+
+	//Appends the segments of every path to segmentsOut generation by generation, maxBounces reflections per path at most
+	void					TracePaths(const std::vector<Ray2D>& primaryRays, int maxBounces, const HullStore& hullStore, const BitFieldBroadPhase& broadPhase, const AABB2& worldBounds, std::vector<BounceSegment>& segmentsOut, JobPool* jobPool = nullptr);
+
+	//Live rays at the start of each generation of the last trace
+	const std::vector<int>&	GetActiveRaysPerGeneration() const { return m_activeRaysPerGeneration; }
+
+private:
+	static float			GetWorldExitTime(const Ray2D& ray, const AABB2& worldBounds);
+
+private:
+	//Current and next generation, swapped after each compaction
+	std::vector<Ray2D>		m_activeRays;
+	std::vector<int>		m_activePathIndices;
+	std::vector<Ray2D>		m_reflectedRays;
+	std::vector<uint8_t>	m_didHit;		//Bytes rather than bools so workers can write neighbouring entries
+
+	std::vector<int>		m_activeRaysPerGeneration;
+};
@@ -96,6 +96,13 @@ void SceneCooker::InitiateWriteSequence()
 	byte sceneInfoChunkLocation = (byte)m_writeUtils->GetTotalSize();
 	WriteSceneInfoChunk(chunkToWrite);
 
+	//The visible set is only written when it was baked from the scene being saved
+	const PotentiallyVisibleSet& potentiallyVisibleSet = m_gameReference->m_potentiallyVisibleSet;
+	if (potentiallyVisibleSet.IsBaked() && potentiallyVisibleSet.GetSceneSignature() == PotentiallyVisibleSet::ComputeSceneSignature(m_gameReference->GetAllGameGeometry()))
+	{
+		WritePotentiallyVisibleSetChunk(chunkToWrite);
+	}
+
 	size_t TOCLocation = m_writeUtils->GetTotalSize();
 	WriteTableOfContents();
 
@@ -390,7 +397,8 @@ void SceneCooker::LoadChunks()
 		}
 		case 3:
 		{
-
+			LoadPotentiallyVisibleSetChunk(m_chunksRead[chunkIndex]);
+			break;
 		}
 		default:
 		{
@@ -580,3 +588,132 @@ void SceneCooker::WriteSceneInfoChunk(ChunkInfo& chunkToWrite)
 	chunkToWrite.m_dataSize = 16;
 	m_chunksWritten.push_back(chunkToWrite);
 }
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SceneCooker::WritePotentiallyVisibleSetChunk(ChunkInfo& chunkToWrite)
+{
+	//Set the chunk to write
+	chunkToWrite.m_type = 3;
+	chunkToWrite.m_location = (uint)m_writeUtils->GetTotalSize();
+
+	//Reset to endianness passed in
+	m_writeUtils->SetEndianMode(m_endianNess);
+
+	//Write FourCC for chunk
+	m_writeUtils->AppendByte('\0');
+	m_writeUtils->AppendByte('C');
+	m_writeUtils->AppendByte('H');
+	m_writeUtils->AppendByte('K');
+
+	//Chunk Type
+	m_writeUtils->AppendByte(3);	//Chunk type potentially visible set
+
+	//Chunk endianness
+	if (m_writeUtils->IsEndianModeBig())
+	{
+		m_writeUtils->AppendByte(2);
+	}
+	else
+	{
+		m_writeUtils->AppendByte(1);
+	}
+
+	const PotentiallyVisibleSet& potentiallyVisibleSet = m_gameReference->m_potentiallyVisibleSet;
+	const std::vector<uint16_t>& rowIndices = potentiallyVisibleSet.GetRowIndices();
+	const std::vector<uint32_t>& rowOffsets = potentiallyVisibleSet.GetRowOffsets();
+	const std::vector<uint8_t>& compressedBytes = potentiallyVisibleSet.GetCompressedBytes();
+
+	//Cells per axis, scene signature, stored row count, byte count, then the row of each cell, the row offsets and the run length coded rows
+	uint dataSize = 16 + (uint)rowIndices.size() * 2 + (uint)rowOffsets.size() * 4 + (uint)compressedBytes.size();
+	m_writeUtils->AppendUint32(dataSize);
+
+	m_writeUtils->AppendUint32((uint)potentiallyVisibleSet.GetNumCellsPerAxis());
+	m_writeUtils->AppendUint32(potentiallyVisibleSet.GetSceneSignature());
+	m_writeUtils->AppendUint32((uint)potentiallyVisibleSet.GetNumUniqueRows());
+	m_writeUtils->AppendUint32((uint)compressedBytes.size());
+
+	for (int cellIndex = 0; cellIndex < (int)rowIndices.size(); cellIndex++)
+	{
+		m_writeUtils->AppendShort((short)rowIndices[cellIndex]);
+	}
+
+	for (int rowIndex = 0; rowIndex < (int)rowOffsets.size(); rowIndex++)
+	{
+		m_writeUtils->AppendUint32(rowOffsets[rowIndex]);
+	}
+
+	for (int byteIndex = 0; byteIndex < (int)compressedBytes.size(); byteIndex++)
+	{
+		m_writeUtils->AppendByte(compressedBytes[byteIndex]);
+	}
+
+	chunkToWrite.m_dataSize = dataSize;
+	m_chunksWritten.push_back(chunkToWrite);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SceneCooker::LoadPotentiallyVisibleSetChunk(ChunkInfo& chunkInfo)
+{
+	//Read this chunk by going to location
+	m_readUtils->SetReadLocation(chunkInfo.m_location);
+	m_readUtils->SetEndianMode(m_endianNess);
+
+	//Check FourCC
+	uchar fourCC0 = m_readUtils->ParseChar();
+	uchar fourCC1 = m_readUtils->ParseChar();
+	uchar fourCC2 = m_readUtils->ParseChar();
+	uchar fourCC3 = m_readUtils->ParseChar();
+
+	GUARANTEE_RECOVERABLE((fourCC0 == '\0'), "Failed at 1");
+	GUARANTEE_RECOVERABLE(fourCC1 == 'C', "Failed at 2");
+	GUARANTEE_RECOVERABLE(fourCC2 == 'H', "Failed at 3");
+	GUARANTEE_RECOVERABLE(fourCC3 == 'K', "Failed at 4");
+
+	//Check Chunk type
+	uchar chunkType = m_readUtils->ParseByte();
+	GUARANTEE_RECOVERABLE(chunkType == 3, "Chunk is not Potentially Visible Set Chunk");
+
+	//Check endianness
+	uchar endianness = m_readUtils->ParseByte();
+
+	//Data size chcek
+	uint dataSize = m_readUtils->ParseUint32();
+
+	uint numCellsPerAxis = m_readUtils->ParseUint32();
+	uint sceneSignature = m_readUtils->ParseUint32();
+	uint numUniqueRows = m_readUtils->ParseUint32();
+	uint numCompressedBytes = m_readUtils->ParseUint32();
+
+	uint numCells = numCellsPerAxis * numCellsPerAxis;
+	uint numRowOffsets = numUniqueRows + 1;
+	if (dataSize != 16 + numCells * 2 + numRowOffsets * 4 + numCompressedBytes)
+	{
+		ERROR_RECOVERABLE("Potentially Visible Set Chunk size mismatch");
+		return;
+	}
+
+	std::vector<uint16_t> rowIndices;
+	rowIndices.reserve(numCells);
+	for (uint cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		rowIndices.push_back((uint16_t)m_readUtils->ParseShort());
+	}
+
+	std::vector<uint32_t> rowOffsets;
+	rowOffsets.reserve(numRowOffsets);
+	for (uint rowIndex = 0; rowIndex < numRowOffsets; rowIndex++)
+	{
+		rowOffsets.push_back(m_readUtils->ParseUint32());
+	}
+
+	std::vector<uint8_t> compressedBytes;
+	compressedBytes.reserve(numCompressedBytes);
+	for (uint byteIndex = 0; byteIndex < numCompressedBytes; byteIndex++)
+	{
+		compressedBytes.push_back(m_readUtils->ParseByte());
+	}
+
+	//Checked against the scene once the geometry is made, a stale set is baked again
+	bool success = m_gameReference->m_potentiallyVisibleSet.SetCompressed((int)numCellsPerAxis, sceneSignature, rowIndices, rowOffsets, compressedBytes);
+	GUARANTEE_RECOVERABLE(success, "Potentially Visible Set Chunk rows are corrupt");
+}
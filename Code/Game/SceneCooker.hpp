@@ -42,6 +42,7 @@ private:
 	void				WriteConvexPolysChunk(ChunkInfo& chunkToWrite);
 	void				WriteConvexHullsChunk(ChunkInfo& chunkToWrite);
 	void				WriteSceneInfoChunk(ChunkInfo& chunkToWrite);
+	void				WritePotentiallyVisibleSetChunk(ChunkInfo& chunkToWrite);
 	void				WriteTableOfContents();
 
 	//Read methods
@@ -52,6 +53,7 @@ private:
 	void				LoadConvexPolysChunk(ChunkInfo& chunkInfo);
 	void				LoadConvexHullsChunk(ChunkInfo& chunkInfo);
 	void				LoadSceneInfoChunk(ChunkInfo& chunkInfo);
+	void				LoadPotentiallyVisibleSetChunk(ChunkInfo& chunkInfo);
 
 	void				MakeGameGeometry();
 
@@ -0,0 +1,235 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/SceneGenerator.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/JobPool.hpp"
+#include <cmath>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Streams keep the different uses of a polygon index apart, placement attempts use the attempt index as their stream
+constexpr uint32_t SCENE_CLUSTER_STREAM = 0x10000;
+constexpr uint32_t SCENE_SHAPE_STREAM = 0x20000;
+
+//Draws of one polygon in one stream
+constexpr uint32_t SCENE_DRAW_RADIUS = 0;
+constexpr uint32_t SCENE_DRAW_POSITION_X = 1;
+constexpr uint32_t SCENE_DRAW_POSITION_Y = 2;
+constexpr uint32_t SCENE_DRAW_SHAPE = 3;
+constexpr uint32_t SCENE_DRAW_CLUSTER = 4;
+constexpr uint32_t SCENE_DRAW_FIRST_ANGLE = 8;
+
+constexpr float SCENE_DEGREES_TO_RADIANS = 3.14159265f / 180.f;
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Squirrel noise style position hash, the same position and seed always give the same bits
+static uint32_t GetNoiseBits(uint32_t position, uint32_t seed)
+{
+	constexpr uint32_t BIT_NOISE1 = 0xB5297A4D;
+	constexpr uint32_t BIT_NOISE2 = 0x68E31DA4;
+	constexpr uint32_t BIT_NOISE3 = 0x1B56C4E9;
+
+	uint32_t mangledBits = position;
+	mangledBits *= BIT_NOISE1;
+	mangledBits += seed;
+	mangledBits ^= (mangledBits >> 8);
+	mangledBits += BIT_NOISE2;
+	mangledBits ^= (mangledBits << 8);
+	mangledBits *= BIT_NOISE3;
+	mangledBits ^= (mangledBits >> 8);
+	return mangledBits;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+SceneGenerator::SceneGenerator()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+SceneGenerator::~SceneGenerator()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SceneGenerator::Generate(int numPolygons, int firstPolygonIndex, const AABB2& worldBounds, const BitFieldBroadPhase& broadPhase,
+	std::vector<Geometry>& geometryOut, JobPool* jobPool /*= nullptr*/) const
+{
+	geometryOut.resize(numPolygons);
+	if (firstPolygonIndex >= numPolygons)
+		return;
+
+	//Every polygon only reads the settings and writes its own slot, so the chunks need nothing from each other
+	auto generateRange = [&](int startIndex, int endIndex)
+	{
+		std::vector<Vec2> scratchPoints;
+		for (int polygonIndex = firstPolygonIndex + startIndex; polygonIndex < firstPolygonIndex + endIndex; polygonIndex++)
+		{
+			MakePolygon(polygonIndex, numPolygons, 0, worldBounds, broadPhase, geometryOut[polygonIndex], scratchPoints);
+		}
+	};
+
+	int numToGenerate = numPolygons - firstPolygonIndex;
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(numToGenerate, SCENE_GENERATION_GRAIN_SIZE, generateRange);
+	}
+	else
+	{
+		generateRange(0, numToGenerate);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SceneGenerator::MakePolygon(int polygonIndex, int numPolygons, int attemptIndex, const AABB2& worldBounds, const BitFieldBroadPhase& broadPhase,
+	Geometry& geometryOut, std::vector<Vec2>& scratchPoints) const
+{
+	uint32_t stream = (uint32_t)attemptIndex;
+
+	//Grid cells can be smaller than the radius range, every polygon is scaled by the same amount so repeated shapes still match
+	float radiusScale = 1.f;
+	if (m_settings.m_distribution == SCENE_DISTRIBUTION_GRID)
+	{
+		IntVec2 gridSize = GetGridSize(numPolygons, worldBounds);
+		Vec2 gridSpan = worldBounds.m_maxBounds - worldBounds.m_minBounds - Vec2(2.f * BUFFER_SPACE, 2.f * BUFFER_SPACE);
+		float cellRadius = 0.45f * GetLowerValue(gridSpan.x / (float)gridSize.x, gridSpan.y / (float)gridSize.y);
+		radiusScale = GetLowerValue(1.f, cellRadius / m_settings.m_maxRadius);
+	}
+
+	float radius;
+	if (m_settings.m_repeatShapes)
+	{
+		uint32_t shapeIndex = (uint32_t)(GetRandomZeroToOne((uint32_t)polygonIndex, SCENE_DRAW_SHAPE, stream) * (float)NUM_REPEATED_SHAPES);
+		radius = GetRadius(shapeIndex, SCENE_SHAPE_STREAM);
+		MakeShapePoints(shapeIndex, SCENE_SHAPE_STREAM, radius * radiusScale, scratchPoints);
+	}
+	else
+	{
+		radius = GetRadius((uint32_t)polygonIndex, stream);
+		MakeShapePoints((uint32_t)polygonIndex, stream, radius * radiusScale, scratchPoints);
+	}
+	radius *= radiusScale;
+
+	//Made around the origin so the shape only needs moving into place
+	Vec2 position = GetPosition(polygonIndex, numPolygons, stream, radius, worldBounds);
+	for (int pointIndex = 0; pointIndex < (int)scratchPoints.size(); pointIndex++)
+	{
+		scratchPoints[pointIndex] += position;
+	}
+
+	geometryOut.m_convexPoly = ConvexPoly2D(scratchPoints);
+	geometryOut.m_convexHull.MakeConvexHullFromConvexPolyon(geometryOut.m_convexPoly);
+	geometryOut.SetBitFieldsForBitBucketBroadPhase(broadPhase.GetRegionForConvexPoly(geometryOut.m_convexPoly));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+IntVec2 SceneGenerator::GetGridSize(int numPolygons, const AABB2& worldBounds)
+{
+	//Columns and rows in the world's aspect so the cells come out close to square
+	Vec2 worldSize = worldBounds.m_maxBounds - worldBounds.m_minBounds;
+	int numPolygonsOnGrid = GetHigherValue(numPolygons, 1);
+	int numColumns = GetHigherValue((int)ceilf(sqrtf((float)numPolygonsOnGrid * worldSize.x / worldSize.y)), 1);
+	int numRows = (numPolygonsOnGrid + numColumns - 1) / numColumns;
+	return IntVec2(numColumns, numRows);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float SceneGenerator::GetRandomZeroToOne(uint32_t polygonIndex, uint32_t drawIndex, uint32_t stream) const
+{
+	//Top 24 bits so the result is exact in a float and never reaches 1
+	uint32_t seed = m_settings.m_seed + GetNoiseBits(drawIndex, stream);
+	return (float)(GetNoiseBits(polygonIndex, seed) >> 8) * (1.f / 16777216.f);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float SceneGenerator::GetRadius(uint32_t polygonIndex, uint32_t stream) const
+{
+	float zeroToOne = GetRandomZeroToOne(polygonIndex, SCENE_DRAW_RADIUS, stream);
+	if (m_settings.m_distribution != SCENE_DISTRIBUTION_POWER_LAW)
+	{
+		return m_settings.m_minRadius + zeroToOne * (m_settings.m_maxRadius - m_settings.m_minRadius);
+	}
+
+	//Inverse of the cumulative distribution of radius ^ -exponent cut off at the ends of the radius range
+	float exponent = m_settings.m_powerLawExponent - 1.f;
+	float tail = powf(m_settings.m_minRadius / m_settings.m_maxRadius, exponent);
+	float radius = m_settings.m_minRadius * powf(1.f - zeroToOne * (1.f - tail), -1.f / exponent);
+	return GetLowerValue(radius, m_settings.m_maxRadius);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec2 SceneGenerator::GetPosition(int polygonIndex, int numPolygons, uint32_t stream, float radius, const AABB2& worldBounds) const
+{
+	Vec2 mins = worldBounds.m_minBounds + Vec2(radius + BUFFER_SPACE, radius + BUFFER_SPACE);
+	Vec2 maxs = worldBounds.m_maxBounds - Vec2(radius + BUFFER_SPACE, radius + BUFFER_SPACE);
+
+	float zeroToOneX = GetRandomZeroToOne((uint32_t)polygonIndex, SCENE_DRAW_POSITION_X, stream);
+	float zeroToOneY = GetRandomZeroToOne((uint32_t)polygonIndex, SCENE_DRAW_POSITION_Y, stream);
+
+	switch (m_settings.m_distribution)
+	{
+	case SCENE_DISTRIBUTION_CLUSTERED:
+	{
+		int numClusters = GetHigherValue(m_settings.m_numClusters, 1);
+		int clusterIndex = (int)(GetRandomZeroToOne((uint32_t)polygonIndex, SCENE_DRAW_CLUSTER, stream) * (float)numClusters);
+		Vec2 center = GetClusterCenter(clusterIndex, worldBounds);
+
+		//Box Muller, the first draw is flipped to (0, 1] for the log
+		Vec2 worldSize = worldBounds.m_maxBounds - worldBounds.m_minBounds;
+		float spread = m_settings.m_clusterSpread * GetLowerValue(worldSize.x, worldSize.y);
+		float distance = spread * sqrtf(-2.f * logf(1.f - zeroToOneX));
+		float angle = zeroToOneY * 360.f * SCENE_DEGREES_TO_RADIANS;
+
+		Vec2 position = center + Vec2(cosf(angle) * distance, sinf(angle) * distance);
+		position.x = GetHigherValue(mins.x, GetLowerValue(position.x, maxs.x));
+		position.y = GetHigherValue(mins.y, GetLowerValue(position.y, maxs.y));
+		return position;
+	}
+	case SCENE_DISTRIBUTION_GRID:
+	{
+		//Cell centers of a grid inside the buffer, polygon order runs along the rows
+		IntVec2 gridSize = GetGridSize(numPolygons, worldBounds);
+		Vec2 gridMins = worldBounds.m_minBounds + Vec2(BUFFER_SPACE, BUFFER_SPACE);
+		Vec2 gridSpan = worldBounds.m_maxBounds - worldBounds.m_minBounds - Vec2(2.f * BUFFER_SPACE, 2.f * BUFFER_SPACE);
+		float cellX = ((float)(polygonIndex % gridSize.x) + 0.5f) / (float)gridSize.x;
+		float cellY = ((float)(polygonIndex / gridSize.x) + 0.5f) / (float)gridSize.y;
+		return Vec2(gridMins.x + cellX * gridSpan.x, gridMins.y + cellY * gridSpan.y);
+	}
+	case SCENE_DISTRIBUTION_UNIFORM:
+	case SCENE_DISTRIBUTION_POWER_LAW:
+	default:
+		return Vec2(mins.x + zeroToOneX * (maxs.x - mins.x), mins.y + zeroToOneY * (maxs.y - mins.y));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec2 SceneGenerator::GetClusterCenter(int clusterIndex, const AABB2& worldBounds) const
+{
+	//Kept a largest polygon away from the edges so a blob is not flattened against the world bounds
+	float margin = m_settings.m_maxRadius + BUFFER_SPACE;
+	Vec2 mins = worldBounds.m_minBounds + Vec2(margin, margin);
+	Vec2 maxs = worldBounds.m_maxBounds - Vec2(margin, margin);
+
+	float zeroToOneX = GetRandomZeroToOne((uint32_t)clusterIndex, SCENE_DRAW_POSITION_X, SCENE_CLUSTER_STREAM);
+	float zeroToOneY = GetRandomZeroToOne((uint32_t)clusterIndex, SCENE_DRAW_POSITION_Y, SCENE_CLUSTER_STREAM);
+	return Vec2(mins.x + zeroToOneX * (maxs.x - mins.x), mins.y + zeroToOneY * (maxs.y - mins.y));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SceneGenerator::MakeShapePoints(uint32_t shapeIndex, uint32_t stream, float radius, std::vector<Vec2>& pointsOut) const
+{
+	//Corners on the circle, starting at most a largest step past zero and never coming back within 10 degrees of the start,
+	//which always gives at least 3 corners
+	pointsOut.clear();
+
+	uint32_t drawIndex = SCENE_DRAW_FIRST_ANGLE;
+	float angle = 10.f + GetRandomZeroToOne(shapeIndex, drawIndex++, stream) * (SCENE_MAX_ANGLE_STEP - 10.f);
+	while (angle <= 360.f)
+	{
+		float radians = angle * SCENE_DEGREES_TO_RADIANS;
+		pointsOut.push_back(Vec2(cosf(radians) * radius, sinf(radians) * radius));
+
+		angle += SCENE_MIN_ANGLE_STEP + GetRandomZeroToOne(shapeIndex, drawIndex++, stream) * (SCENE_MAX_ANGLE_STEP - SCENE_MIN_ANGLE_STEP);
+	}
+}
@@ -0,0 +1,82 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Game/GameCommon.hpp"
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class BitFieldBroadPhase;
+class Geometry;
+class JobPool;
+
+constexpr float SCENE_MIN_ANGLE_STEP = 20.f;		//Smallest turn in degrees between polygon corners, keeps corners from doubling up
+constexpr float SCENE_MAX_ANGLE_STEP = 110.f;		//Largest turn in degrees between polygon corners
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eSceneDistribution
+{
+	SCENE_DISTRIBUTION_UNIFORM = 0,		//Placed anywhere, radius uniform in the range
+	SCENE_DISTRIBUTION_CLUSTERED,		//Placed in gaussian blobs around a few random centers
+	SCENE_DISTRIBUTION_GRID,			//One polygon per cell of a grid laid out for the whole count
+	SCENE_DISTRIBUTION_POWER_LAW,		//Placed anywhere, many small polygons and a few large ones
+
+	NUM_SCENE_DISTRIBUTIONS
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct SceneGeneratorSettings
+{
+	eSceneDistribution	m_distribution = SCENE_DISTRIBUTION_UNIFORM;
+	uint32_t			m_seed = 0;
+	float				m_minRadius = MIN_CONSTRUCTION_RADIUS;
+	float				m_maxRadius = MAX_CONSTRUCTION_RADIUS;
+	bool				m_repeatShapes = false;		//Polygons are copies of NUM_REPEATED_SHAPES shapes, like the tiles of a level
+
+	int					m_numClusters = 8;
+	float				m_clusterSpread = 0.08f;		//Standard deviation of a blob as a share of the world's smaller side
+	float				m_powerLawExponent = 2.5f;		//Radius density falls off as radius ^ -exponent
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Random convex polygon scenes where every random number is a hash of the seed, the polygon index and which draw it is,
+//so there is no generator state to share: any range of polygons can be made on any worker in any order and the same
+//settings always make the same scene. Growing a scene keeps the polygons it had, grid scenes excepted since their
+//layout depends on the count
+//------------------------------------------------------------------------------------------------------------------------------
+class SceneGenerator
+{
+public:
+	SceneGenerator();
+	~SceneGenerator();
+
+	void							SetSettings(const SceneGeneratorSettings& settings) { m_settings = settings; }
+	const SceneGeneratorSettings&	GetSettings() const { return m_settings; }
+
+	//Makes polygons [firstPolygonIndex, numPolygons) of a numPolygons scene into geometryOut, which is resized to numPolygons
+	void					Generate(int numPolygons, int firstPolygonIndex, const AABB2& worldBounds, const BitFieldBroadPhase& broadPhase,
+								std::vector<Geometry>& geometryOut, JobPool* jobPool = nullptr) const;
+
+	//Polygon of a numPolygons scene, a later attempt places it again somewhere else
+	void					MakePolygon(int polygonIndex, int numPolygons, int attemptIndex, const AABB2& worldBounds, const BitFieldBroadPhase& broadPhase,
+								Geometry& geometryOut, std::vector<Vec2>& scratchPoints) const;
+
+	//Columns and rows of a grid scene, laid out for the whole count
+	static IntVec2			GetGridSize(int numPolygons, const AABB2& worldBounds);
+
+private:
+	//Uniform in [0, 1) for one draw of one polygon
+	float					GetRandomZeroToOne(uint32_t polygonIndex, uint32_t drawIndex, uint32_t stream) const;
+
+	float					GetRadius(uint32_t polygonIndex, uint32_t stream) const;
+	Vec2					GetPosition(int polygonIndex, int numPolygons, uint32_t stream, float radius, const AABB2& worldBounds) const;
+	Vec2					GetClusterCenter(int clusterIndex, const AABB2& worldBounds) const;
+
+	//Corners around the origin in counter clockwise order
+	void					MakeShapePoints(uint32_t shapeIndex, uint32_t stream, float radius, std::vector<Vec2>& pointsOut) const;
+
+private:
+	SceneGeneratorSettings	m_settings;
+};
@@ -0,0 +1,525 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/SceneQuery.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/Geometry.hpp"
+#include <cmath>
+#include <functional>
+#include <algorithm>
+
+//------------------------------------------------------------------------------------------------------------------------------
+SceneQuery::SceneQuery()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+SceneQuery::~SceneQuery()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SceneQuery::BuildFromGeometry(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase)
+{
+	Clear();
+
+	m_broadPhase = &broadPhase;
+	m_edges.BuildFromGeometry(geometry);
+
+	//Slack so moving geometry can change cells without a rebuild
+	m_cellBuckets.Build(m_edges.m_bitFields, broadPhase.GetNumBitFields(), CELL_BUCKET_REFIT_SLACK);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int SceneQuery::RefitMovedGeometry(const std::vector<Geometry>& geometry, const std::vector<int>& movedGeometryIndices)
+{
+	int numCellChanges = 0;
+	bool needsBucketRebuild = false;
+
+	for (int movedIndex = 0; movedIndex < (int)movedGeometryIndices.size(); movedIndex++)
+	{
+		int geometryIndex = movedGeometryIndices[movedIndex];
+		int hullIndex = m_edges.RefitMovedGeometry(geometry, geometryIndex);
+		if (hullIndex < 0)
+			continue;
+
+		const IntVec2& newBitFields = geometry[geometryIndex].GetBitFields();
+		IntVec2& hullBitFields = m_edges.m_bitFields[hullIndex];
+		if (hullBitFields.x == newBitFields.x && hullBitFields.y == newBitFields.y)
+			continue;
+
+		numCellChanges++;
+		if (!needsBucketRebuild && !m_cellBuckets.MoveEntry(hullIndex, hullBitFields, newBitFields))
+		{
+			needsBucketRebuild = true;
+		}
+		hullBitFields = newBitFields;
+	}
+
+	//A cell ran out of slack, starting over from the current bit fields gives every cell fresh room
+	if (needsBucketRebuild)
+	{
+		m_cellBuckets.Build(m_edges.m_bitFields, m_broadPhase->GetNumBitFields(), CELL_BUCKET_REFIT_SLACK);
+	}
+
+	return numCellChanges;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SceneQuery::Clear()
+{
+	m_broadPhase = nullptr;
+	m_edges.Clear();
+	m_cellBuckets.Clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int SceneQuery::QueryAABB(const AABB2& region, int* geometryIndicesOut, int maxResults) const
+{
+	return GatherAABB(region, geometryIndicesOut, maxResults);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int SceneQuery::QueryDisc(const Vec2& center, float radius, int* geometryIndicesOut, int maxResults) const
+{
+	return GatherDisc(center, radius, geometryIndicesOut, maxResults);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int SceneQuery::CountAABB(const AABB2& region) const
+{
+	return GatherAABB(region, nullptr, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int SceneQuery::CountDisc(const Vec2& center, float radius) const
+{
+	return GatherDisc(center, radius, nullptr, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SceneQuery::FindNearestGeometry(const Vec2& point, NearestGeometry2D& nearestOut, NearestGeometryScratch& scratch, float maxDistance) const
+{
+	if (m_broadPhase == nullptr)
+		return false;
+
+	int numCellsPerAxis = m_cellBuckets.GetNumCellsPerAxis();
+	int numCells = numCellsPerAxis * numCellsPerAxis;
+
+	//A new stamp un-queues every cell, the stamps only need clearing when the counter wraps
+	scratch.m_currentStamp++;
+	if ((int)scratch.m_cellStamps.size() != numCells || scratch.m_currentStamp == 0)
+	{
+		scratch.m_cellStamps.assign(numCells, 0);
+		scratch.m_currentStamp = 1;
+	}
+	const uint32_t queuedStamp = scratch.m_currentStamp;
+
+	typedef std::pair<float, int> CellEntry;
+	std::vector<CellEntry>& cellHeap = scratch.m_cellHeap;
+	cellHeap.clear();
+
+	IntVec2 startCell = m_broadPhase->GetCellForPoint(point);
+	int startCellIndex = m_cellBuckets.GetCellIndex(startCell);
+	cellHeap.push_back(CellEntry(0.f, startCellIndex));
+	scratch.m_cellStamps[startCellIndex] = queuedStamp;
+
+	float bestDistance = maxDistance;
+	bool foundGeometry = false;
+
+	while (!cellHeap.empty())
+	{
+		std::pop_heap(cellHeap.begin(), cellHeap.end(), std::greater<CellEntry>());
+		CellEntry cellEntry = cellHeap.back();
+		cellHeap.pop_back();
+
+		//Hulls containing the point can still beat a negative best, and they all sit at cell distance 0
+		float pruneDistance = GetHigherValue(bestDistance, 0.f);
+		if (cellEntry.first > pruneDistance)
+			break;
+
+		int cellIndex = cellEntry.second;
+		for (int bucketIndex = m_cellBuckets.GetCellStart(cellIndex); bucketIndex < m_cellBuckets.GetCellEnd(cellIndex); bucketIndex++)
+		{
+			int hullIndex = m_cellBuckets.GetEntry(bucketIndex);
+
+			//Distance to the bounds is a lower bound for the distance to the hull
+			const Vec2& hullMins = m_edges.m_hullMins[hullIndex];
+			const Vec2& hullMaxs = m_edges.m_hullMaxs[hullIndex];
+			float outsideX = GetHigherValue(GetHigherValue(hullMins.x - point.x, point.x - hullMaxs.x), 0.f);
+			float outsideY = GetHigherValue(GetHigherValue(hullMins.y - point.y, point.y - hullMaxs.y), 0.f);
+			float boundsDistanceSquared = outsideX * outsideX + outsideY * outsideY;
+			if (boundsDistanceSquared > 0.f && boundsDistanceSquared >= pruneDistance * pruneDistance)
+				continue;
+
+			Vec2 closestPoint;
+			float signedDistance = GetSignedDistanceToHull(point, hullIndex, closestPoint);
+			if (signedDistance < bestDistance || (!foundGeometry && signedDistance <= bestDistance))
+			{
+				bestDistance = signedDistance;
+				pruneDistance = GetHigherValue(bestDistance, 0.f);
+				foundGeometry = true;
+
+				nearestOut.m_signedDistance = signedDistance;
+				nearestOut.m_closestPoint = closestPoint;
+				nearestOut.m_geometryIndex = m_edges.m_geometryIndices[hullIndex];
+			}
+		}
+
+		//Flood out to the neighbours, every cell has a neighbour at least as close so nothing gets visited out of order
+		IntVec2 cell = IntVec2(cellIndex % numCellsPerAxis, cellIndex / numCellsPerAxis);
+		IntVec2 neighbours[4] = { IntVec2(cell.x - 1, cell.y), IntVec2(cell.x + 1, cell.y), IntVec2(cell.x, cell.y - 1), IntVec2(cell.x, cell.y + 1) };
+		for (int neighbourIndex = 0; neighbourIndex < 4; neighbourIndex++)
+		{
+			const IntVec2& neighbour = neighbours[neighbourIndex];
+			if (neighbour.x < 0 || neighbour.y < 0 || neighbour.x >= numCellsPerAxis || neighbour.y >= numCellsPerAxis)
+				continue;
+
+			int neighbourCellIndex = m_cellBuckets.GetCellIndex(neighbour);
+			if (scratch.m_cellStamps[neighbourCellIndex] == queuedStamp)
+				continue;
+
+			scratch.m_cellStamps[neighbourCellIndex] = queuedStamp;
+
+			float cellDistance = GetDistanceToCell(point, neighbour);
+			if (cellDistance <= pruneDistance)
+			{
+				cellHeap.push_back(CellEntry(cellDistance, neighbourCellIndex));
+				std::push_heap(cellHeap.begin(), cellHeap.end(), std::greater<CellEntry>());
+			}
+		}
+	}
+
+	return foundGeometry;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SceneQuery::GetSceneBounds(AABB2& boundsOut) const
+{
+	if (m_edges.m_hullMins.empty())
+		return false;
+
+	boundsOut = AABB2(m_edges.m_hullMins[0], m_edges.m_hullMaxs[0]);
+	for (int hullIndex = 1; hullIndex < (int)m_edges.m_hullMins.size(); hullIndex++)
+	{
+		boundsOut.m_minBounds.x = GetLowerValue(boundsOut.m_minBounds.x, m_edges.m_hullMins[hullIndex].x);
+		boundsOut.m_minBounds.y = GetLowerValue(boundsOut.m_minBounds.y, m_edges.m_hullMins[hullIndex].y);
+		boundsOut.m_maxBounds.x = GetHigherValue(boundsOut.m_maxBounds.x, m_edges.m_hullMaxs[hullIndex].x);
+		boundsOut.m_maxBounds.y = GetHigherValue(boundsOut.m_maxBounds.y, m_edges.m_hullMaxs[hullIndex].y);
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int SceneQuery::RaycastAll(const Ray2D& ray, RayInterval2D* intervalsOut, int maxIntervals, float maxTime) const
+{
+	if (m_broadPhase == nullptr || maxIntervals <= 0)
+		return 0;
+
+	BitFieldRayWalker walker;
+	if (!walker.Begin(*m_broadPhase, ray, maxTime))
+		return 0;
+
+	int numWritten = 0;
+	do
+	{
+		float cellEnterTime = walker.GetCellEnterTime();
+		float cellExitTime = walker.GetCellExitTime();
+		bool isFirstCell = walker.IsFirstCell();
+		bool isLastCell = walker.IsLastCell();
+
+		//A hull is reported from the cell its entry time falls in, the first and last cells also take entries before and after the grid
+		int cellFirstInterval = numWritten;
+		int cellIndex = m_cellBuckets.GetCellIndex(walker.GetCell());
+		for (int bucketIndex = m_cellBuckets.GetCellStart(cellIndex); bucketIndex < m_cellBuckets.GetCellEnd(cellIndex); bucketIndex++)
+		{
+			int hullIndex = m_cellBuckets.GetEntry(bucketIndex);
+
+			float timeEnter;
+			float timeExit;
+			if (!ClipRayToHull(ray, hullIndex, timeEnter, timeExit))
+				continue;
+
+			if (timeEnter >= maxTime || (timeEnter < cellEnterTime && !isFirstCell) || (timeEnter >= cellExitTime && !isLastCell))
+				continue;
+
+			//Insertion into the sorted run of this cell, dropping the latest entry once the buffer is full
+			int insertIndex = numWritten;
+			if (numWritten == maxIntervals)
+			{
+				if (insertIndex == cellFirstInterval || timeEnter >= intervalsOut[numWritten - 1].m_timeEnter)
+					continue;
+
+				insertIndex--;
+			}
+			else
+			{
+				numWritten++;
+			}
+
+			while (insertIndex > cellFirstInterval && intervalsOut[insertIndex - 1].m_timeEnter > timeEnter)
+			{
+				intervalsOut[insertIndex] = intervalsOut[insertIndex - 1];
+				insertIndex--;
+			}
+
+			intervalsOut[insertIndex].m_geometryIndex = m_edges.m_geometryIndices[hullIndex];
+			intervalsOut[insertIndex].m_timeEnter = timeEnter;
+			intervalsOut[insertIndex].m_timeExit = timeExit;
+		}
+
+		//Everything in later cells enters later than what is already in the buffer
+		if (numWritten == maxIntervals)
+			break;
+	}
+	while (walker.Advance());
+
+	return numWritten;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename HULL_TEST>
+int SceneQuery::GatherRegion(const Vec2& regionMins, const Vec2& regionMaxs, const HULL_TEST& overlapTest, int* geometryIndicesOut, int maxResults) const
+{
+	if (m_broadPhase == nullptr)
+		return 0;
+
+	IntVec2 minCell;
+	IntVec2 maxCell;
+	m_broadPhase->GetCellRangeForMinMaxs(regionMins, regionMaxs, minCell, maxCell);
+
+	int numOverlapping = 0;
+	for (int cellY = minCell.y; cellY <= maxCell.y; cellY++)
+	{
+		for (int cellX = minCell.x; cellX <= maxCell.x; cellX++)
+		{
+			IntVec2 cell = IntVec2(cellX, cellY);
+			int cellIndex = m_cellBuckets.GetCellIndex(cell);
+
+			for (int bucketIndex = m_cellBuckets.GetCellStart(cellIndex); bucketIndex < m_cellBuckets.GetCellEnd(cellIndex); bucketIndex++)
+			{
+				int hullIndex = m_cellBuckets.GetEntry(bucketIndex);
+
+				//Hulls spanning several cells are only looked at from the first cell they share with the region
+				if (!m_cellBuckets.IsFirstCellInRange(hullIndex, cell, minCell))
+					continue;
+
+				if (!overlapTest(hullIndex))
+					continue;
+
+				if (numOverlapping < maxResults)
+				{
+					geometryIndicesOut[numOverlapping] = m_edges.m_geometryIndices[hullIndex];
+				}
+				numOverlapping++;
+			}
+		}
+	}
+
+	return numOverlapping;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int SceneQuery::GatherAABB(const AABB2& region, int* geometryIndicesOut, int maxResults) const
+{
+	const Vec2& regionMins = region.m_minBounds;
+	const Vec2& regionMaxs = region.m_maxBounds;
+
+	auto overlapTest = [this, &regionMins, &regionMaxs](int hullIndex)
+	{
+		const Vec2& hullMins = m_edges.m_hullMins[hullIndex];
+		const Vec2& hullMaxs = m_edges.m_hullMaxs[hullIndex];
+		if (hullMins.x > regionMaxs.x || hullMaxs.x < regionMins.x || hullMins.y > regionMaxs.y || hullMaxs.y < regionMins.y)
+			return false;
+
+		//Bounds inside the region means the hull is too, which is most hulls for large regions like the viewport
+		if (hullMins.x >= regionMins.x && hullMaxs.x <= regionMaxs.x && hullMins.y >= regionMins.y && hullMaxs.y <= regionMaxs.y)
+			return true;
+
+		return DoesAABBOverlapHull(regionMins, regionMaxs, hullIndex);
+	};
+
+	return GatherRegion(regionMins, regionMaxs, overlapTest, geometryIndicesOut, maxResults);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int SceneQuery::GatherDisc(const Vec2& center, float radius, int* geometryIndicesOut, int maxResults) const
+{
+	Vec2 regionMins = center - Vec2(radius, radius);
+	Vec2 regionMaxs = center + Vec2(radius, radius);
+	float radiusSquared = radius * radius;
+
+	auto overlapTest = [this, &center, &regionMins, &regionMaxs, radius, radiusSquared](int hullIndex)
+	{
+		const Vec2& hullMins = m_edges.m_hullMins[hullIndex];
+		const Vec2& hullMaxs = m_edges.m_hullMaxs[hullIndex];
+		if (hullMins.x > regionMaxs.x || hullMaxs.x < regionMins.x || hullMins.y > regionMaxs.y || hullMaxs.y < regionMins.y)
+			return false;
+
+		//Furthest corner of the bounds inside the disc means the whole hull is
+		float farX = GetHigherValue(center.x - hullMins.x, hullMaxs.x - center.x);
+		float farY = GetHigherValue(center.y - hullMins.y, hullMaxs.y - center.y);
+		if (farX * farX + farY * farY <= radiusSquared)
+			return true;
+
+		return DoesDiscOverlapHull(center, radius, hullIndex);
+	};
+
+	return GatherRegion(regionMins, regionMaxs, overlapTest, geometryIndicesOut, maxResults);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SceneQuery::DoesAABBOverlapHull(const Vec2& regionMins, const Vec2& regionMaxs, int hullIndex) const
+{
+	//Bounds already overlap, so the box axes are covered and only the hull edge normals are left to separate them
+	for (int edgeIndex = m_edges.m_vertexOffsets[hullIndex]; edgeIndex < m_edges.m_vertexOffsets[hullIndex + 1]; edgeIndex++)
+	{
+		float normalX = m_edges.m_normalX[edgeIndex];
+		float normalY = m_edges.m_normalY[edgeIndex];
+
+		//Corner of the box furthest behind the edge
+		float cornerX = (normalX > 0.f) ? regionMins.x : regionMaxs.x;
+		float cornerY = (normalY > 0.f) ? regionMins.y : regionMaxs.y;
+
+		if (normalX * cornerX + normalY * cornerY > m_edges.m_distance[edgeIndex])
+			return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SceneQuery::DoesDiscOverlapHull(const Vec2& center, float radius, int hullIndex) const
+{
+	int startIndex = m_edges.m_vertexOffsets[hullIndex];
+	int endIndex = m_edges.m_vertexOffsets[hullIndex + 1];
+
+	float maxSeparation = -FLT_MAX;
+	for (int edgeIndex = startIndex; edgeIndex < endIndex; edgeIndex++)
+	{
+		float separation = m_edges.m_normalX[edgeIndex] * center.x + m_edges.m_normalY[edgeIndex] * center.y - m_edges.m_distance[edgeIndex];
+		maxSeparation = GetHigherValue(maxSeparation, separation);
+	}
+
+	if (maxSeparation > radius)
+		return false;
+
+	if (maxSeparation <= 0.f)
+		return true;
+
+	//Center is outside but close to the planes, near a corner the plane distance underestimates so check the edges
+	float radiusSquared = radius * radius;
+	for (int edgeIndex = startIndex; edgeIndex < endIndex; edgeIndex++)
+	{
+		int nextIndex = (edgeIndex + 1 == endIndex) ? startIndex : edgeIndex + 1;
+		Vec2 closestPoint = GetClosestPointOnSegment(center, Vec2(m_edges.m_vertexX[edgeIndex], m_edges.m_vertexY[edgeIndex]), Vec2(m_edges.m_vertexX[nextIndex], m_edges.m_vertexY[nextIndex]));
+
+		Vec2 displacement = center - closestPoint;
+		if (displacement.x * displacement.x + displacement.y * displacement.y <= radiusSquared)
+			return true;
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SceneQuery::ClipRayToHull(const Ray2D& ray, int hullIndex, float& timeEnterOut, float& timeExitOut) const
+{
+	float timeEnter = 0.f;
+	float timeExit = FLT_MAX;
+
+	for (int edgeIndex = m_edges.m_vertexOffsets[hullIndex]; edgeIndex < m_edges.m_vertexOffsets[hullIndex + 1]; edgeIndex++)
+	{
+		float directionAlongNormal = m_edges.m_normalX[edgeIndex] * ray.m_direction.x + m_edges.m_normalY[edgeIndex] * ray.m_direction.y;
+		float distanceInside = m_edges.m_distance[edgeIndex] - (m_edges.m_normalX[edgeIndex] * ray.m_start.x + m_edges.m_normalY[edgeIndex] * ray.m_start.y);
+
+		if (directionAlongNormal == 0.f)
+		{
+			//Parallel to the edge, either always inside its plane or never
+			if (distanceInside < 0.f)
+				return false;
+
+			continue;
+		}
+
+		float planeTime = distanceInside / directionAlongNormal;
+		if (directionAlongNormal < 0.f)
+		{
+			timeEnter = GetHigherValue(timeEnter, planeTime);
+		}
+		else
+		{
+			timeExit = GetLowerValue(timeExit, planeTime);
+		}
+
+		if (timeEnter >= timeExit)
+			return false;
+	}
+
+	timeEnterOut = timeEnter;
+	timeExitOut = timeExit;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float SceneQuery::GetSignedDistanceToHull(const Vec2& point, int hullIndex, Vec2& closestPointOut) const
+{
+	int startIndex = m_edges.m_vertexOffsets[hullIndex];
+	int endIndex = m_edges.m_vertexOffsets[hullIndex + 1];
+
+	float maxSeparation = -FLT_MAX;
+	int maxSeparationIndex = startIndex;
+	for (int edgeIndex = startIndex; edgeIndex < endIndex; edgeIndex++)
+	{
+		float separation = m_edges.m_normalX[edgeIndex] * point.x + m_edges.m_normalY[edgeIndex] * point.y - m_edges.m_distance[edgeIndex];
+		if (separation > maxSeparation)
+		{
+			maxSeparation = separation;
+			maxSeparationIndex = edgeIndex;
+		}
+	}
+
+	//Inside a convex hull the nearest boundary point is on the nearest edge line
+	if (maxSeparation <= 0.f)
+	{
+		closestPointOut = point - maxSeparation * Vec2(m_edges.m_normalX[maxSeparationIndex], m_edges.m_normalY[maxSeparationIndex]);
+		return maxSeparation;
+	}
+
+	float minDistanceSquared = FLT_MAX;
+	for (int edgeIndex = startIndex; edgeIndex < endIndex; edgeIndex++)
+	{
+		int nextIndex = (edgeIndex + 1 == endIndex) ? startIndex : edgeIndex + 1;
+		Vec2 closestPoint = GetClosestPointOnSegment(point, Vec2(m_edges.m_vertexX[edgeIndex], m_edges.m_vertexY[edgeIndex]), Vec2(m_edges.m_vertexX[nextIndex], m_edges.m_vertexY[nextIndex]));
+
+		Vec2 displacement = point - closestPoint;
+		float distanceSquared = displacement.x * displacement.x + displacement.y * displacement.y;
+		if (distanceSquared < minDistanceSquared)
+		{
+			minDistanceSquared = distanceSquared;
+			closestPointOut = closestPoint;
+		}
+	}
+
+	return sqrtf(minDistanceSquared);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float SceneQuery::GetDistanceToCell(const Vec2& point, const IntVec2& cell) const
+{
+	Vec2 cellMins;
+	Vec2 cellMaxs;
+	m_broadPhase->GetCellBounds(cell, cellMins, cellMaxs);
+
+	//Geometry past the world edge is bucketed into the edge cells, so those are open on their outer side
+	int lastCell = m_cellBuckets.GetNumCellsPerAxis() - 1;
+	cellMins.x = (cell.x == 0) ? -FLT_MAX : cellMins.x;
+	cellMins.y = (cell.y == 0) ? -FLT_MAX : cellMins.y;
+	cellMaxs.x = (cell.x == lastCell) ? FLT_MAX : cellMaxs.x;
+	cellMaxs.y = (cell.y == lastCell) ? FLT_MAX : cellMaxs.y;
+
+	float outsideX = GetHigherValue(GetHigherValue(cellMins.x - point.x, point.x - cellMaxs.x), 0.f);
+	float outsideY = GetHigherValue(GetHigherValue(cellMins.y - point.y, point.y - cellMaxs.y), 0.f);
+	return sqrtf(outsideX * outsideX + outsideY * outsideY);
+}
@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/Ray2D.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include "Game/HullEdges.hpp"
+#include <cfloat>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct NearestGeometry2D
+{
+	float	m_signedDistance = 0.f;			//Negative when the point is inside the geometry
+	Vec2	m_closestPoint = Vec2::ZERO;	//Closest point on the geometry boundary
+	int		m_geometryIndex = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Working memory for FindNearestGeometry owned by the caller, so one per thread and nothing allocated once it has grown
+//A cell is queued when its stamp matches the query's, so the stamps never need clearing between queries
+struct NearestGeometryScratch
+{
+	std::vector<uint32_t>				m_cellStamps;
+	uint32_t							m_currentStamp = 0;
+	std::vector<std::pair<float, int>>	m_cellHeap;			//Min heap of (distance to cell, cell index)
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Stretch of a ray inside one hull, m_timeEnter is 0 when the ray starts inside it
+struct RayInterval2D
+{
+	int		m_geometryIndex = -1;
+	float	m_timeEnter = 0.f;
+	float	m_timeExit = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Region queries over the scene geometry backed by the broadphase cell buckets
+//Only hulls in the cells under the region are considered, each reported once and then confirmed with an exact test
+//------------------------------------------------------------------------------------------------------------------------------
+class SceneQuery
+{
+public:
+	SceneQuery();
+	~SceneQuery();
+
+	void					BuildFromGeometry(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase);
+	void					Clear();
+
+	//Follows geometry that was moved since the build with its bit fields already updated, without a rebuild
+	//Only hulls whose bit fields changed are moved between cells. Returns how many did
+	int						RefitMovedGeometry(const std::vector<Geometry>& geometry, const std::vector<int>& movedGeometryIndices);
+
+	//Write up to maxResults overlapping geometry indices (in no particular order) and return the total number overlapping
+	int						QueryAABB(const AABB2& region, int* geometryIndicesOut, int maxResults) const;
+	int						QueryDisc(const Vec2& center, float radius, int* geometryIndicesOut, int maxResults) const;
+
+	//Count only fast path, nothing is written
+	int						CountAABB(const AABB2& region) const;
+	int						CountDisc(const Vec2& center, float radius) const;
+
+	//Geometry with the smallest signed distance to the point, false when nothing is within maxDistance
+	//Cells are visited nearest first and the search stops once the next cell is further away than the best hull so far
+	bool					FindNearestGeometry(const Vec2& point, NearestGeometry2D& nearestOut, NearestGeometryScratch& scratch, float maxDistance = FLT_MAX) const;
+
+	//Every hull the ray passes through in order of entry time, up to maxIntervals of them. Returns the number written
+	//Cells are walked in the order the ray crosses them and each hull is reported from the cell its entry point is in,
+	//so only the few intervals starting in one cell ever need sorting and a full buffer ends the walk early
+	int						RaycastAll(const Ray2D& ray, RayInterval2D* intervalsOut, int maxIntervals, float maxTime = FLT_MAX) const;
+
+	int						GetNumHulls() const { return m_edges.GetNumHulls(); }
+
+	//Bounds of all the hulls, false when there are none
+	bool					GetSceneBounds(AABB2& boundsOut) const;
+
+private:
+	template <typename HULL_TEST>
+	int						GatherRegion(const Vec2& regionMins, const Vec2& regionMaxs, const HULL_TEST& overlapTest, int* geometryIndicesOut, int maxResults) const;
+
+	int						GatherAABB(const AABB2& region, int* geometryIndicesOut, int maxResults) const;
+	int						GatherDisc(const Vec2& center, float radius, int* geometryIndicesOut, int maxResults) const;
+
+	bool					DoesAABBOverlapHull(const Vec2& regionMins, const Vec2& regionMaxs, int hullIndex) const;
+	bool					DoesDiscOverlapHull(const Vec2& center, float radius, int hullIndex) const;
+
+	bool					ClipRayToHull(const Ray2D& ray, int hullIndex, float& timeEnterOut, float& timeExitOut) const;
+
+	float					GetSignedDistanceToHull(const Vec2& point, int hullIndex, Vec2& closestPointOut) const;
+	float					GetDistanceToCell(const Vec2& point, const IntVec2& cell) const;
+
+private:
+	const BitFieldBroadPhase*	m_broadPhase = nullptr;
+
+	HullEdgeArrays			m_edges;
+
+	BitFieldCellBuckets		m_cellBuckets;
+};
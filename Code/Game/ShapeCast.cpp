@@ -0,0 +1,407 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/ShapeCast.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/JobPool.hpp"
+#include <cfloat>
+#include <cmath>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static float GetDistanceSquared(const Vec2& pointA, const Vec2& pointB)
+{
+	Vec2 displacement = pointB - pointA;
+	return displacement.x * displacement.x + displacement.y * displacement.y;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC ShapeCast2D ShapeCast2D::MakeDiscCast(const Vec2& center, float radius, const Vec2& direction, float maxDistance)
+{
+	return MakeCapsuleCast(center, center, radius, direction, maxDistance);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC ShapeCast2D ShapeCast2D::MakeCapsuleCast(const Vec2& segmentStart, const Vec2& segmentEnd, float radius, const Vec2& direction, float maxDistance)
+{
+	ShapeCast2D cast;
+	cast.m_segmentStart = segmentStart;
+	cast.m_segmentEnd = segmentEnd;
+	cast.m_radius = radius;
+	cast.m_direction = direction;
+	cast.m_direction.Normalize();
+	cast.m_maxDistance = maxDistance;
+	return cast;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ShapeCast2D::GetSweptBounds(Vec2& minsOut, Vec2& maxsOut) const
+{
+	//Bounds of the shape at the start, inflated by the radius and stretched by the displacement of the sweep
+	minsOut.x = GetLowerValue(m_segmentStart.x, m_segmentEnd.x) - m_radius;
+	minsOut.y = GetLowerValue(m_segmentStart.y, m_segmentEnd.y) - m_radius;
+	maxsOut.x = GetHigherValue(m_segmentStart.x, m_segmentEnd.x) + m_radius;
+	maxsOut.y = GetHigherValue(m_segmentStart.y, m_segmentEnd.y) + m_radius;
+
+	Vec2 displacement = m_maxDistance * m_direction;
+	if (displacement.x < 0.f)
+	{
+		minsOut.x += displacement.x;
+	}
+	else
+	{
+		maxsOut.x += displacement.x;
+	}
+
+	if (displacement.y < 0.f)
+	{
+		minsOut.y += displacement.y;
+	}
+	else
+	{
+		maxsOut.y += displacement.y;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ShapeCaster::ShapeCaster()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ShapeCaster::~ShapeCaster()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ShapeCaster::BuildFromGeometry(const std::vector<Geometry>& geometry)
+{
+	m_edges.BuildFromGeometry(geometry);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ShapeCaster::RefitMovedGeometry(const std::vector<Geometry>& geometry, const std::vector<int>& movedGeometryIndices)
+{
+	for (int movedIndex = 0; movedIndex < (int)movedGeometryIndices.size(); movedIndex++)
+	{
+		int geometryIndex = movedGeometryIndices[movedIndex];
+		int hullIndex = m_edges.RefitMovedGeometry(geometry, geometryIndex);
+		if (hullIndex >= 0)
+		{
+			m_edges.m_bitFields[hullIndex] = geometry[geometryIndex].GetBitFields();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ShapeCaster::Clear()
+{
+	m_edges.Clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int ShapeCaster::CastShape(ShapeCastHit2D& hitOut, const ShapeCast2D& cast, bool useBroadPhase) const
+{
+	ShapeCastHit2D bestHit;
+	bestHit.m_timeAtHit = cast.m_maxDistance;
+
+	Vec2 sweptMins;
+	Vec2 sweptMaxs;
+	cast.GetSweptBounds(sweptMins, sweptMaxs);
+
+	for (int hullIndex = 0; hullIndex < GetNumHulls(); hullIndex++)
+	{
+		if (useBroadPhase)
+		{
+			bool xOverlapCondition = (cast.m_bitFieldsXY.x & m_edges.m_bitFields[hullIndex].x) != 0;
+			bool yOverlapCondition = (cast.m_bitFieldsXY.y & m_edges.m_bitFields[hullIndex].y) != 0;
+
+			if (!xOverlapCondition || !yOverlapCondition)
+				continue;
+		}
+
+		//The bit fields are coarse, the swept bounds throw out most of what is left before the exact test
+		const Vec2& hullMins = m_edges.m_hullMins[hullIndex];
+		const Vec2& hullMaxs = m_edges.m_hullMaxs[hullIndex];
+		if (hullMins.x > sweptMaxs.x || hullMaxs.x < sweptMins.x || hullMins.y > sweptMaxs.y || hullMaxs.y < sweptMins.y)
+			continue;
+
+		CastShapeVsHull(bestHit, cast, hullIndex);
+	}
+
+	if (bestHit.m_geometryIndex < 0)
+		return -1;
+
+	hitOut = bestHit;
+	return bestHit.m_geometryIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ShapeCaster::CastShapes(const std::vector<ShapeCast2D>& casts, std::vector<ShapeCastHit2D>& hitsOut, bool useBroadPhase, JobPool* jobPool) const
+{
+	int numCasts = (int)casts.size();
+	hitsOut.resize(numCasts);
+
+	auto castRange = [this, &casts, &hitsOut, useBroadPhase](int startIndex, int endIndex)
+	{
+		for (int castIndex = startIndex; castIndex < endIndex; castIndex++)
+		{
+			ShapeCastHit2D hit;
+			CastShape(hit, casts[castIndex], useBroadPhase);
+			hitsOut[castIndex] = hit;
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(numCasts, RAYCAST_BATCH_GRAIN_SIZE, castRange);
+	}
+	else
+	{
+		castRange(0, numCasts);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ShapeCaster::CastShapeVsHull(ShapeCastHit2D& bestHit, const ShapeCast2D& cast, int hullIndex) const
+{
+	//Overlapping at the start is reported at time 0, everything below can then assume the shape starts outside
+	Vec2 closestPoint;
+	float distanceSquared = GetDistanceSquaredToHull(cast.m_segmentStart, hullIndex, closestPoint);
+
+	if (!cast.IsDisc())
+	{
+		if (DoesSegmentIntersectHull(cast.m_segmentStart, cast.m_segmentEnd, hullIndex))
+		{
+			distanceSquared = 0.f;
+			closestPoint = cast.m_segmentStart;
+		}
+		else
+		{
+			Vec2 endClosestPoint;
+			float endDistanceSquared = GetDistanceSquaredToHull(cast.m_segmentEnd, hullIndex, endClosestPoint);
+			if (endDistanceSquared < distanceSquared)
+			{
+				distanceSquared = endDistanceSquared;
+				closestPoint = endClosestPoint;
+			}
+
+			for (int vertexIndex = m_edges.m_vertexOffsets[hullIndex]; vertexIndex < m_edges.m_vertexOffsets[hullIndex + 1]; vertexIndex++)
+			{
+				Vec2 vertex = Vec2(m_edges.m_vertexX[vertexIndex], m_edges.m_vertexY[vertexIndex]);
+				float vertexDistanceSquared = GetDistanceSquared(vertex, GetClosestPointOnSegment(vertex, cast.m_segmentStart, cast.m_segmentEnd));
+				if (vertexDistanceSquared < distanceSquared)
+				{
+					distanceSquared = vertexDistanceSquared;
+					closestPoint = vertex;
+				}
+			}
+		}
+	}
+
+	if (distanceSquared < cast.m_radius * cast.m_radius)
+	{
+		bestHit.m_timeAtHit = 0.f;
+		bestHit.m_contactPoint = closestPoint;
+		bestHit.m_impactNormal = -cast.m_direction;
+		bestHit.m_geometryIndex = m_edges.m_geometryIndices[hullIndex];
+		return;
+	}
+
+	//A capsule first touches the hull either with one of its end discs or with its side against a hull vertex
+	CastDiscVsHull(bestHit, cast.m_segmentStart, cast.m_radius, cast.m_direction, hullIndex);
+	if (!cast.IsDisc())
+	{
+		CastDiscVsHull(bestHit, cast.m_segmentEnd, cast.m_radius, cast.m_direction, hullIndex);
+		CastHullVerticesVsCapsule(bestHit, cast, hullIndex);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float ShapeCaster::GetDistanceSquaredToHull(const Vec2& point, int hullIndex, Vec2& closestPointOut) const
+{
+	int startIndex = m_edges.m_vertexOffsets[hullIndex];
+	int endIndex = m_edges.m_vertexOffsets[hullIndex + 1];
+
+	bool isInside = true;
+	for (int edgeIndex = startIndex; edgeIndex < endIndex; edgeIndex++)
+	{
+		if (m_edges.m_normalX[edgeIndex] * point.x + m_edges.m_normalY[edgeIndex] * point.y > m_edges.m_distance[edgeIndex])
+		{
+			isInside = false;
+			break;
+		}
+	}
+
+	if (isInside)
+	{
+		closestPointOut = point;
+		return 0.f;
+	}
+
+	float bestDistanceSquared = FLT_MAX;
+	for (int edgeIndex = startIndex; edgeIndex < endIndex; edgeIndex++)
+	{
+		int nextIndex = (edgeIndex + 1 == endIndex) ? startIndex : edgeIndex + 1;
+		Vec2 edgeStart = Vec2(m_edges.m_vertexX[edgeIndex], m_edges.m_vertexY[edgeIndex]);
+		Vec2 edgeEnd = Vec2(m_edges.m_vertexX[nextIndex], m_edges.m_vertexY[nextIndex]);
+
+		Vec2 closestPoint = GetClosestPointOnSegment(point, edgeStart, edgeEnd);
+		float distanceSquared = GetDistanceSquared(point, closestPoint);
+		if (distanceSquared < bestDistanceSquared)
+		{
+			bestDistanceSquared = distanceSquared;
+			closestPointOut = closestPoint;
+		}
+	}
+
+	return bestDistanceSquared;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool ShapeCaster::DoesSegmentIntersectHull(const Vec2& segmentStart, const Vec2& segmentEnd, int hullIndex) const
+{
+	//Clip the segment against every plane, whatever survives is inside the hull
+	Vec2 segment = segmentEnd - segmentStart;
+	float tEnter = 0.f;
+	float tExit = 1.f;
+
+	for (int edgeIndex = m_edges.m_vertexOffsets[hullIndex]; edgeIndex < m_edges.m_vertexOffsets[hullIndex + 1]; edgeIndex++)
+	{
+		float denominator = m_edges.m_normalX[edgeIndex] * segment.x + m_edges.m_normalY[edgeIndex] * segment.y;
+		float startDistance = m_edges.m_distance[edgeIndex] - (m_edges.m_normalX[edgeIndex] * segmentStart.x + m_edges.m_normalY[edgeIndex] * segmentStart.y);
+
+		if (denominator == 0.f)
+		{
+			if (startDistance < 0.f)
+				return false;
+
+			continue;
+		}
+
+		float time = startDistance / denominator;
+		if (denominator < 0.f)
+		{
+			tEnter = GetHigherValue(tEnter, time);
+		}
+		else
+		{
+			tExit = GetLowerValue(tExit, time);
+		}
+
+		if (tEnter > tExit)
+			return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ShapeCaster::CastDiscVsHull(ShapeCastHit2D& bestHit, const Vec2& center, float radius, const Vec2& direction, int hullIndex) const
+{
+	int startIndex = m_edges.m_vertexOffsets[hullIndex];
+	int endIndex = m_edges.m_vertexOffsets[hullIndex + 1];
+
+	//Edges pushed out by the radius, only counts if the contact lands inside the span of the edge
+	for (int edgeIndex = startIndex; edgeIndex < endIndex; edgeIndex++)
+	{
+		float normalX = m_edges.m_normalX[edgeIndex];
+		float normalY = m_edges.m_normalY[edgeIndex];
+
+		float denominator = normalX * direction.x + normalY * direction.y;
+		if (denominator >= 0.f)
+			continue;
+
+		float time = (m_edges.m_distance[edgeIndex] + radius - (normalX * center.x + normalY * center.y)) / denominator;
+		if (time < 0.f || time >= bestHit.m_timeAtHit)
+			continue;
+
+		int nextIndex = (edgeIndex + 1 == endIndex) ? startIndex : edgeIndex + 1;
+		Vec2 edgeStart = Vec2(m_edges.m_vertexX[edgeIndex], m_edges.m_vertexY[edgeIndex]);
+		Vec2 edge = Vec2(m_edges.m_vertexX[nextIndex], m_edges.m_vertexY[nextIndex]) - edgeStart;
+
+		Vec2 contactPoint = center + time * direction - radius * Vec2(normalX, normalY);
+		Vec2 alongEdge = contactPoint - edgeStart;
+		float projection = alongEdge.x * edge.x + alongEdge.y * edge.y;
+		if (projection < 0.f || projection > edge.x * edge.x + edge.y * edge.y)
+			continue;
+
+		bestHit.m_timeAtHit = time;
+		bestHit.m_contactPoint = contactPoint;
+		bestHit.m_impactNormal = Vec2(normalX, normalY);
+		bestHit.m_geometryIndex = m_edges.m_geometryIndices[hullIndex];
+	}
+
+	//Rounded corners, a ray from the center against a disc of the same radius around each vertex
+	if (radius <= 0.f)
+		return;
+
+	float radiusSquared = radius * radius;
+	for (int vertexIndex = startIndex; vertexIndex < endIndex; vertexIndex++)
+	{
+		Vec2 vertex = Vec2(m_edges.m_vertexX[vertexIndex], m_edges.m_vertexY[vertexIndex]);
+		Vec2 fromVertex = center - vertex;
+
+		float halfB = fromVertex.x * direction.x + fromVertex.y * direction.y;
+		if (halfB >= 0.f)
+			continue;
+
+		float c = fromVertex.x * fromVertex.x + fromVertex.y * fromVertex.y - radiusSquared;
+		float discriminant = halfB * halfB - c;
+		if (discriminant < 0.f)
+			continue;
+
+		float time = -halfB - sqrtf(discriminant);
+		if (time < 0.f || time >= bestHit.m_timeAtHit)
+			continue;
+
+		bestHit.m_timeAtHit = time;
+		bestHit.m_contactPoint = vertex;
+		bestHit.m_impactNormal = (center + time * direction - vertex) / radius;
+		bestHit.m_geometryIndex = m_edges.m_geometryIndices[hullIndex];
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ShapeCaster::CastHullVerticesVsCapsule(ShapeCastHit2D& bestHit, const ShapeCast2D& cast, int hullIndex) const
+{
+	//Seen from the capsule each hull vertex moves along -direction, so cast those vertices against the two flat sides
+	//The round ends are already handled by the disc casts from the segment end points
+	Vec2 segment = cast.m_segmentEnd - cast.m_segmentStart;
+	float segmentLength = segment.GetLength();
+	Vec2 axis = segment / segmentLength;
+	Vec2 sideNormal = Vec2(-axis.y, axis.x);
+
+	float sideNormalAlongDirection = sideNormal.x * cast.m_direction.x + sideNormal.y * cast.m_direction.y;
+	if (sideNormalAlongDirection == 0.f)
+		return;
+
+	for (int vertexIndex = m_edges.m_vertexOffsets[hullIndex]; vertexIndex < m_edges.m_vertexOffsets[hullIndex + 1]; vertexIndex++)
+	{
+		Vec2 vertex = Vec2(m_edges.m_vertexX[vertexIndex], m_edges.m_vertexY[vertexIndex]);
+		Vec2 fromStart = vertex - cast.m_segmentStart;
+		float sideOffset = fromStart.x * sideNormal.x + fromStart.y * sideNormal.y;
+
+		//Vertex already between the two sides can only be reached by the round ends
+		if (sideOffset <= cast.m_radius && sideOffset >= -cast.m_radius)
+			continue;
+
+		float sideSign = (sideOffset > 0.f) ? 1.f : -1.f;
+		if (sideSign * sideNormalAlongDirection <= 0.f)
+			continue;
+
+		float time = (sideOffset - sideSign * cast.m_radius) / sideNormalAlongDirection;
+		if (time < 0.f || time >= bestHit.m_timeAtHit)
+			continue;
+
+		Vec2 relativeVertex = fromStart - time * cast.m_direction;
+		float projection = relativeVertex.x * axis.x + relativeVertex.y * axis.y;
+		if (projection < 0.f || projection > segmentLength)
+			continue;
+
+		bestHit.m_timeAtHit = time;
+		bestHit.m_contactPoint = vertex;
+		bestHit.m_impactNormal = -sideSign * sideNormal;
+		bestHit.m_geometryIndex = m_edges.m_geometryIndices[hullIndex];
+	}
+}
@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/HullEdges.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+class JobPool;
+
+//------------------------------------------------------------------------------------------------------------------------------
+//A capsule (segment + radius) swept along a unit direction for up to m_maxDistance
+//A disc cast is a capsule whose segment start and end are the same point
+//------------------------------------------------------------------------------------------------------------------------------
+struct ShapeCast2D
+{
+	Vec2		m_segmentStart;
+	Vec2		m_segmentEnd;
+	float		m_radius = 0.f;
+
+	Vec2		m_direction = Vec2::RIGHT;
+	float		m_maxDistance = 0.f;
+
+	//Bit fields for the bounds of the whole sweep, see BitFieldBroadPhase::GetRegionForSweptCapsule
+	IntVec2		m_bitFieldsXY;
+
+	static ShapeCast2D	MakeDiscCast(const Vec2& center, float radius, const Vec2& direction, float maxDistance);
+	static ShapeCast2D	MakeCapsuleCast(const Vec2& segmentStart, const Vec2& segmentEnd, float radius, const Vec2& direction, float maxDistance);
+
+	bool		IsDisc() const { return m_segmentStart == m_segmentEnd; }
+	void		GetSweptBounds(Vec2& minsOut, Vec2& maxsOut) const;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct ShapeCastHit2D
+{
+	float		m_timeAtHit = MAX_RAYCAST_TIME;		//Distance travelled along the direction before contact
+	Vec2		m_contactPoint;						//Point on the hull that is touched
+	Vec2		m_impactNormal;						//Hull surface normal at the contact, points back at the cast shape
+	int			m_geometryIndex = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Narrowphase for shape casts. Keeps the hull vertices, edge normals and bounds in SoA so a cast only touches
+//the hulls that pass the bit field broadphase and the swept bounds check
+//Casts that start overlapping a hull report it at time 0 with the normal pointing against the direction
+//------------------------------------------------------------------------------------------------------------------------------
+class ShapeCaster
+{
+public:
+	ShapeCaster();
+	~ShapeCaster();
+
+	void					BuildFromGeometry(const std::vector<Geometry>& geometry);
+	void					Clear();
+
+	//Follows geometry moved since the build, with its bit fields already updated
+	void					RefitMovedGeometry(const std::vector<Geometry>& geometry, const std::vector<int>& movedGeometryIndices);
+
+	//Returns the index of the first geometry touched within the max distance or -1 on a miss
+	int						CastShape(ShapeCastHit2D& hitOut, const ShapeCast2D& cast, bool useBroadPhase) const;
+
+	//Batched form, hitsOut is resized to match casts. Runs across the job pool when one is passed in
+	void					CastShapes(const std::vector<ShapeCast2D>& casts, std::vector<ShapeCastHit2D>& hitsOut, bool useBroadPhase, JobPool* jobPool = nullptr) const;
+
+	int						GetNumHulls() const { return m_edges.GetNumHulls(); }
+
+private:
+	void					CastShapeVsHull(ShapeCastHit2D& bestHit, const ShapeCast2D& cast, int hullIndex) const;
+
+	float					GetDistanceSquaredToHull(const Vec2& point, int hullIndex, Vec2& closestPointOut) const;
+	bool					DoesSegmentIntersectHull(const Vec2& segmentStart, const Vec2& segmentEnd, int hullIndex) const;
+
+	void					CastDiscVsHull(ShapeCastHit2D& bestHit, const Vec2& center, float radius, const Vec2& direction, int hullIndex) const;
+	void					CastHullVerticesVsCapsule(ShapeCastHit2D& bestHit, const ShapeCast2D& cast, int hullIndex) const;
+
+private:
+	HullEdgeArrays			m_edges;
+};
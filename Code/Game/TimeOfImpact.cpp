@@ -0,0 +1,364 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/TimeOfImpact.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/ConvexDistance.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/JobPool.hpp"
+#include <algorithm>
+#include <cfloat>
+
+//------------------------------------------------------------------------------------------------------------------------------
+TimeOfImpactSolver::TimeOfImpactSolver()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TimeOfImpactSolver::~TimeOfImpactSolver()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void TimeOfImpactSolver::ComputeTimeOfImpact(const std::vector<Vec2>& pointsA, const Vec2& velocityA, const std::vector<Vec2>& pointsB, const Vec2& velocityB, float maxTime, TimeOfImpact2D& resultOut)
+{
+	std::vector<Vec2> scratchPoints;
+	ComputeTimeOfImpact(pointsA, velocityA, pointsB, velocityB, maxTime, resultOut, scratchPoints);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void TimeOfImpactSolver::ComputeTimeOfImpact(const std::vector<Vec2>& pointsA, const Vec2& velocityA, const std::vector<Vec2>& pointsB, const Vec2& velocityB, float maxTime, TimeOfImpact2D& resultOut, std::vector<Vec2>& scratchPoints)
+{
+	resultOut = TimeOfImpact2D();
+	resultOut.m_time = maxTime;
+	if (pointsA.empty() || pointsB.empty())
+		return;
+
+	//Only the relative motion matters, so A stays put and B moves with the difference
+	Vec2 relativeVelocity = velocityB - velocityA;
+	scratchPoints.resize(pointsB.size());
+
+	//The simplex each step ends on is close to the one the next step needs
+	GjkCache2D cache;
+	ConvexDistance2D distance;
+
+	float time = 0.f;
+	while (resultOut.m_numIterations < TOI_MAX_ITERATIONS)
+	{
+		Vec2 displacement = relativeVelocity * time;
+		for (int pointIndex = 0; pointIndex < (int)pointsB.size(); pointIndex++)
+		{
+			scratchPoints[pointIndex] = pointsB[pointIndex] + displacement;
+		}
+
+		ConvexDistanceSolver::ComputeDistance(pointsA, scratchPoints, distance, &cache);
+		resultOut.m_numIterations++;
+
+		if (distance.m_isOverlapping || distance.m_signedDistance <= 0.f)
+		{
+			//Steps stop short of the target gap so only a start inside the other polygon can land here
+			if (time == 0.f)
+			{
+				resultOut.m_state = TOI_OVERLAPPING_AT_START;
+				resultOut.m_time = 0.f;
+				return;
+			}
+			break;
+		}
+
+		//The gap along the normal only shrinks at this speed, when it does not shrink the polygons never meet
+		float closingSpeed = -(relativeVelocity.x * distance.m_normal.x + relativeVelocity.y * distance.m_normal.y);
+		if (closingSpeed <= FLT_EPSILON)
+			return;
+
+		if (distance.m_signedDistance <= TOI_TARGET_SEPARATION + TOI_TOLERANCE)
+			break;
+
+		time += (distance.m_signedDistance - TOI_TARGET_SEPARATION) / closingSpeed;
+		if (time > maxTime)
+			return;
+	}
+
+	//Running out of iterations still leaves a time before the contact, stopping there is safe
+	resultOut.m_state = TOI_HIT;
+	resultOut.m_time = time;
+	resultOut.m_normal = distance.m_normal;
+
+	Vec2 closestPointA = distance.m_closestPointA + velocityA * time;
+	Vec2 closestPointB = distance.m_closestPointB + velocityA * time;
+	resultOut.m_contactPoint = (closestPointA + closestPointB) * 0.5f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TimeOfImpactSolver::FindSweptPairs(const std::vector<Geometry>& geometry, const std::vector<Vec2>& velocities, float deltaSeconds, const BitFieldBroadPhase& broadPhase, std::vector<OverlapPair>& pairsOut, JobPool* jobPool)
+{
+	int numGeometry = (int)geometry.size();
+	m_sweptMins.resize(numGeometry);
+	m_sweptMaxs.resize(numGeometry);
+	m_isStatic.assign(numGeometry, true);
+
+	std::vector<IntVec2> bitFields(numGeometry, IntVec2::ZERO);
+	for (int geometryIndex = 0; geometryIndex < numGeometry; geometryIndex++)
+	{
+		const std::vector<Vec2>& points = geometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+		if (points.empty())
+			continue;
+
+		Vec2 mins = points[0];
+		Vec2 maxs = points[0];
+		for (int pointIndex = 1; pointIndex < (int)points.size(); pointIndex++)
+		{
+			mins.x = GetLowerValue(mins.x, points[pointIndex].x);
+			mins.y = GetLowerValue(mins.y, points[pointIndex].y);
+			maxs.x = GetHigherValue(maxs.x, points[pointIndex].x);
+			maxs.y = GetHigherValue(maxs.y, points[pointIndex].y);
+		}
+
+		//Geometry past the end of the velocities does not move
+		Vec2 displacement = (geometryIndex < (int)velocities.size()) ? velocities[geometryIndex] * deltaSeconds : Vec2::ZERO;
+		m_isStatic[geometryIndex] = (displacement == Vec2::ZERO);
+
+		m_sweptMins[geometryIndex] = Vec2(GetLowerValue(mins.x, mins.x + displacement.x), GetLowerValue(mins.y, mins.y + displacement.y));
+		m_sweptMaxs[geometryIndex] = Vec2(GetHigherValue(maxs.x, maxs.x + displacement.x), GetHigherValue(maxs.y, maxs.y + displacement.y));
+		bitFields[geometryIndex] = broadPhase.GetRegionIDForMinMaxs(m_sweptMins[geometryIndex], m_sweptMaxs[geometryIndex]);
+	}
+
+	m_cellBuckets.Build(bitFields, broadPhase.GetNumBitFields());
+
+	int numCells = m_cellBuckets.GetNumCellsPerAxis() * m_cellBuckets.GetNumCellsPerAxis();
+	std::vector<std::vector<OverlapPair>> cellPairs(numCells);
+
+	auto findRange = [this, &cellPairs](int startCell, int endCell)
+	{
+		std::vector<OverlapCellEntry> scratchEntries;
+		for (int cellIndex = startCell; cellIndex < endCell; cellIndex++)
+		{
+			FindPairsInCell(cellIndex, scratchEntries, cellPairs[cellIndex]);
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor(numCells, 1, findRange);
+	}
+	else
+	{
+		findRange(0, numCells);
+	}
+
+	pairsOut.clear();
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		pairsOut.insert(pairsOut.end(), cellPairs[cellIndex].begin(), cellPairs[cellIndex].end());
+	}
+
+	std::sort(pairsOut.begin(), pairsOut.end(), [](const OverlapPair& lhs, const OverlapPair& rhs)
+	{
+		if (lhs.m_geometryIndexA != rhs.m_geometryIndexA)
+			return lhs.m_geometryIndexA < rhs.m_geometryIndexA;
+
+		return lhs.m_geometryIndexB < rhs.m_geometryIndexB;
+	});
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TimeOfImpactSolver::FindPairsInCell(int cellIndex, std::vector<OverlapCellEntry>& scratchEntries, std::vector<OverlapPair>& pairsOut) const
+{
+	int numCellsPerAxis = m_cellBuckets.GetNumCellsPerAxis();
+	IntVec2 cell = IntVec2(cellIndex % numCellsPerAxis, cellIndex / numCellsPerAxis);
+
+	scratchEntries.clear();
+	for (int bucketIndex = m_cellBuckets.GetCellStart(cellIndex); bucketIndex < m_cellBuckets.GetCellEnd(cellIndex); bucketIndex++)
+	{
+		OverlapCellEntry entry;
+		entry.m_hullIndex = m_cellBuckets.GetEntry(bucketIndex);
+		entry.m_mins = m_sweptMins[entry.m_hullIndex];
+		entry.m_maxs = m_sweptMaxs[entry.m_hullIndex];
+		entry.m_firstCell = m_cellBuckets.GetFirstCell(entry.m_hullIndex);
+		scratchEntries.push_back(entry);
+	}
+
+	std::sort(scratchEntries.begin(), scratchEntries.end(), [](const OverlapCellEntry& lhs, const OverlapCellEntry& rhs)
+	{
+		return lhs.m_mins.x < rhs.m_mins.x;
+	});
+
+	int numEntries = (int)scratchEntries.size();
+	for (int entryIndexA = 0; entryIndexA < numEntries; entryIndexA++)
+	{
+		const OverlapCellEntry& entryA = scratchEntries[entryIndexA];
+		for (int entryIndexB = entryIndexA + 1; entryIndexB < numEntries && scratchEntries[entryIndexB].m_mins.x <= entryA.m_maxs.x; entryIndexB++)
+		{
+			const OverlapCellEntry& entryB = scratchEntries[entryIndexB];
+			if (entryA.m_mins.y > entryB.m_maxs.y || entryB.m_mins.y > entryA.m_maxs.y)
+				continue;
+
+			//Nothing moves between two static hulls
+			if (m_isStatic[entryA.m_hullIndex] && m_isStatic[entryB.m_hullIndex])
+				continue;
+
+			//Same rule as the overlap pairs, only the first cell both swept bounds cover reports the pair
+			int sharedFirstX = (entryA.m_firstCell.x > entryB.m_firstCell.x) ? entryA.m_firstCell.x : entryB.m_firstCell.x;
+			int sharedFirstY = (entryA.m_firstCell.y > entryB.m_firstCell.y) ? entryA.m_firstCell.y : entryB.m_firstCell.y;
+			if (cell.x != sharedFirstX || cell.y != sharedFirstY)
+				continue;
+
+			OverlapPair pair;
+			bool isAFirst = entryA.m_hullIndex < entryB.m_hullIndex;
+			pair.m_geometryIndexA = isAFirst ? entryA.m_hullIndex : entryB.m_hullIndex;
+			pair.m_geometryIndexB = isAFirst ? entryB.m_hullIndex : entryA.m_hullIndex;
+			pairsOut.push_back(pair);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TimeOfImpactSolver::ComputeTimesOfImpact(const std::vector<Geometry>& geometry, const std::vector<Vec2>& velocities, float deltaSeconds, const std::vector<OverlapPair>& pairs, std::vector<TimeOfImpact2D>& resultsOut, JobPool* jobPool)
+{
+	std::vector<float> moveTimes(geometry.size(), deltaSeconds);
+	std::vector<int> pairIndices(pairs.size());
+	for (int pairIndex = 0; pairIndex < (int)pairs.size(); pairIndex++)
+	{
+		pairIndices[pairIndex] = pairIndex;
+	}
+
+	resultsOut.resize(pairs.size());
+	SolvePairs(geometry, velocities, moveTimes, pairs, pairIndices, resultsOut, jobPool);
+	CountHits(resultsOut);
+	m_numResolvePasses = 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TimeOfImpactSolver::ComputeMoveTimes(const std::vector<Geometry>& geometry, const std::vector<Vec2>& velocities, float deltaSeconds, const std::vector<OverlapPair>& pairs, std::vector<TimeOfImpact2D>& resultsOut, std::vector<float>& moveTimesOut, JobPool* jobPool)
+{
+	int numPairs = (int)pairs.size();
+	resultsOut.resize(numPairs);
+	moveTimesOut.assign(geometry.size(), deltaSeconds);
+
+	//Move times each pair was last solved with, a pair only needs solving again once one of them changes
+	std::vector<float> solvedTimesA(numPairs, -1.f);
+	std::vector<float> solvedTimesB(numPairs, -1.f);
+
+	std::vector<int> pairIndices;
+	pairIndices.reserve(numPairs);
+
+	m_numResolvePasses = 0;
+	while (m_numResolvePasses < TOI_MAX_RESOLVE_PASSES)
+	{
+		pairIndices.clear();
+		for (int pairIndex = 0; pairIndex < numPairs; pairIndex++)
+		{
+			if (solvedTimesA[pairIndex] != moveTimesOut[pairs[pairIndex].m_geometryIndexA] || solvedTimesB[pairIndex] != moveTimesOut[pairs[pairIndex].m_geometryIndexB])
+			{
+				pairIndices.push_back(pairIndex);
+			}
+		}
+
+		if (pairIndices.empty())
+			break;
+
+		SolvePairs(geometry, velocities, moveTimesOut, pairs, pairIndices, resultsOut, jobPool);
+		m_numResolvePasses++;
+
+		//Each pair is marked solved for the times it was solved with, cut short by its own impact
+		//A pair also stopped by another pair this pass no longer matches them and gets solved again
+		for (int listIndex = 0; listIndex < (int)pairIndices.size(); listIndex++)
+		{
+			int pairIndex = pairIndices[listIndex];
+			solvedTimesA[pairIndex] = moveTimesOut[pairs[pairIndex].m_geometryIndexA];
+			solvedTimesB[pairIndex] = moveTimesOut[pairs[pairIndex].m_geometryIndexB];
+			if (resultsOut[pairIndex].m_state == TOI_HIT)
+			{
+				solvedTimesA[pairIndex] = GetLowerValue(solvedTimesA[pairIndex], resultsOut[pairIndex].m_time);
+				solvedTimesB[pairIndex] = GetLowerValue(solvedTimesB[pairIndex], resultsOut[pairIndex].m_time);
+			}
+		}
+
+		//Stopping both at the impact only ever shortens move times, so the passes settle
+		for (int listIndex = 0; listIndex < (int)pairIndices.size(); listIndex++)
+		{
+			int pairIndex = pairIndices[listIndex];
+			int geometryIndexA = pairs[pairIndex].m_geometryIndexA;
+			int geometryIndexB = pairs[pairIndex].m_geometryIndexB;
+			moveTimesOut[geometryIndexA] = GetLowerValue(moveTimesOut[geometryIndexA], solvedTimesA[pairIndex]);
+			moveTimesOut[geometryIndexB] = GetLowerValue(moveTimesOut[geometryIndexB], solvedTimesB[pairIndex]);
+		}
+	}
+
+	CountHits(resultsOut);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TimeOfImpactSolver::SolvePairs(const std::vector<Geometry>& geometry, const std::vector<Vec2>& velocities, const std::vector<float>& moveTimes, const std::vector<OverlapPair>& pairs, const std::vector<int>& pairIndices, std::vector<TimeOfImpact2D>& resultsOut, JobPool* jobPool) const
+{
+	auto solveRange = [&geometry, &velocities, &moveTimes, &pairs, &pairIndices, &resultsOut](int startIndex, int endIndex)
+	{
+		std::vector<Vec2> scratchPoints;
+		for (int listIndex = startIndex; listIndex < endIndex; listIndex++)
+		{
+			int pairIndex = pairIndices[listIndex];
+			int geometryIndexA = pairs[pairIndex].m_geometryIndexA;
+			int geometryIndexB = pairs[pairIndex].m_geometryIndexB;
+			Vec2 velocityA = (geometryIndexA < (int)velocities.size()) ? velocities[geometryIndexA] : Vec2::ZERO;
+			Vec2 velocityB = (geometryIndexB < (int)velocities.size()) ? velocities[geometryIndexB] : Vec2::ZERO;
+
+			const std::vector<Vec2>& pointsA = geometry[geometryIndexA].GetConvexPoly2D().GetConvexPoly2DPoints();
+			const std::vector<Vec2>& pointsB = geometry[geometryIndexB].GetConvexPoly2D().GetConvexPoly2DPoints();
+			ComputeTimeOfImpactUntilStopped(pointsA, velocityA, moveTimes[geometryIndexA], pointsB, velocityB, moveTimes[geometryIndexB], resultsOut[pairIndex], scratchPoints);
+		}
+	};
+
+	if (jobPool != nullptr)
+	{
+		jobPool->ParallelFor((int)pairIndices.size(), PAIR_QUERY_GRAIN_SIZE, solveRange);
+	}
+	else
+	{
+		solveRange(0, (int)pairIndices.size());
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void TimeOfImpactSolver::ComputeTimeOfImpactUntilStopped(const std::vector<Vec2>& pointsA, const Vec2& velocityA, float moveTimeA, const std::vector<Vec2>& pointsB, const Vec2& velocityB, float moveTimeB, TimeOfImpact2D& resultOut, std::vector<Vec2>& scratchPoints)
+{
+	//Both move up to the earlier stop
+	float firstStopTime = GetLowerValue(moveTimeA, moveTimeB);
+	float lastStopTime = GetHigherValue(moveTimeA, moveTimeB);
+	ComputeTimeOfImpact(pointsA, velocityA, pointsB, velocityB, firstStopTime, resultOut, scratchPoints);
+	if (resultOut.m_state != TOI_SEPARATED || lastStopTime <= firstStopTime)
+		return;
+
+	//Then the one still moving goes on towards the stopped one
+	std::vector<Vec2> stoppedPointsA(pointsA.size());
+	for (int pointIndex = 0; pointIndex < (int)pointsA.size(); pointIndex++)
+	{
+		stoppedPointsA[pointIndex] = pointsA[pointIndex] + velocityA * firstStopTime;
+	}
+
+	std::vector<Vec2> stoppedPointsB(pointsB.size());
+	for (int pointIndex = 0; pointIndex < (int)pointsB.size(); pointIndex++)
+	{
+		stoppedPointsB[pointIndex] = pointsB[pointIndex] + velocityB * firstStopTime;
+	}
+
+	bool isAStillMoving = moveTimeA > moveTimeB;
+	int numIterations = resultOut.m_numIterations;
+	ComputeTimeOfImpact(stoppedPointsA, isAStillMoving ? velocityA : Vec2::ZERO, stoppedPointsB, isAStillMoving ? Vec2::ZERO : velocityB, lastStopTime - firstStopTime, resultOut, scratchPoints);
+
+	resultOut.m_time += firstStopTime;
+	resultOut.m_numIterations += numIterations;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TimeOfImpactSolver::CountHits(const std::vector<TimeOfImpact2D>& results)
+{
+	m_numHits = 0;
+	for (int pairIndex = 0; pairIndex < (int)results.size(); pairIndex++)
+	{
+		if (results[pairIndex].m_state == TOI_HIT)
+		{
+			m_numHits++;
+		}
+	}
+}
@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include "Game/OverlapPairs.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Geometry;
+class JobPool;
+
+constexpr int TOI_MAX_ITERATIONS = 32;
+constexpr float TOI_TARGET_SEPARATION = 0.01f;		//Gap left between the polygons at the time of impact so they never end up touching
+constexpr float TOI_TOLERANCE = 0.0025f;			//How close to the target gap counts as arrived
+constexpr int TOI_MAX_RESOLVE_PASSES = 8;			//Passes over the pairs whose polygons were stopped early by another pair
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eTimeOfImpactState
+{
+	TOI_SEPARATED = 0,		//No impact before the max time
+	TOI_HIT,
+	TOI_OVERLAPPING_AT_START
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct TimeOfImpact2D
+{
+	eTimeOfImpactState	m_state = TOI_SEPARATED;
+	float				m_time = 0.f;				//Max time when separated
+	Vec2				m_normal = Vec2::ZERO;		//Points from A to B at the time of impact
+	Vec2				m_contactPoint = Vec2::ZERO;	//Halfway across the gap at the time of impact
+	int					m_numIterations = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Time of impact between translating convex polygons by conservative advancement
+//Each step measures the gap with GJK and moves time forward by the gap over the closing speed along the separating
+//normal. The polygons can not close faster than that, so a step never passes through the first contact however far
+//they move in the frame. Polygons with zero velocity are static hulls to the rest
+//The batched form gets its pairs from the broadphase cells under the bounds swept over the frame
+//------------------------------------------------------------------------------------------------------------------------------
+class TimeOfImpactSolver
+{
+public:
+	TimeOfImpactSolver();
+	~TimeOfImpactSolver();
+
+	static void				ComputeTimeOfImpact(const std::vector<Vec2>& pointsA, const Vec2& velocityA, const std::vector<Vec2>& pointsB, const Vec2& velocityB, float maxTime, TimeOfImpact2D& resultOut);
+
+	//Pairs whose bounds swept over deltaSeconds overlap, sorted by geometry index. Pairs of two static polygons are left out
+	void					FindSweptPairs(const std::vector<Geometry>& geometry, const std::vector<Vec2>& velocities, float deltaSeconds, const BitFieldBroadPhase& broadPhase, std::vector<OverlapPair>& pairsOut, JobPool* jobPool = nullptr);
+
+	//resultsOut lines up with pairs, times are in [0, deltaSeconds]. Every polygon is taken to move for the whole frame
+	void					ComputeTimesOfImpact(const std::vector<Geometry>& geometry, const std::vector<Vec2>& velocities, float deltaSeconds, const std::vector<OverlapPair>& pairs, std::vector<TimeOfImpact2D>& resultsOut, JobPool* jobPool = nullptr);
+
+	//How long each polygon can move this frame before it hits another. A polygon stopped early by one pair changes the
+	//motion its other pairs were solved with, so those are solved again with it stopping until nothing changes
+	//resultsOut lines up with pairs and holds the last solve of each, moveTimesOut lines up with geometry
+	void					ComputeMoveTimes(const std::vector<Geometry>& geometry, const std::vector<Vec2>& velocities, float deltaSeconds, const std::vector<OverlapPair>& pairs, std::vector<TimeOfImpact2D>& resultsOut, std::vector<float>& moveTimesOut, JobPool* jobPool = nullptr);
+
+	int						GetNumHits() const { return m_numHits; }
+	int						GetNumResolvePasses() const { return m_numResolvePasses; }
+
+private:
+	static void				ComputeTimeOfImpact(const std::vector<Vec2>& pointsA, const Vec2& velocityA, const std::vector<Vec2>& pointsB, const Vec2& velocityB, float maxTime, TimeOfImpact2D& resultOut, std::vector<Vec2>& scratchPoints);
+
+	//Each polygon moves until its move time and then stays put, so the pair is solved in two parts around the earlier stop
+	static void				ComputeTimeOfImpactUntilStopped(const std::vector<Vec2>& pointsA, const Vec2& velocityA, float moveTimeA, const std::vector<Vec2>& pointsB, const Vec2& velocityB, float moveTimeB, TimeOfImpact2D& resultOut, std::vector<Vec2>& scratchPoints);
+
+	void					SolvePairs(const std::vector<Geometry>& geometry, const std::vector<Vec2>& velocities, const std::vector<float>& moveTimes, const std::vector<OverlapPair>& pairs, const std::vector<int>& pairIndices, std::vector<TimeOfImpact2D>& resultsOut, JobPool* jobPool) const;
+	void					CountHits(const std::vector<TimeOfImpact2D>& results);
+
+	void					FindPairsInCell(int cellIndex, std::vector<OverlapCellEntry>& scratchEntries, std::vector<OverlapPair>& pairsOut) const;
+
+private:
+	//Geometry index i, bounds cover the polygon at the start and the end of the frame
+	std::vector<Vec2>		m_sweptMins;
+	std::vector<Vec2>		m_sweptMaxs;
+	std::vector<bool>		m_isStatic;
+
+	BitFieldCellBuckets		m_cellBuckets;
+
+	int						m_numHits = 0;
+	int						m_numResolvePasses = 0;
+};
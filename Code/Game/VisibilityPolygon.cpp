@@ -0,0 +1,419 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/VisibilityPolygon.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Game/BitBucketBroadPhase.hpp"
+#include "Game/Geometry.hpp"
+#include "Game/OverlapPairs.hpp"
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Same value atan2f gives for points on the negative x axis, so split segments line up exactly with their neighbours
+static const float SWEEP_HALF_TURN = atan2f(0.f, -1.f);
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Segment as seen from the viewer, always running counter clockwise from m_startAngle to m_endAngle
+struct SweepSegment
+{
+	Vec2	m_start;
+	Vec2	m_end;
+	float	m_startAngle = 0.f;
+	float	m_endAngle = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct SweepEvent
+{
+	float	m_angle = 0.f;
+	bool	m_isStart = false;
+	int		m_segmentIndex = -1;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static float CrossProduct(const Vec2& a, const Vec2& b)
+{
+	return a.x * b.y - a.y * b.x;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static float GetDistanceAlongRay(const Vec2& viewer, const Vec2& direction, const SweepSegment& segment)
+{
+	Vec2 edge = segment.m_end - segment.m_start;
+	float denominator = CrossProduct(direction, edge);
+	if (denominator == 0.f)
+		return (segment.m_start - viewer).GetLength();
+
+	return CrossProduct(segment.m_start - viewer, edge) / denominator;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static Vec2 GetPointAtAngle(const Vec2& viewer, const SweepSegment& segment, float angle)
+{
+	if (angle == segment.m_startAngle)
+		return segment.m_start;
+
+	if (angle == segment.m_endAngle)
+		return segment.m_end;
+
+	Vec2 direction = Vec2(cosf(angle), sinf(angle));
+	return viewer + GetDistanceAlongRay(viewer, direction, segment) * direction;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Edges poking out of the world would cross the world bounds segments, so only the part inside is kept
+static bool ClipSegmentToBounds(const Vec2& start, const Vec2& end, const AABB2& bounds, Vec2& clippedStartOut, Vec2& clippedEndOut)
+{
+	Vec2 delta = end - start;
+	float enterFraction = 0.f;
+	float exitFraction = 1.f;
+
+	float starts[2] = { start.x, start.y };
+	float deltas[2] = { delta.x, delta.y };
+	float mins[2] = { bounds.m_minBounds.x, bounds.m_minBounds.y };
+	float maxs[2] = { bounds.m_maxBounds.x, bounds.m_maxBounds.y };
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (deltas[axis] == 0.f)
+		{
+			if (starts[axis] < mins[axis] || starts[axis] > maxs[axis])
+				return false;
+
+			continue;
+		}
+
+		float minFraction = (mins[axis] - starts[axis]) / deltas[axis];
+		float maxFraction = (maxs[axis] - starts[axis]) / deltas[axis];
+		enterFraction = GetHigherValue(enterFraction, GetLowerValue(minFraction, maxFraction));
+		exitFraction = GetLowerValue(exitFraction, GetHigherValue(minFraction, maxFraction));
+	}
+
+	if (enterFraction >= exitFraction)
+		return false;
+
+	clippedStartOut = (enterFraction == 0.f) ? start : start + enterFraction * delta;
+	clippedEndOut = (exitFraction == 1.f) ? end : start + exitFraction * delta;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Orders segments under the sweep ray by distance. Segments never cross, so comparing two of them anywhere inside the
+//angle range they share gives the same answer and the middle of that range is the safest place to do it
+struct SweepOrder
+{
+	const std::vector<SweepSegment>*	m_segments = nullptr;
+	Vec2								m_viewer;
+
+	bool operator()(int lhsIndex, int rhsIndex) const
+	{
+		if (lhsIndex == rhsIndex)
+			return false;
+
+		const SweepSegment& lhs = (*m_segments)[lhsIndex];
+		const SweepSegment& rhs = (*m_segments)[rhsIndex];
+
+		float sharedStart = GetHigherValue(lhs.m_startAngle, rhs.m_startAngle);
+		float sharedEnd = GetLowerValue(lhs.m_endAngle, rhs.m_endAngle);
+		float compareAngle = 0.5f * (sharedStart + sharedEnd);
+		Vec2 direction = Vec2(cosf(compareAngle), sinf(compareAngle));
+
+		float lhsDistance = GetDistanceAlongRay(m_viewer, direction, lhs);
+		float rhsDistance = GetDistanceAlongRay(m_viewer, direction, rhs);
+		if (lhsDistance != rhsDistance)
+			return lhsDistance < rhsDistance;
+
+		return lhsIndex < rhsIndex;
+	}
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+VisibilityPolygonQuery::VisibilityPolygonQuery()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VisibilityPolygonQuery::~VisibilityPolygonQuery()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VisibilityPolygonQuery::BuildFromGeometry(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase, const AABB2& worldBounds)
+{
+	Clear();
+	m_worldBounds = worldBounds;
+
+	//Only edges of overlapping polygons can cross, so those are the only ones that need splitting
+	OverlapPairFinder overlapFinder;
+	std::vector<OverlapPair> overlapPairs;
+	overlapFinder.FindOverlappingPairs(geometry, broadPhase, overlapPairs);
+
+	std::vector<std::vector<int>> overlappingGeometry(geometry.size());
+	for (int pairIndex = 0; pairIndex < (int)overlapPairs.size(); pairIndex++)
+	{
+		overlappingGeometry[overlapPairs[pairIndex].m_geometryIndexA].push_back(overlapPairs[pairIndex].m_geometryIndexB);
+		overlappingGeometry[overlapPairs[pairIndex].m_geometryIndexB].push_back(overlapPairs[pairIndex].m_geometryIndexA);
+	}
+
+	std::vector<float> splitFractions;
+	for (int geometryIndex = 0; geometryIndex < (int)geometry.size(); geometryIndex++)
+	{
+		const std::vector<Vec2>& points = geometry[geometryIndex].GetConvexPoly2D().GetConvexPoly2DPoints();
+		int numPoints = (int)points.size();
+		if (numPoints < 3)
+			continue;
+
+		//Winding decides which side of each edge is outside
+		float doubleArea = 0.f;
+		for (int pointIndex = 0; pointIndex < numPoints; pointIndex++)
+		{
+			doubleArea += CrossProduct(points[pointIndex], points[(pointIndex + 1) % numPoints]);
+		}
+		float windingSign = (doubleArea >= 0.f) ? 1.f : -1.f;
+
+		for (int pointIndex = 0; pointIndex < numPoints; pointIndex++)
+		{
+			const Vec2& edgeStart = points[pointIndex];
+			const Vec2& edgeEnd = points[(pointIndex + 1) % numPoints];
+			Vec2 edge = edgeEnd - edgeStart;
+
+			Vec2 outwardNormal = windingSign * Vec2(edge.y, -edge.x);
+			outwardNormal.Normalize();
+
+			splitFractions.clear();
+			const std::vector<int>& overlapping = overlappingGeometry[geometryIndex];
+			for (int overlapIndex = 0; overlapIndex < (int)overlapping.size(); overlapIndex++)
+			{
+				const std::vector<Vec2>& otherPoints = geometry[overlapping[overlapIndex]].GetConvexPoly2D().GetConvexPoly2DPoints();
+				int numOtherPoints = (int)otherPoints.size();
+				for (int otherIndex = 0; otherIndex < numOtherPoints; otherIndex++)
+				{
+					const Vec2& otherStart = otherPoints[otherIndex];
+					Vec2 otherEdge = otherPoints[(otherIndex + 1) % numOtherPoints] - otherStart;
+
+					float denominator = CrossProduct(edge, otherEdge);
+					if (denominator == 0.f)
+						continue;
+
+					float fraction = CrossProduct(otherStart - edgeStart, otherEdge) / denominator;
+					float otherFraction = CrossProduct(otherStart - edgeStart, edge) / denominator;
+					if (fraction > 0.f && fraction < 1.f && otherFraction >= 0.f && otherFraction <= 1.f)
+					{
+						splitFractions.push_back(fraction);
+					}
+				}
+			}
+
+			AddSplitEdges(edgeStart, edgeEnd, outwardNormal, splitFractions);
+		}
+	}
+
+	//World bounds close off the region and are never culled
+	Vec2 corners[4] = { worldBounds.m_minBounds, Vec2(worldBounds.m_maxBounds.x, worldBounds.m_minBounds.y), worldBounds.m_maxBounds, Vec2(worldBounds.m_minBounds.x, worldBounds.m_maxBounds.y) };
+	for (int cornerIndex = 0; cornerIndex < 4; cornerIndex++)
+	{
+		VisibilitySegment segment;
+		segment.m_start = corners[cornerIndex];
+		segment.m_end = corners[(cornerIndex + 1) % 4];
+		segment.m_outwardNormal = Vec2::ZERO;
+		m_segments.push_back(segment);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VisibilityPolygonQuery::Clear()
+{
+	m_segments.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VisibilityPolygonQuery::AddSplitEdges(const Vec2& edgeStart, const Vec2& edgeEnd, const Vec2& outwardNormal, std::vector<float>& splitFractions)
+{
+	std::sort(splitFractions.begin(), splitFractions.end());
+	splitFractions.push_back(1.f);
+
+	Vec2 edge = edgeEnd - edgeStart;
+	Vec2 pieceStart = edgeStart;
+	for (int splitIndex = 0; splitIndex < (int)splitFractions.size(); splitIndex++)
+	{
+		Vec2 pieceEnd = (splitFractions[splitIndex] == 1.f) ? edgeEnd : edgeStart + splitFractions[splitIndex] * edge;
+
+		VisibilitySegment segment;
+		if (ClipSegmentToBounds(pieceStart, pieceEnd, m_worldBounds, segment.m_start, segment.m_end))
+		{
+			segment.m_outwardNormal = outwardNormal;
+			m_segments.push_back(segment);
+		}
+
+		pieceStart = pieceEnd;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VisibilityPolygonQuery::ComputeVisibilityPolygon(const Vec2& viewer, std::vector<Vec2>& polygonOut, std::vector<float>* anglesOut) const
+{
+	polygonOut.clear();
+	if (anglesOut != nullptr)
+	{
+		anglesOut->clear();
+	}
+
+	//Outside the world bounds there is nothing to close the region off with
+	if (viewer.x <= m_worldBounds.m_minBounds.x || viewer.x >= m_worldBounds.m_maxBounds.x || viewer.y <= m_worldBounds.m_minBounds.y || viewer.y >= m_worldBounds.m_maxBounds.y)
+		return;
+
+	std::vector<SweepSegment> segments;
+	segments.reserve(m_segments.size());
+	for (int segmentIndex = 0; segmentIndex < (int)m_segments.size(); segmentIndex++)
+	{
+		const VisibilitySegment& source = m_segments[segmentIndex];
+
+		//Edges facing away are behind the front of their own polygon
+		const Vec2& normal = source.m_outwardNormal;
+		if ((normal.x != 0.f || normal.y != 0.f) && normal.x * (viewer.x - source.m_start.x) + normal.y * (viewer.y - source.m_start.y) <= 0.f)
+			continue;
+
+		Vec2 toStart = source.m_start - viewer;
+		Vec2 toEnd = source.m_end - viewer;
+		float winding = CrossProduct(toStart, toEnd);
+		if (winding == 0.f)
+			continue;
+
+		SweepSegment segment;
+		segment.m_start = (winding > 0.f) ? source.m_start : source.m_end;
+		segment.m_end = (winding > 0.f) ? source.m_end : source.m_start;
+		segment.m_startAngle = atan2f(segment.m_start.y - viewer.y, segment.m_start.x - viewer.x);
+		segment.m_endAngle = atan2f(segment.m_end.y - viewer.y, segment.m_end.x - viewer.x);
+
+		//Segments seen end on cover no angle at all
+		if (segment.m_startAngle == segment.m_endAngle)
+			continue;
+
+		//Split segments crossing the negative x axis so every angle range runs forwards inside [-PI, PI]
+		if (segment.m_startAngle > segment.m_endAngle)
+		{
+			//Rounding can flip the angles of a segment that is almost end on, those do not really cross
+			if (segment.m_start.y < viewer.y || segment.m_end.y > viewer.y || segment.m_start.y == segment.m_end.y)
+				continue;
+
+			float fraction = (viewer.y - segment.m_start.y) / (segment.m_end.y - segment.m_start.y);
+			Vec2 crossingPoint = segment.m_start + fraction * (segment.m_end - segment.m_start);
+			crossingPoint.y = viewer.y;
+
+			SweepSegment lowerPiece = segment;
+			lowerPiece.m_start = crossingPoint;
+			lowerPiece.m_startAngle = -SWEEP_HALF_TURN;
+
+			segment.m_end = crossingPoint;
+			segment.m_endAngle = SWEEP_HALF_TURN;
+
+			if (lowerPiece.m_startAngle < lowerPiece.m_endAngle)
+			{
+				segments.push_back(lowerPiece);
+			}
+
+			if (segment.m_startAngle >= segment.m_endAngle)
+				continue;
+		}
+
+		segments.push_back(segment);
+	}
+
+	std::vector<SweepEvent> events;
+	events.reserve(segments.size() * 2);
+	for (int segmentIndex = 0; segmentIndex < (int)segments.size(); segmentIndex++)
+	{
+		SweepEvent startEvent;
+		startEvent.m_angle = segments[segmentIndex].m_startAngle;
+		startEvent.m_isStart = true;
+		startEvent.m_segmentIndex = segmentIndex;
+		events.push_back(startEvent);
+
+		SweepEvent endEvent;
+		endEvent.m_angle = segments[segmentIndex].m_endAngle;
+		endEvent.m_isStart = false;
+		endEvent.m_segmentIndex = segmentIndex;
+		events.push_back(endEvent);
+	}
+
+	//Ends before starts at the same angle so a segment is out of the set before the one continuing from it goes in
+	std::sort(events.begin(), events.end(), [](const SweepEvent& lhs, const SweepEvent& rhs)
+	{
+		if (lhs.m_angle != rhs.m_angle)
+			return lhs.m_angle < rhs.m_angle;
+
+		return !lhs.m_isStart && rhs.m_isStart;
+	});
+
+	SweepOrder sweepOrder;
+	sweepOrder.m_segments = &segments;
+	sweepOrder.m_viewer = viewer;
+
+	typedef std::set<int, SweepOrder> ActiveSet;
+	ActiveSet activeSegments(sweepOrder);
+	std::vector<ActiveSet::iterator> activeHandles(segments.size(), activeSegments.end());
+
+	int eventIndex = 0;
+	int numEvents = (int)events.size();
+	while (eventIndex < numEvents)
+	{
+		float angle = events[eventIndex].m_angle;
+		int nearestBefore = activeSegments.empty() ? -1 : *activeSegments.begin();
+
+		for (; eventIndex < numEvents && events[eventIndex].m_angle == angle; eventIndex++)
+		{
+			int segmentIndex = events[eventIndex].m_segmentIndex;
+			if (events[eventIndex].m_isStart)
+			{
+				activeHandles[segmentIndex] = activeSegments.insert(segmentIndex).first;
+			}
+			else if (activeHandles[segmentIndex] != activeSegments.end())
+			{
+				activeSegments.erase(activeHandles[segmentIndex]);
+				activeHandles[segmentIndex] = activeSegments.end();
+			}
+		}
+
+		int nearestAfter = activeSegments.empty() ? -1 : *activeSegments.begin();
+		if (nearestAfter == nearestBefore)
+			continue;
+
+		//The nearest segment changed at this angle, the boundary jumps from the old one to the new one along the ray
+		if (nearestBefore != -1)
+		{
+			Vec2 point = GetPointAtAngle(viewer, segments[nearestBefore], angle);
+			if (polygonOut.empty() || point != polygonOut.back())
+			{
+				polygonOut.push_back(point);
+				if (anglesOut != nullptr)
+				{
+					anglesOut->push_back(angle);
+				}
+			}
+		}
+
+		if (nearestAfter != -1)
+		{
+			Vec2 point = GetPointAtAngle(viewer, segments[nearestAfter], angle);
+			if (polygonOut.empty() || point != polygonOut.back())
+			{
+				polygonOut.push_back(point);
+				if (anglesOut != nullptr)
+				{
+					anglesOut->push_back(angle);
+				}
+			}
+		}
+	}
+
+	//The sweep ends where it started
+	if (polygonOut.size() > 1 && polygonOut.front() == polygonOut.back())
+	{
+		polygonOut.pop_back();
+		if (anglesOut != nullptr)
+		{
+			anglesOut->pop_back();
+		}
+	}
+}
@@ -0,0 +1,47 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class BitFieldBroadPhase;
+class Geometry;
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Occluding segment, polygon edges are split where overlapping polygons cross so no two segments cross each other
+struct VisibilitySegment
+{
+	Vec2	m_start;
+	Vec2	m_end;
+	Vec2	m_outwardNormal;	//Normal of the polygon edge the segment came from, zero for the world bounds
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Exact region visible from a point, clipped to the world bounds
+//Segment end points are swept in angle order around the viewer while an ordered set of the segments under the sweep
+//ray keeps the nearest one at the front, so a query is O(n log n) in the number of segments facing the viewer
+//Edges facing away are skipped, which also means a viewer inside a polygon sees out through it
+//------------------------------------------------------------------------------------------------------------------------------
+class VisibilityPolygonQuery
+{
+public:
+	VisibilityPolygonQuery();
+	~VisibilityPolygonQuery();
+
+	void					BuildFromGeometry(const std::vector<Geometry>& geometry, const BitFieldBroadPhase& broadPhase, const AABB2& worldBounds);
+	void					Clear();
+
+	//Vertices of the visible region counter clockwise around the viewer, a fan from the viewer over them covers it
+	//anglesOut gets the sweep angle of each vertex, these never decrease and start at -PI
+	void					ComputeVisibilityPolygon(const Vec2& viewer, std::vector<Vec2>& polygonOut, std::vector<float>* anglesOut = nullptr) const;
+
+	int						GetNumSegments() const { return (int)m_segments.size(); }
+
+private:
+	void					AddSplitEdges(const Vec2& edgeStart, const Vec2& edgeEnd, const Vec2& outwardNormal, std::vector<float>& splitFractions);
+
+private:
+	std::vector<VisibilitySegment>	m_segments;
+	AABB2					m_worldBounds;
+};